@@ -47,6 +47,9 @@
 
 #define MP42TS_PRINT_TIME_MS 500 /*refresh printed info every CLOCK_REFRESH ms*/
 #define MP42TS_VIDEO_FREQ 1000 /*meant to send AVC IDR only every CLOCK_REFRESH ms*/
+#define MP42TS_UDP_BATCH 32 /*max number of UDP datagrams sent at once*/
+#define MP42TS_PACE_SPIN_US 300 /*busy-wait before each pack deadline when pacing the output, absorbs the scheduler wake-up latency*/
+#define MP42TS_PACE_NB_BINS 8 /*number of bins in pacing histograms*/
 
 
 s32 temi_id_1 = -1;
@@ -118,7 +121,11 @@ static GFINLINE void usage()
 	        "-nb-pack N             specifies to pack up to N TS packets together before sending on network or writing to file\n"
 	        "-pcr-ms N              sets max interval in ms between 2 PCR. Default is 100 ms or at each PES header\n"
 	        "-force-pcr-only        allows sending PCR-only packets to enforce the requested PCR rate - STILL EXPERIMENTAL.\n"
+	        "-threads               reads the input data of each program in a dedicated thread\n"
 	        "-ttl N                 specifies Time-To-Live for multicast. Default is 1.\n"
+	        "-udp-pace              UDP datagrams leave the host at their multiplex time (kernel pacing, requires fq or etf queuing discipline, real-time mode only)\n"
+	        "-pace                  sends each pack at the system time matching its multiplex time (real-time mode only)\n"
+	        "                        * PCR jitter and burst statistics are printed during the multiplex\n"
 	        "-ifce IPIFCE           specifies default IP interface to use. Default is IF_ANY.\n"
 	        "-temi [URL]            Inserts TEMI time codes in adaptation field. URL is optionnal, and can be a number for external timeline IDs\n"
 	        "-temi-delay DelayMS    Specifies delay between two TEMI url descriptors (default is 1000)\n"
@@ -1836,7 +1843,7 @@ static GFINLINE GF_Err parse_args(int argc, char **argv, u32 *mux_rate, u32 *car
                                   Bool *real_time, u32 *run_time, char **video_buffer, u32 *video_buffer_size,
                                   u32 *audio_input_type, char **audio_input_ip, u16 *audio_input_port,
                                   u32 *output_type, char **ts_out, char **udp_out, char **rtp_out, u16 *output_port,
-                                  char** segment_dir, u32 *segment_duration, char **segment_manifest, u32 *segment_number, char **segment_http_prefix, u32 *split_rap, u32 *nb_pck_pack, u32 *pcr_ms, u32 *ttl, const char **ip_ifce, const char **temi_url, u32 *sdt_refresh_rate, Bool *enable_forced_pcr)
+                                  char** segment_dir, u32 *segment_duration, char **segment_manifest, u32 *segment_number, char **segment_http_prefix, u32 *split_rap, u32 *nb_pck_pack, u32 *pcr_ms, u32 *ttl, const char **ip_ifce, const char **temi_url, u32 *sdt_refresh_rate, Bool *enable_forced_pcr, Bool *udp_pace, Bool *program_threads, Bool *pace)
 {
 	Bool rate_found=0, mpeg4_carousel_found=0, time_found=0, src_found=0, dst_found=0, audio_input_found=0, video_input_found=0,
 	     seg_dur_found=0, seg_dir_found=0, seg_manifest_found=0, seg_number_found=0, seg_http_found=0, real_time_found=0, insert_ntp=0;
@@ -1985,6 +1992,12 @@ static GFINLINE GF_Err parse_args(int argc, char **argv, u32 *mux_rate, u32 *car
 			*split_rap = 2;
 		} else if (!stricmp(arg, "-force-pcr-only")) {
 			*enable_forced_pcr = GF_TRUE;
+		} else if (!stricmp(arg, "-udp-pace")) {
+			*udp_pace = GF_TRUE;
+		} else if (!stricmp(arg, "-threads")) {
+			*program_threads = GF_TRUE;
+		} else if (!stricmp(arg, "-pace")) {
+			*pace = GF_TRUE;
 		} else if (CHECK_PARAM("-nb-pack")) {
 			*nb_pck_pack = atoi(next_arg);
 		} else if (CHECK_PARAM("-nb-pck")) {
@@ -2211,6 +2224,109 @@ error:
 	return GF_BAD_PARAM;
 }
 
+static void send_udp_batch(GF_Socket *sk, GF_SockDatagram *batch, u32 *nb_batch)
+{
+	u32 nb_sent;
+	GF_Err e = gf_sk_send_batch(sk, batch, *nb_batch, &nb_sent);
+	if (e) {
+		fprintf(stderr, "Error %s sending UDP packet\n", gf_error_to_string(e));
+	}
+	*nb_batch = 0;
+}
+
+/*pacing statistics: deadline jitter (send time minus multiplex time of the pack) and bursts (packs sent back-to-back because their deadline was already passed)*/
+typedef struct
+{
+	u64 nb_packs, jitter_sum;
+	u32 jitter_max, burst_max;
+	u32 jitter_hist[MP42TS_PACE_NB_BINS];
+	u32 burst_hist[MP42TS_PACE_NB_BINS];
+} M2TSPaceStats;
+
+typedef struct
+{
+	/*stats since last print and since start*/
+	M2TSPaceStats window, total;
+	/*number of packs in the current burst*/
+	u32 burst_size;
+} M2TSPacer;
+
+/*upper bounds of the histogram bins, in microseconds for jitter and packs for bursts*/
+static const u32 pace_jitter_bins[MP42TS_PACE_NB_BINS-1] = {50, 100, 250, 500, 1000, 2000, 5000};
+static const u32 pace_burst_bins[MP42TS_PACE_NB_BINS-1] = {2, 3, 5, 9, 17, 33, 65};
+
+static u32 pace_get_bin(const u32 *bins, u32 val)
+{
+	u32 i;
+	for (i=0; i<MP42TS_PACE_NB_BINS-1; i++) {
+		if (val < bins[i]) return i;
+	}
+	return MP42TS_PACE_NB_BINS-1;
+}
+
+/*system clock time at which the multiplex reaches its current time (PCR clock), as used by the muxer to release packets in real-time mode*/
+static u64 pace_get_deadline(GF_M2TS_Mux *muxer)
+{
+	u64 ts_time = (u64) muxer->time.sec * 1000000 + muxer->time.nanosec / 1000;
+	u64 ts_init = (u64) muxer->init_ts_time.sec * 1000000 + muxer->init_ts_time.nanosec / 1000;
+	if (ts_time < ts_init) return muxer->init_sys_time;
+	return muxer->init_sys_time + ts_time - ts_init;
+}
+
+static void pace_end_burst(M2TSPacer *pacer)
+{
+	u32 bin;
+	if (!pacer->burst_size) return;
+	bin = pace_get_bin(pace_burst_bins, pacer->burst_size);
+	pacer->window.burst_hist[bin]++;
+	pacer->total.burst_hist[bin]++;
+	if (pacer->burst_size > pacer->window.burst_max) pacer->window.burst_max = pacer->burst_size;
+	if (pacer->burst_size > pacer->total.burst_max) pacer->total.burst_max = pacer->burst_size;
+	pacer->burst_size = 0;
+}
+
+static void pace_update_stats(M2TSPaceStats *stats, u32 jitter)
+{
+	stats->nb_packs++;
+	stats->jitter_sum += jitter;
+	if (jitter > stats->jitter_max) stats->jitter_max = jitter;
+	stats->jitter_hist[pace_get_bin(pace_jitter_bins, jitter)]++;
+}
+
+/*waits until the deadline of the pack about to be sent, the pack ends at the current multiplex time*/
+static void pace_wait_pack(M2TSPacer *pacer, GF_M2TS_Mux *muxer)
+{
+	u64 deadline = pace_get_deadline(muxer);
+	u64 now = gf_sys_clock_high_res();
+	if (now < deadline) {
+		pace_end_burst(pacer);
+		gf_sleep_until_high_res(deadline, MP42TS_PACE_SPIN_US);
+		now = gf_sys_clock_high_res();
+	}
+	pacer->burst_size++;
+	pace_update_stats(&pacer->window, (u32) (now - deadline));
+	pace_update_stats(&pacer->total, (u32) (now - deadline));
+}
+
+/*waits for the next packet to be released by the muxer*/
+static void pace_wait_idle(M2TSPacer *pacer, u32 usec_till_next)
+{
+	pace_end_burst(pacer);
+	if (!usec_till_next || (usec_till_next > 1000)) usec_till_next = 1000;
+	gf_sleep_until_high_res(gf_sys_clock_high_res() + usec_till_next, MP42TS_PACE_SPIN_US);
+}
+
+static void pace_print_stats(M2TSPaceStats *stats, const char *name)
+{
+	const u32 *h = stats->jitter_hist;
+	const u32 *b = stats->burst_hist;
+	if (!stats->nb_packs) return;
+	fprintf(stderr, "%s: "LLU" packs - PCR jitter avg %d max %d us [<50:%d <100:%d <250:%d <500:%d <1ms:%d <2ms:%d <5ms:%d >=5ms:%d] - bursts max %d [1:%d 2:%d 3-4:%d 5-8:%d 9-16:%d 17-32:%d 33-64:%d >64:%d]\n",
+	        name, stats->nb_packs, (u32) (stats->jitter_sum / stats->nb_packs), stats->jitter_max,
+	        h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+	        stats->burst_max, b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7]);
+}
+
 static GF_Err write_manifest(char *manifest, char *segment_dir, u32 segment_duration, char *segment_prefix, char *http_prefix, u32 first_segment, u32 last_segment, Bool end)
 {
 	FILE *manifest_fp;
@@ -2272,10 +2388,16 @@ int main(int argc, char **argv)
 	s64 pcr_init_val = -1;
 	u32 usec_till_next, ttl, split_rap, sdt_refresh_rate;
 	GF_M2TS_PackMode pes_packing_mode;
-	u32 i, j, mux_rate, nb_sources, cur_pid, carrousel_rate, last_print_time, last_video_time, bifs_use_pes, psi_refresh_rate, nb_pck_pack, nb_pck_in_pack, pcr_ms;
+	u32 i, j, mux_rate, nb_sources, cur_pid, carrousel_rate, last_print_time, last_video_time, bifs_use_pes, psi_refresh_rate, nb_pck_pack, nb_pck_in_pack, nb_pck, pcr_ms;
 	char *ts_out = NULL, *udp_out = NULL, *rtp_out = NULL, *audio_input_ip = NULL;
 	FILE *ts_output_file = NULL;
 	GF_Socket *ts_output_udp_sk = NULL, *audio_input_udp_sk = NULL;
+	GF_SockDatagram udp_batch[MP42TS_UDP_BATCH];
+	char *udp_batch_buffer = NULL;
+	u32 nb_udp_batch = 0;
+	Bool udp_pace = GF_FALSE;
+	Bool pace = GF_FALSE;
+	M2TSPacer pacer;
 #ifndef GPAC_DISABLE_STREAMING
 	GF_RTPChannel *ts_output_rtp = NULL;
 	GF_RTSPTransport tr;
@@ -2299,6 +2421,7 @@ int main(int argc, char **argv)
 	GF_M2TS_Time prev_seg_time;
 	GF_M2TS_Mux *muxer;
 	Bool enable_forced_pcr = GF_FALSE;
+	Bool program_threads = GF_FALSE;
 	/*****************/
 	/*   gpac init   */
 	/*****************/
@@ -2357,10 +2480,21 @@ int main(int argc, char **argv)
 	                        &real_time, &run_time, &video_buffer, &video_buffer_size,
 	                        &audio_input_type, &audio_input_ip, &audio_input_port,
 	                        &output_type, &ts_out, &udp_out, &rtp_out, &output_port,
-	                        &segment_dir, &segment_duration, &segment_manifest, &segment_number, &segment_http_prefix, &split_rap, &nb_pck_pack, &pcr_ms, &ttl, &ip_ifce, &insert_temi, &sdt_refresh_rate, &enable_forced_pcr)) {
+	                        &segment_dir, &segment_duration, &segment_manifest, &segment_number, &segment_http_prefix, &split_rap, &nb_pck_pack, &pcr_ms, &ttl, &ip_ifce, &insert_temi, &sdt_refresh_rate, &enable_forced_pcr, &udp_pace, &program_threads, &pace)) {
 		goto exit;
 	}
 
+	if (pace && !real_time) {
+		fprintf(stderr, "Output pacing requires real-time mode - disabling pacing\n");
+		pace = GF_FALSE;
+	}
+	/*departure times are mapped through the real-time clock of the muxer*/
+	if (udp_pace && !real_time) {
+		fprintf(stderr, "UDP pacing requires real-time mode - disabling UDP pacing\n");
+		udp_pace = GF_FALSE;
+	}
+	memset(&pacer, 0, sizeof(M2TSPacer));
+
 	if (run_time && !mux_rate) {
 		fprintf(stderr, "Cannot specify TS run time for VBR multiplex - disabling run time\n");
 		run_time = 0;
@@ -2378,6 +2512,7 @@ int main(int argc, char **argv)
 	if (pcr_init_val>=0) gf_m2ts_mux_set_initial_pcr(muxer, (u64) pcr_init_val);
 	gf_m2ts_mux_set_pcr_max_interval(muxer, pcr_ms);
 	gf_m2ts_mux_enable_pcr_only_packets(muxer, enable_forced_pcr);
+	gf_m2ts_mux_enable_program_threads(muxer, program_threads);
 
 
 	if (ts_out != NULL) {
@@ -2422,6 +2557,10 @@ int main(int argc, char **argv)
 			fprintf(stderr, "Error initializing UDP socket: %s\n", gf_error_to_string(e));
 			goto exit;
 		}
+		if (udp_pace && (gf_sk_set_paced_send(ts_output_udp_sk, GF_TRUE) != GF_OK)) {
+			fprintf(stderr, "UDP pacing not supported - sending datagrams immediately\n");
+			udp_pace = GF_FALSE;
+		}
 	}
 #ifndef GPAC_DISABLE_STREAMING
 	if (rtp_out != NULL) {
@@ -2574,8 +2713,10 @@ int main(int argc, char **argv)
 	}
 	gf_m2ts_mux_update_config(muxer, 1);
 
-	if (nb_pck_pack>1) {
-		ts_pack_buffer = gf_malloc(sizeof(char) * 188 * nb_pck_pack);
+	if (!nb_pck_pack) nb_pck_pack = 1;
+	ts_pack_buffer = gf_malloc(sizeof(char) * 188 * nb_pck_pack);
+	if (ts_output_udp_sk) {
+		udp_batch_buffer = gf_malloc(sizeof(char) * 188 * nb_pck_pack * MP42TS_UDP_BATCH);
 	}
 
 	/*****************/
@@ -2621,21 +2762,19 @@ int main(int argc, char **argv)
 
 		/*flush all packets*/
 		nb_pck_in_pack=0;
-		while ((ts_pck = gf_m2ts_mux_process(muxer, &status, &usec_till_next)) != NULL) {
-
-			if (ts_pack_buffer ) {
-				memcpy(ts_pack_buffer + 188 * nb_pck_in_pack, ts_pck, 188);
-				nb_pck_in_pack++;
+		usec_till_next=0;
+		while ((nb_pck = gf_m2ts_mux_process_packets(muxer, ts_pack_buffer + 188 * nb_pck_in_pack, nb_pck_pack - nb_pck_in_pack, &status, &usec_till_next)) != 0) {
 
-				if (nb_pck_in_pack < nb_pck_pack)
-					continue;
+			nb_pck_in_pack += nb_pck;
+			/*pack not full, no more packets ready*/
+			if (nb_pck_in_pack < nb_pck_pack)
+				break;
 
-				ts_pck = (const char *) ts_pack_buffer;
-			} else {
-				nb_pck_in_pack = 1;
-			}
+			ts_pck = (const char *) ts_pack_buffer;
 
 call_flush:
+			if (pace) pace_wait_pack(&pacer, muxer);
+
 			if (ts_output_file != NULL) {
 				gf_fwrite(ts_pck, 1, 188 * nb_pck_in_pack, ts_output_file);
 				if (segment_duration && (muxer->time.sec > prev_seg_time.sec + segment_duration)) {
@@ -2677,9 +2816,16 @@ call_flush:
 			}
 
 			if (ts_output_udp_sk != NULL) {
-				e = gf_sk_send(ts_output_udp_sk, (char*)ts_pck, 188 * nb_pck_in_pack);
-				if (e) {
-					fprintf(stderr, "Error %s sending UDP packet\n", gf_error_to_string(e));
+				GF_SockDatagram *dg = &udp_batch[nb_udp_batch];
+				dg->data = udp_batch_buffer + 188 * nb_pck_pack * nb_udp_batch;
+				dg->size = 188 * nb_pck_in_pack;
+				memcpy(dg->data, ts_pck, dg->size);
+				dg->timestamp = 0;
+				if (udp_pace) dg->timestamp = pace_get_deadline(muxer);
+				nb_udp_batch++;
+				/*paced packs are sent as soon as their deadline is reached*/
+				if (pace || (nb_udp_batch == MP42TS_UDP_BATCH)) {
+					send_udp_batch(ts_output_udp_sk, udp_batch, &nb_udp_batch);
 				}
 			}
 #ifndef GPAC_DISABLE_STREAMING
@@ -2708,6 +2854,10 @@ call_flush:
 			ts_pck = (const char *) ts_pack_buffer;
 			goto call_flush;
 		}
+		/*send pending datagrams*/
+		if (nb_udp_batch) {
+			send_udp_batch(ts_output_udp_sk, udp_batch, &nb_udp_batch);
+		}
 
 		/*push video*/
 		{
@@ -2726,6 +2876,10 @@ call_flush:
 			if (now > last_print_time + MP42TS_PRINT_TIME_MS) {
 				last_print_time = now;
 				fprintf(stderr, "M2TS: time % 6d - TS time % 6d - bitrate % 8d\r", gf_m2ts_get_sys_clock(muxer), gf_m2ts_get_ts_clock(muxer), muxer->average_birate_kbps);
+				if (pace) {
+					pace_print_stats(&pacer.window, "\nPacing");
+					memset(&pacer.window, 0, sizeof(M2TSPaceStats));
+				}
 
 				if (gf_prompt_has_input()) {
 					char c = gf_prompt_get_char();
@@ -2733,17 +2887,21 @@ call_flush:
 				}
 			}
 			if (status == GF_M2TS_STATE_IDLE) {
+				if (pace) {
+					pace_wait_idle(&pacer, usec_till_next);
+				} else {
 #if 0
-				/*wait till next packet is ready to be sent*/
-				if (usec_till_next>1000) {
-					//fprintf(stderr, "%d usec till next packet\n", usec_till_next);
-					gf_sleep(usec_till_next / 1000);
-				}
+					/*wait till next packet is ready to be sent*/
+					if (usec_till_next>1000) {
+						//fprintf(stderr, "%d usec till next packet\n", usec_till_next);
+						gf_sleep(usec_till_next / 1000);
+					}
 #else
-				//we don't have enough precision on usec counting and we end up eating one core on most machines, so let's just sleep
-				//one second whenever we are idle - it's maybe too much but the muxer will catchup afterwards
-				gf_sleep(1);
+					//we don't have enough precision on usec counting and we end up eating one core on most machines, so let's just sleep
+					//one second whenever we are idle - it's maybe too much but the muxer will catchup afterwards
+					gf_sleep(1);
 #endif
+				}
 			}
 		}
 
@@ -2765,10 +2923,15 @@ call_flush:
 		if (!dur_ms) dur_ms = 1;
 		fprintf(stderr, "Done muxing - %.02f sec - %sbitrate %d kbps "LLD" packets written\n", ((Double) dur_ms)/1000.0,mux_rate ? "" : "average ", (u32) (bits/dur_ms), muxer->tot_pck_sent);
 		fprintf(stderr, " Padding: "LLD" packets (%g kbps) - "LLD" PES padded bytes (%g kbps)\n", muxer->tot_pad_sent, (Double) (muxer->tot_pad_sent*188*8.0/dur_ms) , muxer->tot_pes_pad_bytes, (Double) (muxer->tot_pes_pad_bytes*8.0/dur_ms) );
+		if (pace) {
+			pace_end_burst(&pacer);
+			pace_print_stats(&pacer.total, " Pacing");
+		}
 	}
 
 exit:
 	if (ts_pack_buffer) gf_free(ts_pack_buffer);
+	if (udp_batch_buffer) gf_free(udp_batch_buffer);
 	run = 0;
 	if (segment_duration) {
 		write_manifest(segment_manifest, segment_dir, segment_duration, segment_prefix, segment_http_prefix, segment_index - segment_number, segment_index, 1);
@@ -3049,5 +3049,100 @@ void dump_mpeg2_ts(char *mpeg2ts_file, char *out_name, Bool prog_num)
 
 }
 
+static void on_m2ts_stats_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
+{
+}
+
+static void print_m2ts_stats(GF_M2TS_Demuxer *ts)
+{
+	u32 i;
+	GF_M2TS_Stats stats;
+	GF_M2TS_PIDStats pstats;
+
+	if (gf_m2ts_demux_get_stats(ts, &stats)) return;
+	fprintf(stdout, "Time %d ms - "LLU" packets - %d kbps (average %d kbps) - PCR PID %d - %d sync errors\n", stats.time, stats.nb_packets, stats.bitrate/1000, stats.avg_bitrate/1000, stats.pcr_pid, stats.sync_errors);
+	fprintf(stdout, "  PID type     kbps      avg      max  CC err  TEI err  scrambled   PCRs PCR rep/disc/acc err  PCR acc max/jitter ns  units  avg/max interval ms  rep err\n");
+	for (i=0; i<stats.nb_pids; i++) {
+		const char *type = "";
+		if (gf_m2ts_demux_get_pid_stats(ts, i, &pstats)) break;
+		if (pstats.flags & GF_M2TS_STATS_PAT) type = "PAT";
+		else if (pstats.flags & GF_M2TS_STATS_PMT) type = "PMT";
+		else if (pstats.flags & GF_M2TS_STATS_PES) type = "PES";
+		else if (pstats.flags & GF_M2TS_STATS_SECTION) type = "sections";
+		else if (pstats.flags & GF_M2TS_STATS_PCR) type = "PCR";
+		else if (pstats.pid == 0x1FFF) type = "null";
+		fprintf(stdout, "%5d %-8s %5d %8d %8d %7d %8d %10d %6d %8d/%d/%d %14d/%d %6d %12d/%d %8d\n", pstats.pid, type,
+		        pstats.bitrate/1000, pstats.avg_bitrate/1000, pstats.max_bitrate/1000, pstats.cc_errors, pstats.transport_errors, pstats.nb_scrambled,
+		        pstats.nb_pcr, pstats.pcr_repetition_errors, pstats.pcr_discontinuity_errors, pstats.pcr_accuracy_errors, pstats.pcr_accuracy_max, pstats.pcr_jitter,
+		        pstats.nb_units, pstats.unit_interval_avg, pstats.unit_interval_max, pstats.repetition_errors);
+	}
+	fprintf(stdout, "\n");
+	fflush(stdout);
+}
+
+/*analyzes a TS file or live TS URL, printing the statistics every period ms of stream time for files and of real time for live URLs*/
+u32 dump_mpeg2_ts_stats(char *url, u32 period)
+{
+	char data[188*100];
+	u32 next_dump;
+	GF_Err e;
+	GF_M2TS_Stats stats;
+	GF_M2TS_Demuxer *ts = gf_m2ts_demux_new();
+	ts->on_event = on_m2ts_stats_event;
+	gf_m2ts_demux_enable_stats(ts, GF_TRUE, 0);
+	next_dump = period;
+
+	if (!strnicmp(url, "udp://", 6) || !strnicmp(url, "mpegts-udp://", 13) || !strnicmp(url, "mpegts-tcp://", 13)) {
+		u32 last_dump = gf_sys_clock();
+		ts->th = gf_th_new("TS Analyzer");
+		e = gf_m2ts_demuxer_setup(ts, url, GF_FALSE);
+		if (e) {
+			fprintf(stderr, "Cannot receive TS from %s: %s\n", url, gf_error_to_string(e));
+			gf_m2ts_demux_del(ts);
+			return 1;
+		}
+		fprintf(stderr, "Analyzing %s - press 'q' to quit\n", url);
+		while (ts->run_state != 2) {
+			if (gf_prompt_has_input() && (gf_prompt_get_char()=='q'))
+				break;
+			if (period && (gf_sys_clock() - last_dump >= period)) {
+				print_m2ts_stats(ts);
+				last_dump = gf_sys_clock();
+			}
+			gf_sleep(10);
+		}
+		gf_m2ts_demuxer_close(ts);
+	} else {
+		u32 size;
+		u64 fsize, fdone;
+		FILE *src = gf_fopen(url, "rb");
+		if (!src) {
+			fprintf(stderr, "Cannot open %s: no such file\n", url);
+			gf_m2ts_demux_del(ts);
+			return 1;
+		}
+		gf_fseek(src, 0, SEEK_END);
+		fsize = gf_ftell(src);
+		gf_fseek(src, 0, SEEK_SET);
+		fdone = 0;
+		while (!feof(src)) {
+			size = (u32) fread(data, 1, sizeof(data), src);
+			if (!size) break;
+			gf_m2ts_process_data(ts, data, size);
+			fdone += size;
+			if (period && !gf_m2ts_demux_get_stats(ts, &stats) && (stats.time >= next_dump)) {
+				print_m2ts_stats(ts);
+				while (next_dump <= stats.time) next_dump += period;
+			} else if (!period) {
+				gf_set_progress("MPEG-2 TS Analyzing", fdone, fsize);
+			}
+		}
+		gf_fclose(src);
+	}
+	print_m2ts_stats(ts);
+	gf_m2ts_demux_del(ts);
+	return 0;
+}
+
 
 #endif /*GPAC_DISABLE_MPEG2TS*/
@@ -30,6 +30,7 @@
 #include <gpac/scene_manager.h>
 #include <gpac/network.h>
 #include <gpac/base_coding.h>
+#include <gpac/mpegts.h>
 
 #if !defined(GPAC_DISABLE_VRML) && !defined(GPAC_DISABLE_X3D) && !defined(GPAC_DISABLE_SVG)
 #include <gpac/scenegraph.h>
@@ -246,7 +247,7 @@ GF_Err import_file(GF_ISOFile *dest, char *inName, u32 import_flags, Double forc
 	u32 track_id, i, j, timescale, track, stype, profile, level, new_timescale, rescale, svc_mode, tile_mode, txt_flags;
 	s32 par_d, par_n, prog_id, delay;
 	s32 tw, th, tx, ty, txtw, txth, txtx, txty;
-	Bool do_audio, do_video, do_all, disable, track_layout, text_layout, chap_ref, is_chap, is_chap_file, keep_handler, negative_cts_offset, rap_only;
+	Bool do_audio, do_video, do_all, disable, track_layout, text_layout, chap_ref, is_chap, is_chap_file, keep_handler, negative_cts_offset, rap_only, ts_all_pids;
 	u32 group, handler, rvc_predefined, check_track_for_svc, check_track_for_shvc;
 	const char *szLan;
 	GF_Err e;
@@ -552,6 +553,18 @@ GF_Err import_file(GF_ISOFile *dest, char *inName, u32 import_flags, Double forc
 	}
 	if (do_audio || do_video || track_id) do_all = 0;
 
+	ts_all_pids = GF_FALSE;
+#ifndef GPAC_DISABLE_MPEG2TS
+	/*import all PIDs of an MPEG-2 TS in a single pass rather than one pass per PID, unless MPEG-4 systems streams are present*/
+	if (do_all && import.nb_tracks && gf_m2ts_probe_file(szName)) {
+		ts_all_pids = GF_TRUE;
+		for (i=0; i<import.nb_tracks; i++) {
+			if ((import.tk_info[i].media_type==GF_4CC('M','4','S','P')) || (import.tk_info[i].media_type==GF_4CC('M','4','S','S')))
+				ts_all_pids = GF_FALSE;
+		}
+	}
+#endif
+
 	if (track_layout || is_chap) {
 		u32 w, h, sw, sh, fw, fh, i;
 		w = h = sw = sh = fw = fh = 0;
@@ -697,9 +710,23 @@ GF_Err import_file(GF_ISOFile *dest, char *inName, u32 import_flags, Double forc
 			}
 		}
 	} else {
-		for (i=0; i<import.nb_tracks; i++) {
+		u32 nb_imports = import.nb_tracks;
+		u32 o_count = 0;
+		if (ts_all_pids) {
+			o_count = gf_isom_get_track_count(import.dest);
+			import.trackID = 0;
+			e = gf_media_import(&import);
+			if (e) goto exit;
+			nb_imports = gf_isom_get_track_count(import.dest) - o_count;
+		}
+		for (i=0; i<nb_imports; i++) {
 			import.trackID = import.tk_info[i].track_num;
-			if (prog_id) {
+			/*already imported, the tracks are set up one by one*/
+			if (ts_all_pids) {
+				import.final_trackID = gf_isom_get_track_id(import.dest, o_count+i+1);
+				e = GF_OK;
+			}
+			else if (prog_id) {
 				if (import.tk_info[i].prog_num!=prog_id) continue;
 				e = gf_media_import(&import);
 			}
@@ -741,7 +768,7 @@ GF_Err import_file(GF_ISOFile *dest, char *inName, u32 import_flags, Double forc
 					}
 				}
 			}
-			if ((import.tk_info[i].type==GF_ISOM_MEDIA_VISUAL) && (par_n>=-1) && (par_d>=-1)) {
+			if ((gf_isom_get_media_type(import.dest, track)==GF_ISOM_MEDIA_VISUAL) && (par_n>=-1) && (par_d>=-1)) {
 				e = gf_media_change_par(import.dest, track, par_n, par_d);
 			}
 			if (rap_only) {
@@ -127,6 +127,7 @@ void PrintLanguages();
 
 #ifndef GPAC_DISABLE_MPEG2TS
 void dump_mpeg2_ts(char *mpeg2ts_file, char *pes_out_name, Bool prog_num);
+u32 dump_mpeg2_ts_stats(char *url, u32 period);
 #endif
 
 
@@ -209,6 +210,7 @@ void PrintGeneralUsage()
 	        " -tight               performs tight interleaving (sample based) of the file\n"
 	        "                       * Note: reduces disk seek but increases file size\n"
 	        " -flat                stores file with all media data first, non-interleaved\n"
+	        " -fast-start          stores file with moov first, moving the media data as a single block when unmodified\n"
 	        " -frag time_in_ms     fragments file (track fragments of time_in_ms)\n"
 	        "                       * Note: Always disables interleaving\n"
 	        " -out filename        specifies output file name\n"
@@ -218,6 +220,8 @@ void PrintGeneralUsage()
 			" -for-test            disables all creation/modif dates and GPAC versions in files\n"
 			" -co64                forces usage of 64-bit chunk offsets for ISOBMF files\n"
 	        " -write-buffer SIZE   specifies write buffer in bytes for ISOBMF files\n"
+	        " -write-pipe SIZE     reads and writes media data of interleaved ISOBMF files in parallel, by blocks of SIZE bytes\n"
+	        " -copy-range          with -write-pipe, copies media data file to file in the kernel when possible\n"
 	        " -no-sys              removes all MPEG-4 Systems info except IOD (profiles)\n"
 	        "                       * Note: Set by default whith '-add' and '-cat'\n"
 	        " -no-iod              removes InitialObjectDescriptor from file\n"
@@ -306,6 +310,8 @@ void PrintDASHUsage()
 	        "                       Note: the duration will be the closest to \'dur\', and will remain constant\n"
 	        " -dash-live[=F] dur   generates a live DASH session using dur segment duration, optionally writing live context to F\n"
 	        "                       MP4Box will run the live session until \'q\' is pressed or a fatal error occurs.\n"
+	        "                       If the source is a live TS (udp://, mpegts-udp://, mpegts-tcp://), it is segmented\n"
+	        "                        as it is received, using -out, -segment-name, -rap and -time-shift.\n"
 	        " -ddbg-live[=F] dur   same as -dash-live without time regulation for debug purposes.\n"
 	        " -frag time_in_ms     Specifies a fragment duration of time_in_ms.\n"
 	        "                       * Note: By default, this is the DASH duration\n"
@@ -395,6 +401,7 @@ void PrintDASHUsage()
 	        " -single-traf         uses a single track fragment per moof (smooth streaming and derived specs may require this)\n"
 	        " -dash-ts-prog N      program_number to be considered in case of an MPTS input file.\n"
 	        " -frag-rt             when using fragments in live mode, flush fragments according to their timing (only supported with a single input).\n"
+	        " -ts-index            writes the index of TS inputs next to them (file.ts.tsidx) if not present. By default existing indexes are only read.\n"
 	        " -cp-location=MODE    sets ContentProtection element location. Possible values for mode are:\n"
 	        "                        as: sets ContentProtection in AdaptationSet element\n"
 	        "                        rep: sets ContentProtection in Representation element\n"
@@ -725,6 +732,8 @@ void PrintDumpUsage()
 	        " -dump-chap           Extracts chapter file\n"
 	        " -dump-chap-ogg       Extracts chapter file as OGG format\n"
 	        " -dump-udta [ID:]4cc  Extracts udta for the given 4CC. If ID is given, dumps from UDTA of the given track ID, otherwise moov is used.\n"
+	        " -ts-stats N          analyzes input MPEG-2 TS file or udp:// URL and prints per-PID bitrate, continuity, PCR and repetition statistics\n"
+	        "                       every N ms of stream time (of real time for URLs). If N is 0, prints statistics at the end only\n"
 	        "\n"
 #ifndef GPAC_DISABLE_ISOM_WRITE
 	        " -ttxt                Converts input subtitle to GPAC TTXT format\n"
@@ -1795,11 +1804,15 @@ Bool do_bin_nhml = GF_FALSE;
 #endif
 GF_ISOFile *file;
 Bool frag_real_time = GF_FALSE;
+Bool ts_index_write = GF_FALSE;
 GF_DASH_ContentLocationMode cp_location_mode = GF_DASH_CPMODE_ADAPTATION_SET;
 Double mpd_update_time = GF_FALSE;
 Bool stream_rtp = GF_FALSE;
 Bool force_test_mode = GF_FALSE;
 Bool force_co64 = GF_FALSE;
+u32 write_pipe_size = 0;
+Bool write_pipe_copy = GF_FALSE;
+Bool do_fast_start = GF_FALSE;
 Bool live_scene = GF_FALSE;
 GF_MemTrackerType mem_track = GF_MemTrackerNone;
 
@@ -1832,6 +1845,9 @@ const char *dash_more_info = NULL;
 const char *grab_m2ts = NULL;
 const char *grab_ifce = NULL;
 #endif
+#ifndef GPAC_DISABLE_MPEG2TS
+s32 ts_stats_period = -1;
+#endif
 FILE *logfile = NULL;
 
 u32 mp4box_cleanup(u32 ret_code) {
@@ -2053,6 +2069,10 @@ u32 mp4box_parse_args_continue(int argc, char **argv, u32 *current_index)
 			open_edit = GF_TRUE;
 			do_flat = GF_TRUE;
 		}
+		else if (!stricmp(arg, "-fast-start")) {
+			open_edit = GF_TRUE;
+			do_fast_start = GF_TRUE;
+		}
 		else if (!stricmp(arg, "-keep-utc")) keep_utc = GF_TRUE;
 		else if (!stricmp(arg, "-new")) force_new = GF_TRUE;
 		else if (!stricmp(arg, "-timescale")) {
@@ -2965,6 +2985,13 @@ Bool mp4box_parse_args(int argc, char **argv)
 			else dump_srt = GF_TRUE;
 			import_subtitle = 1;
 		}
+#ifndef GPAC_DISABLE_MPEG2TS
+		else if (!stricmp(arg, "-ts-stats")) {
+			CHECK_NEXT_ARG
+			ts_stats_period = atoi(argv[i + 1]);
+			i++;
+		}
+#endif
 		else if (!stricmp(arg, "-dm2ts")) {
 			dump_m2ts = 1;
 			if (((i + 1<(u32)argc) && inName) || (i + 2<(u32)argc)) {
@@ -3041,6 +3068,14 @@ Bool mp4box_parse_args(int argc, char **argv)
 			gf_isom_set_output_buffering(NULL, atoi(argv[i + 1]));
 			i++;
 		}
+		else if (!stricmp(arg, "-write-pipe")) {
+			CHECK_NEXT_ARG
+			write_pipe_size = atoi(argv[i + 1]);
+			i++;
+		}
+		else if (!stricmp(arg, "-copy-range")) {
+			write_pipe_copy = GF_TRUE;
+		}
 		else if (!stricmp(arg, "-cprt")) {
 			CHECK_NEXT_ARG cprt = argv[i + 1];
 			i++;
@@ -3144,6 +3179,9 @@ Bool mp4box_parse_args(int argc, char **argv)
 		else if (!stricmp(arg, "-frag-rt")) {
 			frag_real_time = GF_TRUE;
 		}
+		else if (!stricmp(arg, "-ts-index")) {
+			ts_index_write = GF_TRUE;
+		}
 		else if (!strnicmp(arg, "-cp-location=", 13)) {
 			if (strcmp(arg+13, "both")) cp_location_mode = GF_DASH_CPMODE_BOTH;
 			else if (strcmp(arg+13, "as")) cp_location_mode = GF_DASH_CPMODE_ADAPTATION_SET;
@@ -3295,6 +3333,53 @@ Bool mp4box_parse_args(int argc, char **argv)
 	return 0;
 }
 
+#ifndef GPAC_DISABLE_MPEG2TS
+/*segments a live TS as it is received, until 'q' is pressed or reception stops*/
+static u32 dash_ts_live_session(const char *url, const char *mpd_name, const char *seg_rad_name)
+{
+	char szMPD[GF_MAX_PATH];
+	u32 nb_segments, last_nb_segments = 0;
+	Bool is_over = GF_FALSE;
+	GF_Err e;
+	GF_DASHTSLive *live;
+
+	strcpy(szMPD, mpd_name ? mpd_name : "live_dash");
+	if (!strstr(szMPD, ".mpd")) strcat(szMPD, ".mpd");
+
+	live = gf_dasher_ts_live_new(szMPD, seg_rad_name, dash_duration, seg_at_rap, time_shift_depth);
+	if (!live) {
+		fprintf(stderr, "Cannot create live TS segmenter\n");
+		return 1;
+	}
+	e = gf_dasher_ts_live_start(live, url);
+	if (e) {
+		fprintf(stderr, "Cannot receive TS from %s: %s\n", url, gf_error_to_string(e));
+		gf_dasher_ts_live_del(live);
+		return 1;
+	}
+	fprintf(stderr, "Live DASH-ing of %s - press 'q' to quit\n", url);
+	while (!is_over) {
+		if (gf_prompt_has_input() && (gf_prompt_get_char()=='q'))
+			break;
+		e = gf_dasher_ts_live_get_status(live, &nb_segments, &is_over);
+		if (e) break;
+		if (nb_segments != last_nb_segments) {
+			fprintf(stderr, "%d segments generated\r", nb_segments);
+			last_nb_segments = nb_segments;
+		}
+		gf_sleep(10);
+	}
+	/*the pending data is written as the last segment*/
+	gf_dasher_ts_live_del(live);
+	if (e) {
+		fprintf(stderr, "Error DASHing live TS: %s\n", gf_error_to_string(e));
+		return 1;
+	}
+	fprintf(stderr, "\nLive DASH-ing done\n");
+	return 0;
+}
+#endif
+
 int mp4boxMain(int argc, char **argv)
 {
 	nb_tsel_acts = nb_add = nb_cat = nb_track_act = nb_sdp_ex = max_ptime = raw_sample_num = nb_meta_act = rtp_rate = major_brand = nb_alt_brand_add = nb_alt_brand_rem = car_dur = minor_version = 0;
@@ -3544,6 +3629,16 @@ int mp4boxMain(int argc, char **argv)
 			return mp4box_cleanup(0);
 		}
 	}
+#endif
+#ifndef GPAC_DISABLE_MPEG2TS
+	if ((ts_stats_period>=0) && inName) {
+		return mp4box_cleanup(dump_mpeg2_ts_stats(inName, ts_stats_period));
+	}
+	/*live TS sources are segmented as they are received, they cannot be read again*/
+	if (dash_duration && dash_live && !nb_dash_inputs && inName
+	        && (!strnicmp(inName, "udp://", 6) || !strnicmp(inName, "mpegts-udp://", 13) || !strnicmp(inName, "mpegts-tcp://", 13))) {
+		return mp4box_cleanup(dash_ts_live_session(inName, outName, seg_name));
+	}
 #endif
 	if (dash_duration && !nb_dash_inputs) {
 		dash_inputs = set_dash_input(dash_inputs, inName, &nb_dash_inputs);
@@ -3624,16 +3719,16 @@ int mp4boxMain(int argc, char **argv)
 	if (nb_add) {
 		u8 open_mode = GF_ISOM_OPEN_EDIT;
 		if (force_new) {
-			open_mode = (do_flat) ? GF_ISOM_OPEN_WRITE : GF_ISOM_WRITE_EDIT;
+			open_mode = (do_flat || do_fast_start) ? GF_ISOM_OPEN_WRITE : GF_ISOM_WRITE_EDIT;
 		} else {
 			FILE *test = gf_fopen(inName, "rb");
 			if (!test) {
-				open_mode = (do_flat) ? GF_ISOM_OPEN_WRITE : GF_ISOM_WRITE_EDIT;
+				open_mode = (do_flat || do_fast_start) ? GF_ISOM_OPEN_WRITE : GF_ISOM_WRITE_EDIT;
 				if (!outName) outName = inName;
 			} else {
 				gf_fclose(test);
 				if (! gf_isom_probe_file(inName) ) {
-					open_mode = (do_flat) ? GF_ISOM_OPEN_WRITE : GF_ISOM_WRITE_EDIT;
+					open_mode = (do_flat || do_fast_start) ? GF_ISOM_OPEN_WRITE : GF_ISOM_WRITE_EDIT;
 					if (!outName) outName = inName;
 				}
 			}
@@ -3690,11 +3785,11 @@ int mp4boxMain(int argc, char **argv)
 		if (!file) {
 			u8 open_mode = GF_ISOM_OPEN_EDIT;
 			if (force_new) {
-				open_mode = (do_flat) ? GF_ISOM_OPEN_WRITE : GF_ISOM_WRITE_EDIT;
+				open_mode = (do_flat || do_fast_start) ? GF_ISOM_OPEN_WRITE : GF_ISOM_WRITE_EDIT;
 			} else {
 				FILE *test = gf_fopen(inName, "rb");
 				if (!test) {
-					open_mode = (do_flat) ? GF_ISOM_OPEN_WRITE : GF_ISOM_WRITE_EDIT;
+					open_mode = (do_flat || do_fast_start) ? GF_ISOM_OPEN_WRITE : GF_ISOM_WRITE_EDIT;
 					if (!outName) outName = inName;
 				}
 				else gf_fclose(test);
@@ -3879,6 +3974,7 @@ int mp4boxMain(int argc, char **argv)
 		if (!e) e = gf_dasher_configure_isobmf_default(dasher, no_fragments_defaults, pssh_in_moof, samplegroups_in_traf, single_traf_per_moof);
 		if (!e) e = gf_dasher_enable_utc_ref(dasher, insert_utc);
 		if (!e) e = gf_dasher_enable_real_time(dasher, frag_real_time);
+		if (!e) e = gf_dasher_enable_ts_index_write(dasher, ts_index_write);
 		if (!e) e = gf_dasher_set_content_protection_location_mode(dasher, cp_location_mode);
 		if (!e) e = gf_dasher_set_profile_extension(dasher, dash_profile_extension);
 
@@ -4894,12 +4990,17 @@ int mp4boxMain(int argc, char **argv)
 	} else if (do_flat) {
 		e = gf_isom_set_storage_mode(file, GF_ISOM_STORE_FLAT);
 		needSave = GF_TRUE;
+	} else if (do_fast_start) {
+		e = gf_isom_set_storage_mode(file, GF_ISOM_STORE_FASTSTART);
+		needSave = GF_TRUE;
 	} else {
 		e = gf_isom_make_interleave(file, interleaving_time);
 		if (!e && old_interleave) e = gf_isom_set_storage_mode(file, GF_ISOM_STORE_INTERLEAVED);
 	}
 	if (force_co64)
 		gf_isom_force_64bit_chunk_offset(file, GF_TRUE);
+	if (!e && write_pipe_size)
+		e = gf_isom_set_write_pipeline(file, write_pipe_size, write_pipe_copy);
 
 	if (e) goto err_exit;
 
@@ -4975,6 +5076,7 @@ int mp4boxMain(int argc, char **argv)
 		}
 		if (HintIt && FullInter) fprintf(stderr, "Hinted file - Full Interleaving\n");
 		else if (FullInter) fprintf(stderr, "Full Interleaving\n");
+		else if (do_fast_start) fprintf(stderr, "Fast start storage\n");
 		else if (do_flat || !interleaving_time) fprintf(stderr, "Flat storage\n");
 		else fprintf(stderr, "%.3f secs Interleaving%s\n", interleaving_time, old_interleave ? " - no drift control" : "");
 
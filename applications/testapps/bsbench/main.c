@@ -0,0 +1,270 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2000-2014
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - bitstream reader benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/tools.h>
+#include <gpac/bitstream.h>
+#include <gpac/constants.h>
+#include <gpac/internal/media_dev.h>
+
+/*same read-ahead size as the NAL importers*/
+#define BENCH_READ_BUFFER_SIZE	65536
+
+static void usage()
+{
+	fprintf(stderr, "USAGE: bsbench [-hevc] [-loops N] file\n"
+	        "\n"
+	        "Parses an AVC (default) or HEVC Annex B elementary stream the way the importers do,\n"
+	        "with and without input buffering, then compares bit-by-bit against word-based\n"
+	        "reading of the stream payload in memory.\n"
+	        "\n"
+	        "\t-hevc:     input is an HEVC Annex B stream\n"
+	        "\t-loops N:  number of passes for each test (default 5)\n"
+	       );
+}
+
+/*skips the start code at the current position if any - returns its size*/
+static u32 bench_skip_start_code(GF_BitStream *bs)
+{
+	if (gf_bs_available(bs)<3) return 0;
+	if (gf_bs_peek_bits(bs, 24, 0)==0x000001) {
+		gf_bs_skip_bytes(bs, 3);
+		return 3;
+	}
+	if ((gf_bs_available(bs)>=4) && (gf_bs_peek_bits(bs, 32, 0)==0x00000001)) {
+		gf_bs_skip_bytes(bs, 4);
+		return 4;
+	}
+	return 0;
+}
+
+/*importer-like NAL loop on a file bitstream - returns number of NALs parsed*/
+static u32 bench_parse_file(FILE *f, Bool is_hevc, Bool buffered, u32 *checksum)
+{
+	GF_BitStream *bs;
+	AVCState *avc;
+	HEVCState *hevc;
+	char *buffer = NULL;
+	u32 max_size = 0;
+	u32 nb_nalus = 0;
+
+	avc = (AVCState *) gf_malloc(sizeof(AVCState));
+	memset(avc, 0, sizeof(AVCState));
+	hevc = (HEVCState *) gf_malloc(sizeof(HEVCState));
+	memset(hevc, 0, sizeof(HEVCState));
+	avc->sps_active_idx = -1;
+	hevc->sps_active_idx = -1;
+
+	gf_fseek(f, 0, SEEK_SET);
+	bs = gf_bs_from_file(f, GF_BITSTREAM_READ);
+	if (buffered) gf_bs_set_input_buffering(bs, BENCH_READ_BUFFER_SIZE);
+
+	bench_skip_start_code(bs);
+	while (gf_bs_available(bs)) {
+		u32 nal_size, nal_and_trailing_size;
+		u64 nal_start = gf_bs_get_position(bs);
+
+		nal_and_trailing_size = gf_media_nalu_next_start_code_bs(bs);
+		nal_size = gf_media_nalu_payload_end_bs(bs);
+		if (!nal_and_trailing_size) break;
+
+		if (nal_size>max_size) {
+			buffer = (char*)gf_realloc(buffer, sizeof(char)*nal_size);
+			max_size = nal_size;
+		}
+		gf_bs_read_data(bs, buffer, nal_size);
+		gf_bs_seek(bs, nal_start);
+
+		if (!is_hevc) {
+			u8 nal_hdr = gf_bs_read_u8(bs);
+			switch (nal_hdr & 0x1F) {
+			case GF_AVC_NALU_SEQ_PARAM:
+				*checksum += gf_media_avc_read_sps(buffer, nal_size, avc, 0, NULL);
+				break;
+			case GF_AVC_NALU_PIC_PARAM:
+				*checksum += gf_media_avc_read_pps(buffer, nal_size, avc);
+				break;
+			default:
+				*checksum += gf_media_avc_parse_nalu(bs, nal_hdr, avc);
+				*checksum += avc->s_info.frame_num + avc->s_info.poc_lsb;
+				break;
+			}
+		} else {
+			u8 nal_type, temporal_id, layer_id;
+			*checksum += gf_media_hevc_parse_nalu(bs, hevc, &nal_type, &temporal_id, &layer_id);
+			switch (nal_type) {
+			case GF_HEVC_NALU_VID_PARAM:
+				*checksum += gf_media_hevc_read_vps(buffer, nal_size, hevc);
+				break;
+			case GF_HEVC_NALU_SEQ_PARAM:
+				*checksum += gf_media_hevc_read_sps(buffer, nal_size, hevc);
+				break;
+			case GF_HEVC_NALU_PIC_PARAM:
+				*checksum += gf_media_hevc_read_pps(buffer, nal_size, hevc);
+				break;
+			default:
+				*checksum += hevc->s_info.poc_lsb;
+				break;
+			}
+		}
+		nb_nalus++;
+
+		gf_bs_seek(bs, nal_start + nal_and_trailing_size);
+		bench_skip_start_code(bs);
+	}
+	gf_bs_del(bs);
+	if (buffer) gf_free(buffer);
+	gf_free(avc);
+	gf_free(hevc);
+	return nb_nalus;
+}
+
+/*reference bit-at-a-time reader*/
+static u32 bench_read_bits(GF_BitStream *bs, u32 nBits)
+{
+	u32 ret = 0;
+	while (nBits-- > 0) {
+		ret <<= 1;
+		ret |= gf_bs_read_int(bs, 1);
+	}
+	return ret;
+}
+
+/*reference exp-Golomb reader, counting leading zeros one bit at a time*/
+static u32 bench_read_ue_bits(GF_BitStream *bs)
+{
+	u32 nb_zeros = 0;
+	while (gf_bs_available(bs) && !gf_bs_read_int(bs, 1)) {
+		nb_zeros++;
+		if (nb_zeros>31) return 0;
+	}
+	if (!nb_zeros) return 0;
+	return (1<<nb_zeros) - 1 + bench_read_bits(bs, nb_zeros);
+}
+
+/*reads the whole buffer as a mix of fixed-size fields and exp-Golomb codes*/
+static u32 bench_read_memory(char *data, u32 size, Bool bitwise)
+{
+	u32 sum = 0;
+	u32 i = 0;
+	GF_BitStream *bs = gf_bs_new(data, size, GF_BITSTREAM_READ);
+	/*worst case per iteration is 24 + 63 bits*/
+	while (gf_bs_available(bs)>16) {
+		u32 nbits = 1 + (i % 24);
+		if (bitwise) {
+			sum += bench_read_bits(bs, nbits);
+			/*only read valid exp-Golomb codes (at most 31 leading zeros)*/
+			if (gf_bs_peek_bits(bs, 32, 0)) sum += bench_read_ue_bits(bs);
+		} else {
+			sum += gf_bs_read_int(bs, nbits);
+			if (gf_bs_peek_bits(bs, 32, 0)) sum += gf_bs_read_ue(bs);
+		}
+		i++;
+	}
+	gf_bs_del(bs);
+	return sum;
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, j, loops, size, nb_nalus;
+	u32 sum_ref, sum;
+	Bool mismatch;
+	u64 start, time_plain, time_buffered, time_bits, time_words;
+	Bool is_hevc = GF_FALSE;
+	char *src = NULL;
+	char *data;
+	FILE *f;
+
+	loops = 5;
+	for (i=1; i<(u32) argc; i++) {
+		if (!strcmp(argv[i], "-hevc")) is_hevc = GF_TRUE;
+		else if (!strcmp(argv[i], "-loops") && (i+1<(u32) argc)) {
+			loops = atoi(argv[i+1]);
+			i++;
+		}
+		else if (argv[i][0]=='-') {
+			usage();
+			return 1;
+		}
+		else src = argv[i];
+	}
+	if (!src || !loops) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+	gf_log_set_tool_level(GF_LOG_ALL, GF_LOG_ERROR);
+
+	f = gf_fopen(src, "rb");
+	if (!f) {
+		fprintf(stderr, "Cannot open %s\n", src);
+		gf_sys_close();
+		return 1;
+	}
+
+	/*file mode, importer-like parsing*/
+	sum_ref = sum = 0;
+	nb_nalus = 0;
+	start = gf_sys_clock_high_res();
+	for (j=0; j<loops; j++) {
+		sum_ref = 0;
+		nb_nalus = bench_parse_file(f, is_hevc, GF_FALSE, &sum_ref);
+	}
+	time_plain = gf_sys_clock_high_res() - start;
+
+	start = gf_sys_clock_high_res();
+	for (j=0; j<loops; j++) {
+		sum = 0;
+		bench_parse_file(f, is_hevc, GF_TRUE, &sum);
+	}
+	time_buffered = gf_sys_clock_high_res() - start;
+
+	fprintf(stdout, "File parsing: %d NALUs - unbuffered "LLU" us - buffered "LLU" us%s\n", nb_nalus, time_plain/loops, time_buffered/loops, (sum==sum_ref) ? "" : " - MISMATCH");
+	mismatch = (sum==sum_ref) ? GF_FALSE : GF_TRUE;
+
+	/*memory mode, bit reading*/
+	gf_fseek(f, 0, SEEK_END);
+	size = (u32) gf_ftell(f);
+	gf_fseek(f, 0, SEEK_SET);
+	data = (char *) gf_malloc(sizeof(char)*size);
+	size = (u32) fread(data, 1, size, f);
+	gf_fclose(f);
+
+	start = gf_sys_clock_high_res();
+	for (j=0; j<loops; j++) sum_ref = bench_read_memory(data, size, GF_TRUE);
+	time_bits = gf_sys_clock_high_res() - start;
+
+	start = gf_sys_clock_high_res();
+	for (j=0; j<loops; j++) sum = bench_read_memory(data, size, GF_FALSE);
+	time_words = gf_sys_clock_high_res() - start;
+
+	fprintf(stdout, "Bit reading: %d bytes - bit by bit "LLU" us - word based "LLU" us%s\n", size, time_bits/loops, time_words/loops, (sum==sum_ref) ? "" : " - MISMATCH");
+	if (sum!=sum_ref) mismatch = GF_TRUE;
+
+	gf_free(data);
+	gf_sys_close();
+	return mismatch ? 1 : 0;
+}
@@ -0,0 +1,403 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2000-2014
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - DASH rate adaptation simulator
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/dash.h>
+#include <gpac/xml.h>
+#include <gpac/internal/mpd.h>
+#include <math.h>
+
+#define SIM_MAX_SEGMENTS	100000
+
+typedef struct
+{
+	/*duration in ms and bandwidth in kbps (bits per ms) of each trace step*/
+	u32 *durations, *rates;
+	u32 nb_steps;
+	u64 total_duration;
+} BandwidthTrace;
+
+typedef struct
+{
+	u32 nb_reps, nb_segments;
+	u32 *bandwidths;
+	/*segment sizes in bytes, per representation*/
+	u64 **sizes;
+	/*segment durations in ms*/
+	u32 *durations;
+	u32 nb_estimated;
+} SimContent;
+
+typedef struct
+{
+	u32 avg_rate, nb_switches, nb_stalls;
+	Double stall_ms, startup_ms, session_ms;
+} SimResult;
+
+static const char *algo_names[] = {"gpac", "ewma", "bba0", "bola"};
+
+static void usage()
+{
+	fprintf(stderr, "USAGE: dashsim -mpd FILE -trace FILE [-algo NAME] [-as N] [-buffer MS] [-rtt MS] [-v]\n"
+	        "\n"
+	        "Replays a bandwidth trace against the representations of a local MPD, and reports for each\n"
+	        "rate adaptation algorithm the average bitrate, the number of switches and the rebuffering.\n"
+	        "Segment sizes are read from the segment files next to the MPD, or estimated from @bandwidth if missing.\n"
+	        "Only SegmentTemplate and SegmentList representations are supported.\n"
+	        "\n"
+	        "\t-mpd FILE:    MPD to simulate\n"
+	        "\t-trace FILE:  bandwidth trace, one step per line as \"duration_ms kbps\", replayed in loop\n"
+	        "\t-algo NAME:   gpac, ewma, bba0, bola or all (default all)\n"
+	        "\t-as N:        index of the adaptation set in the first period (default first one with several representations)\n"
+	        "\t-buffer MS:   max buffer of the player (default 30000)\n"
+	        "\t-rtt MS:      request round trip time (default 50)\n"
+	        "\t-v:           prints each downloaded segment\n"
+	       );
+}
+
+static GF_Err load_trace(const char *file, BandwidthTrace *tr)
+{
+	char line[1024];
+	u32 alloc = 0;
+	FILE *f = gf_fopen(file, "rt");
+	if (!f) return GF_URL_ERROR;
+
+	memset(tr, 0, sizeof(BandwidthTrace));
+	while (fgets(line, 1024, f)) {
+		u32 dur, rate;
+		if ((line[0]=='#') || (sscanf(line, "%u %u", &dur, &rate) != 2) || !dur) continue;
+		if (tr->nb_steps == alloc) {
+			alloc = alloc ? 2*alloc : 256;
+			tr->durations = (u32 *) gf_realloc(tr->durations, sizeof(u32)*alloc);
+			tr->rates = (u32 *) gf_realloc(tr->rates, sizeof(u32)*alloc);
+		}
+		tr->durations[tr->nb_steps] = dur;
+		tr->rates[tr->nb_steps] = rate;
+		tr->nb_steps++;
+		tr->total_duration += dur;
+	}
+	gf_fclose(f);
+	/*the trace must allow some data through*/
+	for (alloc=0; alloc<tr->nb_steps; alloc++) {
+		if (tr->rates[alloc]) return GF_OK;
+	}
+	return GF_NON_COMPLIANT_BITSTREAM;
+}
+
+/*time in ms needed to receive the given number of bytes starting at time t of the trace*/
+static Double trace_download(BandwidthTrace *tr, Double t, u64 size)
+{
+	u32 i;
+	Double bits, pos, elapsed;
+
+	/*locate the trace step at time t*/
+	pos = fmod(t, (Double) tr->total_duration);
+	for (i=0; i<tr->nb_steps; i++) {
+		if (pos < tr->durations[i]) break;
+		pos -= tr->durations[i];
+	}
+	if (i==tr->nb_steps) {
+		i = 0;
+		pos = 0;
+	}
+
+	bits = 8 * (Double) size;
+	elapsed = 0;
+	while (1) {
+		Double avail = tr->durations[i] - pos;
+		if (tr->rates[i] * avail >= bits) {
+			elapsed += bits / tr->rates[i];
+			break;
+		}
+		bits -= tr->rates[i] * avail;
+		elapsed += avail;
+		pos = 0;
+		i = (i+1) % tr->nb_steps;
+	}
+	return elapsed;
+}
+
+static u64 get_segment_size(const char *url, u64 start_range, u64 end_range)
+{
+	u64 size;
+	FILE *f;
+	if (end_range) return end_range - start_range + 1;
+	if (!strnicmp(url, "file://", 7)) url += 7;
+	f = gf_fopen(url, "rb");
+	if (!f) return 0;
+	gf_fseek(f, 0, SEEK_END);
+	size = gf_ftell(f);
+	gf_fclose(f);
+	return size;
+}
+
+static GF_Err load_content(GF_MPD *mpd, const char *mpd_url, s32 as_idx, SimContent *ct)
+{
+	u32 i, j;
+	Double mpd_dur;
+	GF_MPD_Period *period = gf_list_get(mpd->periods, 0);
+	GF_MPD_AdaptationSet *set = NULL;
+
+	if (!period) return GF_NON_COMPLIANT_BITSTREAM;
+	if (as_idx >= 0) {
+		set = gf_list_get(period->adaptation_sets, as_idx);
+	} else {
+		for (i=0; i<gf_list_count(period->adaptation_sets); i++) {
+			set = gf_list_get(period->adaptation_sets, i);
+			if (gf_list_count(set->representations) > 1) break;
+		}
+	}
+	if (!set || !gf_list_count(set->representations)) return GF_BAD_PARAM;
+
+	memset(ct, 0, sizeof(SimContent));
+	ct->nb_reps = gf_list_count(set->representations);
+	ct->bandwidths = (u32 *) gf_malloc(sizeof(u32) * ct->nb_reps);
+	ct->sizes = (u64 **) gf_malloc(sizeof(u64 *) * ct->nb_reps);
+	ct->durations = (u32 *) gf_malloc(sizeof(u32) * SIM_MAX_SEGMENTS);
+	mpd_dur = gf_mpd_get_duration(mpd) * 1000;
+
+	/*representations are simulated in increasing bandwidth order, as in the DASH client*/
+	for (i=1; i<ct->nb_reps; i++) {
+		GF_MPD_Representation *r1 = gf_list_get(set->representations, i-1);
+		GF_MPD_Representation *r2 = gf_list_get(set->representations, i);
+		if (r1->bandwidth > r2->bandwidth) {
+			gf_list_rem(set->representations, i);
+			gf_list_insert(set->representations, r2, i-1);
+			i = 0;
+		}
+	}
+
+	for (i=0; i<ct->nb_reps; i++) {
+		u64 time = 0;
+		GF_MPD_Representation *rep = gf_list_get(set->representations, i);
+		ct->bandwidths[i] = rep->bandwidth;
+		ct->sizes[i] = (u64 *) gf_malloc(sizeof(u64) * SIM_MAX_SEGMENTS);
+
+		if (!rep->segment_list && !set->segment_list && !period->segment_list && !rep->segment_template && !set->segment_template && !period->segment_template) {
+			fprintf(stderr, "Representation %s: single-file representations are not supported\n", rep->id);
+			return GF_NOT_SUPPORTED;
+		}
+
+		for (j=0; j<SIM_MAX_SEGMENTS; j++) {
+			char *url = NULL;
+			u64 start_range, end_range, dur = 0;
+			GF_Err e = gf_mpd_resolve_url(mpd, rep, set, period, mpd_url, GF_MPD_RESOLVE_URL_MEDIA, j, 0, &url, &start_range, &end_range, &dur, NULL, NULL, NULL);
+			if (e || !url) break;
+			if (!dur) dur = 1000;
+			/*segment count of the lowest representation is used for all, for templates without end use the MPD duration*/
+			if (i && (j == ct->nb_segments)) {
+				gf_free(url);
+				break;
+			}
+			if (!i && mpd_dur && (time >= mpd_dur)) {
+				gf_free(url);
+				break;
+			}
+			ct->sizes[i][j] = get_segment_size(url, start_range, end_range);
+			gf_free(url);
+			if (!ct->sizes[i][j]) {
+				/*no end known for this template*/
+				if (!mpd_dur && !i) break;
+				ct->sizes[i][j] = (u64) rep->bandwidth * dur / 8000;
+				ct->nb_estimated++;
+			}
+			if (!i) ct->durations[j] = (u32) dur;
+			time += dur;
+		}
+		if (!i) ct->nb_segments = j;
+		/*missing segments at the end of higher representations*/
+		for (; j<ct->nb_segments; j++) {
+			ct->sizes[i][j] = (u64) rep->bandwidth * ct->durations[j] / 8000;
+			ct->nb_estimated++;
+		}
+	}
+	return ct->nb_segments ? GF_OK : GF_NON_COMPLIANT_BITSTREAM;
+}
+
+static void simulate(SimContent *ct, BandwidthTrace *tr, GF_DASHAdaptationAlgorithm algo, u32 buffer_max, u32 buffer_min, u32 rtt, Bool verbose, SimResult *res)
+{
+	u32 i, rep, prev_rep;
+	Double t, buffer, rate_sum, dur_sum;
+	Bool started, playing;
+	GF_DASHRateInfo info;
+
+	memset(res, 0, sizeof(SimResult));
+	memset(&info, 0, sizeof(GF_DASHRateInfo));
+	info.nb_reps = ct->nb_reps;
+	info.bandwidths = ct->bandwidths;
+	info.probe_rep = -1;
+	info.probe_count_before_switch = 1;
+	info.buffer_min_ms = buffer_min;
+	info.buffer_max_ms = buffer_max;
+
+	t = buffer = rate_sum = dur_sum = 0;
+	started = playing = GF_FALSE;
+	rep = prev_rep = 0;
+	for (i=0; i<ct->nb_segments; i++) {
+		Double dl_time;
+		u32 seg_dur = ct->durations[i];
+
+		/*wait for room in the buffer*/
+		if (buffer + seg_dur > buffer_max) {
+			Double wait = buffer + seg_dur - buffer_max;
+			if (!playing) {
+				playing = started = GF_TRUE;
+			}
+			t += wait;
+			buffer -= wait;
+		}
+
+		dl_time = rtt + trace_download(tr, t + rtt, ct->sizes[rep][i]);
+		if (!started) {
+			res->startup_ms += dl_time;
+		} else if (!playing) {
+			res->stall_ms += dl_time;
+		} else if (dl_time > buffer) {
+			res->stall_ms += dl_time - buffer;
+			res->nb_stalls++;
+			buffer = 0;
+			playing = GF_FALSE;
+		} else {
+			buffer -= dl_time;
+		}
+		t += dl_time;
+		buffer += seg_dur;
+		if (!playing && (buffer >= buffer_min)) playing = started = GF_TRUE;
+
+		if (i && (rep != prev_rep)) res->nb_switches++;
+		prev_rep = rep;
+		rate_sum += (Double) ct->bandwidths[rep] * seg_dur;
+		dur_sum += seg_dur;
+
+		info.active_rep = rep;
+		info.dl_rate = (u32) (8 * ct->sizes[rep][i] * 1000 / dl_time);
+		info.segment_duration = seg_dur;
+		info.buffer_ms = (u32) buffer;
+		rep = gf_dash_rate_adaptation(algo, &info);
+
+		if (verbose) {
+			fprintf(stdout, "%s\tseg %d\trep %d (%d kbps)\tdownload %d ms at %d kbps\tbuffer %d ms%s\n", algo_names[algo], i+1, prev_rep, ct->bandwidths[prev_rep]/1000, (u32) dl_time, info.dl_rate/1000, info.buffer_ms, playing ? "" : " - stalled");
+		}
+	}
+	res->avg_rate = dur_sum ? (u32) (rate_sum / dur_sum) : 0;
+	res->session_ms = t + buffer;
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, buffer_max, buffer_min, rtt;
+	s32 as_idx, algo;
+	Bool verbose;
+	char *mpd_file, *trace_file;
+	GF_Err e;
+	GF_DOMParser *parser;
+	GF_MPD *mpd;
+	BandwidthTrace trace;
+	SimContent content;
+
+	mpd_file = trace_file = NULL;
+	as_idx = algo = -1;
+	buffer_max = 30000;
+	rtt = 50;
+	verbose = GF_FALSE;
+	for (i=1; i<(u32) argc; i++) {
+		if (!strcmp(argv[i], "-v")) {
+			verbose = GF_TRUE;
+			continue;
+		}
+		if (i+1==(u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(argv[i], "-mpd")) mpd_file = argv[i+1];
+		else if (!strcmp(argv[i], "-trace")) trace_file = argv[i+1];
+		else if (!strcmp(argv[i], "-as")) as_idx = atoi(argv[i+1]);
+		else if (!strcmp(argv[i], "-buffer")) buffer_max = atoi(argv[i+1]);
+		else if (!strcmp(argv[i], "-rtt")) rtt = atoi(argv[i+1]);
+		else if (!strcmp(argv[i], "-algo")) {
+			for (algo=GF_DASH_ALGO_BOLA; algo>=0; algo--) {
+				if (!strcmp(argv[i+1], algo_names[algo])) break;
+			}
+			if ((algo<0) && strcmp(argv[i+1], "all")) {
+				usage();
+				return 1;
+			}
+		} else {
+			usage();
+			return 1;
+		}
+		i++;
+	}
+	if (!mpd_file || !trace_file) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+	gf_log_set_tool_level(GF_LOG_ALL, GF_LOG_ERROR);
+
+	if (load_trace(trace_file, &trace) != GF_OK) {
+		fprintf(stderr, "Cannot load bandwidth trace %s\n", trace_file);
+		gf_sys_close();
+		return 1;
+	}
+
+	parser = gf_xml_dom_new();
+	e = gf_xml_dom_parse(parser, mpd_file, NULL, NULL);
+	mpd = gf_mpd_new();
+	if (!e) e = gf_mpd_init_from_dom(gf_xml_dom_get_root(parser), mpd, mpd_file);
+	gf_xml_dom_del(parser);
+	if (!e) e = load_content(mpd, mpd_file, as_idx, &content);
+	if (e) {
+		fprintf(stderr, "Cannot load MPD %s: %s\n", mpd_file, gf_error_to_string(e));
+		gf_mpd_del(mpd);
+		gf_sys_close();
+		return 1;
+	}
+
+	/*playback starts and resumes once minBufferTime is buffered*/
+	buffer_min = mpd->min_buffer_time;
+	if (buffer_min < content.durations[0]) buffer_min = content.durations[0];
+	if (buffer_min > buffer_max) buffer_min = buffer_max;
+	if (buffer_max < content.durations[0]) buffer_max = content.durations[0];
+
+	fprintf(stdout, "%d representations - %d segments (%d sizes estimated) - buffer %d ms - trace %d steps "LLU" ms\n", content.nb_reps, content.nb_segments, content.nb_estimated, buffer_max, trace.nb_steps, trace.total_duration);
+	fprintf(stdout, "algo\tavg kbps\tswitches\tstalls\tstall ms\tstartup ms\tsession ms\n");
+	for (i=0; i<=GF_DASH_ALGO_BOLA; i++) {
+		SimResult res;
+		if ((algo>=0) && ((u32) algo != i)) continue;
+		simulate(&content, &trace, i, buffer_max, buffer_min, rtt, verbose, &res);
+		fprintf(stdout, "%s\t%d\t\t%d\t\t%d\t%d\t\t%d\t\t%d\n", algo_names[i], res.avg_rate/1000, res.nb_switches, res.nb_stalls, (u32) res.stall_ms, (u32) res.startup_ms, (u32) res.session_ms);
+	}
+
+	for (i=0; i<content.nb_reps; i++) gf_free(content.sizes[i]);
+	gf_free(content.sizes);
+	gf_free(content.bandwidths);
+	gf_free(content.durations);
+	gf_free(trace.durations);
+	gf_free(trace.rates);
+	gf_mpd_del(mpd);
+	gf_sys_close();
+	return 0;
+}
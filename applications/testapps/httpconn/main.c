@@ -0,0 +1,343 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2000-2014
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - HTTP connection reuse and pipelining checker
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/download.h>
+#include <gpac/network.h>
+#include <gpac/thread.h>
+#include <gpac/config_file.h>
+#include <gpac/list.h>
+
+#define SERVER_BUFFER_SIZE	4096
+
+/*loopback HTTP server answering GET /N with N bytes*/
+typedef struct
+{
+	GF_Socket *listener;
+	GF_Thread *th;
+	GF_Mutex *mx;
+	GF_List *conns;
+	Bool http10;
+	u32 delay;
+	volatile Bool stop;
+	u32 nb_connections, nb_requests;
+} HTTPServer;
+
+typedef struct
+{
+	HTTPServer *srv;
+	GF_Socket *sock;
+	GF_Thread *th;
+} ServerConn;
+
+typedef struct
+{
+	u32 size, received;
+	volatile Bool sent, done;
+	Bool corrupted;
+	GF_Err e;
+} Request;
+
+static void usage()
+{
+	fprintf(stderr, "USAGE: httpconn [-port N] [-nb-req N] [-delay MS] [-http10] [-sync]\n"
+	        "\n"
+	        "Runs a loopback HTTP server and downloads small resources from it with HTTP pipelining enabled,\n"
+	        "then checks the responses and the number of connections used.\n"
+	        "\n"
+	        "\t-port N:     server port (default 8642)\n"
+	        "\t-nb-req N:   number of requests (default 4)\n"
+	        "\t-delay MS:   server delay before each response (default 100)\n"
+	        "\t-http10:     the server answers in HTTP/1.0 and closes the connection after each response\n"
+	        "\t-sync:       requests are issued one after the other by non-threaded sessions\n"
+	        "\t-h:          prints this help\n"
+	       );
+}
+
+static u8 resource_byte(u32 size, u32 offset)
+{
+	return (u8) (offset*7 + size);
+}
+
+static u32 server_conn_run(void *par)
+{
+	ServerConn *conn = (ServerConn *) par;
+	HTTPServer *srv = conn->srv;
+	char buffer[SERVER_BUFFER_SIZE+1];
+	u32 size = 0;
+
+	while (!srv->stop) {
+		char *hdr_end, *path;
+		u32 read, res_size, i, req_size;
+		char rsp[200];
+		u8 *body;
+		GF_Err e = gf_sk_receive(conn->sock, buffer, SERVER_BUFFER_SIZE, size, &read);
+		if (e == GF_IP_NETWORK_EMPTY) {
+			gf_sleep(1);
+			continue;
+		}
+		if (e) break;
+		size += read;
+		buffer[size] = 0;
+
+		/*requests may be pipelined, answer them in order*/
+		while ((hdr_end = strstr(buffer, "\r\n\r\n")) != NULL) {
+			req_size = (u32) (hdr_end + 4 - buffer);
+			path = strchr(buffer, '/');
+			res_size = path ? atoi(path+1) : 0;
+
+			gf_mx_p(srv->mx);
+			srv->nb_requests++;
+			gf_mx_v(srv->mx);
+			if (srv->delay) gf_sleep(srv->delay);
+
+			sprintf(rsp, "%s 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: %d\r\n\r\n", srv->http10 ? "HTTP/1.0" : "HTTP/1.1", res_size);
+			body = (u8 *) gf_malloc(sizeof(u8) * (res_size+1));
+			for (i=0; i<res_size; i++) body[i] = resource_byte(res_size, i);
+			e = gf_sk_send(conn->sock, rsp, (u32) strlen(rsp));
+			if (!e && res_size) e = gf_sk_send(conn->sock, (char *) body, res_size);
+			gf_free(body);
+			if (e || srv->http10) goto exit;
+
+			size -= req_size;
+			memmove(buffer, buffer + req_size, size);
+			buffer[size] = 0;
+		}
+		if (size == SERVER_BUFFER_SIZE) break;
+	}
+exit:
+	gf_sk_del(conn->sock);
+	conn->sock = NULL;
+	return 0;
+}
+
+static u32 server_run(void *par)
+{
+	HTTPServer *srv = (HTTPServer *) par;
+	while (!srv->stop) {
+		GF_Socket *sock;
+		ServerConn *conn;
+		GF_Err e = gf_sk_accept(srv->listener, &sock);
+		if (e || !sock) {
+			gf_sleep(1);
+			continue;
+		}
+		GF_SAFEALLOC(conn, ServerConn);
+		if (!conn) {
+			gf_sk_del(sock);
+			continue;
+		}
+		conn->srv = srv;
+		conn->sock = sock;
+		conn->th = gf_th_new("HTTPConn");
+		gf_mx_p(srv->mx);
+		srv->nb_connections++;
+		gf_list_add(srv->conns, conn);
+		gf_mx_v(srv->mx);
+		gf_th_run(conn->th, server_conn_run, conn);
+	}
+	return 0;
+}
+
+static void server_del(HTTPServer *srv)
+{
+	srv->stop = GF_TRUE;
+	if (srv->th) gf_th_del(srv->th);
+	while (gf_list_count(srv->conns)) {
+		ServerConn *conn = (ServerConn *) gf_list_pop_back(srv->conns);
+		gf_th_del(conn->th);
+		if (conn->sock) gf_sk_del(conn->sock);
+		gf_free(conn);
+	}
+	gf_list_del(srv->conns);
+	if (srv->listener) gf_sk_del(srv->listener);
+	if (srv->mx) gf_mx_del(srv->mx);
+}
+
+static void on_http_data(void *cbk, GF_NETIO_Parameter *param)
+{
+	u32 i;
+	Request *req = (Request *) cbk;
+	switch (param->msg_type) {
+	case GF_NETIO_WAIT_FOR_REPLY:
+		req->sent = GF_TRUE;
+		break;
+	case GF_NETIO_DATA_EXCHANGE:
+		for (i=0; i<param->size; i++) {
+			if ((u8) param->data[i] != resource_byte(req->size, req->received + i)) req->corrupted = GF_TRUE;
+		}
+		req->received += param->size;
+		break;
+	case GF_NETIO_DATA_TRANSFERED:
+		req->done = GF_TRUE;
+		break;
+	case GF_NETIO_STATE_ERROR:
+		req->e = param->error ? param->error : GF_IO_ERR;
+		req->done = GF_TRUE;
+		break;
+	default:
+		break;
+	}
+}
+
+/*waits for the flag to be set by the session, returns GF_FALSE on timeout*/
+static Bool wait_flag(volatile Bool *flag, u32 timeout)
+{
+	u32 start = gf_sys_clock();
+	while (! *flag) {
+		if (gf_sys_clock() - start > timeout) return GF_FALSE;
+		gf_sleep(1);
+	}
+	return GF_TRUE;
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, port, nb_req, flags, nb_ok, expected_connections;
+	Bool sync, ok;
+	char url[100];
+	GF_Err e;
+	GF_Config *cfg;
+	GF_DownloadManager *dm;
+	GF_DownloadSession **sessions;
+	Request *reqs;
+	GF_DMConnectionStats stats;
+	HTTPServer srv;
+
+	memset(&srv, 0, sizeof(HTTPServer));
+	port = 8642;
+	nb_req = 4;
+	srv.delay = 100;
+	sync = GF_FALSE;
+	for (i=1; i<(u32) argc; i++) {
+		if (!strcmp(argv[i], "-h")) {
+			usage();
+			return 0;
+		}
+		if (!strcmp(argv[i], "-http10")) {
+			srv.http10 = GF_TRUE;
+			continue;
+		}
+		if (!strcmp(argv[i], "-sync")) {
+			sync = GF_TRUE;
+			continue;
+		}
+		if (i+1==(u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(argv[i], "-port")) port = atoi(argv[i+1]);
+		else if (!strcmp(argv[i], "-nb-req")) nb_req = atoi(argv[i+1]);
+		else if (!strcmp(argv[i], "-delay")) srv.delay = atoi(argv[i+1]);
+		else {
+			usage();
+			return 1;
+		}
+		i++;
+	}
+	if (!nb_req) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+	gf_log_set_tool_level(GF_LOG_ALL, GF_LOG_ERROR);
+
+	srv.listener = gf_sk_new(GF_SOCK_TYPE_TCP);
+	e = srv.listener ? gf_sk_bind(srv.listener, "127.0.0.1", port, NULL, 0, GF_SOCK_REUSE_PORT) : GF_IP_NETWORK_FAILURE;
+	if (!e) e = gf_sk_listen(srv.listener, 16);
+	if (e) {
+		fprintf(stderr, "Cannot listen on 127.0.0.1:%d: %s\n", port, gf_error_to_string(e));
+		server_del(&srv);
+		gf_sys_close();
+		return 1;
+	}
+	srv.mx = gf_mx_new("HTTPServer");
+	srv.conns = gf_list_new();
+	srv.th = gf_th_new("HTTPServer");
+	gf_th_run(srv.th, server_run, &srv);
+
+	cfg = gf_cfg_new(NULL, NULL);
+	gf_cfg_set_key(cfg, "Downloader", "HTTPPipelining", "yes");
+	/*all requests fit in the pipeline of the first connection*/
+	sprintf(url, "%d", nb_req);
+	gf_cfg_set_key(cfg, "Downloader", "PipelineDepth", url);
+	dm = gf_dm_new(cfg);
+
+	sessions = (GF_DownloadSession **) gf_malloc(sizeof(GF_DownloadSession *) * nb_req);
+	reqs = (Request *) gf_malloc(sizeof(Request) * nb_req);
+	memset(reqs, 0, sizeof(Request) * nb_req);
+	flags = GF_NETIO_SESSION_NOT_CACHED | GF_NETIO_SESSION_ALLOW_PIPELINE;
+	if (sync) flags |= GF_NETIO_SESSION_NOT_THREADED;
+
+	for (i=0; i<nb_req; i++) {
+		reqs[i].size = 1000 + 1000*i;
+		sprintf(url, "http://127.0.0.1:%d/%d", port, reqs[i].size);
+		sessions[i] = gf_dm_sess_new(dm, url, flags, on_http_data, &reqs[i], &e);
+		if (!sessions[i]) {
+			reqs[i].e = e;
+			reqs[i].done = GF_TRUE;
+			continue;
+		}
+		gf_dm_sess_process(sessions[i]);
+		/*the first request opens the connection the next ones are pipelined on*/
+		if (!sync && !i && !wait_flag(&reqs[0].sent, 5000)) {
+			fprintf(stderr, "First request not sent\n");
+		}
+	}
+	if (!sync) {
+		for (i=0; i<nb_req; i++) {
+			if (!wait_flag(&reqs[i].done, 10000)) reqs[i].e = GF_IP_NETWORK_FAILURE;
+		}
+	}
+
+	nb_ok = 0;
+	for (i=0; i<nb_req; i++) {
+		if (!reqs[i].done || reqs[i].e || reqs[i].corrupted || (reqs[i].received != reqs[i].size)) {
+			fprintf(stderr, "Request %d failed: %s - received %d/%d bytes%s\n", i+1, gf_error_to_string(reqs[i].e), reqs[i].received, reqs[i].size, reqs[i].corrupted ? " - corrupted" : "");
+		} else {
+			nb_ok++;
+		}
+		if (sessions[i]) gf_dm_sess_del(sessions[i]);
+	}
+	gf_dm_get_connection_stats(dm, &stats);
+	gf_dm_del(dm);
+	gf_cfg_del(cfg);
+	server_del(&srv);
+
+	/*HTTP/1.0 connections carry a single response, HTTP/1.1 ones all of them*/
+	expected_connections = srv.http10 ? nb_req : 1;
+	fprintf(stdout, "%d/%d requests OK - server: %d requests on %d connections - client: %d connections opened, %d reused, %d pipelined requests\n",
+	        nb_ok, nb_req, srv.nb_requests, srv.nb_connections, stats.nb_connections, stats.nb_reused, stats.nb_pipelined);
+
+	ok = GF_TRUE;
+	if (nb_ok != nb_req) ok = GF_FALSE;
+	if (srv.nb_requests != nb_req) ok = GF_FALSE;
+	if (srv.nb_connections != expected_connections) ok = GF_FALSE;
+
+	gf_free(sessions);
+	gf_free(reqs);
+	gf_sys_close();
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2000-2014
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - list benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+/*compiles src/utils/list.c for the variant selected by the including file, with all symbols renamed
+so that the variants can be linked together and with libgpac*/
+
+#define gf_list_new	LB_VARIANT(new)
+#define gf_list_del	LB_VARIANT(del)
+#define gf_list_reset	LB_VARIANT(reset)
+#define gf_list_reserve	LB_VARIANT(reserve)
+#define gf_list_add	LB_VARIANT(add)
+#define gf_list_count	LB_VARIANT(count)
+#define gf_list_get	LB_VARIANT(get)
+#define gf_list_last	LB_VARIANT(last)
+#define gf_list_rem	LB_VARIANT(rem)
+#define gf_list_rem_last	LB_VARIANT(rem_last)
+#define gf_list_insert	LB_VARIANT(insert)
+#define gf_list_find	LB_VARIANT(find)
+#define gf_list_del_item	LB_VARIANT(del_item)
+#define gf_list_enum	LB_VARIANT(enum)
+#define gf_list_rev_enum	LB_VARIANT(rev_enum)
+#define gf_list_swap	LB_VARIANT(swap)
+#define gf_list_append	LB_VARIANT(append)
+#define gf_list_transfer	LB_VARIANT(transfer)
+#define gf_list_clone	LB_VARIANT(clone)
+#define gf_list_reverse	LB_VARIANT(reverse)
+#define gf_list_pop_front	LB_VARIANT(pop_front)
+#define gf_list_pop_back	LB_VARIANT(pop_back)
+
+#include "../../../src/utils/list.c"
+#include "listbench.h"
+
+const ListBenchOps LB_VARIANT(ops) = {
+	LB_VARIANT_NAME,
+	gf_list_new,
+	gf_list_del,
+	gf_list_add,
+	gf_list_count,
+	gf_list_get,
+	gf_list_enum,
+	gf_list_rem,
+	gf_list_reserve,
+	gf_list_append
+};
@@ -0,0 +1,51 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2000-2014
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - list benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#ifndef _LISTBENCH_H_
+#define _LISTBENCH_H_
+
+#include <gpac/list.h>
+
+/*list API of one build variant of src/utils/list.c*/
+typedef struct
+{
+	const char *name;
+	GF_List *(*list_new)();
+	void (*list_del)(GF_List *ptr);
+	GF_Err (*add)(GF_List *ptr, void *item);
+	u32 (*count)(const GF_List *ptr);
+	void *(*get)(GF_List *ptr, u32 itemNumber);
+	void *(*enumerate)(GF_List *ptr, u32 *pos);
+	GF_Err (*rem)(GF_List *ptr, u32 itemNumber);
+	GF_Err (*reserve)(GF_List *ptr, u32 nb_items);
+	GF_Err (*append)(GF_List *dst, GF_List *src);
+} ListBenchOps;
+
+extern const ListBenchOps lb_linked_ops;
+extern const ListBenchOps lb_dlinked_ops;
+extern const ListBenchOps lb_array_ops;
+extern const ListBenchOps lb_grow_ops;
+
+#endif
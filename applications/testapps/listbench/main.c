@@ -0,0 +1,427 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2000-2014
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - list benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/tools.h>
+#include <gpac/bitstream.h>
+#include <gpac/xml.h>
+#include "listbench.h"
+
+/*reference: lists as built in libgpac*/
+static const ListBenchOps lb_gpac_ops = {
+	"libgpac",
+	gf_list_new,
+	gf_list_del,
+	gf_list_add,
+	gf_list_count,
+	gf_list_get,
+	gf_list_enum,
+	gf_list_rem,
+	gf_list_reserve,
+	gf_list_append
+};
+
+static const ListBenchOps *bench_variants[] = {
+	&lb_gpac_ops, &lb_linked_ops, &lb_dlinked_ops, &lb_array_ops, &lb_grow_ops
+};
+#define BENCH_NB_VARIANTS	(sizeof(bench_variants) / sizeof(bench_variants[0]))
+
+static void usage()
+{
+	fprintf(stderr, "USAGE: listbench [-loops N] [-queue N] file [file ...]\n"
+	        "\n"
+	        "Compares the GF_List build variants (linked, double linked, exact-size array, growing array)\n"
+	        "and the variant built in libgpac on list-heavy workloads:\n"
+	        "- ISO box tree built from an MP4 file, walked by enumeration and by index\n"
+	        "- XML DOM tree (for example a DASH MPD) mirrored in lists, walked and randomly indexed\n"
+	        "- packet queue pattern (add at the end, remove at the front)\n"
+	        "Files ending with .mpd or .xml are loaded as XML, other files as ISO media.\n"
+	        "\n"
+	        "\t-loops N:  number of walks of each tree (default 100)\n"
+	        "\t-queue N:  number of items pushed through the queue (default 100000)\n"
+	       );
+}
+
+typedef struct _bench_node
+{
+	u32 type;
+	u64 size;
+	GF_List *children;
+	GF_List *attributes;
+} BenchNode;
+
+static BenchNode *bench_node_new(const ListBenchOps *ops, u32 type, u64 size)
+{
+	BenchNode *n;
+	GF_SAFEALLOC(n, BenchNode);
+	n->type = type;
+	n->size = size;
+	n->children = ops->list_new();
+	n->attributes = ops->list_new();
+	return n;
+}
+
+static void bench_node_del(const ListBenchOps *ops, BenchNode *n)
+{
+	u32 i = 0;
+	BenchNode *child;
+	while ((child = (BenchNode *)ops->enumerate(n->children, &i))) {
+		bench_node_del(ops, child);
+	}
+	ops->list_del(n->children);
+	ops->list_del(n->attributes);
+	gf_free(n);
+}
+
+/*box types parsed as containers, and size of the header to skip before the child boxes*/
+static Bool bench_box_is_container(u32 type, u32 *skip)
+{
+	*skip = 0;
+	switch (type) {
+	case GF_4CC('m','o','o','v'):
+	case GF_4CC('t','r','a','k'):
+	case GF_4CC('m','d','i','a'):
+	case GF_4CC('m','i','n','f'):
+	case GF_4CC('s','t','b','l'):
+	case GF_4CC('d','i','n','f'):
+	case GF_4CC('e','d','t','s'):
+	case GF_4CC('u','d','t','a'):
+	case GF_4CC('m','v','e','x'):
+	case GF_4CC('m','o','o','f'):
+	case GF_4CC('t','r','a','f'):
+	case GF_4CC('m','f','r','a'):
+	case GF_4CC('s','i','n','f'):
+	case GF_4CC('s','c','h','i'):
+		return GF_TRUE;
+	case GF_4CC('m','e','t','a'):
+		*skip = 4;
+		return GF_TRUE;
+	case GF_4CC('s','t','s','d'):
+	case GF_4CC('d','r','e','f'):
+		*skip = 8;
+		return GF_TRUE;
+	default:
+		return GF_FALSE;
+	}
+}
+
+/*builds the box tree the way the box parser does, one list of children per box*/
+static void bench_box_parse(const ListBenchOps *ops, GF_BitStream *bs, BenchNode *parent, u64 end)
+{
+	while (gf_bs_get_position(bs) + 8 <= end) {
+		u32 type, skip;
+		u64 start = gf_bs_get_position(bs);
+		u64 size = gf_bs_read_u32(bs);
+		BenchNode *box;
+		type = gf_bs_read_u32(bs);
+		if (size==1) size = gf_bs_read_u64(bs);
+		else if (!size) size = end - start;
+		if ((size<8) || (start + size > end)) break;
+
+		box = bench_node_new(ops, type, size);
+		ops->add(parent->children, box);
+		if (bench_box_is_container(type, &skip) && (gf_bs_get_position(bs) + skip <= start + size)) {
+			gf_bs_skip_bytes(bs, skip);
+			bench_box_parse(ops, bs, box, start + size);
+		}
+		gf_bs_seek(bs, start + size);
+	}
+}
+
+static BenchNode *bench_load_boxes(const ListBenchOps *ops, FILE *f)
+{
+	GF_BitStream *bs;
+	BenchNode *root = bench_node_new(ops, 0, 0);
+	gf_fseek(f, 0, SEEK_SET);
+	bs = gf_bs_from_file(f, GF_BITSTREAM_READ);
+	bench_box_parse(ops, bs, root, gf_bs_get_size(bs));
+	gf_bs_del(bs);
+	return root;
+}
+
+/*mirrors an XML DOM node in lists, attributes as children of the attribute list*/
+static BenchNode *bench_load_xml(const ListBenchOps *ops, GF_XMLNode *node)
+{
+	u32 i;
+	GF_XMLNode *child;
+	GF_XMLAttribute *att;
+	BenchNode *n = bench_node_new(ops, node->type, node->name ? strlen(node->name) : 0);
+	if (node->type != GF_XML_NODE_TYPE) return n;
+
+	i = 0;
+	while ((att = (GF_XMLAttribute *)gf_list_enum(node->attributes, &i))) {
+		ops->add(n->attributes, att);
+	}
+	i = 0;
+	while ((child = (GF_XMLNode *)gf_list_enum(node->content, &i))) {
+		ops->add(n->children, bench_load_xml(ops, child));
+	}
+	return n;
+}
+
+/*depth-first walk using enumeration*/
+static u64 bench_walk_enum(const ListBenchOps *ops, BenchNode *n)
+{
+	u32 i = 0;
+	u64 sum = n->type + n->size + ops->count(n->attributes);
+	BenchNode *child;
+	while ((child = (BenchNode *)ops->enumerate(n->children, &i))) {
+		sum += bench_walk_enum(ops, child);
+	}
+	return sum;
+}
+
+/*depth-first walk by index, as done by most loops in the code base*/
+static u64 bench_walk_index(const ListBenchOps *ops, BenchNode *n)
+{
+	u32 i, count;
+	u64 sum = n->type + n->size;
+	count = ops->count(n->attributes);
+	for (i=0; i<count; i++) {
+		if (ops->get(n->attributes, i)) sum++;
+	}
+	count = ops->count(n->children);
+	for (i=0; i<count; i++) {
+		sum += bench_walk_index(ops, (BenchNode *)ops->get(n->children, i));
+	}
+	return sum;
+}
+
+/*max number of random lookups per list*/
+#define BENCH_RANDOM_LOOKUPS	256
+
+/*random access in every child list, as done when looking up segments or samples by number*/
+static u64 bench_walk_random(const ListBenchOps *ops, BenchNode *n, u32 *seed)
+{
+	u32 i, count;
+	u64 sum = 0;
+	count = ops->count(n->children);
+	for (i=0; (i<count) && (i<BENCH_RANDOM_LOOKUPS); i++) {
+		BenchNode *child;
+		*seed = *seed * 1103515245 + 12345;
+		child = (BenchNode *)ops->get(n->children, (*seed >> 8) % count);
+		sum += child->type + child->size;
+	}
+	for (i=0; i<count; i++) {
+		sum += bench_walk_random(ops, (BenchNode *)ops->get(n->children, i), seed);
+	}
+	return sum;
+}
+
+/*copies all lists of the tree into new lists, with and without pre-allocation and bulk append*/
+static u64 bench_copy_lists(const ListBenchOps *ops, BenchNode *n, Bool bulk)
+{
+	u32 i, count;
+	u64 sum = 0;
+	GF_List *copy = ops->list_new();
+	count = ops->count(n->children);
+	if (bulk) {
+		ops->reserve(copy, count);
+		ops->append(copy, n->children);
+	} else {
+		for (i=0; i<count; i++) ops->add(copy, ops->get(n->children, i));
+	}
+	sum += ops->count(copy);
+	ops->list_del(copy);
+	for (i=0; i<count; i++) {
+		sum += bench_copy_lists(ops, (BenchNode *)ops->get(n->children, i), bulk);
+	}
+	return sum;
+}
+
+/*packet queue: items are added at the end and removed from the front, with a bounded queue depth*/
+static u64 bench_queue(const ListBenchOps *ops, u32 nb_items)
+{
+	u32 i;
+	u64 sum = 0;
+	GF_List *queue = ops->list_new();
+	for (i=0; i<nb_items; i++) {
+		ops->add(queue, (void *) PTR_TO_U_CAST (i+1));
+		if (ops->count(queue) > 256) {
+			sum += (u64) PTR_TO_U_CAST ops->get(queue, 0);
+			ops->rem(queue, 0);
+		}
+	}
+	while (ops->count(queue)) {
+		sum += (u64) PTR_TO_U_CAST ops->get(queue, 0);
+		ops->rem(queue, 0);
+	}
+	ops->list_del(queue);
+	return sum;
+}
+
+typedef struct
+{
+	u64 build, walk_enum, walk_index, walk_random, copy, copy_bulk;
+	u64 sum;
+} BenchResult;
+
+static void bench_tree(const ListBenchOps *ops, FILE *f, GF_XMLNode *xml_root, u32 loops, BenchResult *res)
+{
+	u32 j, seed;
+	u64 start;
+	BenchNode *root = NULL;
+
+	memset(res, 0, sizeof(BenchResult));
+	start = gf_sys_clock_high_res();
+	for (j=0; j<loops; j++) {
+		if (root) bench_node_del(ops, root);
+		root = f ? bench_load_boxes(ops, f) : bench_load_xml(ops, xml_root);
+	}
+	res->build = gf_sys_clock_high_res() - start;
+
+	start = gf_sys_clock_high_res();
+	for (j=0; j<loops; j++) res->sum += bench_walk_enum(ops, root);
+	res->walk_enum = gf_sys_clock_high_res() - start;
+
+	start = gf_sys_clock_high_res();
+	for (j=0; j<loops; j++) res->sum += bench_walk_index(ops, root);
+	res->walk_index = gf_sys_clock_high_res() - start;
+
+	seed = 1;
+	start = gf_sys_clock_high_res();
+	for (j=0; j<loops; j++) res->sum += bench_walk_random(ops, root, &seed);
+	res->walk_random = gf_sys_clock_high_res() - start;
+
+	start = gf_sys_clock_high_res();
+	for (j=0; j<loops; j++) res->sum += bench_copy_lists(ops, root, GF_FALSE);
+	res->copy = gf_sys_clock_high_res() - start;
+
+	start = gf_sys_clock_high_res();
+	for (j=0; j<loops; j++) res->sum += bench_copy_lists(ops, root, GF_TRUE);
+	res->copy_bulk = gf_sys_clock_high_res() - start;
+
+	bench_node_del(ops, root);
+}
+
+static u32 bench_count_nodes(BenchNode *n)
+{
+	u32 i = 0, count = 1;
+	BenchNode *child;
+	while ((child = (BenchNode *)gf_list_enum(n->children, &i))) {
+		count += bench_count_nodes(child);
+	}
+	return count;
+}
+
+static Bool bench_file(const char *src, u32 loops)
+{
+	u32 i, nb_nodes;
+	u64 sum_ref = 0;
+	Bool mismatch = GF_FALSE;
+	FILE *f = NULL;
+	GF_DOMParser *dom = NULL;
+	GF_XMLNode *xml_root = NULL;
+	BenchNode *root;
+	const char *ext = strrchr(src, '.');
+
+	if (ext && (!stricmp(ext, ".mpd") || !stricmp(ext, ".xml"))) {
+		GF_Err e;
+		dom = gf_xml_dom_new();
+		e = gf_xml_dom_parse(dom, src, NULL, NULL);
+		if (e) {
+			fprintf(stderr, "Cannot parse %s: %s\n", src, gf_xml_dom_get_error(dom));
+			gf_xml_dom_del(dom);
+			return GF_TRUE;
+		}
+		xml_root = gf_xml_dom_get_root(dom);
+	} else {
+		f = gf_fopen(src, "rb");
+		if (!f) {
+			fprintf(stderr, "Cannot open %s\n", src);
+			return GF_TRUE;
+		}
+	}
+
+	root = f ? bench_load_boxes(&lb_gpac_ops, f) : bench_load_xml(&lb_gpac_ops, xml_root);
+	nb_nodes = bench_count_nodes(root);
+	bench_node_del(&lb_gpac_ops, root);
+
+	fprintf(stdout, "%s: %s tree with %d nodes - %d loops - times in us\n", src, f ? "box" : "XML", nb_nodes, loops);
+	fprintf(stdout, "%-18s %10s %10s %10s %10s %10s %10s\n", "variant", "build", "enum", "index", "random", "copy", "bulk copy");
+	for (i=0; i<BENCH_NB_VARIANTS; i++) {
+		BenchResult res;
+		bench_tree(bench_variants[i], f, xml_root, loops, &res);
+		if (!i) sum_ref = res.sum;
+		fprintf(stdout, "%-18s %10d %10d %10d %10d %10d %10d%s\n", bench_variants[i]->name,
+		        (u32) res.build, (u32) res.walk_enum, (u32) res.walk_index, (u32) res.walk_random, (u32) res.copy, (u32) res.copy_bulk,
+		        (res.sum==sum_ref) ? "" : " - MISMATCH");
+		if (res.sum!=sum_ref) mismatch = GF_TRUE;
+	}
+	fprintf(stdout, "\n");
+
+	if (f) gf_fclose(f);
+	if (dom) gf_xml_dom_del(dom);
+	return mismatch;
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, loops, queue_size;
+	u64 sum_ref = 0;
+	Bool mismatch = GF_FALSE;
+	Bool has_file = GF_FALSE;
+
+	loops = 100;
+	queue_size = 100000;
+	for (i=1; i<(u32) argc; i++) {
+		if (!strcmp(argv[i], "-loops") && (i+1<(u32) argc)) {
+			loops = atoi(argv[i+1]);
+			i++;
+		}
+		else if (!strcmp(argv[i], "-queue") && (i+1<(u32) argc)) {
+			queue_size = atoi(argv[i+1]);
+			i++;
+		}
+		else if (argv[i][0]=='-') {
+			usage();
+			return 1;
+		}
+		else has_file = GF_TRUE;
+	}
+	if (!has_file || !loops) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+	gf_log_set_tool_level(GF_LOG_ALL, GF_LOG_ERROR);
+
+	for (i=1; i<(u32) argc; i++) {
+		if (!strcmp(argv[i], "-loops") || !strcmp(argv[i], "-queue")) i++;
+		else if (bench_file(argv[i], loops)) mismatch = GF_TRUE;
+	}
+
+	fprintf(stdout, "Queue: %d items - times in us\n", queue_size);
+	for (i=0; i<BENCH_NB_VARIANTS; i++) {
+		u64 sum, start = gf_sys_clock_high_res();
+		sum = bench_queue(bench_variants[i], queue_size);
+		fprintf(stdout, "%-18s %10d%s\n", bench_variants[i]->name, (u32) (gf_sys_clock_high_res() - start), (!i || (sum==sum_ref)) ? "" : " - MISMATCH");
+		if (!i) sum_ref = sum;
+		else if (sum!=sum_ref) mismatch = GF_TRUE;
+	}
+
+	gf_sys_close();
+	return mismatch ? 1 : 0;
+}
@@ -0,0 +1,230 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2000-2014
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - incremental MPD refresh checker
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/internal/mpd.h>
+#include <gpac/xml.h>
+
+static void usage()
+{
+	fprintf(stderr, "USAGE: mpdrefresh MPD [-incremental MPD | -full MPD]...\n"
+	        "\n"
+	        "Applies the successive versions of a dynamic MPD the way the DASH client refreshes it, and checks\n"
+	        "the MPD obtained after each refresh against a full parse of the new version.\n"
+	        "\n"
+	        "\t-incremental MPD:  next version, expected to be applied without parsing the whole document\n"
+	        "\t-full MPD:         next version, expected to require a full parse\n"
+	        "\t-h:                prints this help\n"
+	       );
+}
+
+/*loads the NULL-terminated text of the file*/
+static char *load_text(const char *file, u32 *size)
+{
+	char *text;
+	FILE *f = gf_fopen(file, "rb");
+	if (!f) return NULL;
+	gf_fseek(f, 0, SEEK_END);
+	*size = (u32) gf_ftell(f);
+	gf_fseek(f, 0, SEEK_SET);
+	text = (char *) gf_malloc(sizeof(char) * (*size+1));
+	if (fread(text, 1, *size, f) != *size) {
+		gf_free(text);
+		text = NULL;
+	} else {
+		text[*size] = 0;
+	}
+	gf_fclose(f);
+	return text;
+}
+
+static GF_MPD *parse_mpd(const char *file)
+{
+	GF_Err e;
+	GF_MPD *mpd = NULL;
+	GF_DOMParser *parser = gf_xml_dom_new();
+	e = gf_xml_dom_parse(parser, file, NULL, NULL);
+	if (!e) {
+		mpd = gf_mpd_new();
+		e = gf_mpd_init_from_dom(gf_xml_dom_get_root(parser), mpd, file);
+		if (e) {
+			gf_mpd_del(mpd);
+			mpd = NULL;
+		}
+	}
+	if (e) fprintf(stderr, "Cannot parse %s: %s\n", file, gf_error_to_string(e));
+	gf_xml_dom_del(parser);
+	return mpd;
+}
+
+static void add_timelines(GF_List *timelines, GF_MPD_SegmentList *list, GF_MPD_SegmentTemplate *template)
+{
+	if (list && list->segment_timeline) gf_list_add(timelines, list->segment_timeline);
+	if (template && template->segment_timeline) gf_list_add(timelines, template->segment_timeline);
+}
+
+/*lists the SegmentTimeline elements of the MPD in document order*/
+static GF_List *get_timelines(GF_MPD *mpd)
+{
+	u32 i, j, k;
+	GF_List *timelines = gf_list_new();
+	for (i=0; i<gf_list_count(mpd->periods); i++) {
+		GF_MPD_Period *period = gf_list_get(mpd->periods, i);
+		add_timelines(timelines, period->segment_list, period->segment_template);
+		for (j=0; j<gf_list_count(period->adaptation_sets); j++) {
+			GF_MPD_AdaptationSet *set = gf_list_get(period->adaptation_sets, j);
+			add_timelines(timelines, set->segment_list, set->segment_template);
+			for (k=0; k<gf_list_count(set->representations); k++) {
+				GF_MPD_Representation *rep = gf_list_get(set->representations, k);
+				add_timelines(timelines, rep->segment_list, rep->segment_template);
+			}
+		}
+	}
+	return timelines;
+}
+
+/*compares the timelines and the refreshed attributes of the two MPDs - returns the number of differences*/
+static u32 compare_mpd(GF_MPD *mpd, GF_MPD *ref, const char *file)
+{
+	u32 i, j, nb_diff = 0;
+	GF_List *timelines = get_timelines(mpd);
+	GF_List *ref_timelines = get_timelines(ref);
+
+	if ((mpd->publishTime != ref->publishTime) || (mpd->minimum_update_period != ref->minimum_update_period)
+	        || (mpd->media_presentation_duration != ref->media_presentation_duration)) {
+		fprintf(stderr, "%s: MPD attributes differ from the full parse\n", file);
+		nb_diff++;
+	}
+	if (gf_list_count(timelines) != gf_list_count(ref_timelines)) {
+		fprintf(stderr, "%s: %d timelines, %d in the full parse\n", file, gf_list_count(timelines), gf_list_count(ref_timelines));
+		nb_diff++;
+	} else {
+		for (i=0; i<gf_list_count(timelines); i++) {
+			GF_MPD_SegmentTimeline *tl = gf_list_get(timelines, i);
+			GF_MPD_SegmentTimeline *ref_tl = gf_list_get(ref_timelines, i);
+			if (gf_list_count(tl->entries) != gf_list_count(ref_tl->entries)) {
+				fprintf(stderr, "%s: timeline %d has %d entries, %d in the full parse\n", file, i+1, gf_list_count(tl->entries), gf_list_count(ref_tl->entries));
+				nb_diff++;
+				continue;
+			}
+			for (j=0; j<gf_list_count(tl->entries); j++) {
+				GF_MPD_SegmentTimelineEntry *ent = gf_list_get(tl->entries, j);
+				GF_MPD_SegmentTimelineEntry *ref_ent = gf_list_get(ref_tl->entries, j);
+				if ((ent->start_time != ref_ent->start_time) || (ent->duration != ref_ent->duration) || (ent->repeat_count != ref_ent->repeat_count)) {
+					fprintf(stderr, "%s: timeline %d entry %d is t="LLU" d=%d r=%d, t="LLU" d=%d r=%d in the full parse\n", file, i+1, j+1,
+					        ent->start_time, ent->duration, ent->repeat_count, ref_ent->start_time, ref_ent->duration, ref_ent->repeat_count);
+					nb_diff++;
+				}
+			}
+		}
+	}
+	gf_list_del(timelines);
+	gf_list_del(ref_timelines);
+	return nb_diff;
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, size, nb_errors;
+	char *text;
+	GF_MPD *mpd;
+	GF_MPDTextState *state;
+
+	if ((argc < 2) || !strcmp(argv[1], "-h")) {
+		usage();
+		return (argc < 2) ? 1 : 0;
+	}
+	for (i=2; i<(u32) argc; i+=2) {
+		if ((i+1==(u32) argc) || (strcmp(argv[i], "-incremental") && strcmp(argv[i], "-full"))) {
+			usage();
+			return 1;
+		}
+	}
+
+	gf_sys_init(GF_FALSE);
+	gf_log_set_tool_level(GF_LOG_ALL, GF_LOG_ERROR);
+
+	nb_errors = 0;
+	state = NULL;
+	text = load_text(argv[1], &size);
+	mpd = text ? parse_mpd(argv[1]) : NULL;
+	if (mpd) {
+		state = gf_mpd_text_state_new(mpd, text, size);
+		if (!state) fprintf(stderr, "%s cannot be refreshed incrementally\n", argv[1]);
+	}
+	if (text) gf_free(text);
+	if (!state) nb_errors++;
+
+	for (i=2; state && (i<(u32) argc); i+=2) {
+		GF_Err e;
+		u32 nb_timelines;
+		const char *file = argv[i+1];
+		Bool expect_incremental = !strcmp(argv[i], "-incremental") ? GF_TRUE : GF_FALSE;
+		GF_MPD *ref = parse_mpd(file);
+		text = load_text(file, &size);
+		if (!ref || !text) {
+			if (!text) fprintf(stderr, "Cannot read %s\n", file);
+			if (ref) gf_mpd_del(ref);
+			if (text) gf_free(text);
+			nb_errors++;
+			break;
+		}
+
+		e = gf_mpd_text_state_update(state, mpd, text, size, &nb_timelines);
+		if (e == GF_OK) {
+			fprintf(stdout, "%s: incremental refresh, %d timelines updated\n", file, nb_timelines);
+			nb_errors += compare_mpd(mpd, ref, file);
+			gf_mpd_del(ref);
+		} else if (e == GF_NOT_SUPPORTED) {
+			/*fallback to the full parse, as done by the DASH client*/
+			fprintf(stdout, "%s: full parse\n", file);
+			gf_mpd_text_state_del(state);
+			gf_mpd_del(mpd);
+			mpd = ref;
+			state = gf_mpd_text_state_new(mpd, text, size);
+			if (!state) {
+				fprintf(stderr, "%s cannot be refreshed incrementally\n", file);
+				nb_errors++;
+			}
+		} else {
+			fprintf(stderr, "%s: refresh failed: %s\n", file, gf_error_to_string(e));
+			gf_mpd_del(ref);
+			nb_errors++;
+		}
+		gf_free(text);
+		if ((e == GF_OK) != expect_incremental) {
+			fprintf(stderr, "%s: %s refresh expected\n", file, expect_incremental ? "incremental" : "full");
+			nb_errors++;
+		}
+	}
+
+	if (state) gf_mpd_text_state_del(state);
+	if (mpd) gf_mpd_del(mpd);
+	gf_sys_close();
+	if (nb_errors) {
+		fprintf(stderr, "%d errors\n", nb_errors);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,286 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2000-2014
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - TS over UDP PCR accuracy checker
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/tools.h>
+#include <gpac/network.h>
+#include <math.h>
+
+#define CHECK_NB_DATAGRAMS	64
+#define CHECK_DATAGRAM_SIZE	(188*7*2)
+#define CHECK_NB_BINS	8
+
+/*upper bounds of the inter-arrival histogram bins, in microseconds*/
+static const u32 gap_bins[CHECK_NB_BINS-1] = {100, 500, 1000, 2000, 5000, 10000, 50000};
+static const char *gap_names[CHECK_NB_BINS] = {"<100us", "<500us", "<1ms", "<2ms", "<5ms", "<10ms", "<50ms", ">=50ms"};
+
+typedef struct
+{
+	/*PID carrying the PCR, 0 until found*/
+	u32 pcr_pid;
+	/*arrival time and PCR of the first PCR, in microseconds and 27 MHz units*/
+	u64 first_arrival, first_pcr;
+	/*arrival offsets against the PCR clock and matching PCR times, in microseconds*/
+	Double *offsets, *pcr_times;
+	u32 nb_pcr, alloc_pcr;
+	/*datagram inter-arrival histogram*/
+	u64 last_arrival;
+	u32 nb_datagrams;
+	u32 gap_hist[CHECK_NB_BINS];
+} PCRCheck;
+
+static void usage()
+{
+	fprintf(stderr, "USAGE: tspcrcheck [-ip IP] [-port N] [-duration MS] [-max-jitter US]\n"
+	        "\n"
+	        "Receives an MPEG-2 TS over UDP and measures the arrival time of each PCR of the first\n"
+	        "PCR PID against the PCR value, to check the output pacing of a TS sender.\n"
+	        "\n"
+	        "\t-ip IP:          local or multicast address to listen on (default any)\n"
+	        "\t-port N:         UDP port to listen on (default 1234)\n"
+	        "\t-duration MS:    stops after MS milliseconds of reception (default 10000)\n"
+	        "\t-max-jitter US:  exits with an error if the PCR jitter, drift removed, exceeds US microseconds\n"
+	        "\t-h:              prints this help\n"
+	       );
+}
+
+static u32 get_gap_bin(u64 gap)
+{
+	u32 i;
+	for (i=0; i<CHECK_NB_BINS-1; i++) {
+		if (gap < gap_bins[i]) return i;
+	}
+	return CHECK_NB_BINS-1;
+}
+
+/*locates a PCR in the TS packet - returns GF_TRUE and the 27 MHz PCR value if found*/
+static Bool get_pcr(const u8 *pck, u32 *pid, u64 *pcr)
+{
+	u64 pcr_base;
+	if (pck[0] != 0x47) return GF_FALSE;
+	/*adaptation field present, at least 7 bytes long, PCR flag set*/
+	if (!(pck[3] & 0x20)) return GF_FALSE;
+	if (pck[4] < 7) return GF_FALSE;
+	if (!(pck[5] & 0x10)) return GF_FALSE;
+
+	*pid = ((pck[1] & 0x1F) << 8) | pck[2];
+	pcr_base = ((u64) pck[6] << 25) | ((u64) pck[7] << 17) | ((u64) pck[8] << 9) | ((u64) pck[9] << 1) | (pck[10] >> 7);
+	*pcr = pcr_base * 300 + (((pck[10] & 0x1) << 8) | pck[11]);
+	return GF_TRUE;
+}
+
+static void process_datagram(PCRCheck *check, const u8 *data, u32 size, u64 arrival)
+{
+	u32 i;
+	if (check->nb_datagrams) {
+		check->gap_hist[get_gap_bin(arrival - check->last_arrival)]++;
+	}
+	check->last_arrival = arrival;
+	check->nb_datagrams++;
+
+	for (i=0; i+188<=size; i+=188) {
+		u32 pid;
+		u64 pcr;
+		Double pcr_time;
+		if (!get_pcr(data+i, &pid, &pcr)) continue;
+		if (!check->pcr_pid) {
+			check->pcr_pid = pid;
+			check->first_arrival = arrival;
+			check->first_pcr = pcr;
+		}
+		if (pid != check->pcr_pid) continue;
+		/*PCR wraps every 26 hours, not handled*/
+		if (pcr < check->first_pcr) continue;
+
+		if (check->nb_pcr == check->alloc_pcr) {
+			check->alloc_pcr = check->alloc_pcr ? 2*check->alloc_pcr : 1024;
+			check->offsets = (Double *) gf_realloc(check->offsets, sizeof(Double)*check->alloc_pcr);
+			check->pcr_times = (Double *) gf_realloc(check->pcr_times, sizeof(Double)*check->alloc_pcr);
+		}
+		pcr_time = (Double) (s64) (pcr - check->first_pcr) / 27.0;
+		check->pcr_times[check->nb_pcr] = pcr_time;
+		check->offsets[check->nb_pcr] = (Double) (s64) (arrival - check->first_arrival) - pcr_time;
+		check->nb_pcr++;
+	}
+}
+
+/*prints the PCR statistics - returns the peak-to-peak jitter once the drift is removed, in microseconds*/
+static Double print_stats(PCRCheck *check)
+{
+	u32 i;
+	Double sum_t, sum_o, sum_tt, sum_to, slope, intercept, min_o, max_o, min_r, max_r, rms, n;
+
+	fprintf(stdout, "%d datagrams - %d PCRs on PID %d\n", check->nb_datagrams, check->nb_pcr, check->pcr_pid);
+	fprintf(stdout, "Datagram inter-arrival:");
+	for (i=0; i<CHECK_NB_BINS; i++) fprintf(stdout, " %s:%d", gap_names[i], check->gap_hist[i]);
+	fprintf(stdout, "\n");
+	if (check->nb_pcr < 2) return 0;
+
+	/*least-squares fit of the arrival offset against the PCR clock*/
+	n = check->nb_pcr;
+	sum_t = sum_o = sum_tt = sum_to = 0;
+	min_o = max_o = check->offsets[0];
+	for (i=0; i<check->nb_pcr; i++) {
+		Double t = check->pcr_times[i];
+		Double o = check->offsets[i];
+		sum_t += t;
+		sum_o += o;
+		sum_tt += t*t;
+		sum_to += t*o;
+		if (o < min_o) min_o = o;
+		if (o > max_o) max_o = o;
+	}
+	slope = 0;
+	if (n*sum_tt != sum_t*sum_t) slope = (n*sum_to - sum_t*sum_o) / (n*sum_tt - sum_t*sum_t);
+	intercept = (sum_o - slope*sum_t) / n;
+
+	rms = 0;
+	min_r = max_r = check->offsets[0] - intercept;
+	for (i=0; i<check->nb_pcr; i++) {
+		Double r = check->offsets[i] - intercept - slope*check->pcr_times[i];
+		rms += r*r;
+		if (r < min_r) min_r = r;
+		if (r > max_r) max_r = r;
+	}
+	rms = sqrt(rms / n);
+
+	fprintf(stdout, "PCR arrival offset: peak-to-peak %.0f us - drift %.2f ppm - drift removed: peak-to-peak %.0f us, RMS %.1f us\n",
+	        max_o - min_o, slope * 1000000, max_r - min_r, rms);
+	return max_r - min_r;
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, port, duration, max_jitter;
+	char *ip;
+	char *buffer;
+	u64 start, launch;
+	Double jitter;
+	Bool use_rx_ts;
+	GF_Err e;
+	GF_Socket *sk;
+	GF_SockDatagram datagrams[CHECK_NB_DATAGRAMS];
+	PCRCheck check;
+
+	ip = NULL;
+	port = 1234;
+	duration = 10000;
+	max_jitter = 0;
+	for (i=1; i<(u32) argc; i++) {
+		if (!strcmp(argv[i], "-h")) {
+			usage();
+			return 0;
+		}
+		if (i+1==(u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(argv[i], "-ip")) ip = argv[i+1];
+		else if (!strcmp(argv[i], "-port")) port = atoi(argv[i+1]);
+		else if (!strcmp(argv[i], "-duration")) duration = atoi(argv[i+1]);
+		else if (!strcmp(argv[i], "-max-jitter")) max_jitter = atoi(argv[i+1]);
+		else {
+			usage();
+			return 1;
+		}
+		i++;
+	}
+
+	gf_sys_init(GF_FALSE);
+	gf_log_set_tool_level(GF_LOG_ALL, GF_LOG_ERROR);
+
+	sk = gf_sk_new(GF_SOCK_TYPE_UDP);
+	if (!sk) {
+		fprintf(stderr, "Cannot create socket\n");
+		gf_sys_close();
+		return 1;
+	}
+	if (ip && gf_sk_is_multicast_address(ip)) {
+		e = gf_sk_setup_multicast(sk, ip, port, 0, GF_FALSE, NULL);
+	} else {
+		e = gf_sk_bind(sk, ip, port, NULL, 0, GF_SOCK_REUSE_PORT);
+	}
+	if (e) {
+		fprintf(stderr, "Cannot listen on %s:%d: %s\n", ip ? ip : "*", port, gf_error_to_string(e));
+		gf_sk_del(sk);
+		gf_sys_close();
+		return 1;
+	}
+	gf_sk_set_buffer_size(sk, GF_FALSE, 0x40000);
+	use_rx_ts = (gf_sk_set_rx_timestamps(sk, GF_TRUE) == GF_OK) ? GF_TRUE : GF_FALSE;
+	if (!use_rx_ts) fprintf(stderr, "Kernel reception timestamps not available, using application time\n");
+
+	buffer = (char *) gf_malloc(sizeof(char) * CHECK_DATAGRAM_SIZE * CHECK_NB_DATAGRAMS);
+	memset(&check, 0, sizeof(PCRCheck));
+
+	fprintf(stderr, "Listening on %s:%d for %d ms\n", ip ? ip : "*", port, duration);
+	start = 0;
+	launch = gf_sys_clock_high_res();
+	while (1) {
+		u32 nb_read;
+		u64 now = gf_sys_clock_high_res();
+		/*time starts with the first datagram*/
+		if (start && (now - start > (u64) duration * 1000)) break;
+		/*nothing sent*/
+		if (!start && (now - launch > (u64) duration * 1000)) break;
+
+		for (i=0; i<CHECK_NB_DATAGRAMS; i++) {
+			datagrams[i].data = buffer + i*CHECK_DATAGRAM_SIZE;
+			datagrams[i].size = CHECK_DATAGRAM_SIZE;
+		}
+		e = gf_sk_receive_batch(sk, datagrams, CHECK_NB_DATAGRAMS, &nb_read);
+		if (e == GF_IP_NETWORK_EMPTY) {
+			/*sender done*/
+			if (start && (now - check.last_arrival > 2000000)) break;
+			continue;
+		}
+		if (e) {
+			fprintf(stderr, "Error receiving data: %s\n", gf_error_to_string(e));
+			break;
+		}
+		now = gf_sys_clock_high_res();
+		if (!start) start = now;
+		for (i=0; i<nb_read; i++) {
+			process_datagram(&check, (u8 *) datagrams[i].data, datagrams[i].read, (use_rx_ts && datagrams[i].timestamp) ? datagrams[i].timestamp : now);
+		}
+	}
+
+	jitter = print_stats(&check);
+
+	if (check.offsets) gf_free(check.offsets);
+	if (check.pcr_times) gf_free(check.pcr_times);
+	gf_free(buffer);
+	gf_sk_del(sk);
+	gf_sys_close();
+
+	if (check.nb_pcr < 2) {
+		fprintf(stderr, "Not enough PCRs received\n");
+		return 1;
+	}
+	if (max_jitter && (jitter > max_jitter)) {
+		fprintf(stderr, "PCR jitter %.0f us above %d us\n", jitter, max_jitter);
+		return 1;
+	}
+	return 0;
+}
@@ -109,6 +109,26 @@ GF_Err gf_bs_set_output_buffering(GF_BitStream *bs, u32 size);
  */
 u32 gf_bs_get_output_buffering(GF_BitStream *bs);
 
+/*!
+ *	\brief sets bitstream read cache size
+ *
+ * Sets the read-ahead cache size for file-based read bitstreams. Data is read from the file by blocks of this size instead of byte by byte.
+ * The file handle shall not be used directly while the cache is enabled, since its position is ahead of the bitstream position.
+ *	\param bs the target bitstream
+ *	\param size size of the read cache in bytes, 0 disables the cache
+ *	\return error if any.
+ */
+GF_Err gf_bs_set_input_buffering(GF_BitStream *bs, u32 size);
+
+/*!
+ *	\brief gets bitstream read cache size
+ *
+ * Gets the read-ahead cache size for file-based read bitstreams.
+ *	\param bs the target bitstream
+ *	\return size of the read cache in bytes, 0 if no cache
+ */
+u32 gf_bs_get_input_buffering(GF_BitStream *bs);
+
 /*!
  *	\brief integer reading
  *
@@ -127,6 +147,22 @@ u32 gf_bs_read_int(GF_BitStream *bs, u32 nBits);
  *	\return the large integer value read.
  */
 u64 gf_bs_read_long_int(GF_BitStream *bs, u32 nBits);
+/*!
+ *	\brief unsigned exp-Golomb reading
+ *
+ *	Reads an unsigned integer coded with exp-Golomb code, ue(v), as used in MPEG-4 AVC and HEVC.
+ *	\param bs the target bitstream
+ *	\return the integer value read, 0 if the code is invalid or the bitstream is too short.
+ */
+u32 gf_bs_read_ue(GF_BitStream *bs);
+/*!
+ *	\brief signed exp-Golomb reading
+ *
+ *	Reads a signed integer coded with exp-Golomb code, se(v), as used in MPEG-4 AVC and HEVC.
+ *	\param bs the target bitstream
+ *	\return the integer value read.
+ */
+s32 gf_bs_read_se(GF_BitStream *bs);
 /*!
  *	\brief float reading
  *
@@ -527,6 +563,25 @@ void gf_bs_flush(GF_BitStream *bs);
  */
 void gf_bs_reassign(GF_BitStream *bs, FILE *stream);
 
+/*!
+ *\brief Sets bitstream cookie
+ *
+ *Sets an opaque value on the bitstream, used by parsers to pass context information down to the readers of the bitstream.
+ *\param bs the target bitstream
+ *\param cookie the new cookie value
+ *\return the previous cookie value
+ */
+u64 gf_bs_set_cookie(GF_BitStream *bs, u64 cookie);
+
+/*!
+ *\brief Gets bitstream cookie
+ *
+ *Gets the opaque value set on the bitstream, 0 by default.
+ *\param bs the target bitstream
+ *\return the cookie value
+ */
+u64 gf_bs_get_cookie(GF_BitStream *bs);
+
 /*! @} */
 
 #ifdef __cplusplus
@@ -57,6 +57,11 @@ typedef struct __DownloadedCacheEntryStruct * DownloadedCacheEntry;
 
 typedef struct __CacheReaderStruct * GF_CacheReader;
 
+/**
+ * Handle for the refcounted memory of cache entries stored in memory (gmem:// URLs)
+ */
+typedef struct __CacheBlobStruct GF_CacheBlob;
+
 /**
  * Free The DownloadedCacheEntry handle
  * \param entry The entry to delete
@@ -183,6 +188,14 @@ GF_Err gf_cache_flush_disk_cache( const DownloadedCacheEntry entry );
 
 GF_Err gf_cache_set_content_length( const DownloadedCacheEntry entry, u32 length );
 
+/**
+ * Updates the entry after data has been appended to its cache file by the user
+ * \param entry The entry
+ * \param range_end The new end of the byte range held by the cache file
+ * \param size The number of bytes appended
+ */
+GF_Err gf_cache_extend_range( const DownloadedCacheEntry entry, u64 range_end, u32 size );
+
 u32 gf_cache_get_content_length( const DownloadedCacheEntry entry);
 
 /**
@@ -238,6 +251,24 @@ u64 gf_cache_get_end_range( const DownloadedCacheEntry entry );
 Bool gf_cache_are_headers_processed(const DownloadedCacheEntry entry);
 GF_Err gf_cache_set_headers_processed(const DownloadedCacheEntry entry);
 
+/*
+ * Memory storage functions
+ */
+
+/*!
+ * Gets a reference on the memory of a cache entry stored in memory. The memory stays valid until the reference is released,
+ * even if the cache entry is deleted or downloaded again
+ * \param gmem_url The gmem:// URL of the entry, as returned by the downloader. The URL size must not exceed the size of the memory
+ * \return the memory blob, or NULL if the URL does not point to a cache entry in memory
+ */
+GF_CacheBlob *gf_cache_blob_get(const char *gmem_url);
+
+/*!
+ * Releases a reference on the memory of a cache entry
+ * \param blob The memory blob
+ */
+void gf_cache_blob_release(GF_CacheBlob *blob);
+
 /*! @} */
 
 #ifdef __cplusplus
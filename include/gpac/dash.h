@@ -91,6 +91,15 @@ typedef enum
 typedef struct _gf_dash_io GF_DASHFileIO;
 typedef void *GF_DASHFileIOSession;
 
+/*flags used when creating a file download session*/
+enum
+{
+	/*the connection is kept open to download the next resources*/
+	GF_DASHIO_SESSION_PERSISTENT = 1,
+	/*the session downloads small resources (manifests, init segments) whose requests may be pipelined on a connection in use*/
+	GF_DASHIO_SESSION_ALLOW_PIPELINE = 1<<1,
+};
+
 struct _gf_dash_io
 {
 	/*user private data*/
@@ -106,8 +115,8 @@ struct _gf_dash_io
 	/*called whenever a file has to be deleted*/
 	void (*delete_cache_file)(GF_DASHFileIO *dashio, GF_DASHFileIOSession session, const char *cache_url);
 
-	/*create a file download session for the given resource - group_idx may be -1 if this is a global resource , otherwise it indicates the group/adaptationSet in which the download happens*/
-	GF_DASHFileIOSession (*create)(GF_DASHFileIO *dashio, Bool persistent, const char *url, s32 group_idx);
+	/*create a file download session for the given resource - flags are a combination of GF_DASHIO_SESSION_* flags - group_idx may be -1 if this is a global resource , otherwise it indicates the group/adaptationSet in which the download happens*/
+	GF_DASHFileIOSession (*create)(GF_DASHFileIO *dashio, u32 flags, const char *url, s32 group_idx);
 	/*delete a file download session*/
 	void (*del)(GF_DASHFileIO *dashio, GF_DASHFileIOSession session);
 	/*aborts downloading in the given file session*/
@@ -139,6 +148,9 @@ struct _gf_dash_io
 	u32 (*get_total_size)(GF_DASHFileIO *dashio, GF_DASHFileIOSession session);
 	/*get the total size on bytes for the session*/
 	u32 (*get_bytes_done)(GF_DASHFileIO *dashio, GF_DASHFileIOSession session);
+	/*signals that size bytes were appended by the client to the cache file of the session, the file now holding the resource
+	up to end_range. Function is optional*/
+	GF_Err (*extend_cache_range)(GF_DASHFileIO *dashio, GF_DASHFileIOSession session, u64 end_range, u32 size);
 };
 
 typedef struct __dash_client GF_DashClient;
@@ -189,8 +201,19 @@ const char *gf_dash_get_url(GF_DashClient *dash);
 /*tells whether we are playing some Apple HLS M3U8*/
 Bool gf_dash_is_m3u8(GF_DashClient *dash);
 
-/*get title and source for this MPD*/
-void gf_dash_get_info(GF_DashClient *dash, const char **title, const char **source);
+/*statistics of the manifest refreshes of a live session*/
+typedef struct
+{
+	/*number of refreshes, of refreshes with an unchanged manifest and of refreshes applied without parsing the whole manifest*/
+	u32 nb_refresh, nb_unchanged, nb_incremental;
+	/*number of SegmentTimeline elements modified by the last incremental refresh*/
+	u32 nb_timelines_updated;
+	/*processing time of the last refresh and of all refreshes in microseconds, manifest download excluded*/
+	u64 last_refresh_us, total_refresh_us;
+} GF_DASHRefreshInfo;
+
+/*get title and source for this MPD, and the manifest refresh statistics if refresh_info is not NULL*/
+void gf_dash_get_info(GF_DashClient *dash, const char **title, const char **source, GF_DASHRefreshInfo *refresh_info);
 
 /*switches quality up or down*/
 void gf_dash_switch_quality(GF_DashClient *dash, Bool switch_up, Bool force_immediate_switch);
@@ -396,6 +419,61 @@ void gf_dash_set_switching_probe_count(GF_DashClient *dash, u32 switch_probe_cou
 */
 void gf_dash_set_agressive_adaptation(GF_DashClient *dash, Bool eanble_agressive_switch);
 
+/*rate adaptation algorithms*/
+typedef enum
+{
+	/*GPAC algorithm (default): download rate of the last segment, switching decisions moderated by the buffer level when known*/
+	GF_DASH_ALGO_GPAC_LEGACY = 0,
+	/*throughput-based: lowest of a fast and a slow exponentially weighted moving average of the download rate, minus a 10% safety margin*/
+	GF_DASH_ALGO_THROUGHPUT_EWMA,
+	/*buffer-based BBA-0: the target rate grows linearly with the buffer level between a reservoir and a cushion*/
+	GF_DASH_ALGO_BBA0,
+	/*buffer-based BOLA-BASIC: selects the representation maximizing a log utility of the bitrate weighted by the buffer level*/
+	GF_DASH_ALGO_BOLA,
+	/*user algorithm, see gf_dash_set_custom_algo*/
+	GF_DASH_ALGO_CUSTOM
+} GF_DASHAdaptationAlgorithm;
+
+/*input and state of the rate adaptation of a group, updated after each downloaded segment*/
+typedef struct
+{
+	/*number of representations and their bandwidths in bits per second, in increasing order*/
+	u32 nb_reps;
+	const u32 *bandwidths;
+	/*representations which cannot be selected, may be NULL*/
+	const Bool *disabled;
+	/*representation of the last downloaded segment*/
+	u32 active_rep;
+	/*download rate of the last segment in bits per second, divided by the playback speed*/
+	u32 dl_rate;
+	/*duration of the last segment in milliseconds*/
+	u32 segment_duration;
+	/*buffer level, min level and max level in milliseconds - buffer_max_ms is 0 if the buffer level is unknown*/
+	u32 buffer_ms, buffer_min_ms, buffer_max_ms;
+	/*GPAC algorithm settings, see gf_dash_set_switching_probe_count and gf_dash_set_agressive_adaptation*/
+	u32 probe_count_before_switch;
+	Bool agressive_switching;
+
+	/*algorithm state, set to 0 before the first call and kept between calls*/
+	u32 last_buffer_ms;
+	s32 probe_rep;
+	u32 probe_count;
+	Double ewma_fast, ewma_slow, ewma_weight;
+} GF_DASHRateInfo;
+
+/*runs the given rate adaptation algorithm (GF_DASH_ALGO_CUSTOM excluded) - returns the index of the representation to use for the next segment
+This is used by the client after each segment, and may be used to evaluate the algorithms outside of a DASH session*/
+u32 gf_dash_rate_adaptation(GF_DASHAdaptationAlgorithm algo, GF_DASHRateInfo *info);
+
+/*sets the rate adaptation algorithm. Default is GF_DASH_ALGO_GPAC_LEGACY*/
+void gf_dash_set_algo(GF_DashClient *dash, GF_DASHAdaptationAlgorithm algo);
+
+/*user rate adaptation algorithm for the given group - returns the index of the representation to use for the next segment*/
+typedef u32 (*gf_dash_rate_algo)(void *udta, u32 group_idx, GF_DASHRateInfo *info);
+
+/*sets a user rate adaptation algorithm and selects GF_DASH_ALGO_CUSTOM*/
+void gf_dash_set_custom_algo(GF_DashClient *dash, gf_dash_rate_algo algo, void *udta);
+
 /*returns active period start in ms*/
 u64 gf_dash_get_period_start(GF_DashClient *dash);
 /*returns active period duration in ms*/
@@ -483,6 +561,13 @@ Bool gf_dash_group_get_srd_info(GF_DashClient *dash, u32 idx, u32 *srd_id, u32 *
  @use_threads: if true, threads are used to download files*/
 void gf_dash_set_threaded_download(GF_DashClient *dash, Bool use_threads);
 
+/*Sets the number of segments downloaded at the same time for each group, each download using its own persistent connection.
+Segments are still handed to the client in order.
+ @nb_downloads: max number of concurrent downloads per group. 0 or 1 disables parallel downloads (default)
+ @split_range_size: if not 0, a segment with a byte range of at least twice this size is fetched in several byte range requests
+ of at least this size, using the connections not busy*/
+void gf_dash_set_parallel_downloads(GF_DashClient *dash, u32 nb_downloads, u32 split_range_size);
+
 #endif //GPAC_DISABLE_DASH_CLIENT
 
 /*!	@} */
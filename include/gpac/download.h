@@ -173,6 +173,10 @@ typedef enum
 	/*file is stored in memory, and the cache name is set to gpac://%u@%p, where %d is the size in bytes and %d is the the pointer to the memory.
 	Memory cached files are destroyed upon downloader destruction*/
 	GF_NETIO_SESSION_MEMORY_CACHE = 1<<4,
+	/*indicates that the session only issues small GET requests (manifests, init segments...), always read entirely, which may be pipelined
+	on a connection already in use when HTTP pipelining is enabled. No request is pipelined behind a persistent session, nor behind a
+	request sent by the same thread*/
+	GF_NETIO_SESSION_ALLOW_PIPELINE = 1<<5,
 } GF_NetIOFlags;
 
 
@@ -336,11 +340,22 @@ GF_Err gf_dm_sess_set_range(GF_DownloadSession *sess, u64 start_range, u64 end_r
 /*!
  *\brief get cache file name
  *
- * Gets the cache file name for the session.
+ * Gets the cache file name for the session. For sessions stored in memory, the session keeps a reference on the memory of the returned gmem:// URL until it returns a URL to new memory or is destroyed, so that readers can get their own reference with \ref gf_cache_blob_get.
  *\param sess the download session
  *\return the absolute path of the cache file, or NULL if the session is not cached*/
 const char *gf_dm_sess_get_cache_name(GF_DownloadSession * sess);
 
+/*!
+ *\brief extends cache file range
+ *
+ *Updates the cache entry of a completed session after the user appended data to its cache file, so that the stored content length and range match the file.
+ *\param sess the download session
+ *\param end_range HTTP end range in byte of the data now held in the cache file
+ *\param size number of bytes appended to the cache file
+ *\return error if any
+ */
+GF_Err gf_dm_sess_extend_cache_range(GF_DownloadSession *sess, u64 end_range, u32 size);
+
 /*!
  * \brief Marks the cache file to be deleted once the file is not used anymore by any session
  * \param dm the download manager
@@ -542,6 +557,34 @@ u32 gf_dm_get_data_rate(GF_DownloadManager *dm);
  */
 u32 gf_dm_get_global_rate(GF_DownloadManager *dm);
 
+/*!HTTP connection statistics of a download manager*/
+typedef struct
+{
+	/*!number of connections opened to servers*/
+	u32 nb_connections;
+	/*!number of requests sent on a kept-alive connection taken from the pool*/
+	u32 nb_reused;
+	/*!number of requests pipelined behind pending requests on a connection*/
+	u32 nb_pipelined;
+	/*!number of idle connections closed because of the keep-alive timeout or closed by the server*/
+	u32 nb_expired;
+	/*!number of connections currently idle in the pool*/
+	u32 nb_idle;
+	/*!number of connections currently in use*/
+	u32 nb_active;
+} GF_DMConnectionStats;
+
+/*
+ *\brief gets HTTP connection statistics
+ *
+ *Gets the statistics of the connection pool of the download manager. Connections are kept alive after a download and reused by the
+ *next session to the same server, until the Downloader:KeepAliveTimeout expires.
+ *\param dm the download manager object
+ *\param stats filled with the connection statistics
+ *\return error code if any
+ */
+GF_Err gf_dm_get_connection_stats(GF_DownloadManager *dm, GF_DMConnectionStats *stats);
+
 
 /*
  *\brief fetches remote file in memory
@@ -163,8 +163,18 @@ struct __tag_rtp_channel
 	u32 last_SR_rtp_time;
 	/*payload info*/
 	u32 total_pck, total_bytes;
+
+	/*RTP reception batch: datagrams fetched at once from the socket and handed out one by one*/
+	GF_SockDatagram *rtp_batch;
+	char *rtp_batch_data;
+	u32 rtp_batch_count, rtp_batch_pos;
 };
 
+/*number of datagrams fetched at once from the RTP socket*/
+#define GF_RTP_RECV_BATCH	8
+/*max size of a received RTP datagram (max UDP payload)*/
+#define GF_RTP_RECV_DATAGRAM_SIZE	0x10000
+
 /*gets UTC in the channel RTP timescale*/
 u32 gf_rtp_channel_time(GF_RTPChannel *ch);
 /*gets time in 1/65536 seconds (for reports)*/
@@ -31,6 +31,7 @@ extern "C" {
 #endif
 
 #include <gpac/isomedia.h>
+#include <gpac/cache.h>
 
 #ifndef GPAC_DISABLE_ISOM
 
@@ -99,6 +100,15 @@ GF_Err gf_isom_read_box_list_ex(GF_Box *parent, GF_BitStream *bs, GF_Err (*add_b
 GF_Err gf_isom_box_add_default(GF_Box *a, GF_Box *subbox);
 GF_Err gf_isom_parse_box_ex(GF_Box **outBox, GF_BitStream *bs, u32 parent_type, Bool is_root_box);
 
+/*bitstream cookie flags used when parsing boxes*/
+enum
+{
+	/*large sample tables are not parsed but recorded in their stbl and loaded on first access to the track*/
+	GF_ISOM_BS_COOKIE_LAZY_TABLES = 1,
+};
+/*minimum size of a sample table box for lazy loading*/
+#define GF_ISOM_LAZY_TABLE_MIN_SIZE	65536
+
 #define gf_isom_full_box_init(__pre)
 
 //void gf_isom_full_box_init(GF_Box *ptr);
@@ -553,6 +563,19 @@ typedef struct
 	GF_List *recordList;
 } GF_UserDataBox;
 
+/*track ID lookup table for the trak, traf or trex children of a container. The table is rebuilt from the
+child list on lookup when the list changed since it was built, and shall be reset when the track ID of a
+child box changes or when a child is replaced without changing the list size*/
+typedef struct
+{
+	/*list the table was built from, and its number of items at that time*/
+	GF_List *boxes;
+	u32 nb_boxes;
+	/*open addressing table of (track ID, 1-based index in list) pairs, size is a power of 2*/
+	u32 *entries;
+	u32 size;
+} GF_TrackIDMap;
+
 typedef struct
 {
 	GF_ISOM_BOX
@@ -566,6 +589,8 @@ typedef struct
 	struct __tag_meta_box *meta;
 	/*track boxes*/
 	GF_List *trackList;
+	/*trak lookup by track ID*/
+	GF_TrackIDMap *track_map;
 
 	GF_ISOFile *mov;
 
@@ -626,6 +651,9 @@ typedef struct
 	u32 sample_count_at_seg_start;
 	Bool first_traf_merged;
 	Bool present_in_scalable_segment;
+	/*indexed fragments: total number of samples in the track, and 1-based index of the fragment loaded in the sample tables*/
+	u32 nb_indexed_samples;
+	u32 indexed_fragment;
 #endif
 } GF_TrackBox;
 
@@ -755,6 +783,19 @@ typedef struct
 	u32 sampleDelta;
 } GF_SttsEntry;
 
+/*random access index of a run-length sample table (stts, ctts, stsc), built lazily when enabled through
+gf_isom_enable_sample_index. Tables are assumed append-only in READ mode (fragment merging): only the entries
+added since the last lookup are indexed*/
+typedef struct
+{
+	/*number of indexed entries*/
+	u32 nb_entries, alloc_size;
+	/*first sample number of each entry - the extra slot at nb_entries holds the sample following the table*/
+	u32 *first_sample;
+	/*first DTS of each entry, stts only - the extra slot at nb_entries holds the DTS following the table*/
+	u64 *first_dts;
+} GF_SampleEntryIndex;
+
 typedef struct
 {
 	GF_ISOM_FULL_BOX
@@ -770,6 +811,8 @@ typedef struct
 	u32 r_FirstSampleInEntry;
 	u32 r_currentEntryIndex;
 	u64 r_CurrentDTS;
+	/*random access index for READ, NULL if disabled*/
+	GF_SampleEntryIndex *r_index;
 } GF_TimeToSampleBox;
 
 
@@ -794,6 +837,8 @@ typedef struct
 	/*Cache for read*/
 	u32 r_currentEntryIndex;
 	u32 r_FirstSampleInEntry;
+	/*random access index for READ, NULL if disabled*/
+	GF_SampleEntryIndex *r_index;
 } GF_CompositionOffsetBox;
 
 
@@ -1167,6 +1212,8 @@ typedef struct
 	u32 firstSampleInCurrentChunk;
 	u32 currentChunk;
 	u32 ghostNumber;
+	/*random access index for READ, NULL if disabled*/
+	GF_SampleEntryIndex *r_index;
 } GF_SampleToChunkBox;
 
 typedef struct
@@ -1320,6 +1367,13 @@ typedef struct
 	u32 currentEntryIndex;
 
 	Bool no_sync_found;
+	/*random access index of stts/ctts/stsc enabled (READ mode only)*/
+	Bool use_index;
+
+	/*sample table boxes not parsed yet (lazy loading in READ mode), as types and start offsets in the movie file*/
+	u32 *lazy_types;
+	u64 *lazy_offsets;
+	u32 nb_lazy;
 } GF_SampleTableBox;
 
 typedef struct __tag_media_info_box
@@ -1697,6 +1751,8 @@ typedef struct __tag_mvex_box
 {
 	GF_ISOM_BOX
 	GF_List *TrackExList;
+	/*trex lookup by track ID*/
+	GF_TrackIDMap *trex_map;
 	GF_List *TrackExPropList;
 	GF_MovieExtendsHeaderBox *mehd;
 	GF_ISOFile *mov;
@@ -1734,6 +1790,8 @@ typedef struct
 	GF_ISOM_BOX
 	GF_MovieFragmentHeaderBox *mfhd;
 	GF_List *TrackList;
+	/*traf lookup by track ID*/
+	GF_TrackIDMap *traf_map;
 	GF_ISOFile *mov;
 	/*offset in the file of moof or mdat (whichever comes first) for this fragment*/
 	u64 fragment_offset;
@@ -2542,6 +2600,9 @@ enum
 	GF_ISOM_DATA_MAP_READ_ONLY = 4,
 	/*write-only access at the end of the movie - only used for movie fragments concatenation*/
 	GF_ISOM_DATA_MAP_CAT = 5,
+	/*read-only access to the movie file through a file mapping object whenever supported
+	mode is set to GF_ISOM_DATA_MAP_READ afterwards*/
+	GF_ISOM_DATA_MAP_READ_MMAP = 6,
 };
 
 /*this is the DataHandler structure each data handler has its own bitstream*/
@@ -2566,6 +2627,8 @@ typedef struct
 #ifndef GPAC_DISABLE_ISOM_WRITE
 	char *temp_file;
 #endif
+	/*reference on the downloader memory for gmem:// files, keeps the data valid until the map is closed*/
+	GF_CacheBlob *blob;
 } GF_FileDataMap;
 
 /*file mapping handler. used if supported, only on read mode for complete files  (not in file download)*/
@@ -2583,6 +2646,10 @@ void gf_isom_datamap_del(GF_DataMap *ptr);
 GF_Err gf_isom_datamap_open(GF_MediaBox *minf, u32 dataRefIndex, u8 Edit);
 void gf_isom_datamap_close(GF_MediaInformationBox *minf);
 u32 gf_isom_datamap_get_data(GF_DataMap *map, char *buffer, u32 bufferLength, u64 Offset);
+/*returns a pointer to the data in the file mapping, or NULL if the data map is not mapped or the range is not available*/
+char *gf_isom_datamap_get_mapped_data(GF_DataMap *map, u64 Offset, u32 size);
+/*sets the access pattern hint (GF_ISOM_ACCESS_*) of a file mapping*/
+GF_Err gf_isom_datamap_set_access_hint(GF_DataMap *map, u32 hint);
 
 /*File-based data map*/
 GF_DataMap *gf_isom_fdm_new(const char *sPath, u8 mode);
@@ -2597,6 +2664,7 @@ GF_DataMap *gf_isom_fdm_new_temp(const char *sTempPath);
 GF_DataMap *gf_isom_fmo_new(const char *sPath, u8 mode);
 void gf_isom_fmo_del(GF_FileMappingDataMap *ptr);
 u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, char *buffer, u32 bufferLength, u64 fileOffset);
+GF_Err gf_isom_fmo_set_access_hint(GF_FileMappingDataMap *ptr, u32 hint);
 
 #ifndef GPAC_DISABLE_ISOM_WRITE
 u64 gf_isom_datamap_get_offset(GF_DataMap *map);
@@ -2636,6 +2704,16 @@ enum
 	GF_ISOM_FRAG_READ_DEBUG		=	0x02,
 };
 
+/*movie fragment indexed when reading in GF_ISOM_OPEN_READ_INDEXED mode*/
+typedef struct
+{
+	/*start offset of the moof box in the file*/
+	u64 moof_offset;
+	/*for each track in moov order, number of samples and decode time of the track before this fragment*/
+	u32 *sample_start;
+	u64 *dts_start;
+} GF_FragmentIndexEntry;
+
 /*this is our movie object*/
 struct __tag_isom {
 	/*the last fatal error*/
@@ -2656,6 +2734,14 @@ struct __tag_isom {
 	GF_DataMap *editFileMap;
 	/*the interleaving time for dummy mode (in movie TimeScale)*/
 	u32 interleavingTime;
+	/*block size of the pipelined media data copy for interleaved storage, 0 if disabled*/
+	u32 write_pipe_block_size;
+	/*use kernel range copy in the pipelined media data copy*/
+	Bool write_pipe_range_copy;
+	/*payload offset and size of the first mdat of the file opened for edition, and number of mdat boxes in
+	the file - used to relocate the moov without rewriting the media data*/
+	u64 original_mdat_offset, original_mdat_size;
+	u32 nb_original_mdat;
 #endif
 
 	u8 openMode;
@@ -2695,6 +2781,11 @@ struct __tag_isom {
 	u64 root_sidx_offset;
 	u32 root_sidx_index;
 
+	/*GF_ISOM_OPEN_READ_INDEXED: movie fragments are indexed rather than merged in the sample tables*/
+	Bool index_fragments;
+	GF_FragmentIndexEntry *frag_index;
+	u32 nb_frag_index, frag_index_alloc;
+
 	Bool is_index_segment;
 
 	GF_BitStream *segment_bs;
@@ -2724,6 +2815,13 @@ GF_TrackBox *gf_isom_get_track(GF_MovieBox *moov, u32 trackNumber);
 GF_TrackBox *gf_isom_get_track_from_id(GF_MovieBox *moov, u32 trackID);
 GF_TrackBox *gf_isom_get_track_from_original_id(GF_MovieBox *moov, u32 originalID, u32 originalFile);
 u32 gf_isom_get_tracknum_from_id(GF_MovieBox *moov, u32 trackID);
+/*looks up a trak, traf or trex box in a child list by track ID, using and updating the lookup table of the container.
+When several boxes have the same ID, the first trak or trex and the last traf is returned. If pos is set, it receives
+the 1-based index of the box in the list*/
+GF_Box *gf_isom_trackid_map_find(GF_TrackIDMap **map, GF_List *boxes, u32 trackID, u32 *pos);
+/*forces the lookup table to be rebuilt at the next lookup*/
+void gf_isom_trackid_map_reset(GF_TrackIDMap *map);
+void gf_isom_trackid_map_del(GF_TrackIDMap *map);
 /*open a movie*/
 GF_ISOFile *gf_isom_open_file(const char *fileName, u32 OpenMode, const char *tmp_dir);
 /*close and delete a movie*/
@@ -2744,7 +2842,8 @@ Bool IsMP4Description(u32 entryType);
 GF_Err Track_FindRef(GF_TrackBox *trak, u32 ReferenceType, GF_TrackReferenceTypeBox **dpnd);
 /*Time and sample*/
 GF_Err GetMediaTime(GF_TrackBox *trak, Bool force_non_empty, u64 movieTime, u64 *MediaTime, s64 *SegmentStartTime, s64 *MediaOffset, u8 *useEdit, u64 *next_edit_start_plus_one);
-GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp, u32 *sampleDescriptionIndex, Bool no_data, u64 *out_offset);
+/*if mapped_data is not NULL, the sample data may point to the file mapping rather than being copied, in which case mapped_data is set to GF_TRUE*/
+GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp, u32 *sampleDescriptionIndex, Bool no_data, u64 *out_offset, Bool *mapped_data);
 GF_Err Media_CheckDataEntry(GF_MediaBox *mdia, u32 dataEntryIndex);
 GF_Err Media_FindSyncSample(GF_SampleTableBox *stbl, u32 searchFromTime, u32 *sampleNumber, u8 mode);
 GF_Err Media_RewriteODFrame(GF_MediaBox *mdia, GF_ISOSample *sample);
@@ -2753,6 +2852,16 @@ Bool Media_IsSelfContained(GF_MediaBox *mdia, u32 StreamDescIndex);
 
 
 GF_TrackBox *GetTrackbyID(GF_MovieBox *moov, u32 TrackID);
+/*loads the sample tables of the track left unparsed when opening the file*/
+GF_Err Track_LoadSampleTables(GF_TrackBox *trak);
+/*destroys all sample information in the track sample tables, keeping sample descriptions and boxes present in the moov*/
+void Track_ResetSampleTables(GF_TrackBox *trak);
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+/*for files with indexed fragments, loads the fragment holding the given sample (counting all samples of the track) or decode time
+in the sample tables of the track if not already loaded - no-op for other files*/
+GF_Err Track_LoadFragmentForSample(GF_TrackBox *trak, u32 sampleNumber);
+GF_Err Track_LoadFragmentForTime(GF_TrackBox *trak, u64 DTS);
+#endif
 
 /*check the TimeToSample for the given time and return the Sample number
 if the entry is not found, return the closest sampleNumber in prevSampleNumber and 0 in sampleNumber
@@ -2777,6 +2886,14 @@ u32 stbl_GetSampleFragmentCount(GF_SampleFragmentBox *stsf, u32 sampleNumber);
 u32 stbl_GetSampleFragmentSize(GF_SampleFragmentBox *stsf, u32 sampleNumber, u32 FragmentIndex);
 GF_Err stbl_GetSampleDepType(GF_SampleDependencyTypeBox *stbl, u32 SampleNumber, u32 *isLeading, u32 *dependsOn, u32 *dependedOn, u32 *redundant);
 
+/*creates the random access indexes of the sample tables if enabled and not yet present*/
+void stbl_CheckIndex(GF_SampleTableBox *stbl);
+/*destroys the random access indexes of the sample tables*/
+void stbl_ResetIndex(GF_SampleTableBox *stbl);
+/*gets memory used by the random access indexes of the sample tables*/
+u32 stbl_GetIndexSize(GF_SampleTableBox *stbl);
+void stbl_index_del(GF_SampleEntryIndex *idx);
+
 
 /*unpack sample2chunk and chunk offset so that we have 1 sample per chunk (edition mode only)*/
 GF_Err stbl_UnpackOffsets(GF_SampleTableBox *stbl);
@@ -2883,6 +3000,8 @@ GF_Err udta_AddBox(GF_UserDataBox *ptr, GF_Box *a);
 GF_Err edts_AddBox(GF_Box *s, GF_Box *a);
 GF_Err stdp_Read(GF_Box *s, GF_BitStream *bs);
 GF_Err stbl_AddBox(GF_SampleTableBox *ptr, GF_Box *a);
+/*parses the sample tables left unparsed by lazy loading from the given bitstream*/
+GF_Err stbl_LoadLazyTables(GF_SampleTableBox *ptr, GF_BitStream *bs);
 GF_Err sdtp_Read(GF_Box *s, GF_BitStream *bs);
 GF_Err dinf_AddBox(GF_Box *s, GF_Box *a);
 GF_Err minf_AddBox(GF_Box *s, GF_Box *a);
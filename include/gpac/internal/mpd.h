@@ -231,7 +231,6 @@ typedef struct
 	char *cached_init_segment_url;
 	Bool owned_gmem;
 	u64 init_start_range, init_end_range;
-	u32 probe_switch_count;
 	char *init_segment_data;
 	u32 init_segment_size;
 	char *key_url;
@@ -379,6 +378,19 @@ typedef struct {
 GF_Err gf_mpd_init_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *base_url);
 GF_Err gf_mpd_complete_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *base_url);
 
+/*text of the MPD document last parsed, used to apply the next versions of the document without parsing them again*/
+typedef struct __gf_mpd_text_state GF_MPDTextState;
+/*creates the text state of an MPD just parsed from the given text, before any modification of the MPD. Returns NULL if the MPD
+cannot be updated incrementally (remote elements, unexpected document structure)*/
+GF_MPDTextState *gf_mpd_text_state_new(GF_MPD *mpd, const char *text, u32 size);
+void gf_mpd_text_state_del(GF_MPDTextState *state);
+/*applies a new version of the NULL-terminated MPD text to the MPD the state was created for. Only the SegmentTimeline elements and
+the MPD attributes other than type, id, profiles, availabilityStartTime and timeShiftBufferDepth may differ from the previous
+version, otherwise GF_NOT_SUPPORTED is returned and the MPD is not modified. The S elements of a changed timeline are parsed from
+the first modified one, the previous ones being kept. Timeline entries removed from the start of a timeline are kept in memory.
+@nb_updated_timelines: set to the number of SegmentTimeline elements modified*/
+GF_Err gf_mpd_text_state_update(GF_MPDTextState *state, GF_MPD *mpd, const char *text, u32 size, u32 *nb_updated_timelines);
+
 GF_MPD *gf_mpd_new();
 void gf_mpd_del(GF_MPD *mpd);
 /*frees a GF_MPD_SegmentURL structure (type-casted to void *)*/
@@ -81,6 +81,27 @@ enum
 	GF_ISOM_WRITE_EDIT,
 	/*Opens an existing file for fragment concatenation*/
 	GF_ISOM_OPEN_CAT_FRAGMENTS,
+	/*Opens a file in READ ONLY mode, accessing the file through a memory mapping when supported by the platform.
+	The file must be complete (no progressive download). Behaves as GF_ISOM_OPEN_READ afterwards*/
+	GF_ISOM_OPEN_READ_MMAP,
+	/*Opens a file in READ ONLY mode without merging all movie fragments in the sample tables: fragments are only indexed
+	(position, sample count and decode time per track) when parsing, and the fragment holding a requested sample or time
+	is loaded in the sample tables of the track in place of the previous one. Memory usage no longer depends on the number
+	of fragments, which suits long recordings stored as a single fragmented file.
+	Sample numbers, decode times and durations are the same as in GF_ISOM_OPEN_READ mode, but functions working on
+	the whole sample tables (sync sample search, sample groups...) only see the loaded fragment.
+	If the moov holds samples, fragments are merged as in GF_ISOM_OPEN_READ mode. Behaves as GF_ISOM_OPEN_READ afterwards*/
+	GF_ISOM_OPEN_READ_INDEXED,
+};
+
+/*access pattern hints for memory mapped files*/
+enum
+{
+	GF_ISOM_ACCESS_NORMAL = 0,
+	/*samples are read in file order, the system may read ahead aggressively*/
+	GF_ISOM_ACCESS_SEQUENTIAL,
+	/*samples are read in random order, the system should not read ahead*/
+	GF_ISOM_ACCESS_RANDOM,
 };
 
 /*Movie Options for file writing*/
@@ -97,7 +118,12 @@ enum
 	GF_ISOM_STORE_DRIFT_INTERLEAVED,
 	/*tightly interleaves samples based on their DTS, therefore allowing better placement of samples in the file.
 	This is used for both http interleaving and Hinting optimizations*/
-	GF_ISOM_STORE_TIGHT
+	GF_ISOM_STORE_TIGHT,
+	/*FASTSTART: Same as STREAMABLE, but the media data is not rewritten sample by sample. If the media data has not
+	been modified, the moov is placed before it and the media data is moved in place (capture mode) or copied as a
+	single block (edit mode), with chunk offsets shifted accordingly. Otherwise, behaves as FLAT in capture mode and
+	STREAMABLE in edit mode*/
+	GF_ISOM_STORE_FASTSTART
 
 };
 
@@ -345,6 +371,8 @@ typedef struct
 	/*relative offset for composition if needed*/
 	s32 CTS_Offset;
 	SAPType IsRAP;
+	/*allocated size of data for samples reused across gf_isom_get_sample_static calls, 0 otherwise*/
+	u32 alloc_size;
 } GF_ISOSample;
 
 
@@ -352,7 +380,7 @@ typedef struct
 GF_ISOSample *gf_isom_sample_new();
 
 /*delete a sample. NOTE:the buffer content will be destroyed by default.
-if you wish to keep the buffer, set dataLength to 0 in the sample
+if you wish to keep the buffer, set dataLength (and alloc_size for static samples) to 0 in the sample
 before deleting it
 the pointer is set to NULL after deletion*/
 void gf_isom_sample_del(GF_ISOSample **samp);
@@ -562,6 +590,22 @@ this index allows to retrieve the stream description if needed (2 media in 1 tra
 return NULL if error*/
 GF_ISOSample *gf_isom_get_sample(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *StreamDescriptionIndex);
 
+/*same as gf_isom_get_sample but avoids copying the media data when possible: if the file was opened in GF_ISOM_OPEN_READ_MMAP
+mode and the sample data is not rewritten by the library (no padding, no NALU/OD/text rewriting), sample->data points
+to the file mapping and is valid until the file is closed. In this case @is_mapped is set to GF_TRUE and the caller
+MUST set sample->data to NULL before calling gf_isom_sample_del. Otherwise the sample data is allocated as usual*/
+GF_ISOSample *gf_isom_get_sample_ex(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *StreamDescriptionIndex, Bool *is_mapped);
+
+/*same as gf_isom_get_sample but fetches the sample in @static_sample, created with gf_isom_sample_new and kept by the caller
+across calls. The sample buffer is reused and only reallocated when a larger sample is fetched, avoiding memory allocation
+for each sample when reading a track sequentially. The buffer is destroyed by gf_isom_sample_del.
+@static_sample data must either be NULL or be the buffer of a previous call on this sample*/
+GF_Err gf_isom_get_sample_static(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *StreamDescriptionIndex, GF_ISOSample *static_sample);
+
+/*sets the access pattern hint (GF_ISOM_ACCESS_*) of a file opened in GF_ISOM_OPEN_READ_MMAP mode.
+Returns GF_NOT_SUPPORTED if the file is not memory mapped*/
+GF_Err gf_isom_set_access_hint(GF_ISOFile *the_file, u32 hint);
+
 /*same as gf_isom_get_sample but doesn't fetch media data
 @StreamDescriptionIndex (optional): set to stream description index
 @data_offset (optional): set to sample start offset in file.
@@ -596,6 +640,15 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 /*retrieves given sample DTS*/
 u32 gf_isom_get_sample_from_dts(GF_ISOFile *the_file, u32 trackNumber, u64 dts);
 
+/*enables or disables the random access index of the sample tables of the track (READ mode only). When enabled,
+sample lookups by time (gf_isom_get_sample_for_media_time) or by number (gf_isom_get_sample, gf_isom_get_sample_info)
+are logarithmic in the number of table entries whatever the access direction, instead of relying on a forward-only
+cache. The index is built on first access and updated as fragments are merged*/
+GF_Err gf_isom_enable_sample_index(GF_ISOFile *the_file, u32 trackNumber, Bool enable);
+
+/*returns the memory in bytes currently used by the random access index of the sample tables of the track*/
+u32 gf_isom_get_sample_index_size(GF_ISOFile *the_file, u32 trackNumber);
+
 /*get the current tfdt of the track - this can be used to adjust sample time queries when edit list are used*/
 u64 gf_isom_get_current_tfdt(GF_ISOFile *the_file, u32 trackNumber);
 
@@ -988,6 +1041,14 @@ u32 gf_isom_get_interleave_time(GF_ISOFile *the_file);
 /*forces usage of 64 bit chunk offsets*/
 void gf_isom_force_64bit_chunk_offset(GF_ISOFile *the_file, Bool set_on);
 
+/*enables pipelined copy of the media data when storing the file in interleaved mode (GF_ISOM_STORE_INTERLEAVED,
+GF_ISOM_STORE_DRIFT_INTERLEAVED or GF_ISOM_STORE_TIGHT). Sample payloads are fetched by a reader thread in large
+contiguous reads and written by a writer thread in blocks of about block_size bytes. A block_size of 0 disables
+the pipeline (default).
+If use_range_copy is set, media data is copied by the system without going through user memory when both the
+source and the destination are regular files (Linux only, ignored otherwise)*/
+GF_Err gf_isom_set_write_pipeline(GF_ISOFile *the_file, u32 block_size, Bool use_range_copy);
+
 /*set the copyright in one language.*/
 GF_Err gf_isom_set_copyright(GF_ISOFile *the_file, const char *threeCharCode, char *notice);
 
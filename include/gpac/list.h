@@ -187,6 +187,28 @@ void *gf_list_enum(GF_List *ptr, u32 *pos);
  */
 void *gf_list_rev_enum(GF_List *ptr, u32 *pos);
 
+/*!
+ *	\brief list iterator
+ *
+ *	Iterates over the list items in order until a NULL item is found, as a gf_list_enum loop would do, without
+ *	passing the position by address.
+ *	\param ptr target list object
+ *	\param i u32 variable receiving the current item position
+ *	\param item variable receiving the current item
+ *	\note The list shall not be modified during the iteration, except for removing the current item and decrementing i.
+ */
+#define gf_list_for_each(ptr, i, item)	for ((i) = 0; ((item) = gf_list_get((ptr), (i))) != NULL; (i)++)
+
+/*!
+ *	\brief list pre-allocation
+ *
+ *	Makes sure the list can hold at least the given number of items without further allocation
+ *	\param ptr target list object
+ *	\param nb_items number of items to allocate
+ *	\note This has no effect for linked lists
+ */
+GF_Err gf_list_reserve(GF_List *ptr, u32 nb_items);
+
 /*!
  *	\brief list swap
  *
@@ -205,6 +227,15 @@ GF_Err gf_list_swap(GF_List *l1, GF_List *l2);
  */
 GF_Err gf_list_transfer(GF_List *l1, GF_List *l2);
 
+/*!
+ *	\brief list append
+ *
+ *	Appends all items of a list at the end of another one. The source list is not modified.
+ *	\param dst destination list object
+ *	\param src source list object
+ */
+GF_Err gf_list_append(GF_List *dst, GF_List *src);
+
 /*!
  *	\brief clone list
  *
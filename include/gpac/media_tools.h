@@ -280,6 +280,9 @@ typedef struct __track_import
 			0: first video and first audio
 			1->N: video track
 			N+1->any: audio track
+		MPEG-2 TS files:
+			0: all PIDs imported in a single pass, one track per PID
+			1->any: PID to import
 	TrackNums can be obtain with probing
 	*/
 	u32 trackID;
@@ -805,6 +808,14 @@ GF_Err gf_dasher_enable_utc_ref(GF_DASHSegmenter *dasher, Bool insert_utc);
 */
 GF_Err gf_dasher_enable_real_time(GF_DASHSegmenter *dasher, Bool real_time);
 
+/*!
+ Enables writing of the index of MPEG-2 TS inputs.
+ *	\param dasher the DASH segmenter object
+ *	\param write_index if set, TS inputs without index are scanned once and their index is written next to them (file.ts.tsidx). Otherwise existing indexes are only read. Default is disabled.
+ *	\return error code if any
+*/
+GF_Err gf_dasher_enable_ts_index_write(GF_DASHSegmenter *dasher, Bool write_index);
+
 /*!
  Sets where the  ContentProtection element is inserted in an adaptation set.
 *	\param dasher the DASH segmenter object
@@ -844,6 +855,54 @@ GF_Err gf_dasher_process(GF_DASHSegmenter *dasher, Double sub_duration);
 */
 u32 gf_dasher_next_update_time(GF_DASHSegmenter *dasher);
 
+#ifndef GPAC_DISABLE_MPEG2TS
+/*! live MPEG-2 TS segmenter object*/
+typedef struct __gf_dash_ts_live GF_DASHTSLive;
+
+/*!
+ Creates a live MPEG-2 TS segmenter. The TS is segmented as it is received: the packets are kept in memory until a segment boundary is found, the segment is then written at once and the dynamic MPD is rewritten. The source is never read twice, so that a segment is available about one segment duration after its first packet was received.
+ *	\param mpd_name name of the MPD to generate
+ *	\param seg_rad_name segment name template, using $Number$ (eg "live_$Number$"). If NULL, segments are named after the MPD
+ *	\param segment_duration target segment duration in seconds
+ *	\param segments_start_with_rap if set, segments are cut at the PAT preceding a RAP of the PCR PID
+ *	\param time_shift_depth time shift buffer depth in seconds. Older segments are removed from the MPD and deleted. If 0, all segments are kept
+ *	\return the live segmenter, or NULL if error
+*/
+GF_DASHTSLive *gf_dasher_ts_live_new(const char *mpd_name, const char *seg_rad_name, Double segment_duration, Bool segments_start_with_rap, u32 time_shift_depth);
+
+/*!
+ Destroys a live MPEG-2 TS segmenter. Reception is stopped, the pending packets are written as the last segment and the MPD is closed.
+ *	\param live the live segmenter
+*/
+void gf_dasher_ts_live_del(GF_DASHTSLive *live);
+
+/*!
+ Starts receiving the TS in a dedicated thread.
+ *	\param live the live segmenter
+ *	\param url TS source, any live URL accepted by the TS demuxer (udp://, mpegts-udp://, mpegts-tcp://)
+ *	\return error code if any
+*/
+GF_Err gf_dasher_ts_live_start(GF_DASHTSLive *live, const char *url);
+
+/*!
+ Pushes TS data to the segmenter, when the TS is not received through \ref gf_dasher_ts_live_start.
+ *	\param live the live segmenter
+ *	\param data TS data, does not need to be aligned on packet boundaries
+ *	\param size size of the data
+ *	\return error code if any
+*/
+GF_Err gf_dasher_ts_live_process(GF_DASHTSLive *live, char *data, u32 size);
+
+/*!
+ Gets the live segmenter status.
+ *	\param live the live segmenter
+ *	\param nb_segments set to the number of segments written so far - optional
+ *	\param is_over set to GF_TRUE if reception has stopped - optional
+ *	\return the last error encountered while writing segments or MPD
+*/
+GF_Err gf_dasher_ts_live_get_status(GF_DASHTSLive *live, u32 *nb_segments, Bool *is_over);
+#endif
+
 
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
 /*!
@@ -279,6 +279,9 @@ typedef struct __gf_dvb_tuner GF_Tuner;
 /*Maximum number of streams in a TS*/
 #define GF_M2TS_MAX_STREAMS	8192
 
+/*Size of the demuxer resync buffer: two packets with 4-byte prefix*/
+#define GF_M2TS_RESYNC_BUFFER_SIZE	384
+
 /*Maximum number of service in a TS*/
 #define GF_M2TS_MAX_SERVICES	65535
 
@@ -291,6 +294,9 @@ typedef struct __gf_dvb_tuner GF_Tuner;
 #define GF_M2TS_UDP_BUFFER_SIZE	0x40000
 #endif
 
+/*Maximum size of a UDP datagram in the demuxer reception batch - the UDP buffer holds GF_M2TS_UDP_BUFFER_SIZE/GF_M2TS_UDP_DATAGRAM_SIZE datagrams*/
+#define GF_M2TS_UDP_DATAGRAM_SIZE	0x4000
+
 #define GF_M2TS_MAX_PCR	2576980377811ULL
 
 /*returns readable name for given stream type*/
@@ -880,6 +886,113 @@ typedef struct
 	GF_M2TS_ES *stream;
 } GF_M2TS_SL_PCK;
 
+/*flags of TS index entries*/
+enum
+{
+	/*PES packet starts with a random access point*/
+	GF_M2TS_INDEX_RAP = 1,
+	/*PES packet belongs to the PCR PID of its program*/
+	GF_M2TS_INDEX_PCR_PID = 1<<1,
+	/*interpolated PCR of the PES packet is valid*/
+	GF_M2TS_INDEX_PCR_INTERPOLATED = 1<<2,
+	/*PES packet belongs to a video stream*/
+	GF_M2TS_INDEX_VIDEO = 1<<3,
+};
+
+/*demuxer event recorded in a TS index*/
+typedef struct
+{
+	/*byte offset of the TS packet which triggered the event*/
+	u64 offset;
+	/*byte offset of the TS packet starting the PES, for PES events*/
+	u64 pes_offset;
+	/*PES PTS and DTS in 90 kHz for PES events, PCR value in 27 MHz for PCR events*/
+	u64 PTS, DTS;
+	/*interpolated PCR of the TS packet starting the PES and last PCR before it, in 27 MHz, for PES events*/
+	u64 interpolated_pcr, last_pcr;
+	/*one of GF_M2TS_EVT_PAT_*, GF_M2TS_EVT_CAT_*, GF_M2TS_EVT_PMT_*, GF_M2TS_EVT_PES_PCK or GF_M2TS_EVT_PES_PCR*/
+	u8 evt_type;
+	/*GF_M2TS_INDEX_* flags*/
+	u8 flags;
+	/*PID of the stream for PES and PCR events, PCR PID of the program for PMT events*/
+	u16 pid;
+} GF_M2TS_IndexEntry;
+
+/*index of a TS file, listing the signaling, PCR and PES events of the file in file order.
+The index is persisted next to the file and used to seek without rescanning the file*/
+typedef struct
+{
+	/*size and modification time of the indexed file*/
+	u64 file_size, file_mtime;
+	/*PCR PID of the first program found*/
+	u16 pcr_pid;
+	GF_M2TS_IndexEntry *entries;
+	u32 nb_entries, nb_alloc;
+
+	/*seek state, not persisted: default seek PID, and RAP entries of rap_pid sorted by PTS*/
+	u16 seek_pid, rap_pid;
+	GF_M2TS_IndexEntry **raps;
+	u32 nb_raps;
+	u64 rap_first_PTS;
+} GF_M2TS_Index;
+
+/*kind of data found on a PID by the TS analyzer*/
+enum
+{
+	/*PID carries PES packets*/
+	GF_M2TS_STATS_PES = 1,
+	/*PID carries sections other than PAT and PMT*/
+	GF_M2TS_STATS_SECTION = 1<<1,
+	/*PID is the PAT PID*/
+	GF_M2TS_STATS_PAT = 1<<2,
+	/*PID carries a PMT*/
+	GF_M2TS_STATS_PMT = 1<<3,
+	/*PID carries PCRs*/
+	GF_M2TS_STATS_PCR = 1<<4,
+};
+
+/*TS analyzer statistics of a PID. Times are measured on the stream clock, i.e. the PCRs of the first PCR PID found
+interpolated at the multiplex rate, so that files are analyzed as if they were received in real time. Error counts follow
+the TR 101 290 priority 1 and 2 indicators*/
+typedef struct
+{
+	u16 pid;
+	/*GF_M2TS_STATS_* flags*/
+	u32 flags;
+	/*number of packets received on the PID*/
+	u64 nb_packets;
+	/*bitrate in bits per second over the sliding window, since the stream clock started, and maximum of the window bitrate*/
+	u32 bitrate, avg_bitrate, max_bitrate;
+	/*continuity count errors (1.4), packets with the transport error indicator set (2.1) and scrambled packets*/
+	u32 cc_errors, transport_errors, nb_scrambled;
+	/*number of PCRs, PCR repetition errors (interval above 40 ms, 2.3a) and PCR discontinuity errors (interval above 100 ms
+	or backwards without discontinuity indicator, 2.3b)*/
+	u32 nb_pcr, pcr_repetition_errors, pcr_discontinuity_errors;
+	/*PCR accuracy errors (above 500 ns, 2.4), maximum PCR inaccuracy, and peak-to-peak PCR inaccuracy over the sliding window,
+	in ns. The inaccuracy is measured against the average multiplex rate, as in TR 101 290 for constant rate multiplexes*/
+	u32 pcr_accuracy_errors, pcr_accuracy_max, pcr_jitter;
+	/*number of PES packets or sections started on the PID, average and maximum interval between two starts in ms*/
+	u32 nb_units, unit_interval_avg, unit_interval_max;
+	/*repetition errors: PAT or PMT interval above 500 ms (1.3a, 1.5a) for PAT and PMT PIDs, PTS interval above 700 ms (2.5) for PES PIDs*/
+	u32 repetition_errors;
+} GF_M2TS_PIDStats;
+
+/*TS analyzer global statistics*/
+typedef struct
+{
+	/*stream clock in ms, 0 until two PCRs of the reference PCR PID are received*/
+	u32 time;
+	/*reference PCR PID of the stream clock, 0 if none found yet*/
+	u16 pcr_pid;
+	/*number of packets received and of packets without sync byte (1.2)*/
+	u64 nb_packets;
+	u32 sync_errors;
+	/*multiplex bitrate in bits per second over the sliding window and since the stream clock started*/
+	u32 bitrate, avg_bitrate;
+	/*number of PIDs found*/
+	u32 nb_pids;
+} GF_M2TS_Stats;
+
 /*MPEG-2 TS demuxer*/
 struct tag_m2ts_demux
 {
@@ -935,10 +1048,13 @@ struct tag_m2ts_demux
 	void (*on_event)(struct tag_m2ts_demux *ts, u32 evt_type, void *par);
 	/*private user data*/
 	void *user;
+	/*user callback, may be NULL: called with each run of synchronized TS packets before they are demultiplexed*/
+	void (*on_packets)(struct tag_m2ts_demux *ts, const char *data, u32 nb_pck, u32 pck_size);
 
-	/*private resync buffer*/
-	char *buffer;
-	u32 buffer_size, alloc_size;
+	/*private resync buffer, holding the bytes of an incomplete packet (or not yet synchronized bytes) between two calls to gf_m2ts_process_data*/
+	char buffer[GF_M2TS_RESYNC_BUFFER_SIZE];
+	u32 buffer_size;
+	Bool buffer_synced;
 	/*default transport PID filters*/
 	GF_M2TS_SectionFilter *pat, *cat, *nit, *sdt, *eit, *tdt_tot;
 
@@ -983,6 +1099,12 @@ struct tag_m2ts_demux
 	u64 nb_pck_at_pcr;
 
 	Bool paused;
+
+	/*index of the local file if any, used for seeking and duration - destroyed with the demuxer*/
+	GF_M2TS_Index *index;
+
+	/*TS analyzer statistics, NULL when disabled*/
+	struct __gf_m2ts_stats *stats;
 };
 
 GF_M2TS_Demuxer *gf_m2ts_demux_new();
@@ -1060,6 +1182,35 @@ void gf_m2ts_print_info(GF_M2TS_Demuxer *ts);
 */
 GF_Err gf_m2ts_demux_file(GF_M2TS_Demuxer *ts, const char *fileName, u64 start_byterange, u64 end_byterange, u32 refresh_type, Bool signal_end_of_stream);
 
+/*scans the TS file and builds its index - PES are demuxed with the default framing*/
+GF_M2TS_Index *gf_m2ts_index_build(const char *fileName);
+/*loads the index of the TS file from its sidecar file (fileName.tsidx) - returns NULL if absent or if the TS file was modified since*/
+GF_M2TS_Index *gf_m2ts_index_load(const char *fileName);
+/*writes the index of the TS file to its sidecar file*/
+GF_Err gf_m2ts_index_save(GF_M2TS_Index *index, const char *fileName);
+/*loads the index of the TS file; if none and build is set, builds the index and saves it*/
+GF_M2TS_Index *gf_m2ts_index_open(const char *fileName, Bool build);
+void gf_m2ts_index_del(GF_M2TS_Index *index);
+/*fills the index entry for the given demuxer event - returns GF_FALSE if the event is not indexed.
+For PES events, this computes the interpolated PCR of the PES start and updates the PCR state of the PES accordingly*/
+Bool gf_m2ts_index_get_event_entry(GF_M2TS_Demuxer *ts, u32 evt_type, void *par, GF_M2TS_IndexEntry *entry);
+/*gets the duration in seconds of the PCR PIDs of the indexed file*/
+Double gf_m2ts_index_get_duration(GF_M2TS_Index *index);
+/*gets the byte offset and PTS of the last RAP PES of the given PID starting at or before the given time in ms, counted from the first PTS of the PID.
+If pid is 0, the first video PID with RAP PES is used, or the PCR PID, or the first PID with RAP PES.
+Returns GF_FALSE if no RAP is found*/
+Bool gf_m2ts_index_find_rap(GF_M2TS_Index *index, u16 pid, u32 time_ms, u64 *offset, u64 *PTS);
+
+/*enables or disables the TS analyzer statistics, using a sliding window of window_ms milliseconds (1000 ms if 0) for
+bitrate and jitter measurements. Enabling resets the statistics. All packets are analyzed, including the ones of PIDs not
+demultiplexed; when disabled, the analyzer costs a pointer check per packet*/
+GF_Err gf_m2ts_demux_enable_stats(GF_M2TS_Demuxer *ts, Bool enable, u32 window_ms);
+/*gets the global statistics - may be called from another thread than the demuxer one, in which case the values are
+approximate. Returns GF_BAD_PARAM if statistics are not enabled*/
+GF_Err gf_m2ts_demux_get_stats(GF_M2TS_Demuxer *ts, GF_M2TS_Stats *stats);
+/*gets the statistics of the idx-th PID found, in order of appearance, with idx less than the number of PIDs*/
+GF_Err gf_m2ts_demux_get_pid_stats(GF_M2TS_Demuxer *ts, u32 idx, GF_M2TS_PIDStats *stats);
+
 #endif /*GPAC_DISABLE_MPEG2TS*/
 
 
@@ -1181,6 +1332,14 @@ typedef struct __m2ts_mux_stream {
 	/*packet reassembler (PES packets are most of the time full frames)*/
 	GF_M2TS_Packet *pck_reassembler;
 	GF_Mutex *mx;
+	/*number of packets pushed in the fifo since the stream creation*/
+	u32 nb_pck_dispatched;
+	/*number of packets removed from the fifo since the stream creation*/
+	u32 nb_pck_consumed;
+	/*number of input flushes requested by the muxer, only used with program input threads - protected by the program input mutex*/
+	u32 nb_pck_requested;
+	/*set by the program input thread when the last input flush did not produce any packet - protected by the program input mutex*/
+	Bool input_stalled;
 	/*avg bitrate compute*/
 	u64 last_br_time;
 	u32 bytes_since_last_time, pes_since_last_time;
@@ -1240,6 +1399,18 @@ struct __m2ts_mux_program {
 	Bool mpeg4_signaling_for_scene_only;
 
 	char *name, *provider;
+
+	/*input thread fetching AUs of all streams in the program, only used if enabled on the muxer*/
+	GF_Thread *input_th;
+	/*signaled by the muxer when the input thread should refill the stream fifos*/
+	GF_Semaphore *input_sema;
+	/*signaled by the input thread after a refill pass or when exiting if the muxer waits for data*/
+	GF_Semaphore *input_done_sema;
+	Bool input_wait;
+	/*protects the input thread state and the requested/stalled state of the program streams*/
+	GF_Mutex *input_mx;
+	/*0: stopped, 1: running, 2: done*/
+	u32 input_th_state;
 };
 
 enum
@@ -1316,6 +1487,9 @@ struct __m2ts_mux {
 	Bool flush_pes_at_rap;
 	/*cf enum above*/
 	u32 force_pat_pmt_state;
+
+	/*fetch input data of each program in a dedicated thread*/
+	Bool program_threads;
 };
 
 
@@ -1344,12 +1518,19 @@ void gf_m2ts_mux_update_config(GF_M2TS_Mux *mux, Bool reset_time);
 GF_M2TS_Mux_Program *gf_m2ts_mux_program_find(GF_M2TS_Mux *muxer, u32 program_number);
 
 const char *gf_m2ts_mux_process(GF_M2TS_Mux *muxer, u32 *status, u32 *usec_till_next);
+/*produces up to nb_packets TS packets in the packets buffer (nb_packets*188 bytes), stopping when no packet can be produced.
+Returns the number of packets written, less than nb_packets if the muxer has no more packets ready. status and usec_till_next are the ones of the last packet, as in gf_m2ts_mux_process*/
+u32 gf_m2ts_mux_process_packets(GF_M2TS_Mux *muxer, char *packets, u32 nb_packets, u32 *status, u32 *usec_till_next);
 u32 gf_m2ts_get_sys_clock(GF_M2TS_Mux *muxer);
 u32 gf_m2ts_get_ts_clock(GF_M2TS_Mux *muxer);
 
 GF_Err gf_m2ts_mux_use_single_au_pes_mode(GF_M2TS_Mux *muxer, GF_M2TS_PackMode au_pes_mode);
 GF_Err gf_m2ts_mux_set_initial_pcr(GF_M2TS_Mux *muxer, u64 init_pcr_value);
 GF_Err gf_m2ts_mux_enable_pcr_only_packets(GF_M2TS_Mux *muxer, Bool enable_forced_pcr);
+/*fetches the input data of each program in a dedicated thread, the calling thread only performs scheduling and packetization.
+Only applies to inputs in push mode (no GF_ESI_AU_PULL_CAP), for which GF_ESI_INPUT_DATA_FLUSH is then called from the program thread.
+Threads are started at the first call to gf_m2ts_mux_process, programs and streams shall not be added afterwards*/
+GF_Err gf_m2ts_mux_enable_program_threads(GF_M2TS_Mux *muxer, Bool enable);
 
 /*user inteface functions*/
 GF_Err gf_m2ts_program_stream_update_ts_scale(GF_ESInterface *_self, u32 time_scale);
@@ -425,6 +425,67 @@ GF_Err gf_sk_send_wait(GF_Socket *sock, const char *buffer, u32 length, u32 dela
  */
 GF_Err gf_sk_receive_wait(GF_Socket *sock, char *buffer, u32 length, u32 start_from, u32 *read, u32 delay_sec);
 
+/*!
+ *\brief datagram descriptor
+ *
+ *Describes one datagram for batched socket I/O.
+ */
+typedef struct
+{
+	/*! datagram buffer*/
+	char *data;
+	/*! size of the datagram to send, or allocated size of the buffer for reception*/
+	u32 size;
+	/*! number of bytes received in the buffer (reception only)*/
+	u32 read;
+	/*! for reception, kernel reception time of the datagram if enabled, 0 otherwise. For sending, time at which the datagram shall leave the host if paced sending is enabled, 0 for immediate sending. Both are expressed in microseconds in the \ref gf_sys_clock_high_res timebase*/
+	u64 timestamp;
+} GF_SockDatagram;
+
+/*!
+ *\brief batched datagram reception
+ *
+ *Fetches all datagrams pending on a UDP socket, up to the number of descriptors given, in a single system call when the platform supports it (recvmmsg). The function waits for data the same way \ref gf_sk_receive does.
+ *\param sock the socket object
+ *\param datagrams the datagram descriptors. For each descriptor, the data and size fields must be set by the caller; the read and timestamp fields are filled by the call
+ *\param nb_datagrams the number of datagram descriptors
+ *\param nb_read set to the number of datagrams received
+ *\return error if any, GF_IP_NETWORK_EMPTY if no datagram is available
+ */
+GF_Err gf_sk_receive_batch(GF_Socket *sock, GF_SockDatagram *datagrams, u32 nb_datagrams, u32 *nb_read);
+
+/*!
+ *\brief batched datagram sending
+ *
+ *Sends a set of datagrams on a UDP socket in a single system call when the platform supports it (sendmmsg).
+ *\param sock the socket object
+ *\param datagrams the datagram descriptors. For each descriptor, the data and size fields must be set by the caller, as well as the timestamp field when paced sending is used
+ *\param nb_datagrams the number of datagram descriptors
+ *\param nb_sent set to the number of datagrams sent. If an error is returned, the remaining datagrams have not been sent
+ *\return error if any
+ */
+GF_Err gf_sk_send_batch(GF_Socket *sock, GF_SockDatagram *datagrams, u32 nb_datagrams, u32 *nb_sent);
+
+/*!
+ *\brief reception timestamps
+ *
+ *Enables kernel timestamping of incoming datagrams, reported in the timestamp field of \ref gf_sk_receive_batch descriptors.
+ *\param sock the socket object
+ *\param enable enables or disables timestamping
+ *\return error if any, GF_NOT_SUPPORTED if the platform does not support reception timestamps
+ */
+GF_Err gf_sk_set_rx_timestamps(GF_Socket *sock, Bool enable);
+
+/*!
+ *\brief paced sending
+ *
+ *Enables time-based sending (SO_TXTIME): datagrams sent through \ref gf_sk_send_batch with a non-zero timestamp are held by the kernel until that time. Actual pacing depends on the queuing discipline of the outgoing interface (etf or fq); other disciplines send the datagrams immediately.
+ *\param sock the socket object
+ *\param enable enables or disables paced sending
+ *\return error if any, GF_NOT_SUPPORTED if the platform does not support paced sending
+ */
+GF_Err gf_sk_set_paced_send(GF_Socket *sock, Bool enable);
+
 /*!
  *\brief gets socket handle
  *
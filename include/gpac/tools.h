@@ -758,6 +758,15 @@ u64 gf_sys_clock_high_res();
  */
 void gf_sleep(u32 ms);
 
+/*!
+ *	\brief Sleeps thread/process until a given time
+ *
+ *	Locks calling thread/process execution until the high precision system clock reaches the given value. The thread sleeps for most of the interval and busy-waits for the last microseconds, so that the wake-up time does not depend on the scheduler latency.
+ *	\param clock_us High precision system clock value to wait for, as returned by \ref gf_sys_clock_high_res.
+ *	\param spin_us Amount of time in microseconds to busy-wait before the target clock value. 0 only sleeps.
+ */
+void gf_sleep_until_high_res(u64 clock_us, u32 spin_us);
+
 #ifdef WIN32
 /*!
  *	\brief WINCE time constant
@@ -98,6 +98,8 @@ typedef struct
 	Bool wait_for_segment_switch;
 	/*current sample*/
 	GF_ISOSample *sample;
+	/*sample reused when reading the track sequentially, avoiding one allocation per sample*/
+	GF_ISOSample *static_sample;
 	GF_SLHeader current_slh;
 	GF_Err last_state;
 
@@ -46,6 +46,7 @@ static void isor_delete_channel(ISOMReader *reader, ISOMChannel *ch)
 	while ((ch2 = (ISOMChannel *)gf_list_enum(reader->channels, &i))) {
 		if (ch2 == ch) {
 			isor_reset_reader(ch);
+			if (ch->static_sample) gf_isom_sample_del(&ch->static_sample);
 			gf_free(ch);
 			gf_list_rem(reader->channels, i-1);
 			return;
@@ -31,6 +31,13 @@
 #ifndef GPAC_DISABLE_ISOM
 
 
+/*the channel static sample is only detached, its buffer is kept for the next sample*/
+static void isor_reader_del_sample(ISOMChannel *ch)
+{
+	if (ch->sample == ch->static_sample) ch->sample = NULL;
+	else gf_isom_sample_del(&ch->sample);
+}
+
 void isor_reset_reader(ISOMChannel *ch)
 {
 	ch->last_state = GF_OK;
@@ -469,7 +476,7 @@ void isor_reader_get_sample(ISOMChannel *ch)
 				ch->last_state = GF_EOS;
 			} else {
 				if (ch->sample)
-					gf_isom_sample_del(&ch->sample);
+					isor_reader_del_sample(ch);
 			}
 		}
 		if (ch->sample) {
@@ -489,7 +496,7 @@ void isor_reader_get_sample(ISOMChannel *ch)
 			if (ch->edit_sync_frame) {
 				ch->edit_sync_frame++;
 				if (ch->edit_sync_frame < ch->sample_num) {
-					gf_isom_sample_del(&ch->sample);
+					isor_reader_del_sample(ch);
 					ch->sample = gf_isom_get_sample(ch->owner->mov, ch->track, ch->edit_sync_frame, &sample_desc_index);
 					ch->sample->DTS = ch->sample_time;
 					ch->sample->CTS_Offset = 0;
@@ -502,14 +509,14 @@ void isor_reader_get_sample(ISOMChannel *ch)
 				if (prev_sample == ch->sample_num) {
 					if (ch->owner->frag_type && (ch->sample_num==gf_isom_get_sample_count(ch->owner->mov, ch->track))) {
 						if (ch->sample)
-							gf_isom_sample_del(&ch->sample);
+							isor_reader_del_sample(ch);
 					} else {
 						u32 time_diff = 2;
 						u32 sample_num = ch->sample_num ? ch->sample_num : 1;
 						GF_ISOSample *s1 = gf_isom_get_sample(ch->owner->mov, ch->track, sample_num, NULL);
 						GF_ISOSample *s2 = gf_isom_get_sample(ch->owner->mov, ch->track, sample_num+1, NULL);
 
-						gf_isom_sample_del(&ch->sample);
+						isor_reader_del_sample(ch);
 
 						if (s2 && s1) {
 							assert(s2->DTS >= s1->DTS);
@@ -534,7 +541,7 @@ void isor_reader_get_sample(ISOMChannel *ch)
 					assert (e == GF_OK);
 					/*if no sync point in the past, use the first non-sync for the given time*/
 					if (!ch->sample || !ch->sample->data) {
-						gf_isom_sample_del(&ch->sample);
+						isor_reader_del_sample(ch);
 						ch->sample = found;
 						ch->sample_time = ch->sample->DTS;
 						ch->sample_num = samp_num;
@@ -552,10 +559,12 @@ void isor_reader_get_sample(ISOMChannel *ch)
 	} else {
 		ch->sample_num++;
 
-		ch->sample = gf_isom_get_sample(ch->owner->mov, ch->track, ch->sample_num, &sample_desc_index);
+		if (!ch->static_sample) ch->static_sample = gf_isom_sample_new();
+		if (gf_isom_get_sample_static(ch->owner->mov, ch->track, ch->sample_num, &sample_desc_index, ch->static_sample) == GF_OK)
+			ch->sample = ch->static_sample;
 		/*if sync shadow / carousel RAP skip*/
 		if (ch->sample && (ch->sample->IsRAP==RAP_REDUNDANT)) {
-			gf_isom_sample_del(&ch->sample);
+			isor_reader_del_sample(ch);
 			ch->sample_num++;
 			isor_reader_get_sample(ch);
 			return;
@@ -566,7 +575,7 @@ void isor_reader_get_sample(ISOMChannel *ch)
 	if (ch->sample && ch->sample->IsRAP && ch->next_track) {
 		ch->track = ch->next_track;
 		ch->next_track = 0;
-		gf_isom_sample_del(&ch->sample);
+		isor_reader_del_sample(ch);
 		isor_reader_get_sample(ch);
 		return;
 	}
@@ -637,7 +646,7 @@ void isor_reader_get_sample(ISOMChannel *ch)
 			if ( ! (ch->nalu_extract_mode & GF_ISOM_NALU_EXTRACT_INBAND_PS_FLAG) ) {
 				u32 extract_mode = ch->nalu_extract_mode | GF_ISOM_NALU_EXTRACT_INBAND_PS_FLAG;
 
-				gf_isom_sample_del(&ch->sample);
+				isor_reader_del_sample(ch);
 				ch->sample = NULL;
 				gf_isom_set_nalu_extract_mode(ch->owner->mov, ch->track, extract_mode);
 				ch->sample = gf_isom_get_sample(ch->owner->mov, ch->track, ch->sample_num, &ch->last_sample_desc_index);
@@ -653,7 +662,7 @@ void isor_reader_get_sample(ISOMChannel *ch)
 		default:
 			//TODO: do we want to support codec changes ?
 			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[IsoMedia] Change of sample description (%d->%d) for media type %s not supported\n", ch->last_sample_desc_index, sample_desc_index, gf_4cc_to_str(mtype) ));
-			gf_isom_sample_del(&ch->sample);
+			isor_reader_del_sample(ch);
 			ch->sample = NULL;
 			ch->last_state = GF_NOT_SUPPORTED;
 			return;
@@ -699,6 +708,7 @@ void isor_reader_get_sample(ISOMChannel *ch)
 			gf_free(ch->sample->data);
 			ch->sample->data = ismasamp->data;
 			ch->sample->dataLength = ismasamp->dataLength;
+			if (ch->sample->alloc_size) ch->sample->alloc_size = ch->sample->dataLength;
 			ismasamp->data = NULL;
 			ismasamp->dataLength = 0;
 			ch->current_slh.isma_encrypted = (ismasamp->flags & GF_ISOM_ISMA_IS_ENCRYPTED) ? 1 : 0;
@@ -750,7 +760,7 @@ void isor_reader_release_sample(ISOMChannel *ch)
 		gf_free(ch->current_slh.sai);
 		ch->current_slh.sai = NULL;
 	}
-	if (ch->sample) gf_isom_sample_del(&ch->sample);
+	if (ch->sample) isor_reader_del_sample(ch);
 	ch->sample = NULL;
 	ch->current_slh.AU_sequenceNumber++;
 	ch->current_slh.packetSequenceNumber++;
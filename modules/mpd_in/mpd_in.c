@@ -585,7 +585,7 @@ void mpdin_dash_io_delete_cache_file(GF_DASHFileIO *dashio, GF_DASHFileIOSession
 	gf_dm_delete_cached_file_entry_session((GF_DownloadSession *)session, cache_url);
 }
 
-GF_DASHFileIOSession mpdin_dash_io_create(GF_DASHFileIO *dashio, Bool persistent, const char *url, s32 group_idx)
+GF_DASHFileIOSession mpdin_dash_io_create(GF_DASHFileIO *dashio, u32 dash_flags, const char *url, s32 group_idx)
 {
 	GF_MPDGroup *group = NULL;
 	GF_DownloadSession *sess;
@@ -594,7 +594,8 @@ GF_DASHFileIOSession mpdin_dash_io_create(GF_DASHFileIO *dashio, Bool persistent
 	if (mpdin->memory_storage)
 		flags |= GF_NETIO_SESSION_MEMORY_CACHE;
 
-	if (persistent) flags |= GF_NETIO_SESSION_PERSISTENT;
+	if (dash_flags & GF_DASHIO_SESSION_PERSISTENT) flags |= GF_NETIO_SESSION_PERSISTENT;
+	if (dash_flags & GF_DASHIO_SESSION_ALLOW_PIPELINE) flags |= GF_NETIO_SESSION_ALLOW_PIPELINE;
 
 	if (group_idx>=0) {
 		group = gf_dash_get_group_udta(mpdin->dash, group_idx);
@@ -648,6 +649,10 @@ const char *mpdin_dash_io_get_cache_name(GF_DASHFileIO *dashio, GF_DASHFileIOSes
 {
 	return gf_dm_sess_get_cache_name((GF_DownloadSession *)session);
 }
+GF_Err mpdin_dash_io_extend_cache_range(GF_DASHFileIO *dashio, GF_DASHFileIOSession session, u64 end_range, u32 size)
+{
+	return gf_dm_sess_extend_cache_range((GF_DownloadSession *)session, end_range, size);
+}
 const char *mpdin_dash_io_get_mime(GF_DASHFileIO *dashio, GF_DASHFileIOSession session)
 {
 	return gf_dm_sess_mime_type((GF_DownloadSession *)session);
@@ -931,7 +936,7 @@ GF_Err MPD_ConnectService(GF_InputService *plug, GF_ClientService *serv, const c
 	const char *opt;
 	GF_Err e;
 	s32 shift_utc_ms, debug_adaptation_set;
-	u32 max_cache_duration, auto_switch_count, init_timeshift, tiles_rate_decrease;
+	u32 max_cache_duration, auto_switch_count, init_timeshift, tiles_rate_decrease, nb_parallel;
 	Bool use_server_utc;
 	GF_DASHInitialSelectionMode first_select_mode;
 	GF_DASHTileAdaptationMode tile_adapt_mode;
@@ -962,6 +967,7 @@ GF_Err MPD_ConnectService(GF_InputService *plug, GF_ClientService *serv, const c
 	mpdin->dash_io.get_bytes_per_sec = mpdin_dash_io_get_bytes_per_sec;
 	mpdin->dash_io.get_total_size = mpdin_dash_io_get_total_size;
 	mpdin->dash_io.get_bytes_done = mpdin_dash_io_get_bytes_done;
+	mpdin->dash_io.extend_cache_range = mpdin_dash_io_extend_cache_range;
 	mpdin->dash_io.on_dash_event = mpdin_dash_io_on_dash_event;
 
 	max_cache_duration = 0;
@@ -1002,7 +1008,10 @@ GF_Err MPD_ConnectService(GF_InputService *plug, GF_ClientService *serv, const c
 	else first_select_mode = GF_DASH_SELECT_BANDWIDTH_LOWEST;
 
 	opt = gf_modules_get_option((GF_BaseInterface *)plug, "DASH", "MemoryStorage");
-	if (!opt) gf_modules_set_option((GF_BaseInterface *)plug, "DASH", "MemoryStorage", "yes");
+	if (!opt) {
+		opt = "yes";
+		gf_modules_set_option((GF_BaseInterface *)plug, "DASH", "MemoryStorage", opt);
+	}
 	mpdin->memory_storage = (opt && !strcmp(opt, "yes")) ? 1 : 0;
 
 	opt = gf_modules_get_option((GF_BaseInterface *)plug, "DASH", "UseMaxResolution");
@@ -1128,6 +1137,13 @@ GF_Err MPD_ConnectService(GF_InputService *plug, GF_ClientService *serv, const c
 		gf_dash_set_segment_expiration_threshold(mpdin->dash, atoi(opt));
 	}
 
+	opt = gf_modules_get_option((GF_BaseInterface *)plug, "DASH", "ParallelDownloads");
+	if (!opt) gf_modules_set_option((GF_BaseInterface *)plug, "DASH", "ParallelDownloads", "1");
+	nb_parallel = opt ? atoi(opt) : 1;
+	opt = gf_modules_get_option((GF_BaseInterface *)plug, "DASH", "RangeSplitSize");
+	if (!opt) gf_modules_set_option((GF_BaseInterface *)plug, "DASH", "RangeSplitSize", "0");
+	gf_dash_set_parallel_downloads(mpdin->dash, nb_parallel, opt ? atoi(opt) : 0);
+
 	opt = gf_modules_get_option((GF_BaseInterface *)plug, "DASH", "SwitchProbeCount");
 	if (opt) {
 		gf_dash_set_switching_probe_count(mpdin->dash, atoi(opt));
@@ -1139,6 +1155,13 @@ GF_Err MPD_ConnectService(GF_InputService *plug, GF_ClientService *serv, const c
 	if (!opt) gf_modules_set_option((GF_BaseInterface *)plug, "DASH", "AgressiveSwitching", "no");
 	gf_dash_set_agressive_adaptation(mpdin->dash,  (opt && !strcmp(opt, "yes")) ? GF_TRUE : GF_FALSE);
 
+	opt = gf_modules_get_option((GF_BaseInterface *)plug, "DASH", "AdaptationAlgorithm");
+	if (!opt) gf_modules_set_option((GF_BaseInterface *)plug, "DASH", "AdaptationAlgorithm", "gpac");
+	if (opt && !strcmp(opt, "ewma")) gf_dash_set_algo(mpdin->dash, GF_DASH_ALGO_THROUGHPUT_EWMA);
+	else if (opt && !strcmp(opt, "bba0")) gf_dash_set_algo(mpdin->dash, GF_DASH_ALGO_BBA0);
+	else if (opt && !strcmp(opt, "bola")) gf_dash_set_algo(mpdin->dash, GF_DASH_ALGO_BOLA);
+	else gf_dash_set_algo(mpdin->dash, GF_DASH_ALGO_GPAC_LEGACY);
+
 	opt = gf_modules_get_option((GF_BaseInterface *)plug, "DASH", "DebugAdaptationSet");
 	if (!opt) gf_modules_set_option((GF_BaseInterface *)plug, "DASH", "DebugAdaptationSet", "-1");
 	debug_adaptation_set = opt ? atoi(opt) : -1;
@@ -1227,7 +1250,7 @@ GF_Err MPD_ServiceCommand(GF_InputService *plug, GF_NetworkCommand *com)
 		}
 
 		if (e!= GF_OK || !com->info.name || 2 > strlen(com->info.name)) {
-			gf_dash_get_info(mpdin->dash, &com->info.name, &com->info.comment);
+			gf_dash_get_info(mpdin->dash, &com->info.name, &com->info.comment, NULL);
 		}
 		idx = MPD_GetGroupIndexForChannel(mpdin, com->play.on_channel);
 		if (idx>=0) {
@@ -1155,6 +1155,19 @@ static GF_Err M2TS_ConnectService(GF_InputService *plug, GF_ClientService *serv,
 			}
 			m2ts->ts->run_state = 1;
 		} else {
+			/*local file: load (or build) the file index for seeking - "yes" loads an existing index, "build" creates it if needed*/
+			opt = gf_modules_get_option((GF_BaseInterface *)m2ts->owner, "M2TS", "UseIndex");
+			if (url && (!opt || strcmp(opt, "no"))
+			        && strnicmp(url, "udp://", 6) && strnicmp(url, "mpegts-", 7) && strnicmp(url, "dvb://", 6) && strnicmp(url, "gmem://", 7)) {
+				char szURL[GF_MAX_PATH];
+				char *frag;
+				strncpy(szURL, url, GF_MAX_PATH-1);
+				szURL[GF_MAX_PATH-1] = 0;
+				frag = strrchr(szURL, '#');
+				if (frag) frag[0] = 0;
+				if (m2ts->ts->index) gf_m2ts_index_del(m2ts->ts->index);
+				m2ts->ts->index = gf_m2ts_index_open(szURL, (opt && !strcmp(opt, "build")) ? GF_TRUE : GF_FALSE);
+			}
 			e = gf_m2ts_demuxer_setup(m2ts->ts,url,0);
 		}
 	}
@@ -53,6 +53,8 @@ void gf_rtp_del(GF_RTPChannel *ch)
 	if (ch->net_info.Profile) gf_free(ch->net_info.Profile);
 	if (ch->po) gf_rtp_reorderer_del(ch->po);
 	if (ch->send_buffer) gf_free(ch->send_buffer);
+	if (ch->rtp_batch) gf_free(ch->rtp_batch);
+	if (ch->rtp_batch_data) gf_free(ch->rtp_batch_data);
 
 	if (ch->CName) gf_free(ch->CName);
 	if (ch->s_name) gf_free(ch->s_name);
@@ -341,8 +343,30 @@ u32 gf_rtp_read_rtp(GF_RTPChannel *ch, char *buffer, u32 buffer_size)
 	//only if the socket exist (otherwise RTSP interleaved channel)
 	if (!ch || !ch->rtp) return 0;
 
-	e = gf_sk_receive(ch->rtp, buffer, buffer_size, 0, &res);
-	if (!res || e || (res < 12)) res = 0;
+	/*fetch all pending datagrams at once, and return them one by one*/
+	if (ch->rtp_batch_pos == ch->rtp_batch_count) {
+		ch->rtp_batch_pos = ch->rtp_batch_count = 0;
+		if (!ch->rtp_batch) {
+			u32 i, dg_size = MIN(buffer_size, GF_RTP_RECV_DATAGRAM_SIZE);
+			ch->rtp_batch = (GF_SockDatagram *) gf_malloc(sizeof(GF_SockDatagram) * GF_RTP_RECV_BATCH);
+			ch->rtp_batch_data = (char *) gf_malloc(sizeof(char) * dg_size * GF_RTP_RECV_BATCH);
+			memset(ch->rtp_batch, 0, sizeof(GF_SockDatagram) * GF_RTP_RECV_BATCH);
+			for (i=0; i<GF_RTP_RECV_BATCH; i++) {
+				ch->rtp_batch[i].data = ch->rtp_batch_data + i*dg_size;
+				ch->rtp_batch[i].size = dg_size;
+			}
+		}
+		e = gf_sk_receive_batch(ch->rtp, ch->rtp_batch, GF_RTP_RECV_BATCH, &ch->rtp_batch_count);
+		if (e) ch->rtp_batch_count = 0;
+	}
+	res = 0;
+	if (ch->rtp_batch_pos < ch->rtp_batch_count) {
+		GF_SockDatagram *dg = &ch->rtp_batch[ch->rtp_batch_pos];
+		ch->rtp_batch_pos++;
+		res = MIN(dg->read, buffer_size);
+		memcpy(buffer, dg->data, res);
+	}
+	if (res < 12) res = 0;
 	if (res) {
 		ch->total_bytes+=res;
 		ch->total_pck++;
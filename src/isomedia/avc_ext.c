@@ -127,7 +127,7 @@ static GF_Err process_extractor(GF_ISOFile *file, GF_MediaBox *mdia, u32 sampleN
 		if (sample_offset < -sample_offset)
 			sample_offset = 0;
 
-		e = Media_GetSample(ref_trak->Media, sampleNumber + sample_offset, &ref_samp, &di, GF_FALSE, NULL);
+		e = Media_GetSample(ref_trak->Media, sampleNumber + sample_offset, &ref_samp, &di, GF_FALSE, NULL, NULL);
 		if (e) return e;
 
 		if (rewrite_start_codes) {
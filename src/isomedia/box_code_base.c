@@ -386,6 +386,7 @@ void ctts_del(GF_Box *s)
 {
 	GF_CompositionOffsetBox *ptr = (GF_CompositionOffsetBox *)s;
 	if (ptr->entries) gf_free(ptr->entries);
+	if (ptr->r_index) stbl_index_del(ptr->r_index);
 	gf_free(ptr);
 }
 
@@ -3318,6 +3319,7 @@ void moof_del(GF_Box *s)
 
 	if (ptr->mfhd) gf_isom_box_del((GF_Box *) ptr->mfhd);
 	gf_isom_box_array_del(ptr->TrackList);
+	gf_isom_trackid_map_del(ptr->traf_map);
 	if (ptr->mdat) gf_free(ptr->mdat);
 	gf_free(ptr);
 }
@@ -3407,6 +3409,7 @@ void moov_del(GF_Box *s)
 #endif
 
 	gf_isom_box_array_del(ptr->trackList);
+	gf_isom_trackid_map_del(ptr->track_map);
 	gf_free(ptr);
 }
 
@@ -4003,6 +4006,7 @@ void mvex_del(GF_Box *s)
 	if (ptr == NULL) return;
 	if (ptr->mehd) gf_isom_box_del((GF_Box*)ptr->mehd);
 	gf_isom_box_array_del(ptr->TrackExList);
+	gf_isom_trackid_map_del(ptr->trex_map);
 	gf_isom_box_array_del(ptr->TrackExPropList);
 	gf_free(ptr);
 }
@@ -4611,6 +4615,9 @@ void stbl_del(GF_Box *s)
 	if (ptr->sai_sizes) gf_isom_box_array_del(ptr->sai_sizes);
 	if (ptr->sai_offsets) gf_isom_box_array_del(ptr->sai_offsets);
 
+	if (ptr->lazy_types) gf_free(ptr->lazy_types);
+	if (ptr->lazy_offsets) gf_free(ptr->lazy_offsets);
+
 	gf_free(ptr);
 }
 
@@ -4722,44 +4729,100 @@ GF_Err stbl_AddBox(GF_SampleTableBox *ptr, GF_Box *a)
 
 
 
+/*parses a child box of stbl*/
+static GF_Err stbl_ParseChild(GF_SampleTableBox *ptr, GF_BitStream *bs, GF_Box **out_box)
+{
+	GF_Err e;
+	GF_Box *a;
+
+	*out_box = NULL;
+	e = gf_isom_parse_box(&a, bs);
+	if (e) return e;
+	//we need to read the DegPriority in a different way...
+	if ((a->type == GF_ISOM_BOX_TYPE_STDP) || (a->type == GF_ISOM_BOX_TYPE_SDTP)) {
+		u64 s = a->size;
+		/*
+					if (!ptr->SampleSize) {
+						gf_isom_box_del(a);
+						return GF_ISOM_INVALID_FILE;
+					}
+		*/
+		if (a->type == GF_ISOM_BOX_TYPE_STDP) {
+			if (ptr->SampleSize) ((GF_DegradationPriorityBox *)a)->nb_entries = ptr->SampleSize->sampleCount;
+			e = stdp_Read(a, bs);
+		} else {
+			if (ptr->SampleSize) ((GF_SampleDependencyTypeBox *)a)->sampleCount = ptr->SampleSize->sampleCount;
+			e = sdtp_Read(a, bs);
+		}
+		if (e) {
+			gf_isom_box_del(a);
+			return e;
+		}
+
+		if (a->size>8) {
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[iso file] Box \"%s\" has %d extra bytes\n", gf_4cc_to_str(a->type), a->size));
+			gf_bs_skip_bytes(bs, a->size-8);
+		}
+		a->size = s;
+	}
+	*out_box = a;
+	return GF_OK;
+}
+
+static Bool stbl_IsLazyTable(GF_SampleTableBox *ptr, u32 type, u64 size)
+{
+	u32 i;
+	switch (type) {
+	case GF_ISOM_BOX_TYPE_STDP:
+	case GF_ISOM_BOX_TYPE_SDTP:
+		/*these need the sample count, so they are delayed as well if the sample size box is*/
+		for (i=0; i<ptr->nb_lazy; i++) {
+			if ((ptr->lazy_types[i]==GF_ISOM_BOX_TYPE_STSZ) || (ptr->lazy_types[i]==GF_ISOM_BOX_TYPE_STZ2)) return GF_TRUE;
+		}
+	/*fall-through*/
+	case GF_ISOM_BOX_TYPE_STTS:
+	case GF_ISOM_BOX_TYPE_CTTS:
+	case GF_ISOM_BOX_TYPE_STSS:
+	case GF_ISOM_BOX_TYPE_STSZ:
+	case GF_ISOM_BOX_TYPE_STZ2:
+	case GF_ISOM_BOX_TYPE_STSC:
+	case GF_ISOM_BOX_TYPE_STCO:
+	case GF_ISOM_BOX_TYPE_CO64:
+		return (size >= GF_ISOM_LAZY_TABLE_MIN_SIZE) ? GF_TRUE : GF_FALSE;
+	default:
+		return GF_FALSE;
+	}
+}
+
 GF_Err stbl_Read(GF_Box *s, GF_BitStream *bs)
 {
 	GF_Err e;
 	GF_Box *a;
 	//we need to parse DegPrior in a special way
 	GF_SampleTableBox *ptr = (GF_SampleTableBox *)s;
+	Bool lazy = (gf_bs_get_cookie(bs) & GF_ISOM_BS_COOKIE_LAZY_TABLES) ? GF_TRUE : GF_FALSE;
 
 	while (ptr->size) {
-		e = gf_isom_parse_box(&a, bs);
-		if (e) return e;
-		//we need to read the DegPriority in a different way...
-		if ((a->type == GF_ISOM_BOX_TYPE_STDP) || (a->type == GF_ISOM_BOX_TYPE_SDTP)) {
-			u64 s = a->size;
-			/*
-						if (!ptr->SampleSize) {
-							gf_isom_box_del(a);
-							return GF_ISOM_INVALID_FILE;
-						}
-			*/
-			if (a->type == GF_ISOM_BOX_TYPE_STDP) {
-				if (ptr->SampleSize) ((GF_DegradationPriorityBox *)a)->nb_entries = ptr->SampleSize->sampleCount;
-				e = stdp_Read(a, bs);
-			} else {
-				if (ptr->SampleSize) ((GF_SampleDependencyTypeBox *)a)->sampleCount = ptr->SampleSize->sampleCount;
-				e = sdtp_Read(a, bs);
+		/*only record where large tables are, they will be parsed on first access to the track*/
+		if (lazy && (ptr->size>=8) && (gf_bs_available(bs)>=8)) {
+			u64 size = gf_bs_peek_bits(bs, 32, 0);
+			u32 type = gf_bs_peek_bits(bs, 32, 4);
+			if ((size<=ptr->size) && (size<=gf_bs_available(bs)) && stbl_IsLazyTable(ptr, type, size)) {
+				ptr->lazy_types = (u32*)gf_realloc(ptr->lazy_types, sizeof(u32)*(ptr->nb_lazy+1));
+				ptr->lazy_offsets = (u64*)gf_realloc(ptr->lazy_offsets, sizeof(u64)*(ptr->nb_lazy+1));
+				if (!ptr->lazy_types || !ptr->lazy_offsets) return GF_OUT_OF_MEM;
+				ptr->lazy_types[ptr->nb_lazy] = type;
+				ptr->lazy_offsets[ptr->nb_lazy] = gf_bs_get_position(bs);
+				ptr->nb_lazy++;
+				gf_bs_skip_bytes(bs, size);
+				ptr->size -= size;
+				continue;
 			}
-			if (e) {
-				gf_isom_box_del(a);
-				return e;
-			}
-
-			if (a->size>8) {
-				GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[iso file] Box \"%s\" has %d extra bytes\n", gf_4cc_to_str(a->type), a->size));
-				gf_bs_skip_bytes(bs, a->size-8);
-			}
-			a->size = s;
 		}
 
+		e = stbl_ParseChild(ptr, bs, &a);
+		if (e) return e;
+
 		if (ptr->size<a->size) {
 			gf_isom_box_del(a);
 			return GF_ISOM_INVALID_FILE;
@@ -4777,6 +4840,42 @@ GF_Err stbl_Read(GF_Box *s, GF_BitStream *bs)
 	return GF_OK;
 }
 
+GF_Err stbl_LoadLazyTables(GF_SampleTableBox *ptr, GF_BitStream *bs)
+{
+	u32 i, pass;
+	u64 pos;
+	GF_Box *a;
+	GF_Err e = GF_OK;
+	if (!ptr->nb_lazy) return GF_OK;
+
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[iso file] Loading %d delayed sample tables\n", ptr->nb_lazy));
+	pos = gf_bs_get_position(bs);
+	/*sample dependency boxes need the sample count, parse them last*/
+	for (pass=0; (pass<2) && !e; pass++) {
+		for (i=0; i<ptr->nb_lazy; i++) {
+			Bool is_dep = ((ptr->lazy_types[i]==GF_ISOM_BOX_TYPE_STDP) || (ptr->lazy_types[i]==GF_ISOM_BOX_TYPE_SDTP)) ? GF_TRUE : GF_FALSE;
+			if (is_dep != (pass ? GF_TRUE : GF_FALSE)) continue;
+
+			gf_bs_seek(bs, ptr->lazy_offsets[i]);
+			e = stbl_ParseChild(ptr, bs, &a);
+			if (!e) e = stbl_AddBox(ptr, a);
+			if (e) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Failed to load box %s: %s\n", gf_4cc_to_str(ptr->lazy_types[i]), gf_error_to_string(e) ));
+				break;
+			}
+		}
+	}
+	gf_free(ptr->lazy_types);
+	gf_free(ptr->lazy_offsets);
+	ptr->lazy_types = NULL;
+	ptr->lazy_offsets = NULL;
+	ptr->nb_lazy = 0;
+	if (ptr->SyncSample) ptr->no_sync_found = 0;
+
+	gf_bs_seek(bs, pos);
+	return e;
+}
+
 GF_Box *stbl_New()
 {
 	ISOM_DECL_BOX_ALLOC(GF_SampleTableBox, GF_ISOM_BOX_TYPE_STBL);
@@ -5126,6 +5225,7 @@ void stsc_del(GF_Box *s)
 	GF_SampleToChunkBox *ptr = (GF_SampleToChunkBox *)s;
 	if (ptr == NULL) return;
 	if (ptr->entries) gf_free(ptr->entries);
+	if (ptr->r_index) stbl_index_del(ptr->r_index);
 	gf_free(ptr);
 }
 
@@ -5821,6 +5921,7 @@ void stts_del(GF_Box *s)
 {
 	GF_TimeToSampleBox *ptr = (GF_TimeToSampleBox *)s;
 	if (ptr->entries) gf_free(ptr->entries);
+	if (ptr->r_index) stbl_index_del(ptr->r_index);
 	gf_free(ptr);
 }
 
@@ -6680,6 +6781,11 @@ GF_Err trak_Read(GF_Box *s, GF_BitStream *bs)
 
 	//we should only parse senc/psec when no saiz/saio is present, otherwise we fetch the info directly
 	if (ptr->Media && ptr->Media->information && ptr->Media->information->sampleTable /*&& !ptr->Media->information->sampleTable->sai_sizes*/) {
+		/*sample encryption parsing needs the sample tables*/
+		if (ptr->Media->information->sampleTable->senc || ptr->Media->information->sampleTable->piff_psec) {
+			e = stbl_LoadLazyTables(ptr->Media->information->sampleTable, bs);
+			if (e) return e;
+		}
 		if (ptr->Media->information->sampleTable->senc) {
 			e = senc_Parse(bs, ptr, NULL, (GF_SampleEncryptionBox *)ptr->Media->information->sampleTable->senc);
 		}
@@ -640,6 +640,13 @@ GF_Err gf_isom_dump(GF_ISOFile *mov, FILE * trace)
 	GF_Box *box;
 	if (!mov || !trace) return GF_BAD_PARAM;
 
+	/*make sure all sample tables are loaded*/
+	if (mov->moov) {
+		for (i=0; i<gf_list_count(mov->moov->trackList); i++) {
+			Track_LoadSampleTables((GF_TrackBox *)gf_list_get(mov->moov->trackList, i));
+		}
+	}
+
 	fprintf(trace, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
 	fprintf(trace, "<!--MP4Box dump trace-->\n");
 
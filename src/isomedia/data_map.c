@@ -30,6 +30,9 @@
 
 static u32 default_write_buffering_size = 0;
 
+/*read-ahead cache of file data maps in read mode*/
+#define FDM_READ_BUFFER_SIZE	16384
+
 GF_EXPORT
 GF_Err gf_isom_set_output_buffering(GF_ISOFile *movie, u32 size)
 {
@@ -163,7 +166,9 @@ GF_Err gf_isom_datamap_new(const char *location, const char *parentPath, u8 mode
 		return GF_URL_ERROR;
 	}
 
-	if (mode == GF_ISOM_DATA_MAP_READ_ONLY) {
+	if (mode == GF_ISOM_DATA_MAP_READ_MMAP) {
+		*outDataMap = gf_isom_fmo_new(sPath, GF_ISOM_DATA_MAP_READ);
+	} else if (mode == GF_ISOM_DATA_MAP_READ_ONLY) {
 		mode = GF_ISOM_DATA_MAP_READ;
 		/*It seems win32 file mapping is reported in prog mem usage -> large increases of occupancy. Should not be a pb
 		but unless you want mapping, only regular IO will be used...*/
@@ -281,6 +286,14 @@ u32 gf_isom_datamap_get_data(GF_DataMap *map, char *buffer, u32 bufferLength, u6
 	}
 }
 
+char *gf_isom_datamap_get_mapped_data(GF_DataMap *map, u64 Offset, u32 size)
+{
+	GF_FileMappingDataMap *fmo = (GF_FileMappingDataMap *)map;
+	if (!map || (map->type != GF_ISOM_DATA_FILE_MAPPING) || !fmo->byte_map) return NULL;
+	if (Offset + size > fmo->file_size) return NULL;
+	return fmo->byte_map + Offset;
+}
+
 void gf_isom_datamap_flush(GF_DataMap *map)
 {
 	if (!map) return;
@@ -389,9 +402,12 @@ GF_DataMap *gf_isom_fdm_new(const char *sPath, u8 mode)
 		void *mem_address;
 		if (sscanf(sPath, "gmem://%d@%p", &size, &mem_address) != 2)
 			return NULL;
+#ifndef GPAC_DISABLE_CORE_TOOLS
+		tmp->blob = gf_cache_blob_get(sPath);
+#endif
 		tmp->bs = gf_bs_new((const char *)mem_address, size, GF_BITSTREAM_READ);
 		if (!tmp->bs) {
-			gf_free(tmp);
+			gf_isom_fdm_del(tmp);
 			return NULL;
 		}
 		return (GF_DataMap *)tmp;
@@ -441,6 +457,9 @@ GF_DataMap *gf_isom_fdm_new(const char *sPath, u8 mode)
 	if (default_write_buffering_size) {
 		gf_bs_set_output_buffering(tmp->bs, default_write_buffering_size);
 	}
+	if (mode == GF_ISOM_DATA_MAP_READ) {
+		gf_bs_set_input_buffering(tmp->bs, FDM_READ_BUFFER_SIZE);
+	}
 	return (GF_DataMap *)tmp;
 }
 
@@ -450,6 +469,9 @@ void gf_isom_fdm_del(GF_FileDataMap *ptr)
 	if (ptr->bs) gf_bs_del(ptr->bs);
 	if (ptr->stream && !ptr->is_stdout)
 		gf_fclose(ptr->stream);
+#ifndef GPAC_DISABLE_CORE_TOOLS
+	if (ptr->blob) gf_cache_blob_release(ptr->blob);
+#endif
 
 #ifndef GPAC_DISABLE_ISOM_WRITE
 	if (ptr->temp_file) {
@@ -643,6 +665,99 @@ u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, char *buffer, u32 bufferLen
 	return bufferLength;
 }
 
+GF_Err gf_isom_fmo_set_access_hint(GF_FileMappingDataMap *ptr, u32 hint)
+{
+	return GF_NOT_SUPPORTED;
+}
+
+#elif defined(GPAC_CONFIG_LINUX)
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+GF_DataMap *gf_isom_fmo_new(const char *sPath, u8 mode)
+{
+	GF_FileMappingDataMap *tmp;
+	struct stat st;
+	char *byte_map;
+	int fd;
+
+	//only in read only
+	if (mode != GF_ISOM_DATA_MAP_READ) return NULL;
+
+	fd = open(sPath, O_RDONLY);
+	if (fd < 0) return NULL;
+
+	//empty files cannot be mapped, and large files cannot be mapped on 32 bit systems: use regular IO
+	if (fstat(fd, &st) || !st.st_size || ((u64) st.st_size > (u64) ((size_t) -1))) {
+		close(fd);
+		return gf_isom_fdm_new(sPath, mode);
+	}
+	byte_map = (char *) mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	//the mapping keeps a reference to the file
+	close(fd);
+	if (byte_map == MAP_FAILED) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[IsoMedia] Cannot map file %s, using regular IO\n", sPath));
+		return gf_isom_fdm_new(sPath, mode);
+	}
+
+	GF_SAFEALLOC(tmp, GF_FileMappingDataMap);
+	if (!tmp) {
+		munmap(byte_map, (size_t) st.st_size);
+		return NULL;
+	}
+	tmp->type = GF_ISOM_DATA_FILE_MAPPING;
+	tmp->mode = mode;
+	tmp->name = gf_strdup(sPath);
+	tmp->file_size = st.st_size;
+	tmp->byte_map = byte_map;
+
+	//finaly open our bitstream (from buffer)
+	tmp->bs = gf_bs_new(tmp->byte_map, tmp->file_size, GF_BITSTREAM_READ);
+	return (GF_DataMap *)tmp;
+}
+
+void gf_isom_fmo_del(GF_FileMappingDataMap *ptr)
+{
+	if (!ptr || (ptr->type != GF_ISOM_DATA_FILE_MAPPING)) return;
+
+	if (ptr->bs) gf_bs_del(ptr->bs);
+	if (ptr->byte_map) munmap(ptr->byte_map, (size_t) ptr->file_size);
+	gf_free(ptr->name);
+	gf_free(ptr);
+}
+
+u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, char *buffer, u32 bufferLength, u64 fileOffset)
+{
+	//can we seek till that point ???
+	if (fileOffset >= ptr->file_size) return 0;
+	if (fileOffset + bufferLength > ptr->file_size) bufferLength = (u32) (ptr->file_size - fileOffset);
+
+	//we do only read operations, so trivial
+	memcpy(buffer, ptr->byte_map + fileOffset, bufferLength);
+	return bufferLength;
+}
+
+GF_Err gf_isom_fmo_set_access_hint(GF_FileMappingDataMap *ptr, u32 hint)
+{
+	int advice;
+	switch (hint) {
+	case GF_ISOM_ACCESS_SEQUENTIAL:
+		advice = MADV_SEQUENTIAL;
+		break;
+	case GF_ISOM_ACCESS_RANDOM:
+		advice = MADV_RANDOM;
+		break;
+	default:
+		advice = MADV_NORMAL;
+		break;
+	}
+	if (madvise(ptr->byte_map, (size_t) ptr->file_size, advice)) return GF_IO_ERR;
+	return GF_OK;
+}
+
 #else
 
 GF_DataMap *gf_isom_fmo_new(const char *sPath, u8 mode) {
@@ -655,9 +770,19 @@ u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, char *buffer, u32 bufferLen
 {
 	return gf_isom_fdm_get_data((GF_FileDataMap *)ptr, buffer, bufferLength, fileOffset);
 }
+GF_Err gf_isom_fmo_set_access_hint(GF_FileMappingDataMap *ptr, u32 hint) {
+	return GF_NOT_SUPPORTED;
+}
 
 #endif
 
+GF_Err gf_isom_datamap_set_access_hint(GF_DataMap *map, u32 hint)
+{
+	if (!map) return GF_BAD_PARAM;
+	if (map->type != GF_ISOM_DATA_FILE_MAPPING) return GF_NOT_SUPPORTED;
+	return gf_isom_fmo_set_access_hint((GF_FileMappingDataMap *)map, hint);
+}
+
 #endif /*GPAC_DISABLE_ISOM*/
 
 
@@ -1156,6 +1156,9 @@ GF_Err gf_isom_cenc_get_sample_aux_info(GF_ISOFile *the_file, u32 trackNumber, u
 
 	trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak) return GF_BAD_PARAM;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	if (sai) Track_LoadFragmentForSample(trak, sampleNumber);
+#endif
 	stbl = trak->Media->information->sampleTable;
 	if (!stbl)
 		return GF_BAD_PARAM;
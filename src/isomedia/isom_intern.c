@@ -39,7 +39,7 @@ GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, u64 moof_offset,
 GF_Err MergeFragment(GF_MovieFragmentBox *moof, GF_ISOFile *mov)
 {
 	GF_Err e;
-	u32 i, j;
+	u32 i;
 	u64 MaxDur;
 	GF_TrackFragmentBox *traf;
 	GF_TrackBox *trak;
@@ -65,11 +65,7 @@ GF_Err MergeFragment(GF_MovieFragmentBox *moof, GF_ISOFile *mov)
 			traf->trex = NULL;
 		} else {
 			trak = gf_isom_get_track_from_id(mov->moov, traf->tfhd->trackID);
-			j=0;
-			while ((traf->trex = (GF_TrackExtendsBox*)gf_list_enum(mov->moov->mvex->TrackExList, &j))) {
-				if (traf->trex->trackID == traf->tfhd->trackID) break;
-				traf->trex = NULL;
-			}
+			traf->trex = GetTrex(mov->moov, traf->tfhd->trackID);
 		}
 
 		if (!trak || !traf->trex) {
@@ -169,6 +165,177 @@ static void FixSDTPInTRAF(GF_MovieFragmentBox *moof)
 	}
 }
 
+/*indexed mode: replaces the samples of the previous fragment by the ones of this fragment in the sample tables, and records
+the sample count and decode time of each track at the start of the fragment*/
+static GF_Err IndexFragment(GF_MovieFragmentBox *moof, GF_ISOFile *mov)
+{
+	GF_Err e;
+	u32 i, count;
+	GF_FragmentIndexEntry *ent;
+
+	if (!mov->moov || !mov->moov->mvex) return MergeFragment(moof, mov);
+	count = gf_list_count(mov->moov->trackList);
+
+	if (!mov->nb_frag_index) {
+		/*samples described in the moov cannot be reloaded once removed from the tables*/
+		for (i=0; i<count; i++) {
+			GF_TrackBox *trak = (GF_TrackBox *)gf_list_get(mov->moov->trackList, i);
+			if (trak->Media->information->sampleTable->SampleSize && trak->Media->information->sampleTable->SampleSize->sampleCount) {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[iso file] Movie holds samples, merging movie fragments instead of indexing them\n"));
+				mov->index_fragments = GF_FALSE;
+				return MergeFragment(moof, mov);
+			}
+		}
+	}
+
+	if (mov->nb_frag_index == mov->frag_index_alloc) {
+		u32 alloc = mov->frag_index_alloc ? 2*mov->frag_index_alloc : 64;
+		GF_FragmentIndexEntry *entries = (GF_FragmentIndexEntry *)gf_realloc(mov->frag_index, sizeof(GF_FragmentIndexEntry)*alloc);
+		if (!entries) return GF_OUT_OF_MEM;
+		mov->frag_index = entries;
+		mov->frag_index_alloc = alloc;
+	}
+	ent = &mov->frag_index[mov->nb_frag_index];
+	memset(ent, 0, sizeof(GF_FragmentIndexEntry));
+	ent->moof_offset = mov->current_top_box_start;
+	ent->sample_start = (u32 *)gf_malloc(sizeof(u32)*count);
+	ent->dts_start = (u64 *)gf_malloc(sizeof(u64)*count);
+	if (!ent->sample_start || !ent->dts_start) {
+		e = GF_OUT_OF_MEM;
+		goto exit;
+	}
+
+	/*sample count and decode time of the dropped samples are cumulated in the tracks*/
+	e = gf_isom_reset_tables(mov, GF_FALSE);
+	if (e) goto exit;
+	e = MergeFragment(moof, mov);
+	if (e) goto exit;
+
+	for (i=0; i<count; i++) {
+		GF_TrackBox *trak = (GF_TrackBox *)gf_list_get(mov->moov->trackList, i);
+		ent->sample_start[i] = trak->sample_count_at_seg_start;
+		ent->dts_start[i] = trak->dts_at_seg_start;
+		trak->nb_indexed_samples = trak->sample_count_at_seg_start + trak->Media->information->sampleTable->SampleSize->sampleCount;
+		trak->indexed_fragment = mov->nb_frag_index + 1;
+	}
+	mov->nb_frag_index++;
+	return GF_OK;
+
+exit:
+	if (ent->sample_start) gf_free(ent->sample_start);
+	if (ent->dts_start) gf_free(ent->dts_start);
+	return e;
+}
+
+/*indexed mode: loads the given fragment in the sample tables of the track*/
+static GF_Err LoadIndexedFragment(GF_TrackBox *trak, u32 frag_idx)
+{
+	GF_Err e;
+	u32 i, track_idx;
+	u64 pos;
+	GF_Box *a = NULL;
+	GF_MovieFragmentBox *moof;
+	GF_TrackFragmentBox *traf;
+	GF_ISOFile *mov = trak->moov->mov;
+	GF_FragmentIndexEntry *ent = &mov->frag_index[frag_idx];
+
+	if (!mov->movieFileMap) return GF_ISOM_INVALID_FILE;
+	track_idx = gf_list_find(mov->moov->trackList, trak);
+
+	pos = gf_bs_get_position(mov->movieFileMap->bs);
+	gf_bs_seek(mov->movieFileMap->bs, ent->moof_offset);
+	e = gf_isom_parse_box_ex(&a, mov->movieFileMap->bs, 0, GF_TRUE);
+	if (!e && (a->type != GF_ISOM_BOX_TYPE_MOOF)) e = GF_ISOM_INVALID_FILE;
+	if (e) {
+		if (a) gf_isom_box_del(a);
+		gf_bs_seek(mov->movieFileMap->bs, pos);
+		return e;
+	}
+	moof = (GF_MovieFragmentBox *)a;
+	moof->mov = mov;
+
+	/*same fixes as when the fragment was first parsed*/
+	mov->moof = moof;
+	FixTrackID(mov);
+	FixSDTPInTRAF(moof);
+	mov->moof = NULL;
+
+	Track_ResetSampleTables(trak);
+	trak->sample_count_at_seg_start = ent->sample_start[track_idx];
+	trak->dts_at_seg_start = ent->dts_start[track_idx];
+
+	i=0;
+	while ((traf = (GF_TrackFragmentBox*)gf_list_enum(moof->TrackList, &i))) {
+		if (!traf->tfhd || (traf->tfhd->trackID != trak->Header->trackID)) continue;
+		traf->trex = GetTrex(mov->moov, traf->tfhd->trackID);
+		if (!traf->trex) {
+			e = GF_ISOM_INVALID_FILE;
+			break;
+		}
+		e = MergeTrack(trak, traf, ent->moof_offset, GF_FALSE);
+		if (e) break;
+	}
+	gf_isom_box_del(a);
+	gf_bs_seek(mov->movieFileMap->bs, pos);
+
+	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Failed to load fragment %d of track %d: %s\n", frag_idx+1, trak->Header->trackID, gf_error_to_string(e) ));
+		Track_ResetSampleTables(trak);
+		trak->indexed_fragment = 0;
+		return e;
+	}
+	trak->indexed_fragment = frag_idx + 1;
+	return GF_OK;
+}
+
+GF_Err Track_LoadFragmentForSample(GF_TrackBox *trak, u32 sampleNumber)
+{
+	u32 track_idx, low, high;
+	GF_ISOFile *mov = trak->moov ? trak->moov->mov : NULL;
+	if (!mov || !mov->nb_frag_index) return GF_OK;
+	if (!sampleNumber || (sampleNumber > trak->nb_indexed_samples)) return GF_OK;
+
+	if (trak->indexed_fragment && (sampleNumber > trak->sample_count_at_seg_start)
+	        && (sampleNumber <= trak->sample_count_at_seg_start + trak->Media->information->sampleTable->SampleSize->sampleCount))
+		return GF_OK;
+
+	/*last fragment starting before the sample*/
+	track_idx = gf_list_find(mov->moov->trackList, trak);
+	low = 0;
+	high = mov->nb_frag_index;
+	while (high - low > 1) {
+		u32 mid = (low + high) / 2;
+		if (mov->frag_index[mid].sample_start[track_idx] < sampleNumber) low = mid;
+		else high = mid;
+	}
+	return LoadIndexedFragment(trak, low);
+}
+
+GF_Err Track_LoadFragmentForTime(GF_TrackBox *trak, u64 DTS)
+{
+	u32 track_idx, low, high;
+	GF_ISOFile *mov = trak->moov ? trak->moov->mov : NULL;
+	if (!mov || !mov->nb_frag_index) return GF_OK;
+
+	/*last fragment starting at or before the time*/
+	track_idx = gf_list_find(mov->moov->trackList, trak);
+	low = 0;
+	high = mov->nb_frag_index;
+	while (high - low > 1) {
+		u32 mid = (low + high) / 2;
+		if (mov->frag_index[mid].dts_start[track_idx] <= DTS) low = mid;
+		else high = mid;
+	}
+	/*skip fragments without samples for this track*/
+	while (low) {
+		u32 next_start = (low+1 < mov->nb_frag_index) ? mov->frag_index[low+1].sample_start[track_idx] : trak->nb_indexed_samples;
+		if (next_start > mov->frag_index[low].sample_start[track_idx]) break;
+		low--;
+	}
+	if (trak->indexed_fragment == low+1) return GF_OK;
+	return LoadIndexedFragment(trak, low);
+}
+
 #endif
 
 GF_Err gf_isom_parse_movie_boxes(GF_ISOFile *mov, u64 *bytesMissing, Bool progressive_mode)
@@ -198,7 +365,16 @@ GF_Err gf_isom_parse_movie_boxes(GF_ISOFile *mov, u64 *bytesMissing, Bool progre
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[iso file] Current top box start before parsing %d\n", mov->current_top_box_start));
 #endif
 
+		/*in read mode, large sample tables are only parsed when the track is accessed*/
+		if ((mov->openMode == GF_ISOM_OPEN_READ)
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+		        && !(mov->FragmentsFlags & GF_ISOM_FRAG_READ_DEBUG)
+#endif
+		   ) {
+			gf_bs_set_cookie(mov->movieFileMap->bs, GF_ISOM_BS_COOKIE_LAZY_TABLES);
+		}
 		e = gf_isom_parse_root_box(&a, mov->movieFileMap->bs, bytesMissing, progressive_mode);
+		gf_bs_set_cookie(mov->movieFileMap->bs, 0);
 
 		if (e >= 0) {
 			e = GF_OK;
@@ -224,7 +400,15 @@ GF_Err gf_isom_parse_movie_boxes(GF_ISOFile *mov, u64 *bytesMissing, Bool progre
 			/*set our pointer to the movie*/
 			mov->moov->mov = mov;
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
-			if (mov->moov->mvex) mov->moov->mvex->mov = mov;
+			if (mov->moov->mvex) {
+				u32 k;
+				mov->moov->mvex->mov = mov;
+				/*fragments are merged in the sample tables and the movie file map may change with segments, load them now*/
+				for (k=0; k<gf_list_count(mov->moov->trackList); k++) {
+					e = Track_LoadSampleTables((GF_TrackBox *)gf_list_get(mov->moov->trackList, k));
+					if (e) return e;
+				}
+			}
 #endif
 			e = gf_list_add(mov->TopBoxes, a);
 			if (e) {
@@ -250,6 +434,16 @@ GF_Err gf_isom_parse_movie_boxes(GF_ISOFile *mov, u64 *bytesMissing, Bool progre
 		/*we only keep the MDAT in READ for dump purposes*/
 		case GF_ISOM_BOX_TYPE_MDAT:
 			totSize += a->size;
+#ifndef GPAC_DISABLE_ISOM_WRITE
+			if (mov->openMode == GF_ISOM_OPEN_EDIT) {
+				/*remember where the media data is located for moov relocation*/
+				if (!mov->nb_original_mdat) {
+					mov->original_mdat_size = ((GF_MediaDataBox *)a)->dataSize;
+					mov->original_mdat_offset = gf_bs_get_position(mov->movieFileMap->bs) - mov->original_mdat_size;
+				}
+				mov->nb_original_mdat++;
+			}
+#endif
 			if (mov->openMode == GF_ISOM_OPEN_READ) {
 				if (!mov->mdat) {
 					mov->mdat = (GF_MediaDataBox *) a;
@@ -357,14 +551,8 @@ GF_Err gf_isom_parse_movie_boxes(GF_ISOFile *mov, u64 *bytesMissing, Bool progre
 						GF_TrackFragmentBox *traf = gf_list_get(mov->moof->TrackList, k);
 						if (traf->tfhd) {
 							GF_TrackBox *trak = gf_isom_get_track_from_id(mov->moov, traf->tfhd->trackID);
-							u32 j=0;
-							while ((traf->trex = (GF_TrackExtendsBox*)gf_list_enum(mov->moov->mvex->TrackExList, &j))) {
-								if (traf->trex->trackID == traf->tfhd->trackID) {
-									if (!traf->trex->track) traf->trex->track = trak;
-									break;
-								}
-								traf->trex = NULL;
-							}
+							traf->trex = GetTrex(mov->moov, traf->tfhd->trackID);
+							if (traf->trex && !traf->trex->track) traf->trex->track = trak;
 						}
 						//we should only parse senc/psec when no saiz/saio is present, otherwise we fetch the info directly
 						if (traf->trex && traf->trex->track && (traf->piff_sample_encryption || traf->sample_encryption)) {
@@ -377,6 +565,10 @@ GF_Err gf_isom_parse_movie_boxes(GF_ISOFile *mov, u64 *bytesMissing, Bool progre
 				mov->NextMoofNumber = mov->moof->mfhd->sequence_number+1;
 				mov->moof = NULL;
 				gf_isom_box_del(a);
+			} else if (mov->index_fragments) {
+				/*only keep an index of the fragment*/
+				e = IndexFragment((GF_MovieFragmentBox *)a, mov);
+				gf_isom_box_del(a);
 			} else {
 				/*merge all info*/
 				e = MergeFragment((GF_MovieFragmentBox *)a, mov);
@@ -501,7 +693,7 @@ GF_ISOFile *gf_isom_open_file(const char *fileName, u32 OpenMode, const char *tm
 	mov->fileName = gf_strdup(fileName);
 	mov->openMode = OpenMode;
 
-	if ( (OpenMode == GF_ISOM_OPEN_READ) || (OpenMode == GF_ISOM_OPEN_READ_DUMP) ) {
+	if ( (OpenMode == GF_ISOM_OPEN_READ) || (OpenMode == GF_ISOM_OPEN_READ_DUMP) || (OpenMode == GF_ISOM_OPEN_READ_MMAP) || (OpenMode == GF_ISOM_OPEN_READ_INDEXED) ) {
 		//always in read ...
 		mov->openMode = GF_ISOM_OPEN_READ;
 		mov->es_id_default_sync = -1;
@@ -511,7 +703,7 @@ GF_ISOFile *gf_isom_open_file(const char *fileName, u32 OpenMode, const char *tm
 		//the bitstream IS PART OF the GF_DataMap
 		//as this is read-only, use a FileMapping. this is the only place where
 		//we use file mapping
-		e = gf_isom_datamap_new(fileName, NULL, GF_ISOM_DATA_MAP_READ_ONLY, &mov->movieFileMap);
+		e = gf_isom_datamap_new(fileName, NULL, (OpenMode == GF_ISOM_OPEN_READ_MMAP) ? GF_ISOM_DATA_MAP_READ_MMAP : GF_ISOM_DATA_MAP_READ_ONLY, &mov->movieFileMap);
 		if (e) {
 			gf_isom_set_last_error(NULL, e);
 			gf_isom_delete_movie(mov);
@@ -520,6 +712,7 @@ GF_ISOFile *gf_isom_open_file(const char *fileName, u32 OpenMode, const char *tm
 
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
 		if (OpenMode == GF_ISOM_OPEN_READ_DUMP) mov->FragmentsFlags |= GF_ISOM_FRAG_READ_DEBUG;
+		if (OpenMode == GF_ISOM_OPEN_READ_INDEXED) mov->index_fragments = GF_TRUE;
 #endif
 
 	} else {
@@ -605,6 +798,14 @@ void gf_isom_delete_movie(GF_ISOFile *mov)
 	gf_isom_box_array_del(mov->TopBoxes);
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
 	gf_isom_box_array_del(mov->moof_list);
+	if (mov->frag_index) {
+		u32 i;
+		for (i=0; i<mov->nb_frag_index; i++) {
+			gf_free(mov->frag_index[i].sample_start);
+			gf_free(mov->frag_index[i].dts_start);
+		}
+		gf_free(mov->frag_index);
+	}
 #endif
 	if (mov->last_producer_ref_time)
 		gf_isom_box_del((GF_Box *) mov->last_producer_ref_time);
@@ -612,20 +813,142 @@ void gf_isom_delete_movie(GF_ISOFile *mov)
 	gf_free(mov);
 }
 
-GF_TrackBox *gf_isom_get_track_from_id(GF_MovieBox *moov, u32 trackID)
+/*below this number of boxes, track ID lookups are done by browsing the list*/
+#define TRACKID_MAP_MIN_BOXES	8
+
+#define TRACKID_MAP_HASH(_id, _size)	(((_id) * 2654435761U) & ((_size) - 1))
+
+static u32 trackid_map_get_id(GF_Box *a)
+{
+	switch (a->type) {
+	case GF_ISOM_BOX_TYPE_TRAK:
+		return ((GF_TrackBox *)a)->Header ? ((GF_TrackBox *)a)->Header->trackID : 0;
+#ifndef GPAC_DISABLE_ISOM_FRAGMENTS
+	case GF_ISOM_BOX_TYPE_TRAF:
+		return ((GF_TrackFragmentBox *)a)->tfhd ? ((GF_TrackFragmentBox *)a)->tfhd->trackID : 0;
+	case GF_ISOM_BOX_TYPE_TREX:
+		return ((GF_TrackExtendsBox *)a)->trackID;
+#endif
+	default:
+		return 0;
+	}
+}
+
+static GF_Box *trackid_map_browse(GF_List *boxes, u32 trackID, u32 *pos)
 {
 	u32 i, count;
-	GF_TrackBox *trak;
-	if (!moov || !trackID) return NULL;
+	GF_Box *a, *found = NULL;
+	count = gf_list_count(boxes);
+	for (i=0; i<count; i++) {
+		a = (GF_Box *)gf_list_get(boxes, i);
+		if (trackid_map_get_id(a) != trackID) continue;
+		found = a;
+		if (pos) *pos = i+1;
+		/*there may be more than one traf per track, use the last one*/
+		if (a->type != GF_ISOM_BOX_TYPE_TRAF) break;
+	}
+	return found;
+}
 
-	count = gf_list_count(moov->trackList);
-	for (i = 0; i<count; i++) {
-		trak = (GF_TrackBox*)gf_list_get(moov->trackList, i);
-		if (trak->Header->trackID == trackID) return trak;
+static GF_Err trackid_map_build(GF_TrackIDMap *map, GF_List *boxes)
+{
+	u32 i, k, count, size;
+	count = gf_list_count(boxes);
+	size = 16;
+	while (size < 2*count) size *= 2;
+	if (size != map->size) {
+		u32 *entries = (u32 *)gf_realloc(map->entries, sizeof(u32) * 2 * size);
+		if (!entries) return GF_OUT_OF_MEM;
+		map->entries = entries;
+		map->size = size;
+	}
+	memset(map->entries, 0, sizeof(u32) * 2 * size);
+
+	for (i=0; i<count; i++) {
+		GF_Box *a = (GF_Box *)gf_list_get(boxes, i);
+		u32 ID = trackid_map_get_id(a);
+		if (!ID) continue;
+		k = TRACKID_MAP_HASH(ID, size);
+		while (map->entries[2*k+1] && (map->entries[2*k] != ID)) k = (k+1) & (size-1);
+		/*same ID already present: keep the first trak/trex and the last traf*/
+		if (map->entries[2*k+1] && (a->type != GF_ISOM_BOX_TYPE_TRAF)) continue;
+		map->entries[2*k] = ID;
+		map->entries[2*k+1] = i+1;
+	}
+	map->boxes = boxes;
+	map->nb_boxes = count;
+	return GF_OK;
+}
+
+GF_Box *gf_isom_trackid_map_find(GF_TrackIDMap **map, GF_List *boxes, u32 trackID, u32 *pos)
+{
+	u32 k, count;
+	Bool rebuilt = GF_FALSE;
+	GF_TrackIDMap *m;
+
+	if (pos) *pos = 0;
+	if (!boxes || !trackID) return NULL;
+
+	count = gf_list_count(boxes);
+	if (count < TRACKID_MAP_MIN_BOXES) return trackid_map_browse(boxes, trackID, pos);
+
+	m = *map;
+	if (!m) {
+		GF_SAFEALLOC(m, GF_TrackIDMap);
+		if (!m) return trackid_map_browse(boxes, trackID, pos);
+		*map = m;
+	}
+	if ((m->boxes != boxes) || (m->nb_boxes != count)) {
+		if (trackid_map_build(m, boxes) != GF_OK) {
+			m->boxes = NULL;
+			return trackid_map_browse(boxes, trackID, pos);
+		}
+		rebuilt = GF_TRUE;
+	}
+
+	while (1) {
+		GF_Box *a;
+		k = TRACKID_MAP_HASH(trackID, m->size);
+		while (m->entries[2*k+1] && (m->entries[2*k] != trackID)) k = (k+1) & (m->size-1);
+		if (!m->entries[2*k+1]) return NULL;
+
+		/*check the entry against the box, boxes may have been replaced or renumbered since the table was built*/
+		a = (GF_Box *)gf_list_get(boxes, m->entries[2*k+1] - 1);
+		if (a && (trackid_map_get_id(a) == trackID)) {
+			if (pos) *pos = m->entries[2*k+1];
+			return a;
+		}
+		if (rebuilt || (trackid_map_build(m, boxes) != GF_OK)) {
+			m->boxes = NULL;
+			return trackid_map_browse(boxes, trackID, pos);
+		}
+		rebuilt = GF_TRUE;
 	}
 	return NULL;
 }
 
+void gf_isom_trackid_map_reset(GF_TrackIDMap *map)
+{
+	if (map) map->boxes = NULL;
+}
+
+void gf_isom_trackid_map_del(GF_TrackIDMap *map)
+{
+	if (!map) return;
+	if (map->entries) gf_free(map->entries);
+	gf_free(map);
+}
+
+GF_TrackBox *gf_isom_get_track_from_id(GF_MovieBox *moov, u32 trackID)
+{
+	GF_TrackBox *trak;
+	if (!moov || !trackID) return NULL;
+
+	trak = (GF_TrackBox *)gf_isom_trackid_map_find(&moov->track_map, moov->trackList, trackID, NULL);
+	if (trak) Track_LoadSampleTables(trak);
+	return trak;
+}
+
 GF_TrackBox *gf_isom_get_track_from_original_id(GF_MovieBox *moov, u32 originalID, u32 originalFile)
 {
 	u32 i, count;
@@ -85,7 +85,7 @@ GF_EXPORT
 void gf_isom_sample_del(GF_ISOSample **samp)
 {
 	if (! *samp) return;
-	if ((*samp)->data && (*samp)->dataLength) gf_free((*samp)->data);
+	if ((*samp)->data && ((*samp)->dataLength || (*samp)->alloc_size)) gf_free((*samp)->data);
 	gf_free(*samp);
 	*samp = NULL;
 }
@@ -213,6 +213,8 @@ GF_ISOFile *gf_isom_open(const char *fileName, u32 OpenMode, const char *tmp_dir
 	switch (OpenMode & 0xFF) {
 	case GF_ISOM_OPEN_READ_DUMP:
 	case GF_ISOM_OPEN_READ:
+	case GF_ISOM_OPEN_READ_MMAP:
+	case GF_ISOM_OPEN_READ_INDEXED:
 		movie = gf_isom_open_file(fileName, OpenMode, NULL);
 		break;
 
@@ -417,19 +419,8 @@ u32 gf_isom_get_track_id(GF_ISOFile *movie, u32 trackNumber)
 GF_EXPORT
 u32 gf_isom_get_track_by_id(GF_ISOFile *the_file, u32 trackID)
 {
-	GF_TrackBox *trak;
-	u32 count;
-	u32 i;
 	if (the_file == NULL) return 0;
-
-	count = gf_isom_get_track_count(the_file);
-	if (!count) return 0;
-	for (i = 0; i < count; i++) {
-		trak = gf_isom_get_track_from_file(the_file, i+1);
-		if (!trak) return 0;
-		if (trak->Header->trackID == trackID) return i+1;
-	}
-	return 0;
+	return gf_isom_get_tracknum_from_id(the_file->moov, trackID);
 }
 
 GF_EXPORT
@@ -1238,6 +1229,9 @@ u32 gf_isom_get_sample_count(GF_ISOFile *the_file, u32 trackNumber)
 	GF_TrackBox *trak;
 	trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !trak->Media->information->sampleTable->SampleSize) return 0;
+#ifndef GPAC_DISABLE_ISOM_FRAGMENTS
+	if (the_file->nb_frag_index) return trak->nb_indexed_samples;
+#endif
 	return trak->Media->information->sampleTable->SampleSize->sampleCount
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
 	       + trak->sample_count_at_seg_start
@@ -1321,12 +1315,13 @@ GF_ISOSample *gf_isom_get_sample(GF_ISOFile *the_file, u32 trackNumber, u32 samp
 	if (!samp) return NULL;
 
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	Track_LoadFragmentForSample(trak, sampleNumber);
 	if (sampleNumber<=trak->sample_count_at_seg_start)
 		return NULL;
 	sampleNumber -= trak->sample_count_at_seg_start;
 #endif
 
-	e = Media_GetSample(trak->Media, sampleNumber, &samp, &descIndex, GF_FALSE, NULL);
+	e = Media_GetSample(trak->Media, sampleNumber, &samp, &descIndex, GF_FALSE, NULL, NULL);
 	if (e) {
 		gf_isom_set_last_error(the_file, e);
 		gf_isom_sample_del(&samp);
@@ -1340,6 +1335,90 @@ GF_ISOSample *gf_isom_get_sample(GF_ISOFile *the_file, u32 trackNumber, u32 samp
 	return samp;
 }
 
+GF_EXPORT
+GF_ISOSample *gf_isom_get_sample_ex(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *sampleDescriptionIndex, Bool *is_mapped)
+{
+	GF_Err e;
+	u32 descIndex;
+	GF_TrackBox *trak;
+	GF_ISOSample *samp;
+	Bool mapped = GF_FALSE;
+
+	if (is_mapped) *is_mapped = GF_FALSE;
+	trak = gf_isom_get_track_from_file(the_file, trackNumber);
+	if (!trak) return NULL;
+
+	if (!sampleNumber) return NULL;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	Track_LoadFragmentForSample(trak, sampleNumber);
+	if (sampleNumber<=trak->sample_count_at_seg_start)
+		return NULL;
+	sampleNumber -= trak->sample_count_at_seg_start;
+#endif
+	samp = gf_isom_sample_new();
+	if (!samp) return NULL;
+
+	e = Media_GetSample(trak->Media, sampleNumber, &samp, &descIndex, GF_FALSE, NULL, is_mapped ? &mapped : NULL);
+	if (e) {
+		gf_isom_set_last_error(the_file, e);
+		if (mapped) samp->data = NULL;
+		gf_isom_sample_del(&samp);
+		return NULL;
+	}
+	if (is_mapped) *is_mapped = mapped;
+	if (sampleDescriptionIndex) *sampleDescriptionIndex = descIndex;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	samp->DTS += trak->dts_at_seg_start;
+#endif
+	return samp;
+}
+
+GF_EXPORT
+GF_Err gf_isom_get_sample_static(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *sampleDescriptionIndex, GF_ISOSample *static_sample)
+{
+	GF_Err e;
+	u32 descIndex;
+	GF_TrackBox *trak;
+
+	if (!static_sample || !sampleNumber) return GF_BAD_PARAM;
+	trak = gf_isom_get_track_from_file(the_file, trackNumber);
+	if (!trak) return GF_BAD_PARAM;
+
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	Track_LoadFragmentForSample(trak, sampleNumber);
+	if (sampleNumber<=trak->sample_count_at_seg_start)
+		return GF_BAD_PARAM;
+	sampleNumber -= trak->sample_count_at_seg_start;
+#endif
+
+	e = Media_GetSample(trak->Media, sampleNumber, &static_sample, &descIndex, GF_FALSE, NULL, NULL);
+	/*buffer allocated by the first fetch (or by sample rewriting), start tracking its size*/
+	if (static_sample->data && !static_sample->alloc_size) {
+		if (!e && static_sample->dataLength) {
+			static_sample->alloc_size = static_sample->dataLength;
+		} else {
+			gf_free(static_sample->data);
+			static_sample->data = NULL;
+		}
+	}
+	if (e) {
+		gf_isom_set_last_error(the_file, e);
+		return e;
+	}
+	if (sampleDescriptionIndex) *sampleDescriptionIndex = descIndex;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	static_sample->DTS += trak->dts_at_seg_start;
+#endif
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_isom_set_access_hint(GF_ISOFile *the_file, u32 hint)
+{
+	if (!the_file || !the_file->movieFileMap) return GF_BAD_PARAM;
+	return gf_isom_datamap_set_access_hint(the_file->movieFileMap, hint);
+}
+
 GF_EXPORT
 u32 gf_isom_get_sample_duration(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber)
 {
@@ -1348,6 +1427,7 @@ u32 gf_isom_get_sample_duration(GF_ISOFile *the_file, u32 trackNumber, u32 sampl
 	GF_TrackBox *trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !sampleNumber) return 0;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	Track_LoadFragmentForSample(trak, sampleNumber);
 	if (sampleNumber<=trak->sample_count_at_seg_start) return 0;
 	sampleNumber -= trak->sample_count_at_seg_start;
 #endif
@@ -1364,6 +1444,7 @@ u32 gf_isom_get_sample_size(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNum
 	GF_TrackBox *trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !sampleNumber) return 0;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	Track_LoadFragmentForSample(trak, sampleNumber);
 	if (sampleNumber<=trak->sample_count_at_seg_start) return 0;
 	sampleNumber -= trak->sample_count_at_seg_start;
 #endif
@@ -1379,6 +1460,9 @@ u8 gf_isom_get_sample_sync(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumb
 	GF_TrackBox *trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !sampleNumber) return 0;
 
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	Track_LoadFragmentForSample(trak, sampleNumber);
+#endif
 	if (! trak->Media->information->sampleTable->SyncSample) return 1;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
 	if (sampleNumber<=trak->sample_count_at_seg_start) return 0;
@@ -1401,12 +1485,13 @@ GF_ISOSample *gf_isom_get_sample_info(GF_ISOFile *the_file, u32 trackNumber, u32
 
 	if (!sampleNumber) return NULL;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	Track_LoadFragmentForSample(trak, sampleNumber);
 	if (sampleNumber<=trak->sample_count_at_seg_start) return NULL;
 	sampleNumber -= trak->sample_count_at_seg_start;
 #endif
 	samp = gf_isom_sample_new();
 	if (!samp) return NULL;
-	e = Media_GetSample(trak->Media, sampleNumber, &samp, sampleDescriptionIndex, GF_TRUE, data_offset);
+	e = Media_GetSample(trak->Media, sampleNumber, &samp, sampleDescriptionIndex, GF_TRUE, data_offset, NULL);
 	if (e) {
 		gf_isom_set_last_error(the_file, e);
 		gf_isom_sample_del(&samp);
@@ -1429,10 +1514,14 @@ u64 gf_isom_get_sample_dts(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumb
 
 	if (!sampleNumber) return 0;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	Track_LoadFragmentForSample(trak, sampleNumber);
 	if (sampleNumber<=trak->sample_count_at_seg_start) return 0;
 	sampleNumber -= trak->sample_count_at_seg_start;
 #endif
 	if (stbl_GetSampleDTS(trak->Media->information->sampleTable->TimeToSample, sampleNumber, &dts) != GF_OK) return 0;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	dts += trak->dts_at_seg_start;
+#endif
 	return dts;
 }
 
@@ -1465,6 +1554,32 @@ u32 gf_isom_get_sample_from_dts(GF_ISOFile *the_file, u32 trackNumber, u64 dts)
 }
 
 
+GF_EXPORT
+GF_Err gf_isom_enable_sample_index(GF_ISOFile *the_file, u32 trackNumber, Bool enable)
+{
+	GF_TrackBox *trak;
+	GF_SampleTableBox *stbl;
+
+	trak = gf_isom_get_track_from_file(the_file, trackNumber);
+	if (!trak) return GF_BAD_PARAM;
+	//tables may be modified in place in edit modes
+	if (the_file->openMode != GF_ISOM_OPEN_READ) return GF_ISOM_INVALID_MODE;
+
+	stbl = trak->Media->information->sampleTable;
+	stbl->use_index = enable;
+	if (enable) stbl_CheckIndex(stbl);
+	else stbl_ResetIndex(stbl);
+	return GF_OK;
+}
+
+GF_EXPORT
+u32 gf_isom_get_sample_index_size(GF_ISOFile *the_file, u32 trackNumber)
+{
+	GF_TrackBox *trak = gf_isom_get_track_from_file(the_file, trackNumber);
+	if (!trak) return 0;
+	return stbl_GetIndexSize(trak->Media->information->sampleTable);
+}
+
 //return a sample given a desired display time IN MEDIA TIME SCALE
 //and set the StreamDescIndex of this sample
 //this index allows to retrieve the stream description if needed (2 media in 1 track)
@@ -1486,6 +1601,10 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 	trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak) return GF_BAD_PARAM;
 
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	e = Track_LoadFragmentForTime(trak, desiredTime);
+	if (e) return e;
+#endif
 	stbl = trak->Media->information->sampleTable;
 
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
@@ -1591,7 +1710,7 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 		}
 	}
 
-	e = Media_GetSample(trak->Media, sampleNumber, sample, StreamDescriptionIndex, GF_FALSE, NULL);
+	e = Media_GetSample(trak->Media, sampleNumber, sample, StreamDescriptionIndex, GF_FALSE, NULL, NULL);
 	if (e) {
 		gf_isom_sample_del(sample);
 		return e;
@@ -2368,18 +2487,58 @@ GF_Err gf_isom_reset_data_offset(GF_ISOFile *movie, u64 *top_box_start)
     }\
  
 
+void Track_ResetSampleTables(GF_TrackBox *trak)
+{
+	u32 j, type;
+	GF_Box *a;
+	GF_SampleTableBox *stbl = trak->Media->information->sampleTable;
+
+	RECREATE_BOX(stbl->ChunkOffset, (GF_Box *));
+	RECREATE_BOX(stbl->CompositionOffset, (GF_CompositionOffsetBox *));
+	RECREATE_BOX(stbl->DegradationPriority, (GF_DegradationPriorityBox *));
+	RECREATE_BOX(stbl->PaddingBits, (GF_PaddingBitsBox *));
+	RECREATE_BOX(stbl->SampleDep, (GF_SampleDependencyTypeBox *));
+	RECREATE_BOX(stbl->SampleSize, (GF_SampleSizeBox *));
+	RECREATE_BOX(stbl->SampleToChunk, (GF_SampleToChunkBox *));
+	RECREATE_BOX(stbl->ShadowSync, (GF_ShadowSyncBox *));
+	RECREATE_BOX(stbl->SyncSample, (GF_SyncSampleBox *));
+	RECREATE_BOX(stbl->TimeToSample, (GF_TimeToSampleBox *));
+
+	gf_isom_box_array_del(stbl->sai_offsets);
+	stbl->sai_offsets = NULL;
+
+	gf_isom_box_array_del(stbl->sai_sizes);
+	stbl->sai_sizes = NULL;
+
+	gf_isom_box_array_del(stbl->sampleGroups);
+	stbl->sampleGroups = NULL;
+
+	j = stbl->nb_sgpd_in_stbl;
+	while ((a = (GF_Box *)gf_list_enum(stbl->sampleGroupsDescription, &j))) {
+		gf_isom_box_del(a);
+		j--;
+		gf_list_rem(stbl->sampleGroupsDescription, j);
+	}
+
+	j = stbl->nb_other_boxes_in_stbl;
+	while ((a = (GF_Box *)gf_list_enum(stbl->other_boxes, &j))) {
+		gf_isom_box_del(a);
+		j--;
+		gf_list_rem(stbl->other_boxes, j);
+	}
+}
+
 GF_EXPORT
 GF_Err gf_isom_reset_tables(GF_ISOFile *movie, Bool reset_sample_count)
 {
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
-	u32 i, j;
-	GF_Box *a;
+	u32 i;
 
 	if (!movie || !movie->moov || !movie->moov->mvex) return GF_BAD_PARAM;
 	for (i=0; i<gf_list_count(movie->moov->trackList); i++) {
 		GF_TrackBox *trak = (GF_TrackBox *)gf_list_get(movie->moov->trackList, i);
 
-		u32 type, dur;
+		u32 dur;
 		u64 dts;
 		GF_SampleTableBox *stbl = trak->Media->information->sampleTable;
 
@@ -2392,39 +2551,7 @@ GF_Err gf_isom_reset_tables(GF_ISOFile *movie, Bool reset_sample_count)
 			}
 		}
 
-		RECREATE_BOX(stbl->ChunkOffset, (GF_Box *));
-		RECREATE_BOX(stbl->CompositionOffset, (GF_CompositionOffsetBox *));
-		RECREATE_BOX(stbl->DegradationPriority, (GF_DegradationPriorityBox *));
-		RECREATE_BOX(stbl->PaddingBits, (GF_PaddingBitsBox *));
-		RECREATE_BOX(stbl->SampleDep, (GF_SampleDependencyTypeBox *));
-		RECREATE_BOX(stbl->SampleSize, (GF_SampleSizeBox *));
-		RECREATE_BOX(stbl->SampleToChunk, (GF_SampleToChunkBox *));
-		RECREATE_BOX(stbl->ShadowSync, (GF_ShadowSyncBox *));
-		RECREATE_BOX(stbl->SyncSample, (GF_SyncSampleBox *));
-		RECREATE_BOX(stbl->TimeToSample, (GF_TimeToSampleBox *));
-
-		gf_isom_box_array_del(stbl->sai_offsets);
-		stbl->sai_offsets = NULL;
-
-		gf_isom_box_array_del(stbl->sai_sizes);
-		stbl->sai_sizes = NULL;
-
-		gf_isom_box_array_del(stbl->sampleGroups);
-		stbl->sampleGroups = NULL;
-
-		j = stbl->nb_sgpd_in_stbl;
-		while ((a = (GF_Box *)gf_list_enum(stbl->sampleGroupsDescription, &j))) {
-			gf_isom_box_del(a);
-			j--;
-			gf_list_rem(stbl->sampleGroupsDescription, j);
-		}
-
-		j = stbl->nb_other_boxes_in_stbl;
-		while ((a = (GF_Box *)gf_list_enum(stbl->other_boxes, &j))) {
-			gf_isom_box_del(a);
-			j--;
-			gf_list_rem(stbl->other_boxes, j);
-		}
+		Track_ResetSampleTables(trak);
 
 		if (reset_sample_count) {
 			trak->Media->information->sampleTable->SampleSize->sampleCount = 0;
@@ -2468,7 +2595,7 @@ GF_Err gf_isom_release_segment(GF_ISOFile *movie, Bool reset_tables)
 
 
 		if (reset_tables) {
-			u32 type, dur;
+			u32 dur;
 			u64 dts;
 			Bool scalable = has_scalable;
 			GF_SampleTableBox *stbl = trak->Media->information->sampleTable;
@@ -2500,40 +2627,7 @@ GF_Err gf_isom_release_segment(GF_ISOFile *movie, Bool reset_tables)
 				}
 			}
 
-			RECREATE_BOX(stbl->ChunkOffset, (GF_Box *));
-			RECREATE_BOX(stbl->CompositionOffset, (GF_CompositionOffsetBox *));
-			RECREATE_BOX(stbl->DegradationPriority, (GF_DegradationPriorityBox *));
-			RECREATE_BOX(stbl->PaddingBits, (GF_PaddingBitsBox *));
-			RECREATE_BOX(stbl->SampleDep, (GF_SampleDependencyTypeBox *));
-			RECREATE_BOX(stbl->SampleSize, (GF_SampleSizeBox *));
-			RECREATE_BOX(stbl->SampleToChunk, (GF_SampleToChunkBox *));
-			RECREATE_BOX(stbl->ShadowSync, (GF_ShadowSyncBox *));
-			RECREATE_BOX(stbl->SyncSample, (GF_SyncSampleBox *));
-			RECREATE_BOX(stbl->TimeToSample, (GF_TimeToSampleBox *));
-
-			gf_isom_box_array_del(stbl->sai_offsets);
-			stbl->sai_offsets = NULL;
-
-			gf_isom_box_array_del(stbl->sai_sizes);
-			stbl->sai_sizes = NULL;
-
-			gf_isom_box_array_del(stbl->sampleGroups);
-			stbl->sampleGroups = NULL;
-
-			j = stbl->nb_sgpd_in_stbl;
-			while ((a = (GF_Box *)gf_list_enum(stbl->sampleGroupsDescription, &j))) {
-				gf_isom_box_del(a);
-				j--;
-				gf_list_rem(stbl->sampleGroupsDescription, j);
-			}
-
-
-			j = stbl->nb_other_boxes_in_stbl;
-			while ((a = (GF_Box *)gf_list_enum(stbl->other_boxes, &j))) {
-				gf_isom_box_del(a);
-				j--;
-				gf_list_rem(stbl->other_boxes, j);
-			}
+			Track_ResetSampleTables(trak);
 		}
 
 
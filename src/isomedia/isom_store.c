@@ -25,9 +25,18 @@
  */
 
 #include <gpac/internal/isomedia_dev.h>
+#include <gpac/thread.h>
 
 #if !defined(GPAC_DISABLE_ISOM) && !defined(GPAC_DISABLE_ISOM_WRITE)
 
+#if defined(GPAC_CONFIG_LINUX)
+#include <unistd.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <sys/sendfile.h>
+#define GPAC_HAS_RANGE_COPY
+#endif
+
 #define GPAC_ISOM_CPRT_NOTICE "IsoMedia File Produced with GPAC"
 #define GPAC_ISOM_CPRT_NOTICE_VERSION GPAC_ISOM_CPRT_NOTICE" "GPAC_FULL_VERSION
 
@@ -79,12 +88,55 @@ typedef struct
 	GF_Box *stco;
 } TrackWriter;
 
+/*number of blocks in flight in the write pipeline*/
+#define WRITE_PIPE_NUM_BLOCKS	4
+
+typedef struct
+{
+	GF_DataMap *map;
+	u64 offset;
+	u32 size;
+} WritePipeRange;
+
+typedef struct
+{
+	/*ranges of source data in this block, in output order*/
+	WritePipeRange *ranges;
+	u32 nb_ranges, alloc_ranges;
+	/*total size of the ranges*/
+	u32 size;
+	/*payload as read by the reader thread*/
+	char *data;
+	u32 alloc_size;
+	/*last block of the pipeline*/
+	Bool is_last;
+} WritePipeBlock;
+
+typedef struct
+{
+	WritePipeBlock blocks[WRITE_PIPE_NUM_BLOCKS];
+	/*block being planned*/
+	u32 cur_block;
+	u32 block_size;
+	/*blocks available for planning, to read and to write*/
+	GF_Semaphore *free_blocks, *read_blocks, *write_blocks;
+	GF_Thread *reader, *writer;
+	GF_BitStream *bs;
+	/*output file for range copy, NULL if not used*/
+	FILE *out;
+	GF_Err reader_error, writer_error;
+} WritePipe;
+
 typedef struct
 {
 	char *buffer;
 	u32 size;
 	GF_ISOFile *movie;
 	u32 total_samples, nb_done;
+	/*output file, NULL when writing to stdout*/
+	FILE *out;
+	/*pipelined media data copy, only used when writing samples of interleaved files*/
+	WritePipe *pipe;
 } MovieWriter;
 
 void CleanWriters(GF_List *writers)
@@ -348,6 +400,253 @@ u64 GetMoovAndMetaSize(GF_ISOFile *movie, GF_List *writers)
 	return size;
 }
 
+#ifdef GPAC_HAS_RANGE_COPY
+/*copies a range of a regular file at the current position of the output file without going through
+user memory - returns the number of bytes copied*/
+static u64 FileRangeCopy(FILE *out, GF_BitStream *bs, GF_DataMap *map, u64 offset, u64 size)
+{
+	s64 ret;
+	u64 pos;
+	u64 done = 0;
+	int fd_in, fd_out;
+	loff_t off_in, off_out;
+
+	if ((map->type != GF_ISOM_DATA_FILE) || !((GF_FileDataMap *)map)->stream) return 0;
+
+	gf_bs_flush(bs);
+	pos = gf_bs_get_position(bs);
+	fd_in = fileno(((GF_FileDataMap *)map)->stream);
+	fd_out = fileno(out);
+	off_in = (loff_t) offset;
+	off_out = (loff_t) pos;
+
+	while (done < size) {
+#ifdef SYS_copy_file_range
+		ret = syscall(SYS_copy_file_range, fd_in, &off_in, fd_out, &off_out, (size_t) (size - done), 0);
+		if (ret <= 0)
+#endif
+		{
+			/*sendfile uses the current offset of the output file*/
+			if (lseek(fd_out, off_out, SEEK_SET) != off_out) break;
+			ret = sendfile(fd_out, fd_in, &off_in, (size_t) (size - done));
+			if (ret <= 0) break;
+			off_out += ret;
+		}
+		done += (u64) ret;
+	}
+	/*resync the stream position, sendfile may have moved the file offset*/
+	gf_fseek(out, pos, SEEK_SET);
+	if (done) gf_bs_skip_bytes(bs, done);
+
+	/*partial copy (should not happen with regular files): the remaining data is read and written by the caller*/
+	if (done < size) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[iso file] Range copy failed after "LLU" bytes (error %d), using regular IO\n", done, errno));
+	}
+	return done;
+}
+
+static Bool WritePipe_RangeCopy(WritePipe *pipe, WritePipeRange *range)
+{
+	u32 done;
+	if (!pipe->out) return GF_FALSE;
+
+	done = (u32) FileRangeCopy(pipe->out, pipe->bs, range->map, range->offset, range->size);
+	if (done == range->size) return GF_TRUE;
+	range->offset += done;
+	range->size -= done;
+	return GF_FALSE;
+}
+#endif
+
+static u32 WritePipe_Reader(void *par)
+{
+	u32 i, idx = 0;
+	Bool is_last;
+	WritePipe *pipe = (WritePipe *)par;
+
+	while (1) {
+		WritePipeBlock *block;
+		gf_sema_wait(pipe->read_blocks);
+		block = &pipe->blocks[idx];
+		idx = (idx+1) % WRITE_PIPE_NUM_BLOCKS;
+
+		if (!pipe->reader_error && !pipe->out) {
+			char *data;
+			if (block->size > block->alloc_size) {
+				block->data = (char*)gf_realloc(block->data, block->size);
+				block->alloc_size = block->size;
+			}
+			data = block->data;
+			if (!data && block->size) pipe->reader_error = GF_OUT_OF_MEM;
+			for (i=0; i<block->nb_ranges && !pipe->reader_error; i++) {
+				WritePipeRange *range = &block->ranges[i];
+				if (gf_isom_datamap_get_data(range->map, data, range->size, range->offset) != range->size) {
+					pipe->reader_error = GF_IO_ERR;
+					break;
+				}
+				data += range->size;
+			}
+		}
+		/*the block may be reused as soon as it is released*/
+		is_last = block->is_last;
+		gf_sema_notify(pipe->write_blocks, 1);
+		if (is_last) break;
+	}
+	return 0;
+}
+
+static u32 WritePipe_Writer(void *par)
+{
+	u32 i, idx = 0;
+	Bool is_last;
+	WritePipe *pipe = (WritePipe *)par;
+
+	while (1) {
+		WritePipeBlock *block;
+		gf_sema_wait(pipe->write_blocks);
+		block = &pipe->blocks[idx];
+		idx = (idx+1) % WRITE_PIPE_NUM_BLOCKS;
+
+		if (pipe->reader_error) {
+			if (!pipe->writer_error) pipe->writer_error = pipe->reader_error;
+		} else if (!pipe->writer_error) {
+			if (!pipe->out) {
+				if (block->size && (gf_bs_write_data(pipe->bs, block->data, block->size) != block->size))
+					pipe->writer_error = GF_IO_ERR;
+			} else {
+				/*range copy mode, data is not fetched by the reader*/
+				for (i=0; i<block->nb_ranges && !pipe->writer_error; i++) {
+					WritePipeRange *range = &block->ranges[i];
+#ifdef GPAC_HAS_RANGE_COPY
+					if (WritePipe_RangeCopy(pipe, range)) continue;
+#endif
+					if (range->size > block->alloc_size) {
+						block->data = (char*)gf_realloc(block->data, range->size);
+						block->alloc_size = range->size;
+					}
+					if (!block->data) pipe->writer_error = GF_OUT_OF_MEM;
+					else if (gf_isom_datamap_get_data(range->map, block->data, range->size, range->offset) != range->size) pipe->writer_error = GF_IO_ERR;
+					else if (gf_bs_write_data(pipe->bs, block->data, range->size) != range->size) pipe->writer_error = GF_IO_ERR;
+				}
+			}
+		}
+		block->nb_ranges = 0;
+		block->size = 0;
+		is_last = block->is_last;
+		gf_sema_notify(pipe->free_blocks, 1);
+		if (is_last) break;
+	}
+	return 0;
+}
+
+/*sends the current block down the pipeline and waits for the next free one*/
+static GF_Err WritePipe_PushBlock(WritePipe *pipe, Bool is_last)
+{
+	pipe->blocks[pipe->cur_block].is_last = is_last;
+	gf_sema_notify(pipe->read_blocks, 1);
+	pipe->cur_block = (pipe->cur_block+1) % WRITE_PIPE_NUM_BLOCKS;
+	if (is_last) return GF_OK;
+
+	gf_sema_wait(pipe->free_blocks);
+	if (pipe->writer_error) return pipe->writer_error;
+	return pipe->reader_error;
+}
+
+static GF_Err WritePipe_AddRange(WritePipe *pipe, GF_DataMap *map, u64 offset, u32 size)
+{
+	WritePipeBlock *block = &pipe->blocks[pipe->cur_block];
+
+	/*merge contiguous data*/
+	if (block->nb_ranges) {
+		WritePipeRange *prev = &block->ranges[block->nb_ranges-1];
+		if ((prev->map == map) && (prev->offset + prev->size == offset) && (prev->size + size > prev->size)) {
+			prev->size += size;
+			block->size += size;
+			if (block->size >= pipe->block_size) return WritePipe_PushBlock(pipe, GF_FALSE);
+			return GF_OK;
+		}
+	}
+	if (block->nb_ranges == block->alloc_ranges) {
+		block->alloc_ranges = block->alloc_ranges ? 2*block->alloc_ranges : 32;
+		block->ranges = (WritePipeRange*)gf_realloc(block->ranges, sizeof(WritePipeRange)*block->alloc_ranges);
+		if (!block->ranges) return GF_OUT_OF_MEM;
+	}
+	block->ranges[block->nb_ranges].map = map;
+	block->ranges[block->nb_ranges].offset = offset;
+	block->ranges[block->nb_ranges].size = size;
+	block->nb_ranges++;
+	block->size += size;
+	if (block->size >= pipe->block_size) return WritePipe_PushBlock(pipe, GF_FALSE);
+	return GF_OK;
+}
+
+static GF_Err WritePipe_Start(MovieWriter *mw, GF_BitStream *bs)
+{
+	WritePipe *pipe;
+	GF_ISOFile *movie = mw->movie;
+
+	GF_SAFEALLOC(pipe, WritePipe);
+	if (!pipe) return GF_OUT_OF_MEM;
+	pipe->block_size = movie->write_pipe_block_size;
+	pipe->bs = bs;
+#ifdef GPAC_HAS_RANGE_COPY
+	if (movie->write_pipe_range_copy) pipe->out = mw->out;
+#endif
+	/*make sure all edited data is on disk*/
+	gf_isom_datamap_flush(movie->editFileMap);
+
+	pipe->free_blocks = gf_sema_new(WRITE_PIPE_NUM_BLOCKS, WRITE_PIPE_NUM_BLOCKS-1);
+	pipe->read_blocks = gf_sema_new(WRITE_PIPE_NUM_BLOCKS, 0);
+	pipe->write_blocks = gf_sema_new(WRITE_PIPE_NUM_BLOCKS, 0);
+	pipe->reader = gf_th_new("ISOWriteReader");
+	pipe->writer = gf_th_new("ISOWriteWriter");
+	if (!pipe->free_blocks || !pipe->read_blocks || !pipe->write_blocks || !pipe->reader || !pipe->writer) goto err_exit;
+
+	if (gf_th_run(pipe->reader, WritePipe_Reader, pipe) != GF_OK) goto err_exit;
+	if (gf_th_run(pipe->writer, WritePipe_Writer, pipe) != GF_OK) {
+		/*stop the reader*/
+		WritePipe_PushBlock(pipe, GF_TRUE);
+		goto err_exit;
+	}
+	mw->pipe = pipe;
+	return GF_OK;
+
+err_exit:
+	if (pipe->reader) gf_th_del(pipe->reader);
+	if (pipe->writer) gf_th_del(pipe->writer);
+	if (pipe->free_blocks) gf_sema_del(pipe->free_blocks);
+	if (pipe->read_blocks) gf_sema_del(pipe->read_blocks);
+	if (pipe->write_blocks) gf_sema_del(pipe->write_blocks);
+	gf_free(pipe);
+	return GF_IO_ERR;
+}
+
+/*flushes all pending data and destroys the pipeline*/
+static GF_Err WritePipe_Stop(MovieWriter *mw)
+{
+	u32 i;
+	GF_Err e;
+	WritePipe *pipe = mw->pipe;
+	if (!pipe) return GF_OK;
+
+	WritePipe_PushBlock(pipe, GF_TRUE);
+	/*wait for the threads to be done*/
+	gf_th_del(pipe->reader);
+	gf_th_del(pipe->writer);
+
+	e = pipe->writer_error ? pipe->writer_error : pipe->reader_error;
+	for (i=0; i<WRITE_PIPE_NUM_BLOCKS; i++) {
+		if (pipe->blocks[i].ranges) gf_free(pipe->blocks[i].ranges);
+		if (pipe->blocks[i].data) gf_free(pipe->blocks[i].data);
+	}
+	gf_sema_del(pipe->free_blocks);
+	gf_sema_del(pipe->read_blocks);
+	gf_sema_del(pipe->write_blocks);
+	gf_free(pipe);
+	mw->pipe = NULL;
+	return e;
+}
+
 //Write a sample to the file - this is only called for self-contained media
 GF_Err WriteSample(MovieWriter *mw, u32 size, u64 offset, u8 isEdited, GF_BitStream *bs)
 {
@@ -356,18 +655,26 @@ GF_Err WriteSample(MovieWriter *mw, u32 size, u64 offset, u8 isEdited, GF_BitStr
 
 	if (!size) return GF_OK;
 
+	if (isEdited) {
+		map = mw->movie->editFileMap;
+	} else {
+		map = mw->movie->movieFileMap;
+	}
+
+	if (mw->pipe) {
+		GF_Err e = WritePipe_AddRange(mw->pipe, map, offset, size);
+		if (e) return e;
+		mw->nb_done++;
+		gf_set_progress("ISO File Writing", mw->nb_done, mw->total_samples);
+		return GF_OK;
+	}
+
 	if (size>mw->size) {
 		mw->buffer = (char*)gf_realloc(mw->buffer, size);
 		mw->size = size;
 	}
 
 	if (!mw->buffer) return GF_OUT_OF_MEM;
-
-	if (isEdited) {
-		map = mw->movie->editFileMap;
-	} else {
-		map = mw->movie->movieFileMap;
-	}
 	//get the payload...
 	bytes = gf_isom_datamap_get_data(map, mw->buffer, size, offset);
 	if (bytes != size)
@@ -836,6 +1143,293 @@ exit:
 	return e;
 }
 
+/*block size used when moving or copying the media data for moov relocation*/
+#define RELOCATE_BLOCK_SIZE	0x100000
+
+static Bool MetaHasItemData(GF_MetaBox *meta)
+{
+	if (!meta || !meta->item_locations) return GF_FALSE;
+	return gf_list_count(meta->item_locations->location_entries) ? GF_TRUE : GF_FALSE;
+}
+
+/*copies the chunk tables of the track in the writer*/
+static GF_Err CloneChunkTables(TrackWriter *writer)
+{
+	u32 nb_chunks;
+	GF_SampleTableBox *stbl = writer->mdia->information->sampleTable;
+	GF_SampleToChunkBox *stsc = stbl->SampleToChunk;
+
+	if (stsc->nb_entries) {
+		writer->stsc->entries = (GF_StscEntry*)gf_malloc(sizeof(GF_StscEntry)*stsc->nb_entries);
+		if (!writer->stsc->entries) return GF_OUT_OF_MEM;
+		memcpy(writer->stsc->entries, stsc->entries, sizeof(GF_StscEntry)*stsc->nb_entries);
+	}
+	writer->stsc->nb_entries = writer->stsc->alloc_size = stsc->nb_entries;
+
+	if (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
+		GF_ChunkOffsetBox *src = (GF_ChunkOffsetBox *)stbl->ChunkOffset;
+		GF_ChunkOffsetBox *dst = (GF_ChunkOffsetBox *)writer->stco;
+		nb_chunks = src->nb_entries;
+		if (nb_chunks) {
+			dst->offsets = (u32*)gf_malloc(sizeof(u32)*nb_chunks);
+			if (!dst->offsets) return GF_OUT_OF_MEM;
+			memcpy(dst->offsets, src->offsets, sizeof(u32)*nb_chunks);
+		}
+		dst->nb_entries = dst->alloc_size = nb_chunks;
+	} else {
+		GF_ChunkLargeOffsetBox *src = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
+		GF_ChunkLargeOffsetBox *dst = (GF_ChunkLargeOffsetBox *)writer->stco;
+		nb_chunks = src->nb_entries;
+		if (nb_chunks) {
+			dst->offsets = (u64*)gf_malloc(sizeof(u64)*nb_chunks);
+			if (!dst->offsets) return GF_OUT_OF_MEM;
+			memcpy(dst->offsets, src->offsets, sizeof(u64)*nb_chunks);
+		}
+		dst->nb_entries = dst->alloc_size = nb_chunks;
+	}
+	return GF_OK;
+}
+
+/*checks that all self-contained chunks of the writer are located in [start, end[*/
+static Bool CheckChunkRange(TrackWriter *writer, u64 start, u64 end, Bool check_edited)
+{
+	u32 j, k, last, nb_chunks;
+
+	if (writer->stco->type == GF_ISOM_BOX_TYPE_STCO) nb_chunks = ((GF_ChunkOffsetBox *)writer->stco)->nb_entries;
+	else nb_chunks = ((GF_ChunkLargeOffsetBox *)writer->stco)->nb_entries;
+
+	for (j=0; j<writer->stsc->nb_entries; j++) {
+		GF_StscEntry *ent = &writer->stsc->entries[j];
+		if (!Media_IsSelfContained(writer->mdia, ent->sampleDescriptionIndex)) continue;
+		/*data added or modified since the file was opened*/
+		if (check_edited && ent->isEdited) return GF_FALSE;
+
+		//be carefull for the last entry, nextChunk is set to 0 in edit mode...
+		last = ent->nextChunk ? ent->nextChunk : nb_chunks + 1;
+		if (last > nb_chunks + 1) last = nb_chunks + 1;
+		for (k = ent->firstChunk; k < last; k++) {
+			u64 offset;
+			if (writer->stco->type == GF_ISOM_BOX_TYPE_STCO) offset = ((GF_ChunkOffsetBox *)writer->stco)->offsets[k-1];
+			else offset = ((GF_ChunkLargeOffsetBox *)writer->stco)->offsets[k-1];
+			if ((offset < start) || (offset >= end)) return GF_FALSE;
+		}
+	}
+	return GF_TRUE;
+}
+
+/*moves the moov before the media data without rewriting the samples:
+- in capture mode, the media data is moved in place by large blocks, starting from the end of the file
+- in edit mode, the media data of the original file is copied as a single block to the new file
+The chunk offsets are simply shifted (in capture mode, the chunk tables are first rebuilt as for flat storage).
+Returns GF_NOT_SUPPORTED without writing anything if the media data cannot be relocated as is (edited samples,
+several mdat, item data in meta, fragments)*/
+static GF_Err WriteMoovRelocated(MovieWriter *mw, GF_BitStream *bs)
+{
+	GF_Err e;
+	u32 i, hdr_size;
+	u64 begin, src_start, src_size, data_start, data_end, shift, firstSize, finalSize;
+	GF_Box *a;
+	TrackWriter *writer;
+	GF_DataMap *src_map;
+	GF_List *writers;
+	GF_ISOFile *movie = mw->movie;
+	Bool in_place = (movie->openMode == GF_ISOM_OPEN_WRITE) ? GF_TRUE : GF_FALSE;
+
+	if (!movie->moov || !movie->mdat) return GF_NOT_SUPPORTED;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	if (movie->moov->mvex) return GF_NOT_SUPPORTED;
+#endif
+	if (MetaHasItemData(movie->meta) || MetaHasItemData(movie->moov->meta)) return GF_NOT_SUPPORTED;
+
+	begin = 0;
+	if (movie->is_jp2) begin += 12;
+	if (movie->brand) {
+		e = gf_isom_box_size((GF_Box *)movie->brand);
+		if (e) return e;
+		begin += movie->brand->size;
+	}
+	if (movie->pdin) {
+		e = gf_isom_box_size((GF_Box *)movie->pdin);
+		if (e) return e;
+		begin += movie->pdin->size;
+	}
+
+	if (in_place) {
+		/*start boxes and mdat header (16 bytes) are written with the first sample*/
+		src_map = movie->editFileMap;
+		data_end = gf_isom_datamap_get_offset(movie->editFileMap);
+		if (data_end <= begin + 16) return GF_NOT_SUPPORTED;
+		/*we move the mdat header with the data*/
+		src_start = begin;
+		src_size = data_end - begin;
+		data_start = begin + 16;
+	} else {
+		if (movie->nb_original_mdat != 1) return GF_NOT_SUPPORTED;
+		src_map = movie->movieFileMap;
+		if (!src_map || !movie->original_mdat_size) return GF_NOT_SUPPORTED;
+		src_start = data_start = movie->original_mdat_offset;
+		src_size = movie->original_mdat_size;
+		data_end = data_start + src_size;
+	}
+
+	writers = gf_list_new();
+	e = SetupWriters(mw, writers, 0);
+	if (e) goto exit;
+
+	if (in_place) {
+		/*emulate a write to recreate our tables (media data already written)*/
+		e = DoWrite(mw, writers, bs, 1, begin);
+		if (e) goto exit;
+	}
+	i=0;
+	while ((writer = (TrackWriter*)gf_list_enum(writers, &i))) {
+		if (MetaHasItemData(writer->mdia->mediaTrack->meta)) {
+			e = GF_NOT_SUPPORTED;
+			goto exit;
+		}
+		if (!in_place) {
+			e = CloneChunkTables(writer);
+			if (e) goto exit;
+		}
+		if (!CheckChunkRange(writer, data_start, data_end, in_place ? GF_FALSE : GF_TRUE)) {
+			e = GF_NOT_SUPPORTED;
+			goto exit;
+		}
+	}
+
+	/*compute the offset of the media data once the moov is written*/
+	hdr_size = in_place ? 0 : ((src_size + 8 > 0xFFFFFFFF) ? 16 : 8);
+	firstSize = GetMoovAndMetaSize(movie, writers);
+	if (begin + firstSize + hdr_size < src_start) {
+		/*the moov would be smaller than the data before the original mdat, use regular rewrite*/
+		e = GF_NOT_SUPPORTED;
+		goto exit;
+	}
+	shift = begin + firstSize + hdr_size - src_start;
+	e = ShiftOffset(movie, writers, shift);
+	if (e) goto exit;
+	//get the size and see if it has changed (eg, we moved to 64 bit offsets)
+	finalSize = GetMoovAndMetaSize(movie, writers);
+	if (firstSize != finalSize) {
+		e = ShiftOffset(movie, writers, finalSize - firstSize);
+		if (e) goto exit;
+		shift += finalSize - firstSize;
+	}
+
+	if (in_place) {
+		FILE *stream = ((GF_FileDataMap *)movie->editFileMap)->stream;
+		u64 remain = src_size;
+
+		if (mw->size < RELOCATE_BLOCK_SIZE) {
+			mw->buffer = (char*)gf_realloc(mw->buffer, RELOCATE_BLOCK_SIZE);
+			mw->size = RELOCATE_BLOCK_SIZE;
+		}
+		if (!mw->buffer) {
+			e = GF_OUT_OF_MEM;
+			goto exit;
+		}
+		/*move the media data from the end, the regions overlap*/
+		gf_bs_flush(bs);
+		while (remain) {
+			u32 nb_bytes = (remain > RELOCATE_BLOCK_SIZE) ? RELOCATE_BLOCK_SIZE : (u32) remain;
+			remain -= nb_bytes;
+			if (gf_fseek(stream, src_start + remain, SEEK_SET)
+			        || (fread(mw->buffer, 1, nb_bytes, stream) != nb_bytes)
+			        || gf_fseek(stream, src_start + shift + remain, SEEK_SET)
+			        || (gf_fwrite(mw->buffer, 1, nb_bytes, stream) != nb_bytes)) {
+				e = GF_IO_ERR;
+				goto exit;
+			}
+			gf_set_progress("ISO File Writing", src_size - remain, src_size);
+		}
+		fflush(stream);
+		e = gf_bs_seek(bs, begin);
+		if (e) goto exit;
+	} else {
+		if (movie->is_jp2) {
+			gf_bs_write_u32(bs, 12);
+			gf_bs_write_u32(bs, GF_4CC('j','P',' ',' '));
+			gf_bs_write_u32(bs, 0x0D0A870A);
+		}
+		if (movie->brand) {
+			e = gf_isom_box_write((GF_Box *)movie->brand, bs);
+			if (e) goto exit;
+		}
+		if (movie->pdin) {
+			e = gf_isom_box_write((GF_Box *)movie->pdin, bs);
+			if (e) goto exit;
+		}
+	}
+
+	e = WriteMoovAndMeta(movie, writers, bs);
+	if (e) goto exit;
+
+	/*mdat header - in capture mode, the moved data starts with the 16 bytes reserved for the header*/
+	if (src_size + hdr_size > 0xFFFFFFFF) {
+		gf_bs_write_u32(bs, 1);
+		gf_bs_write_u32(bs, GF_ISOM_BOX_TYPE_MDAT);
+		gf_bs_write_u64(bs, src_size + hdr_size);
+	} else {
+		gf_bs_write_u32(bs, (u32) (src_size + hdr_size));
+		gf_bs_write_u32(bs, GF_ISOM_BOX_TYPE_MDAT);
+	}
+
+	if (in_place) {
+		/*skip the data we moved*/
+		gf_bs_skip_bytes(bs, src_size - ((src_size > 0xFFFFFFFF) ? 16 : 8));
+	} else {
+		u64 done = 0;
+#ifdef GPAC_HAS_RANGE_COPY
+		if (mw->out) done = FileRangeCopy(mw->out, bs, src_map, data_start, src_size);
+#endif
+		if ((done < src_size) && (mw->size < RELOCATE_BLOCK_SIZE)) {
+			mw->buffer = (char*)gf_realloc(mw->buffer, RELOCATE_BLOCK_SIZE);
+			mw->size = RELOCATE_BLOCK_SIZE;
+			if (!mw->buffer) {
+				e = GF_OUT_OF_MEM;
+				goto exit;
+			}
+		}
+		while (done < src_size) {
+			u32 nb_bytes = (src_size - done > RELOCATE_BLOCK_SIZE) ? RELOCATE_BLOCK_SIZE : (u32) (src_size - done);
+			if (gf_isom_datamap_get_data(src_map, mw->buffer, nb_bytes, data_start + done) != nb_bytes) {
+				e = GF_IO_ERR;
+				goto exit;
+			}
+			if (gf_bs_write_data(bs, mw->buffer, nb_bytes) != nb_bytes) {
+				e = GF_IO_ERR;
+				goto exit;
+			}
+			done += nb_bytes;
+			gf_set_progress("ISO File Writing", done, src_size);
+		}
+	}
+	movie->mdat->dataSize = src_size;
+
+	//then the rest
+	i=0;
+	while ((a = (GF_Box*)gf_list_enum(movie->TopBoxes, &i))) {
+		switch (a->type) {
+		case GF_ISOM_BOX_TYPE_MOOV:
+		case GF_ISOM_BOX_TYPE_META:
+		case GF_ISOM_BOX_TYPE_FTYP:
+		case GF_ISOM_BOX_TYPE_PDIN:
+		case GF_ISOM_BOX_TYPE_MDAT:
+			break;
+		default:
+			e = gf_isom_box_size(a);
+			if (e) goto exit;
+			e = gf_isom_box_write(a, bs);
+			if (e) goto exit;
+		}
+	}
+
+exit:
+	CleanWriters(writers);
+	gf_list_del(writers);
+	return e;
+}
+
 GF_Err DoFullInterleave(MovieWriter *mw, GF_List *writers, GF_BitStream *bs, u8 Emulation, u64 StartOffset)
 {
 
@@ -1236,7 +1830,15 @@ static GF_Err WriteInterleaved(MovieWriter *mw, GF_BitStream *bs, Bool drift_int
 
 	//we don't need the offset as we are writing...
 	ResetWriters(writers);
+	if (movie->write_pipe_block_size) {
+		e = WritePipe_Start(mw, bs);
+		if (e) goto exit;
+	}
 	e = DoInterleave(mw, writers, bs, 0, 0, drift_inter);
+	if (mw->pipe) {
+		GF_Err pipe_e = WritePipe_Stop(mw);
+		if (!e) e = pipe_e;
+	}
 	if (e) goto exit;
 
 	//then the rest
@@ -1301,7 +1903,11 @@ GF_Err WriteToFile(GF_ISOFile *movie)
 
 	//capture mode: we don't need a new bitstream
 	if (movie->openMode == GF_ISOM_OPEN_WRITE) {
-		e = WriteFlat(&mw, 0, movie->editFileMap->bs);
+		e = GF_NOT_SUPPORTED;
+		if (movie->storageMode == GF_ISOM_STORE_FASTSTART)
+			e = WriteMoovRelocated(&mw, movie->editFileMap->bs);
+		if (e == GF_NOT_SUPPORTED)
+			e = WriteFlat(&mw, 0, movie->editFileMap->bs);
 	} else {
 		u32 buffer_size = movie->editFileMap ? gf_bs_get_output_buffering(movie->editFileMap->bs) : 0;
 		Bool is_stdout = 0;
@@ -1322,6 +1928,7 @@ GF_Err WriteToFile(GF_ISOFile *movie)
 		if (buffer_size) {
 			gf_bs_set_output_buffering(bs, buffer_size);
 		}
+		if (!is_stdout) mw.out = stream;
 
 		switch (movie->storageMode) {
 		case GF_ISOM_STORE_TIGHT:
@@ -1334,6 +1941,13 @@ GF_Err WriteToFile(GF_ISOFile *movie)
 		case GF_ISOM_STORE_STREAMABLE:
 			e = WriteFlat(&mw, 1, bs);
 			break;
+		case GF_ISOM_STORE_FASTSTART:
+			e = WriteMoovRelocated(&mw, bs);
+			if (e == GF_NOT_SUPPORTED) {
+				GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[iso file] Media data cannot be relocated as is, rewriting file\n"));
+				e = WriteFlat(&mw, 1, bs);
+			}
+			break;
 		default:
 			e = WriteFlat(&mw, 0, bs);
 			break;
@@ -1423,6 +1423,7 @@ GF_Err gf_isom_set_storage_mode(GF_ISOFile *movie, u8 storageMode)
 	case GF_ISOM_STORE_INTERLEAVED:
 	case GF_ISOM_STORE_DRIFT_INTERLEAVED:
 	case GF_ISOM_STORE_TIGHT:
+	case GF_ISOM_STORE_FASTSTART:
 		movie->storageMode = storageMode;
 		return GF_OK;
 	default:
@@ -1700,6 +1701,7 @@ GF_Err gf_isom_remove_track(GF_ISOFile *movie, u32 trackNumber)
 
 	//remove the track from the movie
 	gf_list_del_item(movie->moov->trackList, the_trak);
+	gf_isom_trackid_map_reset(movie->moov->track_map);
 
 	//rewrite any OD tracks
 	i=0;
@@ -2129,6 +2131,18 @@ u32 gf_isom_get_interleave_time(GF_ISOFile *movie)
 	return movie ? movie->interleavingTime : 0;
 }
 
+GF_EXPORT
+GF_Err gf_isom_set_write_pipeline(GF_ISOFile *movie, u32 block_size, Bool use_range_copy)
+{
+	GF_Err e;
+	e = CanAccessMovie(movie, GF_ISOM_OPEN_WRITE);
+	if (e) return e;
+
+	movie->write_pipe_block_size = block_size;
+	movie->write_pipe_range_copy = use_range_copy;
+	return GF_OK;
+}
+
 //set the storage mode of a file (FLAT, STREAMABLE, INTERLEAVED)
 u8 gf_isom_get_storage_mode(GF_ISOFile *movie)
 {
@@ -3290,6 +3304,7 @@ GF_Err gf_isom_set_track_id(GF_ISOFile *movie, u32 trackNumber, u32 trackID)
 		}
 	}
 	trak->Header->trackID = trackID;
+	gf_isom_trackid_map_reset(movie->moov->track_map);
 	return GF_OK;
 }
 
@@ -342,7 +342,23 @@ Bool Media_IsSampleSyncShadow(GF_ShadowSyncBox *stsh, u32 sampleNumber)
 	return 0;
 }
 
-GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp, u32 *sIDX, Bool no_data, u64 *out_offset)
+/*checks whether the sample data is delivered as stored in the file (no rewriting by the library)*/
+static Bool Media_IsSampleDataUnchanged(GF_MediaBox *mdia, GF_SampleEntryBox *entry)
+{
+	if (mdia->mediaTrack->padding_bytes) return GF_FALSE;
+	if (mdia->handler->handlerType == GF_ISOM_MEDIA_OD) return GF_FALSE;
+	/*NALU rewriting only inspects the sample (sync flag) in inspect mode*/
+	if (gf_isom_is_nalu_based_entry(mdia, entry) && (mdia->mediaTrack->extractor_mode != GF_ISOM_NALU_EXTRACT_INSPECT))
+		return GF_FALSE;
+	if (mdia->mediaTrack->moov->mov->convert_streaming_text
+	        && ((mdia->handler->handlerType == GF_ISOM_MEDIA_TEXT) || (mdia->handler->handlerType == GF_ISOM_MEDIA_SUBT))
+	        && (entry->type == GF_ISOM_BOX_TYPE_TX3G || entry->type == GF_ISOM_BOX_TYPE_TEXT)
+	   )
+		return GF_FALSE;
+	return GF_TRUE;
+}
+
+GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp, u32 *sIDX, Bool no_data, u64 *out_offset, Bool *mapped_data)
 {
 	GF_Err e;
 	u32 bytesRead;
@@ -425,11 +441,6 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 	if (out_offset) *out_offset = offset;
 	if (no_data) return GF_OK;
 
-	/*and finally get the data, include padding if needed*/
-	(*samp)->data = (char *) gf_malloc(sizeof(char) * ( (*samp)->dataLength + mdia->mediaTrack->padding_bytes) );
-	if (mdia->mediaTrack->padding_bytes)
-		memset((*samp)->data + (*samp)->dataLength, 0, sizeof(char) * mdia->mediaTrack->padding_bytes);
-
 	//check if we can get the sample (make sure we have enougth data...)
 	new_size = gf_bs_get_size(mdia->information->dataHandler->bs);
 	if (offset + (*samp)->dataLength > new_size) {
@@ -441,6 +452,36 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 		}
 	}
 
+	/*zero-copy: use the data in the file mapping if the sample is not rewritten*/
+	if (mapped_data) {
+		*mapped_data = GF_FALSE;
+		if (Media_IsSampleDataUnchanged(mdia, entry)) {
+			(*samp)->data = gf_isom_datamap_get_mapped_data(mdia->information->dataHandler, offset, (*samp)->dataLength);
+			if ((*samp)->data) {
+				*mapped_data = GF_TRUE;
+				mdia->BytesMissing = 0;
+				if (gf_isom_is_nalu_based_entry(mdia, entry) &&
+				        !gf_isom_is_track_encrypted(mdia->mediaTrack->moov->mov, gf_isom_get_tracknum_from_id(mdia->mediaTrack->moov, mdia->mediaTrack->Header->trackID))
+				   ) {
+					return gf_isom_nalu_sample_rewrite(mdia, *samp, sampleNumber, (GF_MPEGVisualSampleEntryBox *)entry);
+				}
+				return GF_OK;
+			}
+		}
+	}
+
+	/*and finally get the data, include padding if needed - if the sample buffer size is known (static sample), only grow it when needed*/
+	if ((*samp)->alloc_size) {
+		if ((*samp)->alloc_size < (*samp)->dataLength + mdia->mediaTrack->padding_bytes) {
+			(*samp)->alloc_size = (*samp)->dataLength + mdia->mediaTrack->padding_bytes;
+			(*samp)->data = (char *) gf_realloc((*samp)->data, sizeof(char) * (*samp)->alloc_size);
+		}
+	} else {
+		(*samp)->data = (char *) gf_malloc(sizeof(char) * ( (*samp)->dataLength + mdia->mediaTrack->padding_bytes) );
+	}
+	if (mdia->mediaTrack->padding_bytes)
+		memset((*samp)->data + (*samp)->dataLength, 0, sizeof(char) * mdia->mediaTrack->padding_bytes);
+
 	bytesRead = gf_isom_datamap_get_data(mdia->information->dataHandler, (*samp)->data, (*samp)->dataLength, offset);
 	//if bytesRead != sampleSize, we have an IO err
 	if (bytesRead < (*samp)->dataLength) {
@@ -450,14 +491,12 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 	//finally rewrite the sample if this is an OD Access Unit
 	if (mdia->handler->handlerType == GF_ISOM_MEDIA_OD) {
 		e = Media_RewriteODFrame(mdia, *samp);
-		if (e) return e;
 	}
 	/*FIXME: we do NOT rewrite sample if we have a encrypted track*/
 	else if (gf_isom_is_nalu_based_entry(mdia, entry) &&
 	         !gf_isom_is_track_encrypted(mdia->mediaTrack->moov->mov, gf_isom_get_tracknum_from_id(mdia->mediaTrack->moov, mdia->mediaTrack->Header->trackID))
 	        ) {
 		e = gf_isom_nalu_sample_rewrite(mdia, *samp, sampleNumber, (GF_MPEGVisualSampleEntryBox *)entry);
-		if (e) return e;
 	}
 	else if (mdia->mediaTrack->moov->mov->convert_streaming_text
 	         && ((mdia->handler->handlerType == GF_ISOM_MEDIA_TEXT) || (mdia->handler->handlerType == GF_ISOM_MEDIA_SUBT))
@@ -471,9 +510,12 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 			dur -= (*samp)->DTS;
 		}
 		e = gf_isom_rewrite_text_sample(*samp, *sIDX, (u32) dur);
-		if (e) return e;
+	} else {
+		return GF_OK;
 	}
-	return GF_OK;
+	/*rewriting may have reallocated the sample buffer*/
+	if ((*samp)->alloc_size) (*samp)->alloc_size = (*samp)->dataLength;
+	return e;
 }
 
 
@@ -508,6 +508,9 @@ u32 gf_isom_find_od_for_track(GF_ISOFile *file, u32 track)
 	i=0;
 	while ( (od_tk = (GF_TrackBox*)gf_list_enum(file->moov->trackList, &i))) {
 		if (od_tk->Media->handler->handlerType != GF_ISOM_MEDIA_OD) continue;
+		/*the track is not fetched through gf_isom_get_track, make sure its sample tables are loaded*/
+		if (Track_LoadSampleTables(od_tk) != GF_OK) continue;
+		if (!od_tk->Media->information->sampleTable->SampleSize) continue;
 
 		for (j=0; j<od_tk->Media->information->sampleTable->SampleSize->sampleCount; j++) {
 			GF_ISOSample *samp = gf_isom_get_sample(file, i, j+1, &di);
@@ -31,13 +31,7 @@
 
 GF_TrackExtendsBox *GetTrex(GF_MovieBox *moov, u32 TrackID)
 {
-	u32 i;
-	GF_TrackExtendsBox *trex;
-	i=0;
-	while ((trex = (GF_TrackExtendsBox *)gf_list_enum(moov->mvex->TrackExList, &i))) {
-		if (trex->trackID == TrackID) return trex;
-	}
-	return NULL;
+	return (GF_TrackExtendsBox *)gf_isom_trackid_map_find(&moov->mvex->trex_map, moov->mvex->TrackExList, TrackID, NULL);
 }
 
 GF_TrackExtensionPropertiesBox *GetTrep(GF_MovieBox *moov, u32 TrackID)
@@ -53,16 +47,9 @@ GF_TrackExtensionPropertiesBox *GetTrep(GF_MovieBox *moov, u32 TrackID)
 
 GF_TrackFragmentBox *GetTraf(GF_ISOFile *mov, u32 TrackID)
 {
-	u32 i;
-	GF_TrackFragmentBox *traf;
 	if (!mov->moof) return NULL;
-
-	//reverse browse the TRAFs, as there may be more than one per track ...
-	for (i=gf_list_count(mov->moof->TrackList); i>0; i--) {
-		traf = (GF_TrackFragmentBox *)gf_list_get(mov->moof->TrackList, i-1);
-		if (traf->tfhd->trackID == TrackID) return traf;
-	}
-	return NULL;
+	//there may be more than one TRAF per track, the last one is returned
+	return (GF_TrackFragmentBox *)gf_isom_trackid_map_find(&mov->moof->traf_map, mov->moof->TrackList, TrackID, NULL);
 }
 
 
@@ -848,6 +835,7 @@ GF_Err StoreFragment(GF_ISOFile *movie, Bool load_mdat_only, s32 data_offset_dif
 		if (!traf->tfhd->EmptyDuration && !s_count) {
 			i--;
 			gf_list_rem(movie->moof->TrackList, i);
+			gf_isom_trackid_map_reset(movie->moof->traf_map);
 			gf_isom_box_del((GF_Box *) traf);
 			continue;
 		}
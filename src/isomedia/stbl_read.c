@@ -27,6 +27,159 @@
 
 #ifndef GPAC_DISABLE_ISOM
 
+void stbl_index_del(GF_SampleEntryIndex *idx)
+{
+	if (!idx) return;
+	if (idx->first_sample) gf_free(idx->first_sample);
+	if (idx->first_dts) gf_free(idx->first_dts);
+	gf_free(idx);
+}
+
+void stbl_CheckIndex(GF_SampleTableBox *stbl)
+{
+	if (!stbl || !stbl->use_index) return;
+	if (stbl->TimeToSample && !stbl->TimeToSample->r_index) {
+		GF_SAFEALLOC(stbl->TimeToSample->r_index, GF_SampleEntryIndex);
+	}
+	if (stbl->CompositionOffset && !stbl->CompositionOffset->r_index) {
+		GF_SAFEALLOC(stbl->CompositionOffset->r_index, GF_SampleEntryIndex);
+	}
+	if (stbl->SampleToChunk && !stbl->SampleToChunk->r_index) {
+		GF_SAFEALLOC(stbl->SampleToChunk->r_index, GF_SampleEntryIndex);
+	}
+}
+
+void stbl_ResetIndex(GF_SampleTableBox *stbl)
+{
+	if (!stbl) return;
+	if (stbl->TimeToSample) {
+		stbl_index_del(stbl->TimeToSample->r_index);
+		stbl->TimeToSample->r_index = NULL;
+	}
+	if (stbl->CompositionOffset) {
+		stbl_index_del(stbl->CompositionOffset->r_index);
+		stbl->CompositionOffset->r_index = NULL;
+	}
+	if (stbl->SampleToChunk) {
+		stbl_index_del(stbl->SampleToChunk->r_index);
+		stbl->SampleToChunk->r_index = NULL;
+	}
+}
+
+static u32 stbl_index_size(GF_SampleEntryIndex *idx)
+{
+	if (!idx) return 0;
+	return sizeof(GF_SampleEntryIndex) + idx->alloc_size * (sizeof(u32) + (idx->first_dts ? sizeof(u64) : 0));
+}
+
+u32 stbl_GetIndexSize(GF_SampleTableBox *stbl)
+{
+	u32 size = 0;
+	if (!stbl) return 0;
+	if (stbl->TimeToSample) size += stbl_index_size(stbl->TimeToSample->r_index);
+	if (stbl->CompositionOffset) size += stbl_index_size(stbl->CompositionOffset->r_index);
+	if (stbl->SampleToChunk) size += stbl_index_size(stbl->SampleToChunk->r_index);
+	return size;
+}
+
+/*makes room for nb_entries+1 values in the index and returns the first entry to (re)compute. The last indexed
+entry is always recomputed since appending samples to a table may increase its sample count*/
+static Bool stbl_index_prepare(GF_SampleEntryIndex *idx, u32 nb_entries, Bool with_dts, u32 *first_entry)
+{
+	//the table has been shrinked, rebuild everything
+	if (idx->nb_entries > nb_entries) idx->nb_entries = 0;
+
+	if (idx->alloc_size < nb_entries + 1) {
+		u32 alloc_size = idx->alloc_size ? (idx->alloc_size*3)/2 : 0;
+		if (alloc_size < nb_entries + 1) alloc_size = nb_entries + 1;
+		idx->first_sample = (u32*)gf_realloc(idx->first_sample, sizeof(u32) * alloc_size);
+		if (with_dts) idx->first_dts = (u64*)gf_realloc(idx->first_dts, sizeof(u64) * alloc_size);
+		if (!idx->first_sample || (with_dts && !idx->first_dts)) {
+			idx->alloc_size = idx->nb_entries = 0;
+			return GF_FALSE;
+		}
+		idx->alloc_size = alloc_size;
+	}
+	if (!idx->nb_entries) {
+		idx->first_sample[0] = 1;
+		if (with_dts) idx->first_dts[0] = 0;
+	}
+	*first_entry = idx->nb_entries ? idx->nb_entries - 1 : 0;
+	return GF_TRUE;
+}
+
+//returns the last entry whose first sample is lower than or equal to SampleNumber - index must not be empty
+static u32 stbl_index_find_sample(GF_SampleEntryIndex *idx, u32 SampleNumber)
+{
+	u32 low = 0;
+	u32 high = idx->nb_entries;
+	while (low + 1 < high) {
+		u32 mid = (low + high) / 2;
+		if (idx->first_sample[mid] <= SampleNumber) low = mid;
+		else high = mid;
+	}
+	return low;
+}
+
+static Bool stts_update_index(GF_TimeToSampleBox *stts)
+{
+	u32 i;
+	GF_SampleEntryIndex *idx = stts ? stts->r_index : NULL;
+	if (!idx) return GF_FALSE;
+	if (!stbl_index_prepare(idx, stts->nb_entries, GF_TRUE, &i)) return GF_FALSE;
+
+	for (; i<stts->nb_entries; i++) {
+		idx->first_sample[i+1] = idx->first_sample[i] + stts->entries[i].sampleCount;
+		idx->first_dts[i+1] = idx->first_dts[i] + (u64) stts->entries[i].sampleCount * stts->entries[i].sampleDelta;
+	}
+	idx->nb_entries = stts->nb_entries;
+	return GF_TRUE;
+}
+
+static Bool ctts_update_index(GF_CompositionOffsetBox *ctts)
+{
+	u32 i;
+	GF_SampleEntryIndex *idx = ctts ? ctts->r_index : NULL;
+	if (!idx) return GF_FALSE;
+	if (!stbl_index_prepare(idx, ctts->nb_entries, GF_FALSE, &i)) return GF_FALSE;
+
+	for (; i<ctts->nb_entries; i++) {
+		idx->first_sample[i+1] = idx->first_sample[i] + ctts->entries[i].sampleCount;
+	}
+	idx->nb_entries = ctts->nb_entries;
+	return GF_TRUE;
+}
+
+static Bool stsc_update_index(GF_SampleTableBox *stbl)
+{
+	u32 i, nb_chunks, count;
+	GF_SampleToChunkBox *stsc = stbl->SampleToChunk;
+	GF_SampleEntryIndex *idx = stsc ? stsc->r_index : NULL;
+	if (!idx || !stbl->ChunkOffset) return GF_FALSE;
+	if (!stbl_index_prepare(idx, stsc->nb_entries, GF_FALSE, &i)) return GF_FALSE;
+
+	count = stsc->nb_entries;
+	for (; i<count; i++) {
+		GF_StscEntry *ent = &stsc->entries[i];
+		//same rules as GetGhostNum
+		if (ent->nextChunk || (i+1 < count)) {
+			u32 next = ent->nextChunk ? ent->nextChunk : stsc->entries[i+1].firstChunk;
+			nb_chunks = (next > ent->firstChunk) ? (next - ent->firstChunk) : 1;
+		} else {
+			u32 nb_offsets;
+			if (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
+				nb_offsets = ((GF_ChunkOffsetBox *)stbl->ChunkOffset)->nb_entries;
+			} else {
+				nb_offsets = ((GF_ChunkLargeOffsetBox *)stbl->ChunkOffset)->nb_entries;
+			}
+			nb_chunks = (nb_offsets > ent->firstChunk) ? (1 + nb_offsets - ent->firstChunk) : 1;
+		}
+		idx->first_sample[i+1] = idx->first_sample[i] + nb_chunks * ent->samplesPerChunk;
+	}
+	idx->nb_entries = count;
+	return GF_TRUE;
+}
+
 //Get the sample number
 GF_Err findEntryForTime(GF_SampleTableBox *stbl, u64 DTS, u8 useCTS, u32 *sampleNumber, u32 *prevSampleNumber)
 {
@@ -43,6 +196,40 @@ GF_Err findEntryForTime(GF_SampleTableBox *stbl, u64 DTS, u8 useCTS, u32 *sample
 	decoding order. */
 	useCTS = 0;
 
+	stbl_CheckIndex(stbl);
+	if (stts_update_index(stbl->TimeToSample)) {
+		GF_SampleEntryIndex *idx = stbl->TimeToSample->r_index;
+		u32 low, high;
+		count = stbl->TimeToSample->nb_entries;
+		//after the last sample
+		if (!count || (idx->first_dts[count] < DTS)) return GF_OK;
+
+		//locate the first entry starting at or after DTS
+		low = 0;
+		high = count;
+		while (low < high) {
+			u32 mid = (low + high) / 2;
+			if (idx->first_dts[mid] < DTS) low = mid + 1;
+			else high = mid;
+		}
+		curSampNum = idx->first_sample[low];
+		curDTS = idx->first_dts[low];
+		//the matching sample may be inside the previous entry
+		if (low) {
+			ent = &stbl->TimeToSample->entries[low-1];
+			if (ent->sampleDelta) {
+				u64 k = (DTS - idx->first_dts[low-1] + ent->sampleDelta - 1) / ent->sampleDelta;
+				if (k < ent->sampleCount) {
+					curSampNum = idx->first_sample[low-1] + (u32) k;
+					curDTS = idx->first_dts[low-1] + k * ent->sampleDelta;
+				}
+			}
+		}
+		if (curSampNum >= idx->first_sample[count]) return GF_OK;
+		CTSOffset = 0;
+		goto entry_found;
+	}
+
 	//our cache
 	if (stbl->TimeToSample->r_FirstSampleInEntry &&
 	        (DTS >= stbl->TimeToSample->r_CurrentDTS) ) {
@@ -148,6 +335,14 @@ GF_Err stbl_GetSampleCTS(GF_CompositionOffsetBox *ctts, u32 SampleNumber, s32 *C
 	//test on SampleNumber is done before
 	if (!ctts || !SampleNumber) return GF_BAD_PARAM;
 
+	if (ctts_update_index(ctts)) {
+		//asked for a sample not in table, CTTS is 0
+		if (!ctts->nb_entries || (SampleNumber >= ctts->r_index->first_sample[ctts->nb_entries])) return GF_OK;
+		i = stbl_index_find_sample(ctts->r_index, SampleNumber);
+		(*CTSoffset) = ctts->entries[i].decodingOffset;
+		return GF_OK;
+	}
+
 	if (ctts->r_FirstSampleInEntry && (ctts->r_FirstSampleInEntry < SampleNumber) ) {
 		i = ctts->r_currentEntryIndex;
 	} else {
@@ -182,8 +377,23 @@ GF_Err stbl_GetSampleDTS_and_Duration(GF_TimeToSampleBox *stts, u32 SampleNumber
 	if (!stts || !SampleNumber) return GF_BAD_PARAM;
 
 	ent = NULL;
-	//use our cache
 	count = stts->nb_entries;
+	if (stts_update_index(stts)) {
+		if (!count) return GF_OK;
+		//after the last sample, assume the DTS is then what is written in the table
+		if (SampleNumber >= stts->r_index->first_sample[count]) {
+			(*DTS) = stts->r_index->first_dts[count];
+			if (duration) *duration = stts->entries[count-1].sampleDelta;
+			return GF_OK;
+		}
+		i = stbl_index_find_sample(stts->r_index, SampleNumber);
+		ent = &stts->entries[i];
+		(*DTS) = stts->r_index->first_dts[i] + (u64) (SampleNumber - stts->r_index->first_sample[i]) * ent->sampleDelta;
+		if (duration) *duration = ent->sampleDelta;
+		return GF_OK;
+	}
+
+	//use our cache
 	if (stts->r_FirstSampleInEntry
 	        && (stts->r_FirstSampleInEntry <= SampleNumber)
 	        //this is for read/write access
@@ -242,7 +452,14 @@ GF_Err stbl_GetSampleRAP(GF_SyncSampleBox *stss, u32 SampleNumber, SAPType *IsRA
 	if (stss->r_LastSyncSample && (stss->r_LastSyncSample < SampleNumber) ) {
 		i = stss->r_LastSampleIndex;
 	} else {
+		u32 high = stss->nb_entries;
+		//sync samples are stored in increasing order, start from the last one before SampleNumber
 		i = 0;
+		while (i + 1 < high) {
+			u32 mid = (i + high) / 2;
+			if (stss->sampleNumbers[mid] < SampleNumber) i = mid;
+			else high = mid;
+		}
 	}
 	for (; i < stss->nb_entries; i++) {
 		//get the entry
@@ -390,7 +607,7 @@ void GetGhostNum(GF_StscEntry *ent, u32 EntryIndex, u32 count, GF_SampleTableBox
 GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offset, u32 *chunkNumber, u32 *descIndex, u8 *isEdited)
 {
 	GF_Err e;
-	u32 i, j, k, offsetInChunk, size;
+	u32 i, j, k, offsetInChunk, size, firstSampleInChunk;
 	GF_ChunkOffsetBox *stco;
 	GF_ChunkLargeOffsetBox *co64;
 	GF_StscEntry *ent;
@@ -417,6 +634,22 @@ GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offse
 		return GF_OK;
 	}
 
+	stbl_CheckIndex(stbl);
+	if (stsc_update_index(stbl)) {
+		GF_SampleEntryIndex *idx = stbl->SampleToChunk->r_index;
+		if (!idx->nb_entries || (sampleNumber >= idx->first_sample[idx->nb_entries])) return GF_ISOM_INVALID_FILE;
+		i = stbl_index_find_sample(idx, sampleNumber);
+		ent = &stbl->SampleToChunk->entries[i];
+		if (!ent->samplesPerChunk) return GF_ISOM_INVALID_FILE;
+		k = (sampleNumber - idx->first_sample[i]) / ent->samplesPerChunk;
+
+		(*descIndex) = ent->sampleDescriptionIndex;
+		(*chunkNumber) = ent->firstChunk + k;
+		(*isEdited) = ent->isEdited;
+		firstSampleInChunk = idx->first_sample[i] + k * ent->samplesPerChunk;
+		goto chunk_found;
+	}
+
 	//check our cache
 	if (stbl->SampleToChunk->firstSampleInCurrentChunk &&
 	        (stbl->SampleToChunk->firstSampleInCurrentChunk < sampleNumber)) {
@@ -469,11 +702,13 @@ sample_found:
 	(*descIndex) = ent->sampleDescriptionIndex;
 	(*chunkNumber) = ent->firstChunk + stbl->SampleToChunk->currentChunk - 1;
 	(*isEdited) = ent->isEdited;
+	firstSampleInChunk = stbl->SampleToChunk->firstSampleInCurrentChunk;
 
+chunk_found:
 	//ok, get the size of all the previous sample
 	offsetInChunk = 0;
 	//warning, firstSampleInChunk is at least 1 - not 0
-	for (i = stbl->SampleToChunk->firstSampleInCurrentChunk; i < sampleNumber; i++) {
+	for (i = firstSampleInChunk; i < sampleNumber; i++) {
 		e = stbl_GetSampleSize(stbl->SampleSize, i, &size);
 		if (e) return e;
 		offsetInChunk += size;
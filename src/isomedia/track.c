@@ -28,16 +28,19 @@
 
 #ifndef GPAC_DISABLE_ISOM
 
+GF_Err Track_LoadSampleTables(GF_TrackBox *trak)
+{
+	GF_SampleTableBox *stbl;
+	if (!trak->Media || !trak->Media->information || !trak->Media->information->sampleTable) return GF_OK;
+	stbl = trak->Media->information->sampleTable;
+	if (!stbl->nb_lazy) return GF_OK;
+	if (!trak->moov || !trak->moov->mov || !trak->moov->mov->movieFileMap) return GF_ISOM_INVALID_FILE;
+	return stbl_LoadLazyTables(stbl, trak->moov->mov->movieFileMap->bs);
+}
+
 GF_TrackBox *GetTrackbyID(GF_MovieBox *moov, u32 TrackID)
 {
-	GF_TrackBox *trak;
-	u32 i;
-	if (!moov) return NULL;
-	i=0;
-	while ((trak = (GF_TrackBox *)gf_list_enum(moov->trackList, &i))) {
-		if (trak->Header->trackID == TrackID) return trak;
-	}
-	return NULL;
+	return gf_isom_get_track_from_id(moov, TrackID);
 }
 
 GF_TrackBox *gf_isom_get_track(GF_MovieBox *moov, u32 trackNumber)
@@ -45,6 +48,7 @@ GF_TrackBox *gf_isom_get_track(GF_MovieBox *moov, u32 trackNumber)
 	GF_TrackBox *trak;
 	if (!moov || !trackNumber || (trackNumber > gf_list_count(moov->trackList))) return NULL;
 	trak = (GF_TrackBox*)gf_list_get(moov->trackList, trackNumber - 1);
+	Track_LoadSampleTables(trak);
 	return trak;
 
 }
@@ -53,13 +57,10 @@ GF_TrackBox *gf_isom_get_track(GF_MovieBox *moov, u32 trackNumber)
 //return 0 if not found error
 u32 gf_isom_get_tracknum_from_id(GF_MovieBox *moov, u32 trackID)
 {
-	u32 i;
-	GF_TrackBox *trak;
-	i=0;
-	while ((trak = (GF_TrackBox *)gf_list_enum(moov->trackList, &i))) {
-		if (trak->Header->trackID == trackID) return i;
-	}
-	return 0;
+	u32 pos;
+	if (!moov) return 0;
+	gf_isom_trackid_map_find(&moov->track_map, moov->trackList, trackID, &pos);
+	return pos;
 }
 
 //extraction of the ESD from the track
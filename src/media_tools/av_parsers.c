@@ -1857,54 +1857,6 @@ const char *gf_hevc_get_profile_name(u8 video_prof)
 
 #ifndef GPAC_DISABLE_AV_PARSERS
 
-
-static u8 avc_golomb_bits[256] = {
-	8, 7, 6, 6, 5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 4, 3,
-	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 2, 2,
-	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0
-};
-
-static u32 bs_get_ue(GF_BitStream *bs)
-{
-	u8 coded;
-	u32 bits = 0, read = 0;
-	while (1) {
-		read = gf_bs_peek_bits(bs, 8, 0);
-		if (read) break;
-		//check whether we still have bits once the peek is done since we may have less than 8 bits available
-		if (!gf_bs_available(bs)) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[AVC/HEVC] Not enough bits in bitstream !!\n"));
-			return 0;
-		}
-		gf_bs_read_int(bs, 8);
-		bits += 8;
-	}
-	coded = avc_golomb_bits[read];
-	gf_bs_read_int(bs, coded);
-	bits += coded;
-	return gf_bs_read_int(bs, bits + 1) - 1;
-}
-
-static s32 bs_get_se(GF_BitStream *bs)
-{
-	u32 v = bs_get_ue(bs);
-	if ((v & 0x1) == 0) return (s32) (0 - (v>>1));
-	return (v + 1) >> 1;
-}
-
 u32 gf_media_nalu_is_start_code(GF_BitStream *bs)
 {
 	u8 s1, s2, s3, s4;
@@ -2048,7 +2000,7 @@ static void avc_parse_hrd_parameters(GF_BitStream *bs, AVC_HRD *hrd)
 {
 	int i, cpb_cnt_minus1;
 
-	cpb_cnt_minus1 = bs_get_ue(bs);		/*cpb_cnt_minus1*/
+	cpb_cnt_minus1 = gf_bs_read_ue(bs);		/*cpb_cnt_minus1*/
 	if (cpb_cnt_minus1 > 31)
 		GF_LOG(GF_LOG_WARNING, GF_LOG_CODING, ("[avc-h264] invalid cpb_cnt_minus1 value: %d (expected in [0;31])\n", cpb_cnt_minus1));
 	gf_bs_read_int(bs, 4);				/*bit_rate_scale*/
@@ -2056,8 +2008,8 @@ static void avc_parse_hrd_parameters(GF_BitStream *bs, AVC_HRD *hrd)
 
 	/*for( SchedSelIdx = 0; SchedSelIdx <= cpb_cnt_minus1; SchedSelIdx++ ) {*/
 	for (i=0; i<=cpb_cnt_minus1; i++) {
-		bs_get_ue(bs);					/*bit_rate_value_minus1[ SchedSelIdx ]*/
-		bs_get_ue(bs);					/*cpb_size_value_minus1[ SchedSelIdx ]*/
+		gf_bs_read_ue(bs);					/*bit_rate_value_minus1[ SchedSelIdx ]*/
+		gf_bs_read_ue(bs);					/*cpb_size_value_minus1[ SchedSelIdx ]*/
 		gf_bs_read_int(bs, 1);			/*cbr_flag[ SchedSelIdx ]*/
 	}
 	gf_bs_read_int(bs, 5);											/*initial_cpb_removal_delay_length_minus1*/
@@ -2245,7 +2197,7 @@ s32 gf_media_avc_read_sps(const char *sps_data, u32 sps_size, AVCState *avc, u32
 	/*SubsetSps is used to be sure that AVC SPS are not going to be scratched
 	by subset SPS. According to the SVC standard, subset SPS can have the same sps_id
 	than its base layer, but it does not refer to the same SPS. */
-	sps_id = bs_get_ue(bs) + GF_SVC_SSPS_ID_SHIFT * subseq_sps;
+	sps_id = gf_bs_read_ue(bs) + GF_SVC_SSPS_ID_SHIFT * subseq_sps;
 	if (sps_id >=32) {
 		sps_id = -1;
 		goto exit;
@@ -2270,7 +2222,7 @@ s32 gf_media_avc_read_sps(const char *sps_data, u32 sps_size, AVCState *avc, u32
 	case 86:
 	case 118:
 	case 128:
-		chroma_format_idc = bs_get_ue(bs);
+		chroma_format_idc = gf_bs_read_ue(bs);
 		ChromaArrayType = chroma_format_idc;
 		if (chroma_format_idc == 3) {
 			separate_colour_plane_flag = gf_bs_read_int(bs, 1);
@@ -2281,8 +2233,8 @@ s32 gf_media_avc_read_sps(const char *sps_data, u32 sps_size, AVCState *avc, u32
 			*/
 			if (separate_colour_plane_flag) ChromaArrayType = 0;
 		}
-		luma_bd = bs_get_ue(bs);
-		chroma_bd = bs_get_ue(bs);
+		luma_bd = gf_bs_read_ue(bs);
+		chroma_bd = gf_bs_read_ue(bs);
 		/*qpprime_y_zero_transform_bypass_flag = */ gf_bs_read_int(bs, 1);
 		/*seq_scaling_matrix_present_flag*/
 		if (gf_bs_read_int(bs, 1)) {
@@ -2293,7 +2245,7 @@ s32 gf_media_avc_read_sps(const char *sps_data, u32 sps_size, AVCState *avc, u32
 					u32 sl = k<6 ? 16 : 64;
 					for (z=0; z<sl; z++) {
 						if (next) {
-							s32 delta = bs_get_se(bs);
+							s32 delta = gf_bs_read_se(bs);
 							next = (last + delta + 256) % 256;
 						}
 						last = next ? next : last;
@@ -2307,29 +2259,29 @@ s32 gf_media_avc_read_sps(const char *sps_data, u32 sps_size, AVCState *avc, u32
 	sps->profile_idc = profile_idc;
 	sps->level_idc = level_idc;
 	sps->prof_compat = pcomp;
-	sps->log2_max_frame_num = bs_get_ue(bs) + 4;
-	sps->poc_type = bs_get_ue(bs);
+	sps->log2_max_frame_num = gf_bs_read_ue(bs) + 4;
+	sps->poc_type = gf_bs_read_ue(bs);
 	sps->chroma_format = chroma_format_idc;
 	sps->luma_bit_depth_m8 = luma_bd;
 	sps->chroma_bit_depth_m8 = chroma_bd;
 
 	if (sps->poc_type == 0) {
-		sps->log2_max_poc_lsb = bs_get_ue(bs) + 4;
+		sps->log2_max_poc_lsb = gf_bs_read_ue(bs) + 4;
 	} else if(sps->poc_type == 1) {
 		sps->delta_pic_order_always_zero_flag = gf_bs_read_int(bs, 1);
-		sps->offset_for_non_ref_pic = bs_get_se(bs);
-		sps->offset_for_top_to_bottom_field = bs_get_se(bs);
-		sps->poc_cycle_length = bs_get_ue(bs);
-		for(i=0; i<sps->poc_cycle_length; i++) sps->offset_for_ref_frame[i] = bs_get_se(bs);
+		sps->offset_for_non_ref_pic = gf_bs_read_se(bs);
+		sps->offset_for_top_to_bottom_field = gf_bs_read_se(bs);
+		sps->poc_cycle_length = gf_bs_read_ue(bs);
+		for(i=0; i<sps->poc_cycle_length; i++) sps->offset_for_ref_frame[i] = gf_bs_read_se(bs);
 	}
 	if (sps->poc_type > 2) {
 		sps_id = -1;
 		goto exit;
 	}
-	bs_get_ue(bs); /*ref_frame_count*/
+	gf_bs_read_ue(bs); /*ref_frame_count*/
 	gf_bs_read_int(bs, 1); /*gaps_in_frame_num_allowed_flag*/
-	mb_width = bs_get_ue(bs) + 1;
-	mb_height= bs_get_ue(bs) + 1;
+	mb_width = gf_bs_read_ue(bs) + 1;
+	mb_height= gf_bs_read_ue(bs) + 1;
 
 	sps->frame_mbs_only_flag = gf_bs_read_int(bs, 1);
 
@@ -2360,10 +2312,10 @@ s32 gf_media_avc_read_sps(const char *sps_data, u32 sps_size, AVCState *avc, u32
 			CropUnitY = SubHeightC * (2-sps->frame_mbs_only_flag);
 		}
 
-		cl = bs_get_ue(bs); /*crop_left*/
-		cr = bs_get_ue(bs); /*crop_right*/
-		ct = bs_get_ue(bs); /*crop_top*/
-		cb = bs_get_ue(bs); /*crop_bottom*/
+		cl = gf_bs_read_ue(bs); /*crop_left*/
+		cr = gf_bs_read_ue(bs); /*crop_right*/
+		ct = gf_bs_read_ue(bs); /*crop_top*/
+		cb = gf_bs_read_ue(bs); /*crop_bottom*/
 
 		sps->width -= CropUnitX * (cl + cr);
 		sps->height -= CropUnitY * (ct + cb);
@@ -2399,8 +2351,8 @@ s32 gf_media_avc_read_sps(const char *sps_data, u32 sps_size, AVCState *avc, u32
 		}
 
 		if (gf_bs_read_int(bs, 1)) {	/* chroma_location_info_present_flag */
-			bs_get_ue(bs);				/* chroma_sample_location_type_top_field */
-			bs_get_ue(bs);				/* chroma_sample_location_type_bottom_field */
+			gf_bs_read_ue(bs);				/* chroma_sample_location_type_top_field */
+			gf_bs_read_ue(bs);				/* chroma_sample_location_type_bottom_field */
 		}
 
 		sps->vui.timing_info_present_flag = gf_bs_read_int(bs, 1);
@@ -2443,10 +2395,10 @@ s32 gf_media_avc_read_sps(const char *sps_data, u32 sps_size, AVCState *avc, u32
 					/*seq_ref_layer_chroma_phase_x_plus1_flag*/gf_bs_read_int(bs, 1);
 					/*seq_ref_layer_chroma_phase_y_plus1*/gf_bs_read_int(bs, 2);
 				}
-				/*seq_scaled_ref_layer_left_offset*/ bs_get_se(bs);
-				/*seq_scaled_ref_layer_top_offset*/bs_get_se(bs);
-				/*seq_scaled_ref_layer_right_offset*/bs_get_se(bs);
-				/*seq_scaled_ref_layer_bottom_offset*/bs_get_se(bs);
+				/*seq_scaled_ref_layer_left_offset*/ gf_bs_read_se(bs);
+				/*seq_scaled_ref_layer_top_offset*/gf_bs_read_se(bs);
+				/*seq_scaled_ref_layer_right_offset*/gf_bs_read_se(bs);
+				/*seq_scaled_ref_layer_bottom_offset*/gf_bs_read_se(bs);
 			}
 			if (/*seq_tcoeff_level_prediction_flag*/gf_bs_read_int(bs, 1)) {
 				/*adaptive_tcoeff_level_prediction_flag*/ gf_bs_read_int(bs, 1);
@@ -2456,7 +2408,7 @@ s32 gf_media_avc_read_sps(const char *sps_data, u32 sps_size, AVCState *avc, u32
 			/*svc_vui_parameters_present*/
 			if (gf_bs_read_int(bs, 1)) {
 				u32 i, vui_ext_num_entries_minus1;
-				vui_ext_num_entries_minus1 = bs_get_ue(bs);
+				vui_ext_num_entries_minus1 = gf_bs_read_ue(bs);
 
 				for (i=0; i <= vui_ext_num_entries_minus1; i++) {
 					u8 vui_ext_nal_hrd_parameters_present_flag, vui_ext_vcl_hrd_parameters_present_flag, vui_ext_timing_info_present_flag;
@@ -2521,7 +2473,7 @@ s32 gf_media_avc_read_pps(const char *pps_data, u32 pps_size, AVCState *avc)
 	/*nal hdr*/gf_bs_read_u8(bs);
 
 
-	pps_id = bs_get_ue(bs);
+	pps_id = gf_bs_read_ue(bs);
 	if (pps_id>=255) {
 		pps_id = -1;
 		goto exit;
@@ -2529,7 +2481,7 @@ s32 gf_media_avc_read_pps(const char *pps_data, u32 pps_size, AVCState *avc)
 	pps = &avc->pps[pps_id];
 
 	if (!pps->status) pps->status = 1;
-	pps->sps_id = bs_get_ue(bs);
+	pps->sps_id = gf_bs_read_ue(bs);
 	if (pps->sps_id >= 32) {
 		pps->sps_id = 0;
 		pps_id = -1;
@@ -2543,19 +2495,19 @@ s32 gf_media_avc_read_pps(const char *pps_data, u32 pps_size, AVCState *avc)
 	avc->sps_active_idx = pps->sps_id; /*set active sps*/
 	/*pps->cabac = */gf_bs_read_int(bs, 1);
 	pps->pic_order_present= gf_bs_read_int(bs, 1);
-	pps->slice_group_count= bs_get_ue(bs) + 1;
-	if (pps->slice_group_count > 1 ) /*pps->mb_slice_group_map_type = */bs_get_ue(bs);
-	/*pps->ref_count[0]= */bs_get_ue(bs) /*+ 1*/;
-	/*pps->ref_count[1]= */bs_get_ue(bs) /*+ 1*/;
+	pps->slice_group_count= gf_bs_read_ue(bs) + 1;
+	if (pps->slice_group_count > 1 ) /*pps->mb_slice_group_map_type = */gf_bs_read_ue(bs);
+	/*pps->ref_count[0]= */gf_bs_read_ue(bs) /*+ 1*/;
+	/*pps->ref_count[1]= */gf_bs_read_ue(bs) /*+ 1*/;
 	/*
 	if ((pps->ref_count[0] > 32) || (pps->ref_count[1] > 32)) goto exit;
 	*/
 
 	/*pps->weighted_pred = */gf_bs_read_int(bs, 1);
 	/*pps->weighted_bipred_idc = */gf_bs_read_int(bs, 2);
-	/*pps->init_qp = */bs_get_se(bs) /*+ 26*/;
-	/*pps->init_qs= */bs_get_se(bs) /*+ 26*/;
-	/*pps->chroma_qp_index_offset = */bs_get_se(bs);
+	/*pps->init_qp = */gf_bs_read_se(bs) /*+ 26*/;
+	/*pps->init_qs= */gf_bs_read_se(bs) /*+ 26*/;
+	/*pps->chroma_qp_index_offset = */gf_bs_read_se(bs);
 	/*pps->deblocking_filter_parameters_present = */gf_bs_read_int(bs, 1);
 	/*pps->constrained_intra_pred = */gf_bs_read_int(bs, 1);
 	pps->redundant_pic_cnt_present = gf_bs_read_int(bs, 1);
@@ -2580,7 +2532,7 @@ s32 gf_media_avc_read_sps_ext(const char *spse_data, u32 spse_size)
 
 	/*nal header*/gf_bs_read_u8(bs);
 
-	sps_id = bs_get_ue(bs);
+	sps_id = gf_bs_read_ue(bs);
 
 	gf_bs_del(bs);
 	gf_free(spse_data_without_emulation_bytes);
@@ -2608,11 +2560,11 @@ static s32 avc_parse_slice(GF_BitStream *bs, AVCState *avc, Bool svc_idr_flag, A
 	s32 pps_id;
 
 	/*s->current_picture.reference= h->nal_ref_idc != 0;*/
-	/*first_mb_in_slice = */bs_get_ue(bs);
-	si->slice_type = bs_get_ue(bs);
+	/*first_mb_in_slice = */gf_bs_read_ue(bs);
+	si->slice_type = gf_bs_read_ue(bs);
 	if (si->slice_type > 9) return -1;
 
-	pps_id = bs_get_ue(bs);
+	pps_id = gf_bs_read_ue(bs);
 	if (pps_id>255) return -1;
 	si->pps = &avc->pps[pps_id];
 	if (!si->pps->slice_group_count) return -2;
@@ -2629,20 +2581,20 @@ static s32 avc_parse_slice(GF_BitStream *bs, AVCState *avc, Bool svc_idr_flag, A
 			si->bottom_field_flag = gf_bs_read_int(bs, 1);
 	}
 	if ((si->nal_unit_type==GF_AVC_NALU_IDR_SLICE) || svc_idr_flag)
-		si->idr_pic_id = bs_get_ue(bs);
+		si->idr_pic_id = gf_bs_read_ue(bs);
 
 	if (si->sps->poc_type==0) {
 		si->poc_lsb = gf_bs_read_int(bs, si->sps->log2_max_poc_lsb);
 		if (si->pps->pic_order_present && !si->field_pic_flag) {
-			si->delta_poc_bottom = bs_get_se(bs);
+			si->delta_poc_bottom = gf_bs_read_se(bs);
 		}
 	} else if ((si->sps->poc_type==1) && !si->sps->delta_pic_order_always_zero_flag) {
-		si->delta_poc[0] = bs_get_se(bs);
+		si->delta_poc[0] = gf_bs_read_se(bs);
 		if ((si->pps->pic_order_present==1) && !si->field_pic_flag)
-			si->delta_poc[1] = bs_get_se(bs);
+			si->delta_poc[1] = gf_bs_read_se(bs);
 	}
 	if (si->pps->redundant_pic_cnt_present) {
-		si->redundant_pic_cnt = bs_get_ue(bs);
+		si->redundant_pic_cnt = gf_bs_read_ue(bs);
 	}
 	return 0;
 }
@@ -2653,11 +2605,11 @@ static s32 svc_parse_slice(GF_BitStream *bs, AVCState *avc, AVCSliceInfo *si)
 	s32 pps_id;
 
 	/*s->current_picture.reference= h->nal_ref_idc != 0;*/
-	/*first_mb_in_slice = */bs_get_ue(bs);
-	si->slice_type = bs_get_ue(bs);
+	/*first_mb_in_slice = */gf_bs_read_ue(bs);
+	si->slice_type = gf_bs_read_ue(bs);
 	if (si->slice_type > 9) return -1;
 
-	pps_id = bs_get_ue(bs);
+	pps_id = gf_bs_read_ue(bs);
 	if (pps_id>255)
 		return -1;
 	si->pps = &avc->pps[pps_id];
@@ -2678,20 +2630,20 @@ static s32 svc_parse_slice(GF_BitStream *bs, AVCState *avc, AVCSliceInfo *si)
 		if (si->field_pic_flag) si->bottom_field_flag = gf_bs_read_int(bs, 1);
 	}
 	if (si->nal_unit_type == GF_AVC_NALU_IDR_SLICE || si ->NalHeader.idr_pic_flag)
-		si->idr_pic_id = bs_get_ue(bs);
+		si->idr_pic_id = gf_bs_read_ue(bs);
 
 	if (si->sps->poc_type==0) {
 		si->poc_lsb = gf_bs_read_int(bs, si->sps->log2_max_poc_lsb);
 		if (si->pps->pic_order_present && !si->field_pic_flag) {
-			si->delta_poc_bottom = bs_get_se(bs);
+			si->delta_poc_bottom = gf_bs_read_se(bs);
 		}
 	} else if ((si->sps->poc_type==1) && !si->sps->delta_pic_order_always_zero_flag) {
-		si->delta_poc[0] = bs_get_se(bs);
+		si->delta_poc[0] = gf_bs_read_se(bs);
 		if ((si->pps->pic_order_present==1) && !si->field_pic_flag)
-			si->delta_poc[1] = bs_get_se(bs);
+			si->delta_poc[1] = gf_bs_read_se(bs);
 	}
 	if (si->pps->redundant_pic_cnt_present) {
-		si->redundant_pic_cnt = bs_get_ue(bs);
+		si->redundant_pic_cnt = gf_bs_read_ue(bs);
 	}
 	return 0;
 }
@@ -2701,7 +2653,7 @@ static s32 avc_parse_recovery_point_sei(GF_BitStream *bs, AVCState *avc)
 {
 	AVCSeiRecoveryPoint *rp = &avc->sei.recovery_point;
 
-	rp->frame_cnt = bs_get_ue(bs);
+	rp->frame_cnt = gf_bs_read_ue(bs);
 	rp->exact_match_flag = gf_bs_read_int(bs, 1);
 	rp->broken_link_flag = gf_bs_read_int(bs, 1);
 	rp->changing_slice_group_idc = gf_bs_read_int(bs, 2);
@@ -3332,8 +3284,8 @@ GF_Err gf_avc_get_pps_info(char *pps_data, u32 pps_size, u32 *pps_id, u32 *sps_i
 	}
 	/*nal hdr*/ gf_bs_read_int(bs, 8);
 
-	*pps_id = bs_get_ue(bs);
-	*sps_id = bs_get_ue(bs);
+	*pps_id = gf_bs_read_ue(bs);
+	*sps_id = gf_bs_read_ue(bs);
 
 exit:
 	gf_bs_del(bs);
@@ -3396,12 +3348,12 @@ static Bool parse_short_term_ref_pic_set(GF_BitStream *bs, HEVC_SPS *sps, u32 id
 		s32 deltaRPS;
 		u32 k = 0, k0 = 0, k1 = 0;
 		if (idx_rps == sps->num_short_term_ref_pic_sets)
-			delta_idx_minus1 = bs_get_ue(bs);
+			delta_idx_minus1 = gf_bs_read_ue(bs);
 
 		assert(delta_idx_minus1 <= idx_rps - 1);
 		ref_idx = idx_rps - 1 - delta_idx_minus1;
 		delta_rps_sign = gf_bs_read_int(bs, 1);
-		abs_delta_rps_minus1 = bs_get_ue(bs);
+		abs_delta_rps_minus1 = gf_bs_read_ue(bs);
 		deltaRPS = (1 - (delta_rps_sign<<1)) * (abs_delta_rps_minus1 + 1);
 
 		rps = &sps->rps[idx_rps];
@@ -3432,17 +3384,17 @@ static Bool parse_short_term_ref_pic_set(GF_BitStream *bs, HEVC_SPS *sps, u32 id
 		rps->num_positive_pics = k1;
 	} else {
 		s32 prev = 0, poc = 0;
-		sps->rps[idx_rps].num_negative_pics = bs_get_ue(bs);
-		sps->rps[idx_rps].num_positive_pics = bs_get_ue(bs);
+		sps->rps[idx_rps].num_negative_pics = gf_bs_read_ue(bs);
+		sps->rps[idx_rps].num_positive_pics = gf_bs_read_ue(bs);
 		for (i=0; i<sps->rps[idx_rps].num_negative_pics; i++) {
-			u32 delta_poc_s0_minus1 = bs_get_ue(bs);
+			u32 delta_poc_s0_minus1 = gf_bs_read_ue(bs);
 			poc = prev - delta_poc_s0_minus1 - 1;
 			prev = poc;
 			sps->rps[idx_rps].delta_poc[i] = poc;
 			/*used_by_curr_pic_s1_flag[ i ] = */gf_bs_read_int(bs, 1);
 		}
 		for (i=0; i<sps->rps[idx_rps].num_positive_pics; i++) {
-			u32 delta_poc_s1_minus1 = bs_get_ue(bs);
+			u32 delta_poc_s1_minus1 = gf_bs_read_ue(bs);
 			poc = prev + delta_poc_s1_minus1 + 1;
 			prev = poc;
 			sps->rps[idx_rps].delta_poc[i] = poc;
@@ -3484,7 +3436,7 @@ s32 hevc_parse_slice_segment(GF_BitStream *bs, HEVCState *hevc, HEVCSliceInfo *s
 		/*Bool no_output_of_prior_pics_flag = */gf_bs_read_int(bs, 1);
 	}
 
-	pps_id = bs_get_ue(bs);
+	pps_id = gf_bs_read_ue(bs);
 	if (pps_id>=64) return -1;
 
 	pps = &hevc->pps[pps_id];
@@ -3516,7 +3468,7 @@ s32 hevc_parse_slice_segment(GF_BitStream *bs, HEVCState *hevc, HEVCSliceInfo *s
 		//"slice_reserved_undetermined_flag[]"
 		gf_bs_read_int(bs, pps->num_extra_slice_header_bits);
 
-		si->slice_type = bs_get_ue(bs);
+		si->slice_type = gf_bs_read_ue(bs);
 
 		if(pps->output_flag_present_flag)
 			/*pic_output_flag = */gf_bs_read_int(bs, 1);
@@ -3551,9 +3503,9 @@ s32 hevc_parse_slice_segment(GF_BitStream *bs, HEVCState *hevc, HEVCSliceInfo *s
 				u32 num_long_term_sps = 0;
 				u32 num_long_term_pics = 0;
 				if (sps->num_long_term_ref_pic_sps > 0 ) {
-					num_long_term_sps = bs_get_ue(bs);
+					num_long_term_sps = gf_bs_read_ue(bs);
 				}
-				num_long_term_pics = bs_get_ue(bs);
+				num_long_term_pics = gf_bs_read_ue(bs);
 
 				for (i = 0; i < num_long_term_sps + num_long_term_pics; i++ ) {
 					if( i < num_long_term_sps ) {
@@ -3566,9 +3518,9 @@ s32 hevc_parse_slice_segment(GF_BitStream *bs, HEVCState *hevc, HEVCSliceInfo *s
 					}
 					if (/*delta_poc_msb_present_flag[ i ] = */ gf_bs_read_int(bs, 1) ) {
 						if( i == 0 || i == num_long_term_sps )
-							DeltaPocMsbCycleLt[i] = bs_get_ue(bs);
+							DeltaPocMsbCycleLt[i] = gf_bs_read_ue(bs);
 						else
-							DeltaPocMsbCycleLt[i] = bs_get_ue(bs) + DeltaPocMsbCycleLt[i-1];
+							DeltaPocMsbCycleLt[i] = gf_bs_read_ue(bs) + DeltaPocMsbCycleLt[i-1];
 					}
 				}
 			}
@@ -3590,9 +3542,9 @@ s32 hevc_parse_slice_segment(GF_BitStream *bs, HEVCState *hevc, HEVCSliceInfo *s
 				num_ref_idx_l1_active = pps->num_ref_idx_l1_default_active;
 
 			if ( /*num_ref_idx_active_override_flag =*/gf_bs_read_int(bs, 1) ) {
-				num_ref_idx_l0_active = 1 + bs_get_ue(bs);
+				num_ref_idx_l0_active = 1 + gf_bs_read_ue(bs);
 				if (si->slice_type == GF_HEVC_TYPE_B)
-					num_ref_idx_l1_active = 1 + bs_get_ue(bs);
+					num_ref_idx_l1_active = 1 + gf_bs_read_ue(bs);
 			}
 
 //            if (pps->lists_modification_present_flag && NumPocTotalCurr > 1) {
@@ -3614,7 +3566,7 @@ s32 hevc_parse_slice_segment(GF_BitStream *bs, HEVCState *hevc, HEVCSliceInfo *s
 				if ( (collocated_from_l0_flag && num_ref_idx_l0_active-1 > 0 )
 				        || ( !collocated_from_l0_flag && num_ref_idx_l1_active-1 > 0 )
 				   ) {
-					/*collocated_ref_idx=*/bs_get_ue(bs);
+					/*collocated_ref_idx=*/gf_bs_read_ue(bs);
 				}
 			}
 
@@ -3624,12 +3576,12 @@ s32 hevc_parse_slice_segment(GF_BitStream *bs, HEVCState *hevc, HEVCSliceInfo *s
 				GF_LOG(GF_LOG_INFO, GF_LOG_CODING, ("[hehv] pred_weight_table not implemented\n"));
 				return 0;
 			}
-			/*five_minus_max_num_merge_cand=*/bs_get_ue(bs);
+			/*five_minus_max_num_merge_cand=*/gf_bs_read_ue(bs);
 		}
-		/*slice_qp_delta = */bs_get_se(bs);
+		/*slice_qp_delta = */gf_bs_read_se(bs);
 		if( pps->slice_chroma_qp_offsets_present_flag ) {
-			/*slice_cb_qp_offset=*/bs_get_se(bs);
-			/*slice_cr_qp_offset=*/bs_get_se(bs);
+			/*slice_cb_qp_offset=*/gf_bs_read_se(bs);
+			/*slice_cr_qp_offset=*/gf_bs_read_se(bs);
 		}
 		if ( pps->deblocking_filter_override_enabled_flag ) {
 			deblocking_filter_override_flag = gf_bs_read_int(bs, 1);
@@ -3638,8 +3590,8 @@ s32 hevc_parse_slice_segment(GF_BitStream *bs, HEVCState *hevc, HEVCSliceInfo *s
 		if (deblocking_filter_override_flag) {
 			slice_deblocking_filter_disabled_flag = gf_bs_read_int(bs, 1);
 			if ( !slice_deblocking_filter_disabled_flag) {
-				/*slice_beta_offset_div2=*/ bs_get_se(bs);
-				/*slice_tc_offset_div2=*/bs_get_se(bs);
+				/*slice_beta_offset_div2=*/ gf_bs_read_se(bs);
+				/*slice_tc_offset_div2=*/gf_bs_read_se(bs);
 			}
 		}
 		if( pps->loop_filter_across_slices_enabled_flag
@@ -3651,9 +3603,9 @@ s32 hevc_parse_slice_segment(GF_BitStream *bs, HEVCState *hevc, HEVCSliceInfo *s
 
 
 	if (pps->tiles_enabled_flag || pps->entropy_coding_sync_enabled_flag ) {
-		u32 num_entry_point_offsets = bs_get_ue(bs);
+		u32 num_entry_point_offsets = gf_bs_read_ue(bs);
 		if ( num_entry_point_offsets > 0) {
-			u32 offset = bs_get_ue(bs) + 1;
+			u32 offset = gf_bs_read_ue(bs) + 1;
 			u32 segments = offset >> 4;
 			s32 remain = (offset & 15);
 
@@ -3962,12 +3914,12 @@ s32 gf_media_hevc_read_vps(char *data, u32 size, HEVCState *hevc)
 
 	vps_sub_layer_ordering_info_present_flag = gf_bs_read_int(bs, 1);
 	for (i=(vps_sub_layer_ordering_info_present_flag ? 0 : vps->max_sub_layers - 1); i < vps->max_sub_layers; i++) {
-		/*vps_max_dec_pic_buffering_minus1[i] = */bs_get_ue(bs);
-		/*vps_max_num_reorder_pics[i] = */bs_get_ue(bs);
-		/*vps_max_latency_increase_plus1[i] = */bs_get_ue(bs);
+		/*vps_max_dec_pic_buffering_minus1[i] = */gf_bs_read_ue(bs);
+		/*vps_max_num_reorder_pics[i] = */gf_bs_read_ue(bs);
+		/*vps_max_latency_increase_plus1[i] = */gf_bs_read_ue(bs);
 	}
 	vps->max_layer_id = gf_bs_read_int(bs, 6);
-	vps->num_layer_sets = bs_get_ue(bs) + 1;
+	vps->num_layer_sets = gf_bs_read_ue(bs) + 1;
 	for (i=1; i < vps->num_layer_sets; i++) {
 		for (j=0; j <= vps->max_layer_id; j++) {
 			/*layer_id_included_flag[ i ][ j ]*/gf_bs_read_int(bs, 1);
@@ -3978,12 +3930,12 @@ s32 gf_media_hevc_read_vps(char *data, u32 size, HEVCState *hevc)
 		/*u32 vps_num_units_in_tick = */gf_bs_read_int(bs, 32);
 		/*u32 vps_time_scale = */gf_bs_read_int(bs, 32);
 		if (/*vps_poc_proportional_to_timing_flag*/gf_bs_read_int(bs, 1)) {
-			/*vps_num_ticks_poc_diff_one_minus1*/bs_get_ue(bs);
+			/*vps_num_ticks_poc_diff_one_minus1*/gf_bs_read_ue(bs);
 		}
-		vps_num_hrd_parameters = bs_get_ue(bs);
+		vps_num_hrd_parameters = gf_bs_read_ue(bs);
 		for( i = 0; i < vps_num_hrd_parameters; i++ ) {
 			//Bool cprms_present_flag=1;
-			/*hrd_layer_set_idx[ i ] = */bs_get_ue(bs);
+			/*hrd_layer_set_idx[ i ] = */gf_bs_read_ue(bs);
 			if (i>0)
 				/*cprms_present_flag = */gf_bs_read_int(bs, 1) ;
 			// hevc_parse_hrd_parameters(cprms_present_flag, vps->max_sub_layers - 1);
@@ -4054,7 +4006,7 @@ static s32 gf_media_hevc_read_sps_ex(char *data, u32 size, HEVCState *hevc, u32
 		profile_tier_level(bs, 1, max_sub_layers_minus1, &ptl);
 	}
 
-	sps_id = bs_get_ue(bs);
+	sps_id = gf_bs_read_ue(bs);
 	if (sps_id>=16) {
 		sps_id = -1;
 		goto exit;
@@ -4088,11 +4040,11 @@ static s32 gf_media_hevc_read_sps_ex(char *data, u32 size, HEVCState *hevc, u32
 		//TODO this is crude ...
 		sps->ptl = vps->ext_ptl[0];
 	} else {
-		sps->chroma_format_idc = bs_get_ue(bs);
+		sps->chroma_format_idc = gf_bs_read_ue(bs);
 		if (sps->chroma_format_idc==3)
 			sps->separate_colour_plane_flag = gf_bs_read_int(bs, 1);
-		sps->width = bs_get_ue(bs);
-		sps->height = bs_get_ue(bs);
+		sps->width = gf_bs_read_ue(bs);
+		sps->height = gf_bs_read_ue(bs);
 	}
 
 	if (gf_bs_read_int(bs, 1)) {
@@ -4108,41 +4060,41 @@ static s32 gf_media_hevc_read_sps_ex(char *data, u32 size, HEVCState *hevc, u32
 			SubWidthC = SubHeightC = 1;
 		}
 
-		sps->cw_left = bs_get_ue(bs);
-		sps->cw_right = bs_get_ue(bs);
-		sps->cw_top = bs_get_ue(bs);
-		sps->cw_bottom = bs_get_ue(bs);
+		sps->cw_left = gf_bs_read_ue(bs);
+		sps->cw_right = gf_bs_read_ue(bs);
+		sps->cw_top = gf_bs_read_ue(bs);
+		sps->cw_bottom = gf_bs_read_ue(bs);
 
 		sps->width -= SubWidthC * (sps->cw_left + sps->cw_right);
 		sps->height -= SubHeightC * (sps->cw_top + sps->cw_bottom);
 	}
 	if (layer_id == 0) {
-		sps->bit_depth_luma = 8 + bs_get_ue(bs);
-		sps->bit_depth_chroma = 8 + bs_get_ue(bs);
+		sps->bit_depth_luma = 8 + gf_bs_read_ue(bs);
+		sps->bit_depth_chroma = 8 + gf_bs_read_ue(bs);
 	}
 
-	sps->log2_max_pic_order_cnt_lsb = 4 + bs_get_ue(bs);
+	sps->log2_max_pic_order_cnt_lsb = 4 + gf_bs_read_ue(bs);
 
 	if (layer_id == 0) {
 		sps_sub_layer_ordering_info_present_flag = gf_bs_read_int(bs, 1);
 		for(i=sps_sub_layer_ordering_info_present_flag ? 0 : max_sub_layers_minus1; i<=max_sub_layers_minus1; i++) {
-			/*max_dec_pic_buffering = */ bs_get_ue(bs);
-			/*num_reorder_pics = */ bs_get_ue(bs);
-			/*max_latency_increase = */ bs_get_ue(bs);
+			/*max_dec_pic_buffering = */ gf_bs_read_ue(bs);
+			/*num_reorder_pics = */ gf_bs_read_ue(bs);
+			/*max_latency_increase = */ gf_bs_read_ue(bs);
 		}
 	}
 
-	log2_min_luma_coding_block_size = 3 + bs_get_ue(bs);
-	log2_diff_max_min_luma_coding_block_size = bs_get_ue(bs);
+	log2_min_luma_coding_block_size = 3 + gf_bs_read_ue(bs);
+	log2_diff_max_min_luma_coding_block_size = gf_bs_read_ue(bs);
 	sps->max_CU_width = ( 1<<(log2_min_luma_coding_block_size + log2_diff_max_min_luma_coding_block_size) );
 	sps->max_CU_height = ( 1<<(log2_min_luma_coding_block_size + log2_diff_max_min_luma_coding_block_size) );
 
-	log2_min_transform_block_size = 2 + bs_get_ue(bs);
-	/*log2_max_transform_block_size = log2_min_transform_block_size  + */bs_get_ue(bs);
+	log2_min_transform_block_size = 2 + gf_bs_read_ue(bs);
+	/*log2_max_transform_block_size = log2_min_transform_block_size  + */gf_bs_read_ue(bs);
 
 	depth = 0;
-	/*u32 max_transform_hierarchy_depth_inter = */bs_get_ue(bs);
-	/*u32 max_transform_hierarchy_depth_intra = */bs_get_ue(bs);
+	/*u32 max_transform_hierarchy_depth_inter = */gf_bs_read_ue(bs);
+	/*u32 max_transform_hierarchy_depth_intra = */gf_bs_read_ue(bs);
 	while( (u32) ( sps->max_CU_width >> log2_diff_max_min_luma_coding_block_size ) > (u32) ( 1 << ( log2_min_transform_block_size + depth )  ) )
 	{
 		depth++;
@@ -4176,18 +4128,18 @@ static s32 gf_media_hevc_read_sps_ex(char *data, u32 size, HEVCState *hevc, u32
 	if (/*pcm_enabled_flag= */ gf_bs_read_int(bs, 1) ) {
 		/*pcm_sample_bit_depth_luma_minus1=*/gf_bs_read_int(bs, 4);
 		/*pcm_sample_bit_depth_chroma_minus1=*/gf_bs_read_int(bs, 4);
-		/*log2_min_pcm_luma_coding_block_size_minus3= */ bs_get_ue(bs);
-		/*log2_diff_max_min_pcm_luma_coding_block_size = */ bs_get_ue(bs);
+		/*log2_min_pcm_luma_coding_block_size_minus3= */ gf_bs_read_ue(bs);
+		/*log2_diff_max_min_pcm_luma_coding_block_size = */ gf_bs_read_ue(bs);
 		/*pcm_loop_filter_disable_flag=*/gf_bs_read_int(bs, 1);
 	}
-	sps->num_short_term_ref_pic_sets = bs_get_ue(bs);
+	sps->num_short_term_ref_pic_sets = gf_bs_read_ue(bs);
 	for (i=0; i<sps->num_short_term_ref_pic_sets; i++) {
 		Bool ret = parse_short_term_ref_pic_set(bs, sps, i);
 		/*cannot parse short_term_ref_pic_set, skip VUI parsing*/
 		if (!ret) goto exit;
 	}
 	if ( (sps->long_term_ref_pics_present_flag = gf_bs_read_int(bs, 1)) ) {
-		sps->num_long_term_ref_pic_sps = bs_get_ue(bs);
+		sps->num_long_term_ref_pic_sps = gf_bs_read_ue(bs);
 		for (i=0; i<sps->num_long_term_ref_pic_sps; i++) {
 			/*lt_ref_pic_poc_lsb_sps=*/gf_bs_read_int(bs, sps->log2_max_pic_order_cnt_lsb);
 			/*used_by_curr_pic_lt_sps_flag*/gf_bs_read_int(bs, 1);
@@ -4231,8 +4183,8 @@ static s32 gf_media_hevc_read_sps_ex(char *data, u32 size, HEVCState *hevc, u32
 		}
 
 		if (/*chroma_loc_info_present_flag = */ gf_bs_read_int(bs, 1)) {
-			/*chroma_sample_loc_type_top_field = */ bs_get_ue(bs);
-			/*chroma_sample_loc_type_bottom_field = */bs_get_ue(bs);
+			/*chroma_sample_loc_type_top_field = */ gf_bs_read_ue(bs);
+			/*chroma_sample_loc_type_bottom_field = */gf_bs_read_ue(bs);
 		}
 
 		/*neutra_chroma_indication_flag = */gf_bs_read_int(bs, 1);
@@ -4240,10 +4192,10 @@ static s32 gf_media_hevc_read_sps_ex(char *data, u32 size, HEVCState *hevc, u32
 		/*frame_field_info_present_flag = */gf_bs_read_int(bs, 1);
 
 		if (/*default_display_window_flag=*/gf_bs_read_int(bs, 1)) {
-			/*left_offset = */bs_get_ue(bs);
-			/*right_offset = */bs_get_ue(bs);
-			/*top_offset = */bs_get_ue(bs);
-			/*bottom_offset = */bs_get_ue(bs);
+			/*left_offset = */gf_bs_read_ue(bs);
+			/*right_offset = */gf_bs_read_ue(bs);
+			/*top_offset = */gf_bs_read_ue(bs);
+			/*bottom_offset = */gf_bs_read_ue(bs);
 		}
 
 		sps->has_timing_info = gf_bs_read_int(bs, 1);
@@ -4252,7 +4204,7 @@ static s32 gf_media_hevc_read_sps_ex(char *data, u32 size, HEVCState *hevc, u32
 			sps->time_scale = gf_bs_read_int(bs, 32);
 			sps->poc_proportional_to_timing_flag = gf_bs_read_int(bs, 1);
 			if (sps->poc_proportional_to_timing_flag)
-				sps->num_ticks_poc_diff_one_minus1 = bs_get_ue(bs);
+				sps->num_ticks_poc_diff_one_minus1 = gf_bs_read_ue(bs);
 			if (/*hrd_parameters_present_flag=*/gf_bs_read_int(bs, 1) ) {
 				goto exit;
 //				GF_LOG(GF_LOG_INFO, GF_LOG_CODING, ("[HEVC] HRD param parsing not implemented\n"));
@@ -4263,11 +4215,11 @@ static s32 gf_media_hevc_read_sps_ex(char *data, u32 size, HEVCState *hevc, u32
 			/*tiles_fixed_structure_flag = */gf_bs_read_int(bs, 1);
 			/*motion_vectors_over_pic_boundaries_flag = */gf_bs_read_int(bs, 1);
 			/*restricted_ref_pic_lists_flag = */gf_bs_read_int(bs, 1);
-			/*min_spatial_segmentation_idc = */bs_get_ue(bs);
-			/*max_bytes_per_pic_denom = */bs_get_ue(bs);
-			/*max_bits_per_min_cu_denom = */bs_get_ue(bs);
-			/*log2_max_mv_length_horizontal = */bs_get_ue(bs);
-			/*log2_max_mv_length_vertical = */bs_get_ue(bs);
+			/*min_spatial_segmentation_idc = */gf_bs_read_ue(bs);
+			/*max_bytes_per_pic_denom = */gf_bs_read_ue(bs);
+			/*max_bits_per_min_cu_denom = */gf_bs_read_ue(bs);
+			/*log2_max_mv_length_horizontal = */gf_bs_read_ue(bs);
+			/*log2_max_mv_length_vertical = */gf_bs_read_ue(bs);
 		}
 	}
 
@@ -4309,7 +4261,7 @@ s32 gf_media_hevc_read_pps(char *data, u32 size, HEVCState *hevc)
 
 	gf_bs_read_u16(bs);
 
-	pps_id = bs_get_ue(bs);
+	pps_id = gf_bs_read_ue(bs);
 
 	if (pps_id>=64) goto exit;
 	pps = &hevc->pps[pps_id];
@@ -4318,7 +4270,7 @@ s32 gf_media_hevc_read_pps(char *data, u32 size, HEVCState *hevc)
 		pps->id = pps_id;
 		pps->state = 1;
 	}
-	pps->sps_id = bs_get_ue(bs);
+	pps->sps_id = gf_bs_read_ue(bs);
 	hevc->sps_active_idx = pps->sps_id; /*set active sps*/
 	pps->dependent_slice_segments_enabled_flag = gf_bs_read_int(bs, 1);
 
@@ -4326,16 +4278,16 @@ s32 gf_media_hevc_read_pps(char *data, u32 size, HEVCState *hevc)
 	pps->num_extra_slice_header_bits = gf_bs_read_int(bs, 3);
 	/*sign_data_hiding_flag = */gf_bs_read_int(bs, 1);
 	pps->cabac_init_present_flag = gf_bs_read_int(bs, 1);
-	pps->num_ref_idx_l0_default_active = 1 + bs_get_ue(bs);
-	pps->num_ref_idx_l1_default_active = 1 + bs_get_ue(bs);
-	/*pic_init_qp_minus26 = */bs_get_se(bs);
+	pps->num_ref_idx_l0_default_active = 1 + gf_bs_read_ue(bs);
+	pps->num_ref_idx_l1_default_active = 1 + gf_bs_read_ue(bs);
+	/*pic_init_qp_minus26 = */gf_bs_read_se(bs);
 	/*constrained_intra_pred_flag = */gf_bs_read_int(bs, 1);
 	/*transform_skip_enabled_flag = */gf_bs_read_int(bs, 1);
 	if (/*cu_qp_delta_enabled_flag = */gf_bs_read_int(bs, 1) )
-		/*diff_cu_qp_delta_depth = */bs_get_ue(bs);
+		/*diff_cu_qp_delta_depth = */gf_bs_read_ue(bs);
 
-	/*pic_cb_qp_offset = */bs_get_se(bs);
-	/*pic_cr_qp_offset = */bs_get_se(bs);
+	/*pic_cb_qp_offset = */gf_bs_read_se(bs);
+	/*pic_cr_qp_offset = */gf_bs_read_se(bs);
 	pps->slice_chroma_qp_offsets_present_flag = gf_bs_read_int(bs, 1);
 	pps->weighted_pred_flag = gf_bs_read_int(bs, 1);
 	pps->weighted_bipred_flag = gf_bs_read_int(bs, 1);
@@ -4343,15 +4295,15 @@ s32 gf_media_hevc_read_pps(char *data, u32 size, HEVCState *hevc)
 	pps->tiles_enabled_flag = gf_bs_read_int(bs, 1);
 	pps->entropy_coding_sync_enabled_flag = gf_bs_read_int(bs, 1);
 	if (pps->tiles_enabled_flag) {
-		pps->num_tile_columns = 1 + bs_get_ue(bs);
-		pps->num_tile_rows = 1 + bs_get_ue(bs);
+		pps->num_tile_columns = 1 + gf_bs_read_ue(bs);
+		pps->num_tile_rows = 1 + gf_bs_read_ue(bs);
 		pps->uniform_spacing_flag = gf_bs_read_int(bs, 1);
 		if (!pps->uniform_spacing_flag ) {
 			for (i=0; i<pps->num_tile_columns-1; i++) {
-				pps->column_width[i] = 1 + bs_get_ue(bs);
+				pps->column_width[i] = 1 + gf_bs_read_ue(bs);
 			}
 			for (i=0; i<pps->num_tile_rows-1; i++) {
-				pps->row_height[i] = 1+bs_get_ue(bs);
+				pps->row_height[i] = 1+gf_bs_read_ue(bs);
 			}
 		}
 		pps->loop_filter_across_tiles_enabled_flag = gf_bs_read_int(bs, 1);
@@ -4360,8 +4312,8 @@ s32 gf_media_hevc_read_pps(char *data, u32 size, HEVCState *hevc)
 	if( /*deblocking_filter_control_present_flag = */gf_bs_read_int(bs, 1)  ) {
 		pps->deblocking_filter_override_enabled_flag = gf_bs_read_int(bs, 1);
 		if (! /*pic_disable_deblocking_filter_flag= */gf_bs_read_int(bs, 1) ) {
-			/*beta_offset_div2 = */bs_get_se(bs);
-			/*tc_offset_div2 = */bs_get_se(bs);
+			/*beta_offset_div2 = */gf_bs_read_se(bs);
+			/*tc_offset_div2 = */gf_bs_read_se(bs);
 		}
 	}
 	if (/*pic_scaling_list_data_present_flag	= */gf_bs_read_int(bs, 1) ) {
@@ -4370,7 +4322,7 @@ s32 gf_media_hevc_read_pps(char *data, u32 size, HEVCState *hevc)
 		goto exit;
 	}
 	pps->lists_modification_present_flag = gf_bs_read_int(bs, 1);
-	/*log2_parallel_merge_level_minus2 = */bs_get_ue(bs);
+	/*log2_parallel_merge_level_minus2 = */gf_bs_read_ue(bs);
 	pps->slice_segment_header_extension_present_flag = gf_bs_read_int(bs, 1);
 	if ( /*pps_extension_flag= */gf_bs_read_int(bs, 1) ) {
 		while (gf_bs_available(bs) ) {
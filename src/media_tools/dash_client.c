@@ -31,6 +31,7 @@
 #include <gpac/internal/isomedia_dev.h>
 #include <gpac/base_coding.h>
 #include <string.h>
+#include <math.h>
 #include <sys/stat.h>
 
 #ifdef _WIN32_WCE
@@ -92,6 +93,9 @@ struct __dash_client
 	u32 reload_count, last_update_time;
 	/*signature of last MPD*/
 	u8 lastMPDSignature[GF_SHA1_DIGEST_SIZE];
+	/*text of the MPD in use for incremental refreshes, and of the MPD being loaded*/
+	GF_MPDTextState *mpd_state, *next_mpd_state;
+	GF_DASHRefreshInfo refresh_info;
 	/*mime type of media segments (m3u8)*/
 	char *mimeTypeForM3U8Segments;
 
@@ -130,6 +134,9 @@ struct __dash_client
 	Double speed;
 	u32 probe_times_before_switch;
 	Bool agressive_switching;
+	GF_DASHAdaptationAlgorithm rate_algo;
+	gf_dash_rate_algo custom_algo;
+	void *custom_algo_udta;
 	u32 min_wait_ms_before_next_request;
 
 	Bool force_mpd_update;
@@ -150,6 +157,9 @@ struct __dash_client
 	GF_DASHTileAdaptationMode tile_adapt_mode;
 
 	GF_List *SRDs;
+
+	/*max number of concurrent segment downloads per group, and min size of segment byte ranges to split in parallel requests*/
+	u32 nb_parallel_downloads, split_range_size;
 };
 
 static void gf_dash_seek_group(GF_DashClient *dash, GF_DASH_Group *group, Double seek_to, Bool is_dynamic);
@@ -169,6 +179,38 @@ typedef struct
 	Bool has_dep_following;
 } segment_cache_entry;
 
+typedef enum
+{
+	DASH_PREFETCH_IDLE = 0,
+	DASH_PREFETCH_RUNNING,
+	DASH_PREFETCH_DONE,
+} DASHPrefetchState;
+
+/*download of a segment or of a byte range of a segment ahead of the group download, on its own persistent connection*/
+typedef struct
+{
+	struct __dash_group *group;
+	GF_Thread *th;
+	GF_Semaphore *run_sema;
+	/*notified once at the end of each download, consumed once by the first wait on it*/
+	GF_Semaphore *done_sema;
+	Bool done_consumed;
+	Bool stop;
+	/*protects the switch to DASH_PREFETCH_DONE and the aborts requested by the group - the session is created once and never replaced while the slot lives*/
+	GF_Mutex *mx;
+	Bool abort_requested;
+	GF_DASHFileIOSession sess;
+	volatile u32 state;
+	/*segment index and representation index in adaptation_set->representations at the time of the request*/
+	s32 segment_index;
+	u32 representation_index;
+	/*set if the download is a byte range part of the segment being downloaded by the group*/
+	Bool is_part;
+	char *url;
+	u64 start_range, end_range;
+	GF_Err error;
+} dash_prefetch_slot;
+
 typedef enum
 {
 	/*set if group cannot be selected (wrong MPD)*/
@@ -289,7 +331,10 @@ struct __dash_group
 	u32 display_width, display_height;
 	/*buffer status*/
 	u32 buffer_min_ms, buffer_max_ms, buffer_occupancy_ms;
-	u32 buffer_occupancy_at_last_seg;
+	/*rate adaptation input and state, with the bandwidths and disabled flags of the representations*/
+	GF_DASHRateInfo rate_info;
+	u32 *rate_bandwidths;
+	Bool *rate_disabled;
 
 	u32 m3u8_start_media_seq;
 
@@ -306,6 +351,14 @@ struct __dash_group
 
 	GF_Thread *download_th;
 	Bool download_th_done;
+
+	/*concurrent downloads of the next segments or of byte ranges of the current one*/
+	dash_prefetch_slot *prefetch;
+	u32 nb_prefetch;
+	Bool disable_split;
+	/*aggregated download rate of all connections of the group: bytes received and time with at least one download active*/
+	u32 nb_active_downloads;
+	u64 active_start, active_time, active_bytes;
 };
 
 struct _dash_srd_desc
@@ -950,7 +1003,10 @@ GF_Err gf_dash_download_resource(GF_DashClient *dash, GF_DASHFileIOSession *sess
 	}
 
 	if (! *sess) {
-		*sess = dash_io->create(dash_io, persistent_mode ? 1 : 0, url, group_idx);
+		u32 flags = persistent_mode ? GF_DASHIO_SESSION_PERSISTENT : 0;
+		/*manifests and init segments are small resources, the group session being created for its init segment*/
+		if (!group || !group->nb_cached_segments) flags |= GF_DASHIO_SESSION_ALLOW_PIPELINE;
+		*sess = dash_io->create(dash_io, flags, url, group_idx);
 		if (!(*sess)) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Cannot try to download %s... OUT of memory ?\n", url));
 			return GF_OUT_OF_MEM;
@@ -1532,6 +1588,183 @@ static void gf_dash_solve_representation_xlink(GF_DashClient *dash, GF_MPD_Repre
 }
 
 
+/*min media time to keep in the timelines of the groups when updating the manifest*/
+static Double gf_dash_get_timeline_start_time(GF_DashClient *dash)
+{
+	u32 group_idx;
+	Double timeline_start_time = 0;
+	/*if not infinity for timeShift, compute min media time before merge and adjust it*/
+	if (dash->mpd->time_shift_buffer_depth != (u32) -1) {
+		Double timeshift = dash->mpd->time_shift_buffer_depth;
+		timeshift /= 1000;
+
+		for (group_idx=0; group_idx<gf_list_count(dash->groups); group_idx++) {
+			GF_DASH_Group *group = gf_list_get(dash->groups, group_idx);
+			if (group->selection!=GF_DASH_GROUP_NOT_SELECTABLE) {
+				Double group_start = gf_dash_get_segment_start_time(group, NULL);
+				if (!group_idx || (timeline_start_time > group_start) ) timeline_start_time = group_start;
+			}
+		}
+		/*we can rewind our segments from timeshift*/
+		if (timeline_start_time > timeshift) timeline_start_time -= timeshift;
+		/*we can rewind all segments*/
+		else timeline_start_time = 0;
+	}
+	return timeline_start_time;
+}
+
+/*updates the group state once its adaptation set has been updated in new_mpd*/
+static void gf_dash_group_manifest_updated(GF_DashClient *dash, GF_DASH_Group *group, u32 group_idx, GF_MPD *new_mpd, GF_MPD_Period *period, u64 fetch_time, Double timeline_start_time, Bool force_timeline_setup)
+{
+	Double seg_dur;
+	Bool reset_segment_count;
+
+	/*now that all possible SegmentXXX have been updated, purge them if needed: all segments ending before timeline_start_time
+	will be removed from MPD*/
+	if (timeline_start_time) {
+		u32 nb_segments_removed = gf_dash_purge_segment_timeline(group, timeline_start_time);
+		if (nb_segments_removed) {
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] AdaptationSet %d - removed %d segments from timeline (%d since start of the period)\n", group_idx+1, nb_segments_removed, group->nb_segments_purged));
+		}
+	}
+
+	if (force_timeline_setup) {
+		group->timeline_setup = 0;
+		group->start_number_at_last_ast = 0;
+		gf_dash_group_timeline_setup(new_mpd, group, fetch_time);
+	}
+	else if (new_mpd->availabilityStartTime != dash->mpd->availabilityStartTime) {
+		s64 diff = new_mpd->availabilityStartTime;
+		diff -= dash->mpd->availabilityStartTime;
+		if (diff < 0) diff = -diff;
+		if (diff>3000)
+			gf_dash_group_timeline_setup(new_mpd, group, fetch_time);
+	}
+
+	group->maybe_end_of_stream = 0;
+	reset_segment_count = GF_FALSE;
+	/*compute fetchTime + minUpdatePeriod and check period end time*/
+	if (new_mpd->minimum_update_period && new_mpd->media_presentation_duration) {
+		u64 endTime = fetch_time - new_mpd->availabilityStartTime - period->start;
+		if (endTime > new_mpd->media_presentation_duration) {
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period EndTime is signaled to "LLU", less than fetch time "LLU" ! Ignoring mediaPresentationDuration\n", new_mpd->media_presentation_duration, endTime));
+			new_mpd->media_presentation_duration = 0;
+			reset_segment_count = GF_TRUE;
+		} else {
+			endTime += new_mpd->minimum_update_period;
+			if (endTime > new_mpd->media_presentation_duration) {
+				GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period EndTime is signaled to "LLU", less than fetch time + next update "LLU" - maybe end of stream ?\n", new_mpd->availabilityStartTime, endTime));
+				group->maybe_end_of_stream = 1;
+			}
+		}
+	}
+
+	/*update number of segments in active rep*/
+	gf_dash_get_segment_duration(gf_list_get(group->adaptation_set->representations, group->active_rep_index), group->adaptation_set, group->period, new_mpd, &group->nb_segments_in_rep, &seg_dur);
+
+	if (reset_segment_count) {
+		u32 nb_segs_in_mpd_period = (u32) (dash->mpd->minimum_update_period / (1000*seg_dur) );
+		group->nb_segments_in_rep = group->download_segment_index + nb_segs_in_mpd_period;
+	}
+	/*check if number of segments are coherent ...*/
+	else if (!group->maybe_end_of_stream && new_mpd->minimum_update_period && new_mpd->media_presentation_duration) {
+		u32 nb_segs_in_mpd_period = (u32) (dash->mpd->minimum_update_period / (1000*seg_dur) );
+
+		if (group->download_segment_index + nb_segs_in_mpd_period >= group->nb_segments_in_rep) {
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period has %d segments but %d are needed until next refresh. Maybe end of stream is near ?\n", group->nb_segments_in_rep, group->download_segment_index + nb_segs_in_mpd_period));
+			group->maybe_end_of_stream = 1;
+		}
+	}
+
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Updated AdaptationSet %d - %d segments\n", group_idx+1, group->nb_segments_in_rep));
+}
+
+/*loads the manifest file in a NULL-terminated buffer*/
+static char *gf_dash_load_manifest_text(const char *local_url, u32 *size)
+{
+	char *text;
+	u64 file_size;
+	FILE *f = gf_fopen(local_url, "rb");
+	if (!f) return NULL;
+	gf_fseek(f, 0, SEEK_END);
+	file_size = gf_ftell(f);
+	gf_fseek(f, 0, SEEK_SET);
+	if (file_size >= 0xFFFFFFFFUL) {
+		gf_fclose(f);
+		return NULL;
+	}
+	*size = (u32) file_size;
+	text = (char *) gf_malloc(sizeof(char) * (*size + 1));
+	if (text && (fread(text, 1, *size, f) != *size)) {
+		gf_free(text);
+		text = NULL;
+	}
+	gf_fclose(f);
+	if (text) text[*size] = 0;
+	return text;
+}
+
+/*applies a new version of the manifest text to the current MPD without parsing the whole document. Returns GF_NOT_SUPPORTED
+if the changes require a full parse, in which case nothing is modified*/
+static GF_Err gf_dash_update_manifest_incremental(GF_DashClient *dash, const char *text, u32 size, u64 fetch_time)
+{
+	GF_Err e;
+	u32 group_idx, nb_timelines;
+	Double timeline_start_time;
+	GF_MPD_Period *period = gf_list_get(dash->mpd->periods, dash->active_period_index);
+	if (!period) return GF_NOT_SUPPORTED;
+
+	/*get the timing of the groups before updating the timelines*/
+	timeline_start_time = gf_dash_get_timeline_start_time(dash);
+	for (group_idx=0; group_idx<gf_list_count(dash->groups); group_idx++) {
+		GF_DASH_Group *group = gf_list_get(dash->groups, group_idx);
+		if (group->selection==GF_DASH_GROUP_NOT_SELECTABLE) continue;
+		group->current_start_time = gf_dash_get_segment_start_time_with_timescale(group, NULL, &group->current_timescale);
+	}
+
+	e = gf_mpd_text_state_update(dash->mpd_state, dash->mpd, text, size, &nb_timelines);
+	if (e) return e;
+	dash->refresh_info.nb_timelines_updated = nb_timelines;
+
+	for (group_idx=0; group_idx<gf_list_count(dash->groups); group_idx++) {
+		u64 duration;
+		u32 i, timescale, nb_segs;
+		GF_MPD_SegmentTimelineEntry *ent;
+		GF_MPD_SegmentTimeline *timeline = NULL;
+		GF_DASH_Group *group = gf_list_get(dash->groups, group_idx);
+		if (group->selection==GF_DASH_GROUP_NOT_SELECTABLE) continue;
+
+		/*locate the segment we were at in the updated timeline*/
+		gf_mpd_resolve_segment_duration(gf_list_get(group->adaptation_set->representations, group->active_rep_index), group->adaptation_set, group->period, &duration, &timescale, NULL, &timeline);
+		if (timeline) {
+			nb_segs = 0;
+			i = 0;
+			while ((ent = gf_list_enum(timeline->entries, &i))) {
+				nb_segs += 1 + ent->repeat_count;
+			}
+			group->nb_segments_in_rep = nb_segs;
+			group->download_segment_index = gf_dash_get_index_in_timeline(timeline, group->current_start_time, group->current_timescale, timescale ? timescale : group->current_timescale);
+		}
+		gf_dash_group_manifest_updated(dash, group, group_idx, dash->mpd, period, fetch_time, timeline_start_time, GF_FALSE);
+	}
+	dash->last_update_time = gf_sys_clock();
+	dash->mpd_fetch_time = fetch_time;
+	return GF_OK;
+}
+
+/*updates the manifest refresh statistics*/
+static void gf_dash_refresh_done(GF_DashClient *dash, u64 start, Bool unchanged, Bool incremental)
+{
+	u64 cost = gf_sys_clock_high_res() - start;
+	dash->refresh_info.nb_refresh++;
+	if (unchanged) dash->refresh_info.nb_unchanged++;
+	if (incremental) dash->refresh_info.nb_incremental++;
+	else if (!unchanged) dash->refresh_info.nb_timelines_updated = 0;
+	dash->refresh_info.last_refresh_us = cost;
+	dash->refresh_info.total_refresh_us += cost;
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Manifest refresh %s in "LLU" us\n", unchanged ? "(unchanged)" : (incremental ? "(incremental)" : "(full parse)"), cost));
+}
+
 static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 {
 	GF_Err e;
@@ -1547,6 +1780,13 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 	Double timeline_start_time;
 	GF_MPD *new_mpd=NULL;
 	Bool fetch_only = GF_FALSE;
+	char *mpd_text;
+	u32 mpd_text_size = 0;
+	u64 refresh_start;
+
+	/*drop the state of a previous update which failed*/
+	gf_mpd_text_state_del(dash->next_mpd_state);
+	dash->next_mpd_state = NULL;
 
 	if (!dash->mpd_dnload) {
 		local_url = purl = NULL;
@@ -1653,10 +1893,13 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 			return GF_NON_COMPLIANT_BITSTREAM;
 		}
 
-		if (gf_sha1_file( local_url, signature)) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] : cannot SHA1 file %s\n", local_url));
+		refresh_start = gf_sys_clock_high_res();
+		mpd_text = gf_dash_load_manifest_text(local_url, &mpd_text_size);
+		if (!mpd_text) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] : cannot read file %s\n", local_url));
 			return GF_IO_ERR;
 		}
+		gf_sha1_csum((u8 *) mpd_text, mpd_text_size, signature);
 
 		if (!dash->in_error && ! memcmp( signature, dash->lastMPDSignature, GF_SHA1_DIGEST_SIZE)) {
 
@@ -1672,6 +1915,8 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 			}
 
 			dash->mpd_fetch_time = fetch_time;
+			gf_free(mpd_text);
+			gf_dash_refresh_done(dash, refresh_start, GF_TRUE, GF_FALSE);
 			return GF_OK;
 		}
 
@@ -1680,12 +1925,26 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 		dash->reload_count = 0;
 		memcpy(dash->lastMPDSignature, signature, GF_SHA1_DIGEST_SIZE);
 
+		/*try to apply the changes to the current MPD*/
+		if (dash->mpd_state && !force_timeline_setup) {
+			e = gf_dash_update_manifest_incremental(dash, mpd_text, mpd_text_size, fetch_time);
+			if (e == GF_OK) {
+				gf_free(mpd_text);
+				gf_dash_refresh_done(dash, refresh_start, GF_FALSE, GF_TRUE);
+				return GF_OK;
+			}
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Manifest changes cannot be applied incrementally (%s), parsing the whole manifest\n", gf_error_to_string(e)));
+		}
+		gf_mpd_text_state_del(dash->mpd_state);
+		dash->mpd_state = NULL;
+
 		/* It means we have to reparse the file ... */
 		/* parse the MPD */
 		mpd_parser = gf_xml_dom_new();
 		e = gf_xml_dom_parse(mpd_parser, local_url, NULL, NULL);
 		if (e != GF_OK) {
 			gf_xml_dom_del(mpd_parser);
+			gf_free(mpd_text);
 			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot update playlist: error in XML parsing %s\n", gf_error_to_string(e)));
 			return GF_NON_COMPLIANT_BITSTREAM;
 		}
@@ -1695,8 +1954,12 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 		if (e) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot update playlist: error in MPD creation %s\n", gf_error_to_string(e)));
 			gf_mpd_del(new_mpd);
+			gf_free(mpd_text);
 			return GF_NON_COMPLIANT_BITSTREAM;
 		}
+		/*keep the text of the new MPD for the next updates, the MPD being applied only if the update succeeds*/
+		dash->next_mpd_state = gf_mpd_text_state_new(new_mpd, mpd_text, mpd_text_size);
+		gf_free(mpd_text);
 	}
 
 	assert(new_mpd);
@@ -1720,24 +1983,7 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Updating playlist at UTC time "LLU" - availabilityStartTime "LLU"\n", fetch_time, new_mpd->availabilityStartTime));
 
-	timeline_start_time = 0;
-	/*if not infinity for timeShift, compute min media time before merge and adjust it*/
-	if (dash->mpd->time_shift_buffer_depth != (u32) -1) {
-		Double timeshift = dash->mpd->time_shift_buffer_depth;
-		timeshift /= 1000;
-
-		for (group_idx=0; group_idx<gf_list_count(dash->groups); group_idx++) {
-			GF_DASH_Group *group = gf_list_get(dash->groups, group_idx);
-			if (group->selection!=GF_DASH_GROUP_NOT_SELECTABLE) {
-				Double group_start = gf_dash_get_segment_start_time(group, NULL);
-				if (!group_idx || (timeline_start_time > group_start) ) timeline_start_time = group_start;
-			}
-		}
-		/*we can rewind our segments from timeshift*/
-		if (timeline_start_time > timeshift) timeline_start_time -= timeshift;
-		/*we can rewind all segments*/
-		else timeline_start_time = 0;
-	}
+	timeline_start_time = gf_dash_get_timeline_start_time(dash);
 
 	/*update segmentTimeline at Period level*/
 	e = gf_dash_merge_segment_timeline(NULL, dash, period->segment_list, period->segment_template, new_period->segment_list, new_period->segment_template, timeline_start_time);
@@ -1747,8 +1993,6 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 	}
 
 	for (group_idx=0; group_idx<gf_list_count(dash->groups); group_idx++) {
-		Double seg_dur;
-		Bool reset_segment_count;
 		GF_MPD_AdaptationSet *set, *new_set;
 		u32 rep_i;
 		GF_DASH_Group *group = gf_list_get(dash->groups, group_idx);
@@ -1940,65 +2184,7 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 		j = gf_list_count(group->adaptation_set->representations);
 		assert(j);
 
-		/*now that all possible SegmentXXX have been updated, purge them if needed: all segments ending before timeline_start_time
-		will be removed from MPD*/
-		if (timeline_start_time) {
-			u32 nb_segments_removed = gf_dash_purge_segment_timeline(group, timeline_start_time);
-			if (nb_segments_removed) {
-				GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] AdaptationSet %d - removed %d segments from timeline (%d since start of the period)\n", group_idx+1, nb_segments_removed, group->nb_segments_purged));
-			}
-		}
-
-		if (force_timeline_setup) {
-			group->timeline_setup = 0;
-			group->start_number_at_last_ast = 0;
-			gf_dash_group_timeline_setup(new_mpd, group, fetch_time);
-		}
-		else if (new_mpd->availabilityStartTime != dash->mpd->availabilityStartTime) {
-			s64 diff = new_mpd->availabilityStartTime;
-			diff -= dash->mpd->availabilityStartTime;
-			if (diff < 0) diff = -diff;
-			if (diff>3000)
-				gf_dash_group_timeline_setup(new_mpd, group, fetch_time);
-		}
-
-		group->maybe_end_of_stream = 0;
-		reset_segment_count = GF_FALSE;
-		/*compute fetchTime + minUpdatePeriod and check period end time*/
-		if (new_mpd->minimum_update_period && new_mpd->media_presentation_duration) {
-			u64 endTime = fetch_time - new_mpd->availabilityStartTime - period->start;
-			if (endTime > new_mpd->media_presentation_duration) {
-				GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period EndTime is signaled to "LLU", less than fetch time "LLU" ! Ignoring mediaPresentationDuration\n", new_mpd->media_presentation_duration, endTime));
-				new_mpd->media_presentation_duration = 0;
-				reset_segment_count = GF_TRUE;
-			} else {
-				endTime += new_mpd->minimum_update_period;
-				if (endTime > new_mpd->media_presentation_duration) {
-					GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period EndTime is signaled to "LLU", less than fetch time + next update "LLU" - maybe end of stream ?\n", new_mpd->availabilityStartTime, endTime));
-					group->maybe_end_of_stream = 1;
-				}
-			}
-		}
-
-		/*update number of segments in active rep*/
-		gf_dash_get_segment_duration(gf_list_get(group->adaptation_set->representations, group->active_rep_index), group->adaptation_set, group->period, new_mpd, &group->nb_segments_in_rep, &seg_dur);
-
-		if (reset_segment_count) {
-			u32 nb_segs_in_mpd_period = (u32) (dash->mpd->minimum_update_period / (1000*seg_dur) );
-			group->nb_segments_in_rep = group->download_segment_index + nb_segs_in_mpd_period;
-		}
-		/*check if number of segments are coherent ...*/
-		else if (!group->maybe_end_of_stream && new_mpd->minimum_update_period && new_mpd->media_presentation_duration) {
-			u32 nb_segs_in_mpd_period = (u32) (dash->mpd->minimum_update_period / (1000*seg_dur) );
-
-			if (group->download_segment_index + nb_segs_in_mpd_period >= group->nb_segments_in_rep) {
-				GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Period has %d segments but %d are needed until next refresh. Maybe end of stream is near ?\n", group->nb_segments_in_rep, group->download_segment_index + nb_segs_in_mpd_period));
-				group->maybe_end_of_stream = 1;
-			}
-		}
-
-		GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Updated AdaptationSet %d - %d segments\n", group_idx+1, group->nb_segments_in_rep));
-
+		gf_dash_group_manifest_updated(dash, group, group_idx, new_mpd, period, fetch_time, timeline_start_time, force_timeline_setup);
 	}
 
 exit:
@@ -2008,6 +2194,10 @@ exit:
 	dash->mpd = new_mpd;
 	dash->last_update_time = gf_sys_clock();
 	dash->mpd_fetch_time = fetch_time;
+	gf_mpd_text_state_del(dash->mpd_state);
+	dash->mpd_state = dash->next_mpd_state;
+	dash->next_mpd_state = NULL;
+	if (mpd_text_size) gf_dash_refresh_done(dash, refresh_start, GF_FALSE, GF_FALSE);
 	return GF_OK;
 }
 
@@ -2288,17 +2478,265 @@ static void dash_store_stats(GF_DashClient *dash, GF_DASH_Group *group, GF_DASHF
 #endif
 }
 
-static void dash_do_rate_adaptation(GF_DashClient *dash, GF_DASH_Group *group)
+/*highest representation not above the given rate, or the lowest one*/
+static u32 dash_rate_select_below(GF_DASHRateInfo *info, Double rate)
 {
-	Double speed;
-	u32 k, dl_rate;
+	u32 k;
+	s32 sel = -1, lowest = -1;
+	for (k=0; k<info->nb_reps; k++) {
+		if (info->disabled && info->disabled[k]) continue;
+		if (lowest<0) lowest = k;
+		if (info->bandwidths[k] <= rate) sel = k;
+	}
+	if (sel>=0) return sel;
+	return (lowest>=0) ? lowest : info->active_rep;
+}
+
+static u32 dash_rate_algo_gpac(GF_DASHRateInfo *info)
+{
+	u32 k, dl_rate, min_rate, cur_rate;
+	s32 new_idx = -1;
 	Bool go_up_bitrate = GF_FALSE;
+	Bool do_switch = GF_TRUE;
 	u32 nb_inter_rep = 0;
+
+	dl_rate = info->dl_rate;
+	cur_rate = info->bandwidths[info->active_rep];
+	min_rate = (u32) -1;
+	for (k=0; k<info->nb_reps; k++) {
+		if (info->disabled && info->disabled[k]) continue;
+		if (info->bandwidths[k] < min_rate) min_rate = info->bandwidths[k];
+	}
+
+	if (cur_rate < dl_rate) {
+		go_up_bitrate = 1;
+	}
+	if (dl_rate < min_rate)
+		dl_rate = min_rate;
+
+	/*buffer-based control: if we are below half of the buffer don't try to go up and limit rate to less than our current rep bandwidth*/
+	if (info->buffer_max_ms) {
+		u32 buf_high_threshold, buf_low_threshold;
+		s32 occ;
+
+		if (info->segment_duration && (info->buffer_max_ms > info->segment_duration))
+			buf_high_threshold = info->buffer_max_ms - info->segment_duration;
+		else
+			buf_high_threshold = 2*info->buffer_max_ms/3;
+
+		buf_low_threshold = (info->segment_duration && (info->buffer_min_ms>10)) ? info->buffer_min_ms : info->segment_duration;
+		if (buf_low_threshold > info->buffer_max_ms) buf_low_threshold = 1*info->buffer_max_ms/3;
+
+		//compute how much we managed to refill (current state minus previous state)
+		occ = (s32) info->buffer_ms;
+		occ -= (s32) info->last_buffer_ms;
+		//if above max buffer force occ>0 since a segment may still be pending and not dispatched (buffer regulation)
+		if (info->buffer_ms>info->buffer_max_ms) occ=1;
+
+		//switch down if current buffer falls below min threshold
+		if ( (s32) info->buffer_ms < (s32) buf_low_threshold) {
+			if (!info->buffer_ms) dl_rate = min_rate;
+			else dl_rate = (cur_rate>10) ? cur_rate - 10 : 1;
+			go_up_bitrate = 0;
+			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] bitrate %d bps buffer max %d current %d refill since last %d - running low, switching down, target rate %d\n", cur_rate, info->buffer_max_ms, info->buffer_ms, occ, dl_rate));
+		}
+		//switch up if above max threshold and buffer refill is fast enough
+		else if ((occ>0) && (info->buffer_ms > buf_high_threshold)) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] bitrate %d bps buffer max %d current %d refill since last %d - running high, will try to switch up, target rate %d\n", cur_rate, info->buffer_max_ms, info->buffer_ms, occ, dl_rate));
+			go_up_bitrate = 1;
+		}
+		//don't do anything in the middle or if refill not fast enough
+		else {
+			do_switch = GF_FALSE;
+			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] bitrate %d bps buffer max %d current %d refill since last %d - steady\n", cur_rate, info->buffer_max_ms, info->buffer_ms, occ));
+		}
+	}
+	info->last_buffer_ms = info->buffer_ms;
+
+	/*find best bandwidth that fits our bitrate*/
+	if (do_switch) {
+		for (k=0; k<info->nb_reps; k++) {
+			u32 rate = info->bandwidths[k];
+			if (info->disabled && info->disabled[k]) continue;
+			if (dl_rate < rate) continue;
+
+			if (new_idx<0) new_idx = k;
+			else if (go_up_bitrate) {
+				if (info->agressive_switching) {
+					/*try to switch to highest bitrate below available download rate*/
+					if (rate > info->bandwidths[new_idx]) {
+						if (info->bandwidths[new_idx] > cur_rate) {
+							nb_inter_rep ++;
+						}
+						new_idx = k;
+					} else if (rate > cur_rate) {
+						nb_inter_rep ++;
+					}
+				} else {
+					/*try to switch to lowest bitrate above our current rep*/
+					if (info->bandwidths[new_idx]<=cur_rate) {
+						new_idx = k;
+					} else if ( (rate < info->bandwidths[new_idx]) && (rate > cur_rate)) {
+						new_idx = k;
+					}
+				}
+			} else {
+				/*try to switch to highest bitrate below available download rate*/
+				if (rate > info->bandwidths[new_idx]) {
+					new_idx = k;
+				}
+			}
+		}
+		if ((new_idx<0) || (new_idx == (s32) info->active_rep)) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] no rep found better matching requested bandwidth %d - not switching !\n", dl_rate));
+			do_switch = GF_FALSE;
+		}
+	}
+
+	/*probing only counts for consecutive proposals of the same representation*/
+	if (new_idx != info->probe_rep) {
+		info->probe_rep = new_idx;
+		info->probe_count = 0;
+	}
+	//if we're switching to the next upper bitrate (no intermediate bitrates), do not immediately switch
+	//but for a given number of segments - this avoids fluctuation in the quality
+	if (do_switch && go_up_bitrate && !nb_inter_rep) {
+		info->probe_count++;
+		if (info->probe_count > info->probe_count_before_switch) {
+			info->probe_count = 0;
+		} else {
+			do_switch = GF_FALSE;
+		}
+	}
+	return do_switch ? (u32) new_idx : info->active_rep;
+}
+
+static u32 dash_rate_algo_ewma(GF_DASHRateInfo *info)
+{
+	Double dur, alpha_fast, alpha_slow, fast, slow;
+
+	/*half-lives of 3 and 8 seconds of media, so that short segments weight less*/
+	dur = info->segment_duration ? info->segment_duration / 1000.0 : 1.0;
+	alpha_fast = pow(0.5, dur / 3);
+	alpha_slow = pow(0.5, dur / 8);
+	info->ewma_fast = alpha_fast * info->ewma_fast + (1 - alpha_fast) * info->dl_rate;
+	info->ewma_slow = alpha_slow * info->ewma_slow + (1 - alpha_slow) * info->dl_rate;
+	info->ewma_weight += dur;
+
+	/*remove the bias towards 0 of the first estimates*/
+	fast = info->ewma_fast / (1 - pow(0.5, info->ewma_weight / 3));
+	slow = info->ewma_slow / (1 - pow(0.5, info->ewma_weight / 8));
+
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] EWMA throughput estimates: fast %d kbps slow %d kbps\n", (u32) (fast/1000), (u32) (slow/1000)));
+	return dash_rate_select_below(info, 0.9 * MIN(fast, slow));
+}
+
+static u32 dash_rate_algo_bba0(GF_DASHRateInfo *info)
+{
+	u32 k;
+	s32 rate_min, rate_max, rate_plus, rate_minus, sel;
+	Double target, reservoir, cushion;
+
+	if (!info->buffer_max_ms) return dash_rate_select_below(info, info->dl_rate);
+
+	/*reservoir and cushion scaled from the 90s/126s of a 240s buffer in BBA-0*/
+	reservoir = MAX(info->buffer_max_ms * 0.375, info->segment_duration);
+	cushion = info->buffer_max_ms * 0.525;
+
+	rate_min = rate_max = rate_plus = rate_minus = -1;
+	for (k=0; k<info->nb_reps; k++) {
+		if (info->disabled && info->disabled[k]) continue;
+		if (rate_min<0) rate_min = k;
+		rate_max = k;
+		if (k < info->active_rep) rate_minus = k;
+		if ((k > info->active_rep) && (rate_plus<0)) rate_plus = k;
+	}
+	if (rate_min<0) return info->active_rep;
+	if (rate_plus<0) rate_plus = rate_max;
+	if (rate_minus<0) rate_minus = rate_min;
+
+	if (info->buffer_ms <= reservoir) target = info->bandwidths[rate_min];
+	else if (info->buffer_ms >= reservoir + cushion) target = info->bandwidths[rate_max];
+	else target = info->bandwidths[rate_min] + (info->bandwidths[rate_max] - info->bandwidths[rate_min]) * (info->buffer_ms - reservoir) / cushion;
+
+	/*stay on the current rate until the target crosses the rate above or below it*/
+	if (target >= info->bandwidths[rate_plus]) {
+		return dash_rate_select_below(info, target);
+	}
+	if (target <= info->bandwidths[rate_minus]) {
+		sel = rate_max;
+		for (k=info->nb_reps; k>0; k--) {
+			if (info->disabled && info->disabled[k-1]) continue;
+			if (info->bandwidths[k-1] <= target) break;
+			sel = k-1;
+		}
+		return sel;
+	}
+	return info->active_rep;
+}
+
+static u32 dash_rate_algo_bola(GF_DASHRateInfo *info)
+{
+	u32 k;
+	s32 sel = -1, rate_min = -1, rate_max = -1;
+	Double buffer_max, buffer, gp, V, best_score = 0;
+
+	if (!info->buffer_max_ms || !info->segment_duration) return dash_rate_select_below(info, info->dl_rate);
+
+	for (k=0; k<info->nb_reps; k++) {
+		if (info->disabled && info->disabled[k]) continue;
+		if (rate_min<0) rate_min = k;
+		rate_max = k;
+	}
+	if (rate_min<0) return info->active_rep;
+
+	/*buffer expressed in segments, utility of a rate is log(rate/min_rate)*/
+	buffer_max = (Double) info->buffer_max_ms / info->segment_duration;
+	if (buffer_max < 2) buffer_max = 2;
+	buffer = (Double) info->buffer_ms / info->segment_duration;
+	gp = 5;
+	V = (buffer_max - 1) / (log((Double) info->bandwidths[rate_max] / info->bandwidths[rate_min]) + gp);
+
+	for (k=0; k<info->nb_reps; k++) {
+		Double score;
+		if (info->disabled && info->disabled[k]) continue;
+		score = (V * (log((Double) info->bandwidths[k] / info->bandwidths[rate_min]) + gp) - buffer) / info->bandwidths[k];
+		if ((sel<0) || (score > best_score)) {
+			best_score = score;
+			sel = k;
+		}
+	}
+	return sel;
+}
+
+GF_EXPORT
+u32 gf_dash_rate_adaptation(GF_DASHAdaptationAlgorithm algo, GF_DASHRateInfo *info)
+{
+	if (!info || !info->nb_reps || (info->active_rep >= info->nb_reps)) return 0;
+
+	switch (algo) {
+	case GF_DASH_ALGO_THROUGHPUT_EWMA:
+		return dash_rate_algo_ewma(info);
+	case GF_DASH_ALGO_BBA0:
+		return dash_rate_algo_bba0(info);
+	case GF_DASH_ALGO_BOLA:
+		return dash_rate_algo_bola(info);
+	case GF_DASH_ALGO_GPAC_LEGACY:
+		return dash_rate_algo_gpac(info);
+	default:
+		return info->active_rep;
+	}
+}
+
+static void dash_do_rate_adaptation(GF_DashClient *dash, GF_DASH_Group *group)
+{
+	Double speed;
+	u32 k, dl_rate, nb_reps;
 	GF_MPD_Representation *rep, *new_rep;
 	Double max_available_speed = 0;
 	Bool force_below_resolution = GF_FALSE;
 	GF_DASH_Group *base_group = group;
-	Bool do_switch = GF_TRUE;
+	GF_DASHRateInfo *info = &group->rate_info;
 
 	if (dash->auto_switch_count) return;
 	if (group->dash->disable_switching) return;
@@ -2319,12 +2757,6 @@ static void dash_do_rate_adaptation(GF_DashClient *dash, GF_DASH_Group *group)
 	if (speed<0) speed = -speed;
 	dl_rate = (u32)  (8*group->bytes_per_sec / speed);
 
-	if (rep->bandwidth < dl_rate) {
-		go_up_bitrate = 1;
-	}
-	if (dl_rate < group->min_representation_bitrate)
-		dl_rate = group->min_representation_bitrate;
-
 	group->buffer_max_ms = group->buffer_occupancy_ms = 0;
 	group->codec_reset = 0;
 
@@ -2339,121 +2771,65 @@ static void dash_do_rate_adaptation(GF_DashClient *dash, GF_DASH_Group *group)
 			force_below_resolution = GF_TRUE;
 	}
 
-	/*buffer-based control (skip is cache is full, ie player did not fetched downloaded data yet: if we are below half of the buffer don't try to go up and limit rate to less than our current rep bandwidth*/
-	if (group->buffer_max_ms && (group->nb_cached_segments<group->max_cached_segments) ) {
-		u32 buf_high_threshold, buf_low_threshold;
-		s32 occ;
-
-		if (group->current_downloaded_segment_duration && (group->buffer_max_ms > group->current_downloaded_segment_duration))
-			buf_high_threshold = group->buffer_max_ms - (u32) group->current_downloaded_segment_duration;
-		else
-			buf_high_threshold = 2*group->buffer_max_ms/3;
-
-		buf_low_threshold = (group->current_downloaded_segment_duration && (group->buffer_min_ms>10)) ? group->buffer_min_ms : (u32) group->current_downloaded_segment_duration;
-		if (buf_low_threshold > group->buffer_max_ms) buf_low_threshold = 1*group->buffer_max_ms/3;
-
-		//compute how much we managed to refill (current state minus previous state)
-		occ = (s32) group->buffer_occupancy_ms;
-		occ -= (s32) group->buffer_occupancy_at_last_seg;
-		//if above max buffer force occ>0 since a segment may still be pending and not dispatched (buffer regulation)
-		if (group->buffer_occupancy_ms>group->buffer_max_ms) occ=1;
-
-		//switch down if current buffer falls below min threshold
-		if ( (s32) group->buffer_occupancy_ms < (s32) buf_low_threshold) {
-			if (!group->buffer_occupancy_ms) dl_rate = group->min_representation_bitrate;
-			else dl_rate = (rep->bandwidth>10) ? rep->bandwidth - 10 : 1;
-			go_up_bitrate = 0;
-			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] AS#%d bitrate %d bps buffer max %d current %d refill since last %d - running low, switching down, target rate %d\n", 1+gf_list_find(group->period->adaptation_sets, group->adaptation_set), rep->bandwidth, group->buffer_max_ms, group->buffer_occupancy_ms, occ, dl_rate));
-		}
-		//switch up if above max threshold and buffer refill is fast enough
-		else if ((occ>0) && (group->buffer_occupancy_ms > buf_high_threshold)) {
-			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] AS#%d bitrate %d bps buffer max %d current %d refill since last %d - running high, will try to switch up, target rate %d\n", 1+gf_list_find(group->period->adaptation_sets, group->adaptation_set), rep->bandwidth, group->buffer_max_ms, group->buffer_occupancy_ms, occ, dl_rate));
-			go_up_bitrate = 1;
-		}
-		//don't do anything in the middle or if refill not fast enough
-		else {
-			do_switch = GF_FALSE;
-			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] AS#%d bitrate %d bps buffer max %d current %d refill since last %d - steady\n", 1+gf_list_find(group->period->adaptation_sets, group->adaptation_set), rep->bandwidth, group->buffer_max_ms, group->buffer_occupancy_ms, occ));
-		}
+	nb_reps = gf_list_count(group->adaptation_set->representations);
+	if (info->nb_reps != nb_reps) {
+		group->rate_bandwidths = (u32 *) gf_realloc(group->rate_bandwidths, sizeof(u32) * nb_reps);
+		group->rate_disabled = (Bool *) gf_realloc(group->rate_disabled, sizeof(Bool) * nb_reps);
+		info->nb_reps = nb_reps;
+		info->bandwidths = group->rate_bandwidths;
+		info->disabled = group->rate_disabled;
+		info->probe_rep = -1;
 	}
+	for (k=0; k<nb_reps; k++) {
+		GF_MPD_Representation *arep = gf_list_get(group->adaptation_set->representations, k);
+		if (!arep->playback.prev_max_available_speed)
+			arep->playback.prev_max_available_speed = 1.0;
+		group->rate_bandwidths[k] = arep->bandwidth;
+		group->rate_disabled[k] = arep->playback.disabled;
+		/*representations known to be too complex for this speed*/
+		if (arep->playback.prev_max_available_speed && (speed > arep->playback.prev_max_available_speed))
+			group->rate_disabled[k] = GF_TRUE;
+	}
+	info->active_rep = group->active_rep_index;
+	info->dl_rate = dl_rate;
+	info->segment_duration = (u32) group->current_downloaded_segment_duration;
+	info->buffer_ms = group->buffer_occupancy_ms;
+	info->buffer_min_ms = group->buffer_min_ms;
+	info->probe_count_before_switch = dash->probe_times_before_switch;
+	info->agressive_switching = dash->agressive_switching;
+	/*skip buffer-based control if cache is full, ie player did not fetch downloaded data yet*/
+	info->buffer_max_ms = (group->nb_cached_segments<group->max_cached_segments) ? group->buffer_max_ms : 0;
 
-	/*find best bandwidth that fits our bitrate and playing speed*/
 	new_rep = NULL;
-
-	if (do_switch) {
-		for (k=0; k<gf_list_count(group->adaptation_set->representations) && do_switch; k++) {
+	if (force_below_resolution) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Speed adaptation\n"));
+		/*try to switch to highest quality below the current one*/
+		for (k=0; k<nb_reps; k++) {
 			GF_MPD_Representation *arep = gf_list_get(group->adaptation_set->representations, k);
-			if (!arep->playback.prev_max_available_speed)
-				arep->playback.prev_max_available_speed = 1.0;
-			
-			if (arep->playback.disabled) continue;
-			if (arep->playback.prev_max_available_speed && (speed > arep->playback.prev_max_available_speed))
-				continue;
+			if (group->rate_disabled[k]) continue;
+			if (dl_rate < arep->bandwidth) continue;
 
-			if (dl_rate >= arep->bandwidth) {
-				if (force_below_resolution && !dash->disable_speed_adaptation) {
-					if (!k) GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Speed adaptation\n"));
-					/*try to switch to highest quality below the current one*/
-					if ((arep->quality_ranking < rep->quality_ranking) || (arep->width < rep->width) || (arep->height < rep->height)) {
-						if (!new_rep)
-							new_rep = arep;
-						else if ((arep->quality_ranking > new_rep->quality_ranking) || (arep->width > new_rep->width) || (arep->height > new_rep->height))
-							new_rep = arep;
-					}
-					rep->playback.prev_max_available_speed = max_available_speed;
-					go_up_bitrate = GF_FALSE;
-				} else {
-					if (!k) GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Bitrate adaptation\n"));
-					if (!new_rep) new_rep = arep;
-					else if (go_up_bitrate) {
-						if (dash->agressive_switching) {
-							/*try to switch to highest bitrate below available download rate*/
-							if (arep->bandwidth > new_rep->bandwidth) {
-								if (new_rep->bandwidth > rep->bandwidth) {
-									nb_inter_rep ++;
-								}
-								new_rep = arep;
-							} else if (arep->bandwidth > rep->bandwidth) {
-								nb_inter_rep ++;
-							}
-						} else {
-							/*try to switch to lowest bitrate above our current rep*/
-							if (new_rep->bandwidth<=rep->bandwidth) {
-								new_rep = arep;
-							} else if ( (arep->bandwidth < new_rep->bandwidth) && (arep->bandwidth > rep->bandwidth)) {
-								new_rep = arep;
-							}
-						}
-					} else {
-						/*try to switch to highest bitrate below available download rate*/
-						if (arep->bandwidth > new_rep->bandwidth) {
-							new_rep = arep;
-						}
-					}
-				}
+			if ((arep->quality_ranking < rep->quality_ranking) || (arep->width < rep->width) || (arep->height < rep->height)) {
+				if (!new_rep)
+					new_rep = arep;
+				else if ((arep->quality_ranking > new_rep->quality_ranking) || (arep->width > new_rep->width) || (arep->height > new_rep->height))
+					new_rep = arep;
 			}
+			rep->playback.prev_max_available_speed = max_available_speed;
 		}
-
-		if (!new_rep || (new_rep==rep)) {
-			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] AS#%d no rep found better matching requested bandwidth %d - not switching !\n", 1+gf_list_find(group->period->adaptation_sets, group->adaptation_set), dl_rate));
-			do_switch=GF_FALSE;
-		}
-	}
-
-	if (do_switch) {
-		//if we're switching to the next upper bitrate (no intermediate bitrates), do not immediately switch
-		//but for a given number of segments - this avoids fluctuation in the quality
-		if (go_up_bitrate && ! nb_inter_rep) {
-			new_rep->playback.probe_switch_count++;
-			if (new_rep->playback.probe_switch_count > dash->probe_times_before_switch) {
-				new_rep->playback.probe_switch_count = 0;
-			} else {
-				do_switch = 0;
-			}
+		info->last_buffer_ms = info->buffer_ms;
+	} else {
+		u32 new_idx;
+		if ((dash->rate_algo == GF_DASH_ALGO_CUSTOM) && dash->custom_algo) {
+			new_idx = dash->custom_algo(dash->custom_algo_udta, gf_list_find(dash->groups, group), info);
+		} else {
+			new_idx = gf_dash_rate_adaptation(dash->rate_algo, info);
 		}
+		if ((new_idx != group->active_rep_index) && (new_idx < nb_reps) && !group->rate_disabled[new_idx])
+			new_rep = gf_list_get(group->adaptation_set->representations, new_idx);
 	}
 
-	if (do_switch) {
+	if (new_rep && (new_rep != rep)) {
 		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] AS#%d switching after playing %d segments from current rep\n", 1+gf_list_find(group->period->adaptation_sets, group->adaptation_set), group->nb_segments_since_switch));
 		group->nb_segments_since_switch = 0;
 
@@ -2461,20 +2837,12 @@ static void dash_do_rate_adaptation(GF_DashClient *dash, GF_DASH_Group *group)
 			new_rep->playback.waiting_codec_reset = GF_TRUE;
 			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] AS#%d switching representation from bandwidth %d bps to %d bps at UTC "LLU" ms (playback speed %f)\n", 1+gf_list_find(group->period->adaptation_sets, group->adaptation_set), rep->bandwidth, new_rep->bandwidth, gf_net_get_utc(), dash->speed ));
 		} else {
-			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] AS#%d switching representation %s from bandwidth %d bps to %d bps at UTC "LLU" ms (download rate %d)\n", 1+gf_list_find(group->period->adaptation_sets, group->adaptation_set), go_up_bitrate ? "up" : "down", rep->bandwidth, new_rep->bandwidth, gf_net_get_utc(), dl_rate));
+			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] AS#%d switching representation %s from bandwidth %d bps to %d bps at UTC "LLU" ms (download rate %d)\n", 1+gf_list_find(group->period->adaptation_sets, group->adaptation_set), (new_rep->bandwidth > rep->bandwidth) ? "up" : "down", rep->bandwidth, new_rep->bandwidth, gf_net_get_utc(), dl_rate));
 		}
 
 		gf_dash_set_group_representation(group, new_rep);
 	}
 
-	group->buffer_occupancy_at_last_seg = group->buffer_occupancy_ms;
-
-	for (k=0; k<gf_list_count(group->adaptation_set->representations); k++) {
-		GF_MPD_Representation *arep = gf_list_get(group->adaptation_set->representations, k);
-		if (new_rep==arep) continue;
-		arep->playback.probe_switch_count = 0;
-	}
-
 	if (force_below_resolution && !new_rep) {
 		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Speed %f is too fast to play - speed down \n", dash->speed));
 		/*FIXME: should do something here*/
@@ -2801,6 +3169,384 @@ static void gf_dash_skip_disabled_representation(GF_DASH_Group *group, GF_MPD_Re
 }
 
 
+/*start and end of a download on one of the connections of the group, for the aggregated download rate*/
+static void gf_dash_group_download_started(GF_DASH_Group *group)
+{
+	gf_mx_p(group->cache_mutex);
+	if (!group->nb_active_downloads) group->active_start = gf_sys_clock_high_res();
+	group->nb_active_downloads++;
+	gf_mx_v(group->cache_mutex);
+}
+
+static void gf_dash_group_download_done(GF_DASH_Group *group, u32 size)
+{
+	u64 now = gf_sys_clock_high_res();
+	gf_mx_p(group->cache_mutex);
+	group->active_time += now - group->active_start;
+	group->active_start = now;
+	group->active_bytes += size;
+	group->nb_active_downloads--;
+	gf_mx_v(group->cache_mutex);
+}
+
+/*replaces the download rate of the last segment with the rate of all connections since the previous segment*/
+static void gf_dash_group_update_parallel_rate(GF_DASH_Group *group)
+{
+	gf_mx_p(group->cache_mutex);
+	if (group->active_time && group->active_bytes) {
+		group->bytes_per_sec = (u32) (group->active_bytes * 1000000 / group->active_time);
+		group->active_time = group->active_bytes = 0;
+	}
+	gf_mx_v(group->cache_mutex);
+}
+
+/*same as gf_dash_download_resource() but retries on the slot session rather than on a new one, so that the group may abort it at any time.
+An abort requested before the session is setup is caught here, and one requested after leaves the session disconnected until the next setup*/
+static GF_Err dash_prefetch_download(GF_DashClient *dash, dash_prefetch_slot *slot)
+{
+	GF_Err e;
+	Bool retry = GF_TRUE;
+	GF_DASHFileIO *dash_io = dash->dash_io;
+
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Prefetching %s starting at UTC "LLU" ms\n", slot->url, gf_net_get_utc() ));
+	while (1) {
+		gf_mx_p(slot->mx);
+		if (slot->abort_requested) {
+			e = GF_IP_CONNECTION_CLOSED;
+		} else {
+			e = dash_io->setup_from_url(dash_io, slot->sess, slot->url, -1);
+			if (!e && slot->end_range)
+				e = dash_io->set_range(dash_io, slot->sess, slot->start_range, slot->end_range, GF_TRUE);
+		}
+		gf_mx_v(slot->mx);
+		if (e) return e;
+
+		e = dash_io->init(dash_io, slot->sess);
+		if (e>=GF_OK)
+			e = dash_io->run(dash_io, slot->sess);
+
+		if ((e!=GF_IP_CONNECTION_FAILURE) && (e!=GF_IP_NETWORK_FAILURE)) break;
+		if (!retry || slot->abort_requested) break;
+		retry = GF_FALSE;
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] failed to prefetch, retrying once with %s...\n", slot->url));
+	}
+	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] FAILED to prefetch %s = %s...\n", slot->url, gf_error_to_string(e)));
+	}
+	return e;
+}
+
+static u32 dash_prefetch_thread(void *par)
+{
+	dash_prefetch_slot *slot = (dash_prefetch_slot *) par;
+	GF_DashClient *dash = slot->group->dash;
+
+	while (1) {
+		u32 size = 0;
+		gf_sema_wait(slot->run_sema);
+		if (slot->stop) break;
+
+		gf_dash_group_download_started(slot->group);
+		slot->error = dash_prefetch_download(dash, slot);
+		/*data is handed over to the client through the cache only*/
+		if (!slot->error && !dash->dash_io->get_cache_name(dash->dash_io, slot->sess))
+			slot->error = GF_NOT_SUPPORTED;
+		if (!slot->error)
+			size = dash->dash_io->get_total_size(dash->dash_io, slot->sess);
+		gf_dash_group_download_done(slot->group, size);
+		gf_mx_p(slot->mx);
+		slot->state = DASH_PREFETCH_DONE;
+		gf_mx_v(slot->mx);
+		gf_sema_notify(slot->done_sema, 1);
+	}
+	return 0;
+}
+
+/*requests the download thread of the slot to stop, aborting the session if the download is running*/
+static void gf_dash_group_abort_prefetch_slot(GF_DashClient *dash, dash_prefetch_slot *slot)
+{
+	gf_mx_p(slot->mx);
+	if (slot->state == DASH_PREFETCH_RUNNING) {
+		slot->abort_requested = GF_TRUE;
+		dash->dash_io->abort(dash->dash_io, slot->sess);
+	}
+	gf_mx_v(slot->mx);
+}
+
+static void gf_dash_group_abort_prefetch(GF_DashClient *dash, GF_DASH_Group *group)
+{
+	u32 i;
+	for (i=0; i<group->nb_prefetch; i++) {
+		gf_dash_group_abort_prefetch_slot(dash, &group->prefetch[i]);
+	}
+}
+
+/*waits for the end of the download and returns its status - aborts requested while waiting abort the slot session*/
+static GF_Err gf_dash_group_wait_prefetch(GF_DashClient *dash, GF_DASH_Group *group, dash_prefetch_slot *slot)
+{
+	if (slot->done_consumed) return slot->error;
+	if (group->download_abort_type || dash->mpd_stop_request)
+		gf_dash_group_abort_prefetch_slot(dash, slot);
+	gf_sema_wait(slot->done_sema);
+	slot->done_consumed = GF_TRUE;
+	return slot->error;
+}
+
+/*releases the slot once its download is done, deleting the downloaded file if not used*/
+static void gf_dash_group_release_prefetch(GF_DashClient *dash, GF_DASH_Group *group, dash_prefetch_slot *slot, Bool delete_file)
+{
+	gf_dash_group_wait_prefetch(dash, group, slot);
+	if (delete_file && !slot->error && !dash->keep_files) {
+		const char *url = dash->dash_io->get_url(dash->dash_io, slot->sess);
+		if (url) dash->dash_io->delete_cache_file(dash->dash_io, slot->sess, url);
+	}
+	if (slot->url) gf_free(slot->url);
+	slot->url = NULL;
+	slot->state = DASH_PREFETCH_IDLE;
+}
+
+static void gf_dash_group_reset_prefetch(GF_DashClient *dash, GF_DASH_Group *group)
+{
+	u32 i;
+	gf_dash_group_abort_prefetch(dash, group);
+	for (i=0; i<group->nb_prefetch; i++) {
+		if (group->prefetch[i].state != DASH_PREFETCH_IDLE)
+			gf_dash_group_release_prefetch(dash, group, &group->prefetch[i], GF_TRUE);
+	}
+}
+
+static void gf_dash_group_del_prefetch(GF_DashClient *dash, GF_DASH_Group *group)
+{
+	u32 i;
+	if (!group->prefetch) return;
+	gf_dash_group_reset_prefetch(dash, group);
+	for (i=0; i<group->nb_prefetch; i++) {
+		dash_prefetch_slot *slot = &group->prefetch[i];
+		slot->stop = GF_TRUE;
+		gf_sema_notify(slot->run_sema, 1);
+		gf_th_del(slot->th);
+		gf_sema_del(slot->run_sema);
+		gf_sema_del(slot->done_sema);
+		gf_mx_del(slot->mx);
+		if (slot->sess) dash->dash_io->del(dash->dash_io, slot->sess);
+	}
+	gf_free(group->prefetch);
+	group->prefetch = NULL;
+	group->nb_prefetch = 0;
+}
+
+/*returns the slot downloading the given resource*/
+static dash_prefetch_slot *gf_dash_group_find_prefetch(GF_DASH_Group *group, const char *url, u64 start_range, u64 end_range)
+{
+	u32 i;
+	for (i=0; i<group->nb_prefetch; i++) {
+		dash_prefetch_slot *slot = &group->prefetch[i];
+		if ((slot->state == DASH_PREFETCH_IDLE) || slot->is_part) continue;
+		if ((slot->start_range == start_range) && (slot->end_range == end_range) && !strcmp(slot->url, url)) return slot;
+	}
+	return NULL;
+}
+
+/*starts downloading the resource on an idle connection - returns NULL if none is available*/
+static dash_prefetch_slot *gf_dash_group_start_prefetch(GF_DashClient *dash, GF_DASH_Group *group, const char *url, u64 start_range, u64 end_range, s32 segment_index, u32 representation_index, Bool is_part)
+{
+	u32 i;
+	dash_prefetch_slot *slot = NULL;
+	for (i=0; i<group->nb_prefetch; i++) {
+		if (group->prefetch[i].state == DASH_PREFETCH_IDLE) {
+			slot = &group->prefetch[i];
+			break;
+		}
+	}
+	if (!slot) return NULL;
+
+	/*connections are created here rather than in the download threads, and kept alive for the next segments*/
+	if (!slot->sess) {
+		slot->sess = dash->dash_io->create(dash->dash_io, GF_DASHIO_SESSION_PERSISTENT, url, -1);
+		if (!slot->sess) return NULL;
+	}
+	slot->url = gf_strdup(url);
+	slot->start_range = start_range;
+	slot->end_range = end_range;
+	slot->segment_index = segment_index;
+	slot->representation_index = representation_index;
+	slot->is_part = is_part;
+	slot->error = GF_OK;
+	slot->done_consumed = GF_FALSE;
+	slot->abort_requested = GF_FALSE;
+	slot->state = DASH_PREFETCH_RUNNING;
+	gf_sema_notify(slot->run_sema, 1);
+	return slot;
+}
+
+/*checks whether the next segments of the group may be downloaded in parallel, and creates the connections if needed*/
+static Bool gf_dash_group_use_parallel_download(GF_DashClient *dash, GF_DASH_Group *group, GF_DASH_Group *base_group, GF_MPD_Representation *rep, Bool has_dep_following)
+{
+	u32 i;
+	if (dash->nb_parallel_downloads < 2) return GF_FALSE;
+	/*dependent representations and groups are downloaded in sequence*/
+	if ((group != base_group) || group->groups_depending_on || has_dep_following) return GF_FALSE;
+	if (rep->enhancement_rep_index_plus_one || group->base_rep_index_plus_one) return GF_FALSE;
+	if (dash->speed < 0) return GF_FALSE;
+
+	if (!group->prefetch) {
+		group->nb_prefetch = dash->nb_parallel_downloads - 1;
+		group->prefetch = (dash_prefetch_slot *) gf_malloc(sizeof(dash_prefetch_slot) * group->nb_prefetch);
+		memset(group->prefetch, 0, sizeof(dash_prefetch_slot) * group->nb_prefetch);
+		for (i=0; i<group->nb_prefetch; i++) {
+			dash_prefetch_slot *slot = &group->prefetch[i];
+			slot->group = group;
+			slot->run_sema = gf_sema_new(1, 0);
+			slot->done_sema = gf_sema_new(1, 0);
+			slot->mx = gf_mx_new("DashGroupPrefetch");
+			slot->th = gf_th_new("DashGroupPrefetch");
+			gf_th_run(slot->th, dash_prefetch_thread, slot);
+		}
+	}
+	return GF_TRUE;
+}
+
+/*releases downloads no longer needed, and starts downloading the segments following the one at segment_index*/
+static void gf_dash_group_prefetch(GF_DashClient *dash, GF_DASH_Group *group, u32 representation_index)
+{
+	u32 i;
+	s32 max_index, nb_ahead;
+	GF_MPD_Representation *rep = gf_list_get(group->adaptation_set->representations, representation_index);
+
+	/*segments stay in the download cache until the group cache has room for them*/
+	nb_ahead = (s32) group->max_cached_segments - (s32) group->nb_cached_segments - 1;
+	if (nb_ahead < 0) nb_ahead = 0;
+	max_index = group->download_segment_index + MIN((s32) group->nb_prefetch, nb_ahead);
+	if (group->nb_segments_in_rep && (max_index >= (s32) group->nb_segments_in_rep)) max_index = group->nb_segments_in_rep - 1;
+
+	for (i=0; i<group->nb_prefetch; i++) {
+		dash_prefetch_slot *slot = &group->prefetch[i];
+		if ((slot->state == DASH_PREFETCH_IDLE) || slot->is_part) continue;
+		if ((slot->representation_index == representation_index) && (slot->segment_index >= group->download_segment_index) && (slot->segment_index <= max_index))
+			continue;
+		/*representation switch or seek*/
+		gf_dash_group_abort_prefetch_slot(dash, slot);
+		gf_dash_group_release_prefetch(dash, group, slot, GF_TRUE);
+	}
+
+	for (i=group->download_segment_index+1; (s32) i<=max_index; i++) {
+		char *url = NULL, *key_url = NULL;
+		u64 start_range, end_range, duration;
+		GF_Err e;
+
+		/*segments not yet available on the server are fetched once their availability time is reached*/
+		if ((dash->mpd->type==GF_MPD_TYPE_DYNAMIC) && !dash->is_m3u8 && !group->broken_timing) {
+			u32 seg_dur_ms = 0;
+			u64 segment_ast = gf_dash_get_segment_availability_start_time(dash->mpd, group, i, &seg_dur_ms);
+			if (segment_ast > gf_net_get_utc()) break;
+		}
+		e = gf_dash_resolve_url(dash->mpd, rep, group, dash->base_url, GF_MPD_RESOLVE_URL_MEDIA, i, &url, &start_range, &end_range, &duration, NULL, &key_url, NULL, NULL);
+		if (e || !url) break;
+		/*local files and encrypted segments are not fetched ahead*/
+		if (key_url || !strstr(url, "://") || !strnicmp(url, "file://", 7) || !strnicmp(url, "gmem://", 7)) {
+			gf_free(url);
+			if (key_url) gf_free(key_url);
+			break;
+		}
+		if (!gf_dash_group_find_prefetch(group, url, start_range, end_range)) {
+			if (!gf_dash_group_start_prefetch(dash, group, url, start_range, end_range, i, representation_index, GF_FALSE)) {
+				gf_free(url);
+				break;
+			}
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Fetching segment %s ahead on parallel connection\n", url));
+		}
+		gf_free(url);
+	}
+}
+
+/*splits the byte range of the segment in parts downloaded on idle connections, the first part being downloaded by the group -
+returns the number of parts started*/
+static u32 gf_dash_group_split_download(GF_DashClient *dash, GF_DASH_Group *group, const char *url, u64 start_range, u64 *end_range, u32 representation_index)
+{
+	u32 i, nb_idle, nb_parts, nb_started;
+	u64 size, part_size, start;
+
+	if (!dash->split_range_size || group->disable_split) return 0;
+	size = *end_range - start_range + 1;
+	if (size < 2 * (u64) dash->split_range_size) return 0;
+
+	nb_idle = 0;
+	for (i=0; i<group->nb_prefetch; i++) {
+		if (group->prefetch[i].state == DASH_PREFETCH_IDLE) nb_idle++;
+	}
+	nb_parts = (u32) MIN(1 + nb_idle, size / dash->split_range_size);
+	if (nb_parts < 2) return 0;
+
+	part_size = size / nb_parts;
+	nb_started = 0;
+	start = start_range + part_size;
+	for (i=1; i<nb_parts; i++) {
+		u64 end = (i+1 == nb_parts) ? *end_range : start + part_size - 1;
+		if (!gf_dash_group_start_prefetch(dash, group, url, start, end, group->download_segment_index, representation_index, GF_TRUE)) break;
+		nb_started++;
+		start = end + 1;
+	}
+	if (!nb_started) return 0;
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Downloading segment %s in %d byte ranges\n", url, nb_started+1));
+	*end_range = start_range + part_size - 1;
+	return nb_started;
+}
+
+/*waits for the byte range parts of the segment and appends them in order to the file of the first part*/
+static GF_Err gf_dash_group_merge_parts(GF_DashClient *dash, GF_DASH_Group *group, GF_Err e, u32 *total_size)
+{
+	u32 i, appended = 0;
+	u64 end_range = 0;
+	FILE *out = NULL;
+	char buf[4096];
+
+	if (e) {
+		gf_dash_group_abort_prefetch(dash, group);
+	} else {
+		const char *cache_name = dash->dash_io->get_cache_name(dash->dash_io, group->segment_download);
+		if (cache_name && strnicmp(cache_name, "gmem://", 7)) out = gf_fopen(cache_name, "ab");
+		if (!out) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Segments are not stored in files, disabling byte range splitting\n"));
+			group->disable_split = GF_TRUE;
+			e = GF_NOT_SUPPORTED;
+		}
+	}
+
+	/*parts are allocated in order to the slots*/
+	for (i=0; i<group->nb_prefetch; i++) {
+		dash_prefetch_slot *slot = &group->prefetch[i];
+		if ((slot->state == DASH_PREFETCH_IDLE) || !slot->is_part) continue;
+
+		if (!e) e = gf_dash_group_wait_prefetch(dash, group, slot);
+		if (!e) {
+			const char *part_name = dash->dash_io->get_cache_name(dash->dash_io, slot->sess);
+			FILE *in = part_name ? gf_fopen(part_name, "rb") : NULL;
+			if (!in) {
+				e = GF_IO_ERR;
+			} else {
+				while (1) {
+					u32 read = (u32) fread(buf, 1, 4096, in);
+					if (!read) break;
+					if (gf_fwrite(buf, 1, read, out) != read) {
+						e = GF_IO_ERR;
+						break;
+					}
+					appended += read;
+				}
+				gf_fclose(in);
+				end_range = slot->end_range;
+			}
+		}
+		gf_dash_group_release_prefetch(dash, group, slot, GF_TRUE);
+	}
+	if (out) gf_fclose(out);
+	*total_size += appended;
+	/*the cache entry of the first part now describes the whole segment*/
+	if (!e && appended && dash->dash_io->extend_cache_range)
+		e = dash->dash_io->extend_cache_range(dash->dash_io, group->segment_download, end_range, appended);
+	return e;
+}
+
 static void gf_dash_group_reset_cache_entry(segment_cache_entry *cached)
 {
 	gf_free(cached->cache);
@@ -2825,6 +3571,7 @@ static void gf_dash_group_reset(GF_DashClient *dash, GF_DASH_Group *group)
 		dash->dash_io->del(dash->dash_io, group->segment_download);
 		group->segment_download = NULL;
 	}
+	gf_dash_group_reset_prefetch(dash, group);
 	while (group->nb_cached_segments) {
 		group->nb_cached_segments --;
 		if (!dash->keep_files && !group->local_files)
@@ -2845,9 +3592,12 @@ static void gf_dash_reset_groups(GF_DashClient *dash)
 		gf_list_rem_last(dash->groups);
 
 		gf_dash_group_reset(dash, group);
+		gf_dash_group_del_prefetch(dash, group);
 
 		gf_list_del(group->groups_depending_on);
 		gf_free(group->cached);
+		if (group->rate_bandwidths) gf_free(group->rate_bandwidths);
+		if (group->rate_disabled) gf_free(group->rate_disabled);
 		if (group->service_mime)
 			gf_free(group->service_mime);
 		
@@ -4147,6 +4897,7 @@ static DownloadGroupStatus dash_download_group_download(GF_DashClient *dash, GF_
 	Bool empty_file = GF_FALSE;
 	const char *local_file_name = NULL;
 	const char *resource_name = NULL;
+	GF_DASHFileIOSession seg_sess = NULL;
 
 	if (group->done) return GF_DASH_DownloadSuccess;
 
@@ -4307,17 +5058,56 @@ static DownloadGroupStatus dash_download_group_download(GF_DashClient *dash, GF_
 			return GF_DASH_DownloadRestart;
 		}
 	} else {
+		dash_prefetch_slot *slot = NULL;
+		Bool parallel_download = GF_FALSE;
+		u32 nb_parts = 0;
+		u32 parts_size = 0;
+		u64 segment_end_range = end_range;
 		base_group->max_bitrate = 0;
 		base_group->min_bitrate = (u32)-1;
+		seg_sess = base_group->segment_download;
 
-		/*use persistent connection for segment downloads*/
-		//gf_mx_p(dash->dl_mutex);
-		if (use_byterange) {
-			e = gf_dash_download_resource(dash, &(base_group->segment_download), new_base_seg_url, start_range, end_range, 1, base_group);
+		if (gf_dash_group_use_parallel_download(dash, group, base_group, rep, has_dep_following)) {
+			parallel_download = GF_TRUE;
+			/*segment may have been fetched ahead*/
+			slot = gf_dash_group_find_prefetch(base_group, new_base_seg_url, start_range, end_range);
+			if (slot && gf_dash_group_wait_prefetch(dash, base_group, slot)) {
+				gf_dash_group_release_prefetch(dash, base_group, slot, GF_TRUE);
+				slot = NULL;
+			}
+			if (!slot && use_byterange)
+				nb_parts = gf_dash_group_split_download(dash, base_group, new_base_seg_url, start_range, &end_range, representation_index);
+			gf_dash_group_prefetch(dash, base_group, representation_index);
+		}
+
+		if (slot) {
+			e = GF_OK;
+			seg_sess = slot->sess;
+			base_group->segment_must_be_streamed = GF_FALSE;
 		} else {
-			e = gf_dash_download_resource(dash, &(base_group->segment_download), new_base_seg_url, 0, 0, 1, base_group);
+			if (parallel_download) gf_dash_group_download_started(base_group);
+			/*use persistent connection for segment downloads*/
+			//gf_mx_p(dash->dl_mutex);
+			if (use_byterange) {
+				e = gf_dash_download_resource(dash, &(base_group->segment_download), new_base_seg_url, start_range, end_range, 1, base_group);
+			} else {
+				e = gf_dash_download_resource(dash, &(base_group->segment_download), new_base_seg_url, 0, 0, 1, base_group);
+			}
+			//gf_mx_v(dash->dl_mutex);
+			if (parallel_download) gf_dash_group_download_done(base_group, e ? 0 : dash->dash_io->get_total_size(dash->dash_io, base_group->segment_download));
+			seg_sess = base_group->segment_download;
+
+			if (nb_parts) {
+				e = gf_dash_group_merge_parts(dash, base_group, e, &parts_size);
+				/*download the segment in one request*/
+				if (e && !group->download_abort_type) {
+					GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Failed to fetch byte ranges of segment %s (%s), fetching the complete segment\n", new_base_seg_url, gf_error_to_string(e)));
+					parts_size = 0;
+					end_range = segment_end_range;
+					e = gf_dash_download_resource(dash, &(base_group->segment_download), new_base_seg_url, start_range, end_range, 1, base_group);
+				}
+			}
 		}
-		//gf_mx_v(dash->dl_mutex);
 
 		if ((e==GF_IP_CONNECTION_CLOSED) && group->download_abort_type) {
 			base_group->download_abort_type = 0;
@@ -4430,16 +5220,26 @@ static DownloadGroupStatus dash_download_group_download(GF_DashClient *dash, GF_
 		group->segment_must_be_streamed = base_group->segment_must_be_streamed;
 
 		if (group->segment_must_be_streamed)
-			local_file_name = dash->dash_io->get_url(dash->dash_io, base_group->segment_download);
+			local_file_name = dash->dash_io->get_url(dash->dash_io, seg_sess);
 		else
-			local_file_name = dash->dash_io->get_cache_name(dash->dash_io, base_group->segment_download);
+			local_file_name = dash->dash_io->get_cache_name(dash->dash_io, seg_sess);
 
-		if (dash->dash_io->get_total_size(dash->dash_io, base_group->segment_download)==0) {
+		if (dash->dash_io->get_total_size(dash->dash_io, seg_sess)==0) {
 			empty_file = GF_TRUE;
 		}
-		resource_name = dash->dash_io->get_url(dash->dash_io, base_group->segment_download);
+		resource_name = dash->dash_io->get_url(dash->dash_io, seg_sess);
 
-		dash_store_stats(dash, group, base_group->segment_download);
+		dash_store_stats(dash, group, seg_sess);
+		if (parallel_download) {
+			group->total_size += parts_size;
+			gf_dash_group_update_parallel_rate(group);
+		}
+		/*the downloaded file is now owned by the group cache*/
+		if (slot) {
+			gf_free(slot->url);
+			slot->url = NULL;
+			slot->state = DASH_PREFETCH_IDLE;
+		}
 	}
 
 	if (local_file_name && (e == GF_OK || group->segment_must_be_streamed )) {
@@ -5022,6 +5822,7 @@ static void gf_dash_download_stop(GF_DashClient *dash)
 					dash->dash_io->abort(dash->dash_io, group->segment_download);
 				group->done = 1;
 			}
+			gf_dash_group_abort_prefetch(dash, group);
 		}
 	}
 	/* stop the download thread */
@@ -5195,7 +5996,7 @@ static GF_Err http_ifce_get(GF_FileDownload *getter, char *url)
 	GF_DASHFileIOSession *sess;
 	GF_DashClient *dash = (GF_DashClient*) getter->udta;
 	if (!getter->session) {
-		sess = dash->dash_io->create(dash->dash_io, 1, url, -1);
+		sess = dash->dash_io->create(dash->dash_io, GF_DASHIO_SESSION_PERSISTENT | GF_DASHIO_SESSION_ALLOW_PIPELINE, url, -1);
 		if (!sess) return GF_IO_ERR;
 		getter->session = sess;
 	}
@@ -5344,6 +6145,8 @@ GF_Err gf_dash_open(GF_DashClient *dash, const char *manifest_url)
 
 	if (dash->mpd)
 		gf_mpd_del(dash->mpd);
+	gf_mpd_text_state_del(dash->mpd_state);
+	dash->mpd_state = NULL;
 
 	dash->mpd = gf_mpd_new();
 	if (!dash->mpd) {
@@ -5455,6 +6258,10 @@ void gf_dash_close(GF_DashClient *dash)
 	if (dash->mpd)
 		gf_mpd_del(dash->mpd);
 	dash->mpd = NULL;
+	gf_mpd_text_state_del(dash->mpd_state);
+	dash->mpd_state = NULL;
+	gf_mpd_text_state_del(dash->next_mpd_state);
+	dash->next_mpd_state = NULL;
 
 	gf_mx_v(dash->dash_mutex);
 
@@ -5533,6 +6340,20 @@ void gf_dash_set_agressive_adaptation(GF_DashClient *dash, Bool agressive_switch
 	dash->agressive_switching = agressive_switch;
 }
 
+GF_EXPORT
+void gf_dash_set_algo(GF_DashClient *dash, GF_DASHAdaptationAlgorithm algo)
+{
+	dash->rate_algo = algo;
+}
+
+GF_EXPORT
+void gf_dash_set_custom_algo(GF_DashClient *dash, gf_dash_rate_algo algo, void *udta)
+{
+	dash->custom_algo = algo;
+	dash->custom_algo_udta = udta;
+	dash->rate_algo = GF_DASH_ALGO_CUSTOM;
+}
+
 
 GF_EXPORT
 u32 gf_dash_get_group_count(GF_DashClient *dash)
@@ -5575,13 +6396,18 @@ Bool gf_dash_is_group_selectable(GF_DashClient *dash, u32 idx)
 }
 
 GF_EXPORT
-void gf_dash_get_info(GF_DashClient *dash, const char **title, const char **source)
+void gf_dash_get_info(GF_DashClient *dash, const char **title, const char **source, GF_DASHRefreshInfo *refresh_info)
 {
 	GF_MPD_ProgramInfo *info = gf_list_get(dash->mpd->program_infos, 0);
 	if (info) {
 		*title = info->title;
 		*source = info->source;
 	}
+	if (refresh_info) {
+		gf_mx_p(dash->dash_mutex);
+		memcpy(refresh_info, &dash->refresh_info, sizeof(GF_DASHRefreshInfo));
+		gf_mx_v(dash->dash_mutex);
+	}
 }
 
 
@@ -6113,6 +6939,7 @@ void gf_dash_set_group_done(GF_DashClient *dash, u32 idx, Bool done)
 		if (done && group->segment_download) {
 			group->download_abort_type = 1;
 			dash->dash_io->abort(dash->dash_io, group->segment_download);
+			gf_dash_group_abort_prefetch(dash, group);
 		}
 		gf_mx_v(group->cache_mutex);
 		gf_mx_v(dash->dash_mutex);
@@ -6918,6 +7745,13 @@ Bool gf_dash_group_get_srd_info(GF_DashClient *dash, u32 idx, u32 *srd_id, u32 *
 	return GF_TRUE;
 }
 
+GF_EXPORT
+void gf_dash_set_parallel_downloads(GF_DashClient *dash, u32 nb_downloads, u32 split_range_size)
+{
+	dash->nb_parallel_downloads = nb_downloads;
+	dash->split_range_size = split_range_size;
+}
+
 GF_EXPORT
 void gf_dash_set_threaded_download(GF_DashClient *dash, Bool use_threads)
 {
@@ -110,6 +110,8 @@ struct __gf_dash_segmenter
 	Double mpd_live_duration;
 	Bool insert_utc;
 	Bool real_time;
+	/*builds and writes the index of TS inputs next to them if not present*/
+	Bool ts_index_write;
 	const char *dash_profile_extension;
 
 	GF_Config *dash_ctx;
@@ -207,6 +209,10 @@ struct _dash_segment_input
 	Bool get_component_info_done;
 	//cached isobmf input
 	GF_ISOFile *isobmf_input;
+#ifndef GPAC_DISABLE_MPEG2TS
+	//cached TS index
+	GF_M2TS_Index *ts_index;
+#endif
 };
 
 
@@ -3258,6 +3264,18 @@ static GF_Err dasher_generic_get_components_info(GF_DashSegInput *input, GF_DASH
 #endif
 
 
+static void format_duration(FILE *mpd, Double dur, const char *name)
+{
+	Double s;
+	u32 h, m;
+
+	h = (u32) (dur/3600);
+	m = (u32) (dur/60 - h*60);
+	s = (dur - h*3600 - m*60);
+	fprintf(mpd, " %s=\"PT%dH%dM%.3fS\"", name, h, m, s);
+
+}
+
 #ifndef GPAC_DISABLE_MPEG2TS
 
 typedef struct
@@ -3280,12 +3298,13 @@ typedef struct
 	u32 subduration;
 	u32 skip_nb_segments;
 	u64 duration_at_last_pass;
+	/*number of subsegments indexed so far*/
+	u32 nb_segments;
 
 	GF_SegmentIndexBox *sidx;
 	GF_PcrInfoBox *pcrb;
 
 	u32 reference_pid;
-	GF_M2TS_PES *reference_stream;
 
 	u32 nb_pes_in_segment;
 	/* earliest presentation time for the whole segment */
@@ -3302,7 +3321,7 @@ typedef struct
 	/* last decoding time for the subsegment being processed */
 	u64 last_DTS;
 	/* byte offset for the last PES packet for the subsegment being processed */
-	u32 last_offset;
+	u64 last_offset;
 	u32 last_frame_duration;
 
 	/* earliest presentation time for the previous subsegment */
@@ -3312,7 +3331,7 @@ typedef struct
 	/* last presentation time for the previous subsegment */
 	u64 prev_last_PTS;
 	/* byte offset for the last PES packet for the previous subsegment */
-	u32 prev_last_offset;
+	u64 prev_last_offset;
 
 	/* indicates if the current subsegment contains a SAP and its SAP type*/
 	u32 SAP_type;
@@ -3321,11 +3340,11 @@ typedef struct
 	/* Presentation time for the first RAP encountered in the subsegment */
 	u64 first_SAP_PTS;
 	/* byte offset for the first RAP encountered in the subsegment */
-	u32 first_SAP_offset;
+	u64 first_SAP_offset;
 	u64 prev_last_SAP_PTS;
-	u32 prev_last_SAP_offset;
+	u64 prev_last_SAP_offset;
 	u64 last_SAP_PTS;
-	u32 last_SAP_offset;
+	u64 last_SAP_offset;
 
 	Bool pes_after_last_pat_is_sap;
 
@@ -3334,31 +3353,31 @@ typedef struct
 	u64 last_pcr_value;
 
 	/* information about the first PAT found in the subsegment */
-	u32 last_pat_position;
-	u32 first_pat_position;
-	u32 prev_last_pat_position;
+	u64 last_pat_position;
+	u64 first_pat_position;
+	u64 prev_last_pat_position;
 	Bool first_pat_position_valid, first_pes_after_last_pat;
 	u32 pat_version;
 
 	/* information about the first CAT found in the subsegment */
-	u32 last_cat_position;
-	u32 first_cat_position;
-	u32 prev_last_cat_position;
+	u64 last_cat_position;
+	u64 first_cat_position;
+	u64 prev_last_cat_position;
 	Bool first_cat_position_valid;
 	u32 cat_version;
 
 	/* information about the first PMT found in the subsegment */
-	u32 last_pmt_position;
-	u32 first_pmt_position;
-	u32 prev_last_pmt_position;
+	u64 last_pmt_position;
+	u64 first_pmt_position;
+	u64 prev_last_pmt_position;
 	Bool first_pmt_position_valid;
 	u32 pmt_version;
 
 	/* information about the first PCR found in the subsegment */
-	u32 last_pcr_position;
-	u32 first_pcr_position;
+	u64 last_pcr_position;
+	u64 first_pcr_position;
 	Bool first_pcr_position_valid;
-	u32 prev_last_pcr_position;
+	u64 prev_last_pcr_position;
 
 } GF_TSSegmenter;
 
@@ -3384,12 +3403,13 @@ static void m2ts_sidx_finalize_size(GF_TSSegmenter *index_info, u64 file_size)
 	if (index_info->sidx->nb_refs == 0) return;
 	ref = &(index_info->sidx->refs[index_info->sidx->nb_refs-1]);
 	ref->reference_size = (u32)(file_size - index_info->prev_base_offset);
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("Subsegment: position-range ajdustment:%d-%d (%d bytes)\n", index_info->prev_base_offset, (u32)file_size, ref->reference_size));
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("Subsegment: position-range ajdustment:"LLU"-"LLU" (%d bytes)\n", index_info->prev_base_offset, file_size, ref->reference_size));
 }
 
 static void m2ts_sidx_flush_entry(GF_TSSegmenter *index_info)
 {
-	u32 end_offset, size, duration;
+	u64 end_offset;
+	u32 size, duration;
 	Bool store_segment = GF_TRUE;
 
 	if (index_info->suspend_indexing)
@@ -3414,7 +3434,7 @@ static void m2ts_sidx_flush_entry(GF_TSSegmenter *index_info)
 	if (store_segment) {
 		u32 prev_duration, SAP_delta_time, SAP_offset;
 		if (!index_info->sidx) {
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("Segment: Reference PID: %d, EPTime: "LLU", Start Offset: %d bytes\n", index_info->reference_pid, index_info->base_PTS, index_info->base_offset));
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("Segment: Reference PID: %d, EPTime: "LLU", Start Offset: "LLU" bytes\n", index_info->reference_pid, index_info->base_PTS, index_info->base_offset));
 			index_info->sidx = (GF_SegmentIndexBox *)gf_isom_box_new(GF_ISOM_BOX_TYPE_SIDX);
 			index_info->sidx->reference_ID = index_info->reference_pid;
 			/* timestamps in MPEG-2 are expressed in 90 kHz timescale */
@@ -3433,6 +3453,7 @@ static void m2ts_sidx_flush_entry(GF_TSSegmenter *index_info)
 		SAP_delta_time = (u32)(index_info->first_SAP_PTS - index_info->base_PTS);
 		SAP_offset = (u32)(index_info->first_SAP_offset - index_info->base_offset);
 		m2ts_sidx_add_entry(index_info->sidx, GF_FALSE, size, duration, index_info->first_pes_sap, index_info->SAP_type, SAP_delta_time);
+		index_info->nb_segments++;
 
 		/*add pcrb entry*/
 		index_info->pcrb->subsegment_count++;
@@ -3456,7 +3477,7 @@ static void m2ts_sidx_flush_entry(GF_TSSegmenter *index_info)
 		/* Printing result */
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("Subsegment:"));
 		//time-range:position-range:
-		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, (" %.3f-%.3f / %.3f sec., %d-%d / %d bytes, ",
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, (" %.3f-%.3f / %.3f sec., "LLU"-"LLU" / %d bytes, ",
 		                                        (index_info->base_PTS - index_info->first_PTS)/90000.0,
 		                                        (index_info->last_PTS - index_info->first_PTS)/90000.0, duration/90000.0,
 		                                        index_info->base_offset, end_offset, size));
@@ -3564,9 +3585,9 @@ static void m2ts_check_indexing(GF_TSSegmenter *index_info)
 	u64 target_duration = segment_duration;
 
 	//using drift control to ensure that nb_seg*segment_duration is roughly aligned with segment(nb_seg).first_PTS
-	if (index_info->sidx) {
+	if (index_info->nb_segments) {
 		current_duration = (index_info->last_PTS - index_info->first_PTS) - index_info->duration_at_last_pass;
-		target_duration += index_info->sidx->nb_refs * segment_duration;
+		target_duration += index_info->nb_segments * segment_duration;
 	}
 
 	if (index_info->segment_at_rap) {
@@ -3648,124 +3669,73 @@ static void dash_m2ts_event_check_pat(GF_M2TS_Demuxer *ts, u32 evt_type, void *p
 	}
 }
 
-static void dash_m2ts_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
+/*updates the segmenter state with a demuxer event, either from the demuxer or from the file index*/
+static void dash_m2ts_process_entry(GF_TSSegmenter *ts_seg, GF_M2TS_IndexEntry *entry)
 {
-	GF_M2TS_Program *prog;
-	GF_M2TS_PES_PCK *pck;
-	GF_M2TS_PES *pes;
-	u64 interpolated_pcr_value;
-	u32 count, i;
-	GF_TSSegmenter *ts_seg = (GF_TSSegmenter*)ts->user;
-
-	switch (evt_type) {
+	switch (entry->evt_type) {
 	case GF_M2TS_EVT_PAT_FOUND:
-		if (!ts_seg->first_pat_position_valid) {
-			ts_seg->first_pat_position_valid = GF_TRUE;
-			ts_seg->first_pat_position = (ts->pck_number-1)*188;
-		}
-		ts_seg->last_pat_position = (ts->pck_number-1)*188;
-		ts_seg->first_pes_after_last_pat = GF_FALSE;
-		ts_seg->pes_after_last_pat_is_sap = GF_FALSE;
-		break;
 	case GF_M2TS_EVT_PAT_UPDATE:
-		if (!ts_seg->first_pat_position_valid) {
-			ts_seg->first_pat_position_valid = GF_TRUE;
-			ts_seg->first_pat_position = (ts->pck_number-1)*188;
-		}
-		ts_seg->last_pat_position = (ts->pck_number-1)*188;
-		ts_seg->first_pes_after_last_pat = GF_FALSE;
-		ts_seg->pes_after_last_pat_is_sap = GF_FALSE;
-		break;
 	case GF_M2TS_EVT_PAT_REPEAT:
 		if (!ts_seg->first_pat_position_valid) {
 			ts_seg->first_pat_position_valid = GF_TRUE;
-			ts_seg->first_pat_position = (ts->pck_number-1)*188;
+			ts_seg->first_pat_position = entry->offset;
 		}
-		ts_seg->last_pat_position = (ts->pck_number-1)*188;
+		ts_seg->last_pat_position = entry->offset;
 		ts_seg->first_pes_after_last_pat = GF_FALSE;
 		ts_seg->pes_after_last_pat_is_sap = GF_FALSE;
 		break;
 	case GF_M2TS_EVT_CAT_FOUND:
 		if (!ts_seg->first_cat_position_valid) {
 			ts_seg->first_cat_position_valid = GF_TRUE;
-			ts_seg->first_cat_position = (ts->pck_number-1)*188;
+			ts_seg->first_cat_position = entry->offset;
 		}
-		ts_seg->last_cat_position = (ts->pck_number-1)*188;
+		ts_seg->last_cat_position = entry->offset;
 		break;
 	case GF_M2TS_EVT_CAT_UPDATE:
 		if (!ts_seg->first_cat_position_valid) {
 			ts_seg->first_cat_position_valid = GF_TRUE;
-			ts_seg->first_cat_position = (ts->pck_number-1)*188;
+			ts_seg->first_cat_position = entry->offset;
 		}
 		break;
 	case GF_M2TS_EVT_CAT_REPEAT:
 		if (!ts_seg->first_cat_position_valid) {
 			ts_seg->first_cat_position_valid = GF_TRUE;
-			ts_seg->first_cat_position = (ts->pck_number-1)*188;
+			ts_seg->first_cat_position = entry->offset;
 		}
-		ts_seg->last_cat_position = (ts->pck_number-1)*188;
+		ts_seg->last_cat_position = entry->offset;
 		break;
 	case GF_M2TS_EVT_PMT_FOUND:
 		ts_seg->has_seen_pat = GF_TRUE;
-		prog = (GF_M2TS_Program*)par;
 		if (!ts_seg->first_pmt_position_valid) {
 			ts_seg->first_pmt_position_valid = GF_TRUE;
-			ts_seg->first_pmt_position = (ts->pck_number-1)*188;
+			ts_seg->first_pmt_position = entry->offset;
 		}
-		ts_seg->last_pmt_position = (ts->pck_number-1)*188;
+		ts_seg->last_pmt_position = entry->offset;
 		/* we create indexing information on the stream used for carrying the PCR */
-		ts_seg->reference_pid = prog->pcr_pid;
-		ts_seg->reference_stream = (GF_M2TS_PES *) ts_seg->ts->ess[prog->pcr_pid];
-		count = gf_list_count(prog->streams);
-
-		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("Program number %d found - %d streams:\n", prog->number, count));
-		for (i=0; i<count; i++) {
-			GF_M2TS_ES *es = (GF_M2TS_ES*)gf_list_get(prog->streams, i);
-			gf_m2ts_set_pes_framing((GF_M2TS_PES *)es, GF_M2TS_PES_FRAMING_DEFAULT);
-		}
+		ts_seg->reference_pid = entry->pid;
 		break;
 	case GF_M2TS_EVT_PMT_UPDATE:
-		if (!ts_seg->first_pmt_position_valid) {
-			ts_seg->first_pmt_position_valid = GF_TRUE;
-			ts_seg->first_pmt_position = (ts->pck_number-1)*188;
-		}
-		ts_seg->last_pmt_position = (ts->pck_number-1)*188;
-		break;
 	case GF_M2TS_EVT_PMT_REPEAT:
 		if (!ts_seg->first_pmt_position_valid) {
 			ts_seg->first_pmt_position_valid = GF_TRUE;
-			ts_seg->first_pmt_position = (ts->pck_number-1)*188;
+			ts_seg->first_pmt_position = entry->offset;
 		}
-		ts_seg->last_pmt_position = (ts->pck_number-1)*188;
+		ts_seg->last_pmt_position = entry->offset;
 		break;
 	case GF_M2TS_EVT_PES_PCK:
-		pck = (GF_M2TS_PES_PCK*)par;
-		/*We need the interpolated PCR for the pcrb, hence moved this calculus out, and saving the calculated value in ts_seg to put it in the pcrb*/
-		pes = pck->stream;
-		/* Interpolated PCR value for the TS packet containing the PES header start */
-		interpolated_pcr_value = 0;
-		if (pes->last_pcr_value && pes->before_last_pcr_value_pck_number && pes->last_pcr_value > pes->before_last_pcr_value) {
-			u32 delta_pcr_pck_num = pes->last_pcr_value_pck_number - pes->before_last_pcr_value_pck_number;
-			u32 delta_pts_pcr_pck_num = pes->pes_start_packet_number - pes->last_pcr_value_pck_number;
-			u64 delta_pcr_value = pes->last_pcr_value - pes->before_last_pcr_value;
-			if ((pes->pes_start_packet_number > pes->last_pcr_value_pck_number)
-			        && (pes->last_pcr_value > pes->before_last_pcr_value)) {
-
-				pes->last_pcr_value = pes->before_last_pcr_value;
-			}
-			/* we can compute the interpolated pcr value for the packet containing the PES header */
-			interpolated_pcr_value = pes->last_pcr_value + (u64)((delta_pcr_value*delta_pts_pcr_pck_num*1.0)/delta_pcr_pck_num);
-			ts_seg->interpolated_pcr_value = interpolated_pcr_value;
-			ts_seg->last_pcr_value = pes->last_pcr_value;
+		/*We need the interpolated PCR for the pcrb, saving the calculated value in ts_seg to put it in the pcrb*/
+		if (entry->flags & GF_M2TS_INDEX_PCR_INTERPOLATED) {
+			ts_seg->interpolated_pcr_value = entry->interpolated_pcr;
+			ts_seg->last_pcr_value = entry->last_pcr;
 		}
 		/* we process packets only for the given PID */
-		if (pck->stream->pid != ts_seg->reference_pid) {
+		if (entry->pid != ts_seg->reference_pid) {
 			break;
 		} else {
-			if (ts_seg->last_DTS != pck->DTS) {
+			if (ts_seg->last_DTS != entry->DTS) {
 				if (ts_seg->last_DTS)
-					ts_seg->last_frame_duration = (u32) (pck->DTS - ts_seg->last_DTS);
-				ts_seg->last_DTS = pck->DTS;
+					ts_seg->last_frame_duration = (u32) (entry->DTS - ts_seg->last_DTS);
+				ts_seg->last_DTS = entry->DTS;
 				ts_seg->nb_pes_in_segment++;
 
 				if (!ts_seg->first_pes_after_last_pat) {
@@ -3776,14 +3746,14 @@ static void dash_m2ts_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 
 			/* we store the fact that there is at least a RAP for the index
 			and we store the PTS of the first encountered RAP in the index*/
-			if (pck->flags & GF_M2TS_PES_PCK_RAP) {
+			if (entry->flags & GF_M2TS_INDEX_RAP) {
 				ts_seg->SAP_type = 1;
-				if (!ts_seg->first_SAP_PTS || (ts_seg->first_SAP_PTS > pck->PTS)) {
-					ts_seg->first_SAP_PTS = pck->PTS;
-					ts_seg->first_SAP_offset = (pck->stream->pes_start_packet_number-1)*188;
+				if (!ts_seg->first_SAP_PTS || (ts_seg->first_SAP_PTS > entry->PTS)) {
+					ts_seg->first_SAP_PTS = entry->PTS;
+					ts_seg->first_SAP_offset = entry->pes_offset;
 				}
-				ts_seg->last_SAP_PTS = pck->PTS;
-				ts_seg->last_SAP_offset = (pck->stream->pes_start_packet_number-1)*188;
+				ts_seg->last_SAP_PTS = entry->PTS;
+				ts_seg->last_SAP_offset = entry->pes_offset;
 
 				if (ts_seg->nb_pes_in_segment==1) {
 					ts_seg->first_pes_sap = GF_TRUE;
@@ -3793,37 +3763,72 @@ static void dash_m2ts_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 				}
 			}
 			/* we need to know the earliest PTS value (RAP or not) in the index*/
-			if (!ts_seg->base_PTS || (ts_seg->base_PTS > pck->PTS)) {
-				ts_seg->base_PTS = pck->PTS;
+			if (!ts_seg->base_PTS || (ts_seg->base_PTS > entry->PTS)) {
+				ts_seg->base_PTS = entry->PTS;
 			}
 			/* we need to know the earliest PTS value for the whole file (segment) */
-			if (!ts_seg->first_PTS || (ts_seg->first_PTS > pck->PTS)) {
-				ts_seg->first_PTS = pck->PTS;
+			if (!ts_seg->first_PTS || (ts_seg->first_PTS > entry->PTS)) {
+				ts_seg->first_PTS = entry->PTS;
 			}
-			if (pck->PTS > ts_seg->last_PTS) {
+			if (entry->PTS > ts_seg->last_PTS) {
 				/* we use the last PTS for first approximation of the duration */
-				ts_seg->last_PTS = pck->PTS;
-				ts_seg->last_offset = (ts_seg->reference_stream->pes_start_packet_number-1)*188;
+				ts_seg->last_PTS = entry->PTS;
+				ts_seg->last_offset = entry->pes_offset;
 			}
 
 			if (ts_seg->PCR_DTS_initial_diff == (u64) -1) {
-				ts_seg->PCR_DTS_initial_diff = ts_seg->last_DTS - pes->last_pcr_value / 300;
+				ts_seg->PCR_DTS_initial_diff = ts_seg->last_DTS - entry->last_pcr / 300;
 			}
 
 			m2ts_check_indexing(ts_seg);
 		}
 		break;
 	case GF_M2TS_EVT_PES_PCR:
-		pck = (GF_M2TS_PES_PCK*)par;
 		if (!ts_seg->first_pcr_position_valid) {
 			ts_seg->first_pcr_position_valid = GF_TRUE;
-			ts_seg->first_pcr_position = (ts->pck_number-1)*188;
+			ts_seg->first_pcr_position = entry->offset;
 		}
-		ts_seg->last_pcr_position = (ts->pck_number-1)*188;
+		ts_seg->last_pcr_position = entry->offset;
 		break;
 	}
 }
 
+static void dash_m2ts_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
+{
+	GF_M2TS_IndexEntry entry;
+	GF_TSSegmenter *ts_seg = (GF_TSSegmenter*)ts->user;
+
+	if (evt_type == GF_M2TS_EVT_PMT_FOUND) {
+		u32 i, count;
+		GF_M2TS_Program *prog = (GF_M2TS_Program*)par;
+		count = gf_list_count(prog->streams);
+
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("Program number %d found - %d streams:\n", prog->number, count));
+		for (i=0; i<count; i++) {
+			GF_M2TS_ES *es = (GF_M2TS_ES*)gf_list_get(prog->streams, i);
+			gf_m2ts_set_pes_framing((GF_M2TS_PES *)es, GF_M2TS_PES_FRAMING_DEFAULT);
+		}
+	}
+	if (gf_m2ts_index_get_event_entry(ts, evt_type, par, &entry))
+		dash_m2ts_process_entry(ts_seg, &entry);
+}
+
+/*replays the file index until indexing is suspended, as done when demuxing the file by chunks of NB_TSPCK_IO_BYTES bytes*/
+static void dash_m2ts_replay_index(GF_TSSegmenter *ts_seg, GF_M2TS_Index *index, u32 chunk_size)
+{
+	u32 i;
+	u64 chunk_end = 0;
+	for (i=0; i<index->nb_entries; i++) {
+		GF_M2TS_IndexEntry *entry = &index->entries[i];
+		/*indexing is only checked once a chunk is processed*/
+		if (ts_seg->suspend_indexing && (entry->offset >= chunk_end)) break;
+		dash_m2ts_process_entry(ts_seg, entry);
+		chunk_end = (entry->offset / chunk_size + 1) * chunk_size;
+	}
+	/*end of file reached while reading the last chunk*/
+	if (!ts_seg->suspend_indexing || (chunk_end > ts_seg->file_size)) ts_seg->suspend_indexing = 0;
+}
+
 static GF_Err dasher_get_ts_demux(GF_TSSegmenter *ts_seg, const char *file, u32 probe_mode)
 {
 	memset(ts_seg, 0, sizeof(GF_TSSegmenter));
@@ -3882,6 +3887,12 @@ static GF_Err dasher_mp2t_get_components_info(GF_DashSegInput *dash_input, GF_DA
 		}
 	}
 
+	/*use the file index rather than scanning the whole file to get the duration*/
+	if (!dash_input->duration) {
+		if (!dash_input->ts_index) dash_input->ts_index = gf_m2ts_index_open(dash_input->file_name, dash_opts->ts_index_write);
+		if (dash_input->ts_index) dash_input->duration = gf_m2ts_index_get_duration(dash_input->ts_index);
+	}
+
 	e = dasher_get_ts_demux(&ts_seg, dash_input->file_name, dash_input->duration ? 2 : 3);
 	if (e) return e;
 
@@ -3912,6 +3923,7 @@ static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *
 	u32 i;
 	GF_Err e;
 	u64 start, pcr_shift, next_pcr_shift, presentationTimeOffset;
+	Bool resume = GF_FALSE;
 	Double cumulated_duration = 0;
 	u32 bandwidth = 0;
 	u32 segment_index;
@@ -3991,6 +4003,7 @@ static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *
 			gf_fseek(ts_seg.src, offset, SEEK_SET);
 			ts_seg.base_offset = offset;
 			ts_seg.ts->pck_number = (u32) (offset/188);
+			resume = GF_TRUE;
 		}
 
 		opt = gf_cfg_get_key(dash_cfg->dash_ctx, szSectionName, "InitialDTSOffset");
@@ -4006,14 +4019,19 @@ static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *
 		if (opt) sscanf(opt, LLD, &ts_seg.duration_at_last_pass);
 	}
 
-	/*index the file*/
-	while (!feof(ts_seg.src) && !ts_seg.suspend_indexing) {
-		char data[NB_TSPCK_IO_BYTES];
-		u32 size = (u32) fread(data, 1, NB_TSPCK_IO_BYTES, ts_seg.src);
-		gf_m2ts_process_data(ts_seg.ts, data, size);
-		if (size<NB_TSPCK_IO_BYTES) break;
+	/*index the file - when starting from the beginning of the file, use the file index if any rather than demuxing the file*/
+	if (!resume && !dash_input->ts_index) dash_input->ts_index = gf_m2ts_index_open(dash_input->file_name, dash_cfg->ts_index_write);
+	if (!resume && dash_input->ts_index && (dash_input->ts_index->file_size == ts_seg.file_size)) {
+		dash_m2ts_replay_index(&ts_seg, dash_input->ts_index, NB_TSPCK_IO_BYTES);
+	} else {
+		while (!feof(ts_seg.src) && !ts_seg.suspend_indexing) {
+			char data[NB_TSPCK_IO_BYTES];
+			u32 size = (u32) fread(data, 1, NB_TSPCK_IO_BYTES, ts_seg.src);
+			gf_m2ts_process_data(ts_seg.ts, data, size);
+			if (size<NB_TSPCK_IO_BYTES) break;
+		}
+		if (feof(ts_seg.src)) ts_seg.suspend_indexing = 0;
 	}
-	if (feof(ts_seg.src)) ts_seg.suspend_indexing = 0;
 
 	if (!presentationTimeOffset) {
 		presentationTimeOffset = 1 + ts_seg.first_PTS;
@@ -4359,6 +4377,471 @@ exit:
 	return e;
 }
 
+/*live TS segmenter: the received packets are kept in memory until the segment they belong to is cut, then written at once*/
+#define DASH_TS_LIVE_MAX_COMPONENTS	20
+/*maximum size of the packets kept while waiting for a segment boundary*/
+#define DASH_TS_LIVE_MAX_BUFFER	(64*1024*1024)
+
+typedef struct
+{
+	u32 number;
+	/*start time and duration in 90 kHz*/
+	u64 start, duration;
+	u32 size;
+} GF_DASHTSLiveSegment;
+
+struct __gf_dash_ts_live
+{
+	GF_TSSegmenter ts_seg;
+	char *mpd_name, *seg_rad_name;
+	u32 time_shift_depth;
+
+	/*packets received and not yet written, buffer[0] is at byte offset buffer_offset in the stream*/
+	char *buffer;
+	u32 buffer_size, buffer_alloc;
+	u64 buffer_offset;
+	/*set once the first PAT is found, the first segment starts with it*/
+	Bool started;
+	/*UTC time at which the first segment started, used as availability start time*/
+	u32 ast_sec, ast_msec;
+
+	struct _dash_component components[DASH_TS_LIVE_MAX_COMPONENTS];
+	u32 nb_components;
+
+	/*segments in the time shift buffer*/
+	GF_List *segments;
+	u32 next_number;
+	/*start time of the next segment, 0 until the first segment is written*/
+	u64 next_start;
+	u64 presentation_time_offset;
+	u64 total_bytes, total_duration, max_duration;
+	u32 nb_segments;
+	Bool url_started;
+	GF_Err last_error;
+};
+
+static void dash_ts_live_set_codec(GF_DASHTSLive *live, GF_M2TS_PES *pes, const char *data, u32 data_len)
+{
+	u32 i;
+	struct _dash_component *comp = NULL;
+	for (i=0; i<live->nb_components; i++) {
+		if (live->components[i].ID == pes->pid) {
+			comp = &live->components[i];
+			break;
+		}
+	}
+	if (!comp) return;
+
+	if (pes->vid_w && !comp->width) {
+		comp->width = pes->vid_w;
+		comp->height = pes->vid_h;
+	}
+	if (pes->aud_sr && !comp->sample_rate) {
+		comp->sample_rate = pes->aud_sr;
+		comp->channels = pes->aud_nb_ch;
+		if ((pes->stream_type==GF_M2TS_AUDIO_AAC) || (pes->stream_type==GF_M2TS_AUDIO_LATM_AAC))
+			sprintf(comp->szCodec, "mp4a.40.%02x", (u8) pes->aud_aac_obj_type);
+	}
+	/*profile and level are read from the first SPS found in the access units*/
+	if (((pes->stream_type==GF_M2TS_VIDEO_H264) || (pes->stream_type==GF_M2TS_VIDEO_SVC)) && !strcmp(comp->szCodec, "avc1")) {
+		for (i=0; i+6<data_len; i++) {
+			if (data[i] || data[i+1] || (data[i+2]!=1)) continue;
+			if ((data[i+3] & 0x1F) == GF_AVC_NALU_SEQ_PARAM) {
+				sprintf(comp->szCodec, "avc1.%02x%02x%02x", (u8) data[i+4], (u8) data[i+5], (u8) data[i+6]);
+				break;
+			}
+		}
+	}
+}
+
+static void dash_ts_live_add_components(GF_DASHTSLive *live, GF_M2TS_Program *prog)
+{
+	u32 i, count = gf_list_count(prog->streams);
+	for (i=0; i<count; i++) {
+		struct _dash_component *comp;
+		GF_M2TS_ES *es = (GF_M2TS_ES *)gf_list_get(prog->streams, i);
+		if (!(es->flags & GF_M2TS_ES_IS_PES)) continue;
+		gf_m2ts_set_pes_framing((GF_M2TS_PES *)es, GF_M2TS_PES_FRAMING_DEFAULT);
+		if (live->nb_components==DASH_TS_LIVE_MAX_COMPONENTS) continue;
+
+		comp = &live->components[live->nb_components];
+		memset(comp, 0, sizeof(struct _dash_component));
+		comp->ID = es->pid;
+		switch (es->stream_type) {
+		case GF_M2TS_VIDEO_H264:
+		case GF_M2TS_VIDEO_SVC:
+			strcpy(comp->szCodec, "avc1");
+			break;
+		case GF_M2TS_VIDEO_HEVC:
+		case GF_M2TS_VIDEO_SHVC:
+			strcpy(comp->szCodec, "hvc1");
+			break;
+		case GF_M2TS_VIDEO_MPEG1:
+			strcpy(comp->szCodec, "mp4v.6A");
+			break;
+		case GF_M2TS_VIDEO_MPEG2:
+			strcpy(comp->szCodec, "mp4v.61");
+			break;
+		case GF_M2TS_VIDEO_MPEG4:
+			strcpy(comp->szCodec, "mp4v.20");
+			break;
+		case GF_M2TS_AUDIO_MPEG1:
+			strcpy(comp->szCodec, "mp4a.6B");
+			break;
+		case GF_M2TS_AUDIO_MPEG2:
+			strcpy(comp->szCodec, "mp4a.69");
+			break;
+		case GF_M2TS_AUDIO_AAC:
+		case GF_M2TS_AUDIO_LATM_AAC:
+			strcpy(comp->szCodec, "mp4a.40");
+			break;
+		case GF_M2TS_AUDIO_AC3:
+			strcpy(comp->szCodec, "ac-3");
+			break;
+		case GF_M2TS_AUDIO_EC3:
+			strcpy(comp->szCodec, "ec-3");
+			break;
+		default:
+			continue;
+		}
+		live->nb_components++;
+	}
+}
+
+static void dash_ts_live_format_date(FILE *mpd, const char *name, u32 sec, u32 msec)
+{
+	time_t gtime = sec;
+	struct tm *t = gmtime(&gtime);
+	fprintf(mpd, " %s=\"%d-%02d-%02dT%02d:%02d:%02d.%03dZ\"", name, 1900+t->tm_year, t->tm_mon+1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec, msec);
+}
+
+/*rewrites the whole MPD in a temporary file moved over the previous one, so that clients never fetch a partial MPD*/
+static GF_Err dash_ts_live_write_mpd(GF_DASHTSLive *live, Bool is_final)
+{
+	u32 i, count, sec, msec, bandwidth, width, height, sample_rate;
+	char szTmp[GF_MAX_PATH], szSegName[GF_MAX_PATH], szCodecs[200];
+	GF_DASHTSLiveSegment *seg;
+	FILE *mpd;
+
+	sprintf(szTmp, "%s.tmp", live->mpd_name);
+	mpd = gf_fopen(szTmp, "wt");
+	if (!mpd) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Cannot create MPD file %s\n", szTmp));
+		return GF_IO_ERR;
+	}
+	bandwidth = live->total_duration ? (u32) (live->total_bytes * 8 * 90000 / live->total_duration) : 0;
+
+	gf_utc_time_since_1970(&sec, &msec);
+	fprintf(mpd, "<?xml version=\"1.0\"?>\n");
+	fprintf(mpd, "<!-- MPD file Generated with GPAC version "GPAC_FULL_VERSION" -->\n");
+	fprintf(mpd, "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" minBufferTime=\"PT%.3fS\" type=\"dynamic\"", live->ts_seg.segment_duration);
+	dash_ts_live_format_date(mpd, "publishTime", sec, 0);
+	dash_ts_live_format_date(mpd, "availabilityStartTime", live->ast_sec, live->ast_msec);
+	if (live->time_shift_depth)
+		format_duration(mpd, live->time_shift_depth, "timeShiftBufferDepth");
+	if (is_final)
+		format_duration(mpd, (Double) (live->next_start - live->presentation_time_offset) / 90000, "mediaPresentationDuration");
+	else
+		format_duration(mpd, live->ts_seg.segment_duration, "minimumUpdatePeriod");
+	format_duration(mpd, (Double) live->max_duration / 90000, "maxSegmentDuration");
+	fprintf(mpd, " profiles=\"urn:mpeg:dash:profile:mp2t-simple:2011\">\n");
+
+	fprintf(mpd, " <Period id=\"DID1\" start=\"PT0S\">\n");
+	fprintf(mpd, "  <AdaptationSet segmentAlignment=\"true\" bitstreamSwitching=\"true\">\n");
+	fprintf(mpd, "   <Representation id=\"1\" mimeType=\"video/mp2t\"");
+	/*the representation is multiplexed, signal the largest video size and the first audio sample rate*/
+	width = height = sample_rate = 0;
+	szCodecs[0] = 0;
+	for (i=0; i<live->nb_components; i++) {
+		struct _dash_component *comp = &live->components[i];
+		if (strlen(szCodecs) + strlen(comp->szCodec) + 2 < sizeof(szCodecs)) {
+			if (strlen(szCodecs)) strcat(szCodecs, ",");
+			strcat(szCodecs, comp->szCodec);
+		}
+		if (comp->width * comp->height > width * height) {
+			width = comp->width;
+			height = comp->height;
+		}
+		if (!sample_rate) sample_rate = comp->sample_rate;
+	}
+	if (width && height)
+		fprintf(mpd, " width=\"%u\" height=\"%u\"", width, height);
+	if (sample_rate)
+		fprintf(mpd, " audioSamplingRate=\"%d\"", sample_rate);
+	if (strlen(szCodecs))
+		fprintf(mpd, " codecs=\"%s\"", szCodecs);
+	fprintf(mpd, " startWithSAP=\"%d\" bandwidth=\"%d\">\n", live->ts_seg.segment_at_rap ? 1 : 0, bandwidth);
+
+	seg = (GF_DASHTSLiveSegment *)gf_list_get(live->segments, 0);
+	gf_media_mpd_format_segment_name(GF_DASH_TEMPLATE_TEMPLATE, GF_TRUE, szSegName, live->mpd_name, "1", NULL, gf_dasher_strip_output_dir(live->mpd_name, live->seg_rad_name), "ts", 0, 0, 0, GF_FALSE);
+	fprintf(mpd, "    <SegmentTemplate timescale=\"90000\" presentationTimeOffset=\""LLU"\" startNumber=\"%d\" media=\"%s\">\n", live->presentation_time_offset, seg ? seg->number : live->next_number, szSegName);
+	fprintf(mpd, "     <SegmentTimeline>\n");
+	count = gf_list_count(live->segments);
+	for (i=0; i<count; i++) {
+		u32 repeat = 0;
+		seg = (GF_DASHTSLiveSegment *)gf_list_get(live->segments, i);
+		while (i+1<count) {
+			GF_DASHTSLiveSegment *next = (GF_DASHTSLiveSegment *)gf_list_get(live->segments, i+1);
+			if (next->duration != seg->duration) break;
+			repeat++;
+			i++;
+		}
+		fprintf(mpd, "      <S t=\""LLU"\" d=\""LLU"\"", seg->start, seg->duration);
+		if (repeat) fprintf(mpd, " r=\"%d\"", repeat);
+		fprintf(mpd, "/>\n");
+	}
+	fprintf(mpd, "     </SegmentTimeline>\n");
+	fprintf(mpd, "    </SegmentTemplate>\n");
+	fprintf(mpd, "   </Representation>\n");
+	fprintf(mpd, "  </AdaptationSet>\n");
+	fprintf(mpd, " </Period>\n");
+	fprintf(mpd, "</MPD>\n");
+	gf_fclose(mpd);
+
+	return gf_move_file(szTmp, live->mpd_name);
+}
+
+/*writes the segments indexed since the last call from the packet buffer and updates the MPD*/
+static void dash_ts_live_write_segments(GF_DASHTSLive *live, Bool is_last)
+{
+	u32 i;
+	GF_SegmentIndexBox *sidx = live->ts_seg.sidx;
+
+	for (i=0; i<sidx->nb_refs; i++) {
+		char szName[GF_MAX_PATH];
+		GF_DASHTSLiveSegment *seg;
+		FILE *out;
+		u32 size = sidx->refs[i].reference_size;
+		if (size > live->buffer_size) size = live->buffer_size;
+
+		GF_SAFEALLOC(seg, GF_DASHTSLiveSegment);
+		if (!seg) {
+			live->last_error = GF_OUT_OF_MEM;
+			break;
+		}
+		seg->number = live->next_number++;
+		seg->size = size;
+		/*segments are contiguous in time, each one ends where the next one starts*/
+		seg->start = live->next_start ? live->next_start : sidx->earliest_presentation_time;
+		if (!live->next_start) live->presentation_time_offset = seg->start;
+		if (i+1<sidx->nb_refs) {
+			seg->duration = sidx->refs[i].subsegment_duration;
+		} else if (is_last) {
+			seg->duration = live->ts_seg.last_PTS + live->ts_seg.last_frame_duration - seg->start;
+		} else {
+			seg->duration = live->ts_seg.base_PTS - seg->start;
+		}
+		live->next_start = seg->start + seg->duration;
+
+		gf_media_mpd_format_segment_name(GF_DASH_TEMPLATE_SEGMENT, GF_TRUE, szName, live->mpd_name, "1", NULL, live->seg_rad_name, "ts", 0, 0, seg->number, GF_FALSE);
+		out = gf_fopen(szName, "wb");
+		if (!out || (fwrite(live->buffer, 1, size, out) != size)) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Cannot write segment file %s\n", szName));
+			live->last_error = GF_IO_ERR;
+		}
+		if (out) gf_fclose(out);
+		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] Live TS segment %s: %d bytes - %.3f sec\n", szName, size, (Double) seg->duration / 90000));
+
+		live->buffer_size -= size;
+		if (live->buffer_size) memmove(live->buffer, live->buffer + size, sizeof(char)*live->buffer_size);
+		live->buffer_offset += size;
+
+		live->total_bytes += size;
+		live->total_duration += seg->duration;
+		if (seg->duration > live->max_duration) live->max_duration = seg->duration;
+		live->nb_segments++;
+		gf_list_add(live->segments, seg);
+	}
+	/*the file index is not needed once the segments are written*/
+	gf_isom_box_del((GF_Box *)live->ts_seg.sidx);
+	live->ts_seg.sidx = NULL;
+	if (live->ts_seg.pcrb) gf_isom_box_del((GF_Box *)live->ts_seg.pcrb);
+	live->ts_seg.pcrb = NULL;
+
+	/*remove the segments out of the time shift buffer*/
+	while (live->time_shift_depth && (gf_list_count(live->segments)>1)) {
+		char szName[GF_MAX_PATH];
+		GF_DASHTSLiveSegment *seg = (GF_DASHTSLiveSegment *)gf_list_get(live->segments, 0);
+		if (seg->start + seg->duration + (u64) live->time_shift_depth * 90000 >= live->next_start) break;
+		gf_list_rem(live->segments, 0);
+		gf_media_mpd_format_segment_name(GF_DASH_TEMPLATE_SEGMENT, GF_TRUE, szName, live->mpd_name, "1", NULL, live->seg_rad_name, "ts", 0, 0, seg->number, GF_FALSE);
+		gf_delete_file(szName);
+		gf_free(seg);
+	}
+
+	if (dash_ts_live_write_mpd(live, is_last) != GF_OK)
+		live->last_error = GF_IO_ERR;
+}
+
+static void dash_ts_live_on_packets(GF_M2TS_Demuxer *ts, const char *data, u32 nb_pck, u32 pck_size)
+{
+	GF_DASHTSLive *live = (GF_DASHTSLive *)ts->user;
+	u32 i, size = nb_pck*188;
+
+	/*segmentation stopped on error*/
+	if (live->last_error) return;
+
+	/*the packets before the first PAT are dropped*/
+	if (!live->started) {
+		live->buffer_size = 0;
+		live->buffer_offset = (u64) ts->pck_number*188;
+	}
+	if (live->buffer_size + size > DASH_TS_LIVE_MAX_BUFFER) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] No segment boundary found in the last %d bytes of TS, stopping segmentation\n", live->buffer_size));
+		live->last_error = GF_OUT_OF_MEM;
+		return;
+	}
+	if (live->buffer_size + size > live->buffer_alloc) {
+		char *buffer;
+		u32 alloc = 2*(live->buffer_size + size);
+		if (alloc > DASH_TS_LIVE_MAX_BUFFER) alloc = DASH_TS_LIVE_MAX_BUFFER;
+		buffer = (char *)gf_realloc(live->buffer, sizeof(char)*alloc);
+		if (!buffer) {
+			live->last_error = GF_OUT_OF_MEM;
+			return;
+		}
+		live->buffer = buffer;
+		live->buffer_alloc = alloc;
+	}
+	/*segment offsets are counted in 188-byte packets, the M2TS timecode prefix is not kept*/
+	if (pck_size==188) {
+		memcpy(live->buffer + live->buffer_size, data, size);
+	} else {
+		for (i=0; i<nb_pck; i++)
+			memcpy(live->buffer + live->buffer_size + i*188, data + i*pck_size, 188);
+	}
+	live->buffer_size += size;
+}
+
+static void dash_ts_live_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
+{
+	GF_M2TS_IndexEntry entry;
+	GF_DASHTSLive *live = (GF_DASHTSLive *)ts->user;
+
+	switch (evt_type) {
+	case GF_M2TS_EVT_PAT_FOUND:
+		if (!live->started) {
+			u64 pat_offset = (u64) (ts->pck_number-1)*188;
+			u32 skip = (u32) (pat_offset - live->buffer_offset);
+			live->buffer_size -= skip;
+			if (live->buffer_size) memmove(live->buffer, live->buffer + skip, sizeof(char)*live->buffer_size);
+			live->buffer_offset = pat_offset;
+			live->ts_seg.base_offset = pat_offset;
+			live->started = GF_TRUE;
+			gf_utc_time_since_1970(&live->ast_sec, &live->ast_msec);
+		}
+		break;
+	case GF_M2TS_EVT_PMT_FOUND:
+		dash_ts_live_add_components(live, (GF_M2TS_Program *)par);
+		break;
+	case GF_M2TS_EVT_PES_PCK:
+		dash_ts_live_set_codec(live, ((GF_M2TS_PES_PCK *)par)->stream, ((GF_M2TS_PES_PCK *)par)->data, ((GF_M2TS_PES_PCK *)par)->data_len);
+		break;
+	}
+	if (!live->started || live->last_error) return;
+
+	if (gf_m2ts_index_get_event_entry(ts, evt_type, par, &entry))
+		dash_m2ts_process_entry(&live->ts_seg, &entry);
+	if (live->ts_seg.sidx)
+		dash_ts_live_write_segments(live, GF_FALSE);
+}
+
+GF_EXPORT
+GF_DASHTSLive *gf_dasher_ts_live_new(const char *mpd_name, const char *seg_rad_name, Double segment_duration, Bool segments_start_with_rap, u32 time_shift_depth)
+{
+	GF_DASHTSLive *live;
+	if (!mpd_name || (segment_duration<=0)) return NULL;
+
+	GF_SAFEALLOC(live, GF_DASHTSLive);
+	if (!live) return NULL;
+	live->mpd_name = gf_strdup(mpd_name);
+	if (seg_rad_name) {
+		live->seg_rad_name = gf_strdup(seg_rad_name);
+	} else {
+		char *sep;
+		live->seg_rad_name = (char *)gf_malloc(sizeof(char) * (strlen(mpd_name) + 10));
+		strcpy(live->seg_rad_name, mpd_name);
+		sep = strrchr(live->seg_rad_name, '.');
+		if (sep && !strchr(sep, '/') && !strchr(sep, '\\')) sep[0] = 0;
+		strcat(live->seg_rad_name, "_$Number$");
+	}
+	live->time_shift_depth = time_shift_depth;
+	live->segments = gf_list_new();
+	live->next_number = 1;
+
+	live->ts_seg.segment_duration = segment_duration;
+	live->ts_seg.segment_at_rap = segments_start_with_rap;
+	live->ts_seg.PCR_DTS_initial_diff = (u64) -1;
+
+	live->ts_seg.ts = gf_m2ts_demux_new();
+	live->ts_seg.ts->on_event = dash_ts_live_event;
+	live->ts_seg.ts->on_packets = dash_ts_live_on_packets;
+	live->ts_seg.ts->notify_pes_timing = GF_TRUE;
+	live->ts_seg.ts->user = live;
+	return live;
+}
+
+GF_EXPORT
+GF_Err gf_dasher_ts_live_start(GF_DASHTSLive *live, const char *url)
+{
+	GF_Err e;
+	if (!live || !url || live->url_started) return GF_BAD_PARAM;
+	live->ts_seg.ts->th = gf_th_new("DASH TS Live");
+	e = gf_m2ts_demuxer_setup(live->ts_seg.ts, url, GF_FALSE);
+	if (e) return e;
+	live->url_started = GF_TRUE;
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_dasher_ts_live_process(GF_DASHTSLive *live, char *data, u32 size)
+{
+	if (!live || live->url_started) return GF_BAD_PARAM;
+	gf_m2ts_process_data(live->ts_seg.ts, data, size);
+	return live->last_error;
+}
+
+GF_EXPORT
+GF_Err gf_dasher_ts_live_get_status(GF_DASHTSLive *live, u32 *nb_segments, Bool *is_over)
+{
+	if (!live) return GF_BAD_PARAM;
+	if (nb_segments) *nb_segments = live->nb_segments;
+	if (is_over) *is_over = (live->url_started && (live->ts_seg.ts->run_state==2)) ? GF_TRUE : GF_FALSE;
+	return live->last_error;
+}
+
+GF_EXPORT
+void gf_dasher_ts_live_del(GF_DASHTSLive *live)
+{
+	if (!live) return;
+	if (live->url_started) gf_m2ts_demuxer_close(live->ts_seg.ts);
+
+	/*write the pending data as the last segment*/
+	if (live->started && live->buffer_size) {
+		m2ts_sidx_flush_entry(&live->ts_seg);
+		if (live->ts_seg.sidx) {
+			m2ts_sidx_finalize_size(&live->ts_seg, live->buffer_offset + live->buffer_size);
+			dash_ts_live_write_segments(live, GF_TRUE);
+		}
+	} else if (live->nb_segments) {
+		dash_ts_live_write_mpd(live, GF_TRUE);
+	}
+
+	while (gf_list_count(live->segments)) {
+		GF_DASHTSLiveSegment *seg = (GF_DASHTSLiveSegment *)gf_list_last(live->segments);
+		gf_list_rem_last(live->segments);
+		gf_free(seg);
+	}
+	gf_list_del(live->segments);
+	if (live->ts_seg.sidx) gf_isom_box_del((GF_Box *)live->ts_seg.sidx);
+	if (live->ts_seg.pcrb) gf_isom_box_del((GF_Box *)live->ts_seg.pcrb);
+	gf_m2ts_demux_del(live->ts_seg.ts);
+	if (live->buffer) gf_free(live->buffer);
+	gf_free(live->mpd_name);
+	gf_free(live->seg_rad_name);
+	gf_free(live);
+}
+
 #endif //GPAC_DISABLE_MPEG2TS
 
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
@@ -4650,18 +5133,6 @@ static GF_Err gf_dash_segmenter_probe_input(GF_DashSegInput **io_dash_inputs, u3
 	return GF_NOT_SUPPORTED;
 }
 
-static void format_duration(FILE *mpd, Double dur, const char *name)
-{
-	Double s;
-	u32 h, m;
-
-	h = (u32) (dur/3600);
-	m = (u32) (dur/60 - h*60);
-	s = (dur - h*3600 - m*60);
-	fprintf(mpd, " %s=\"PT%dH%dM%.3fS\"", name, h, m, s);
-
-}
-
 static GF_Err write_mpd_header(GF_DASHSegmenter *dasher, FILE *mpd, Bool is_mpeg2, Double mpd_duration, Bool use_cenc, Bool use_xlink)
 {
 	u32 sec, frac;
@@ -5335,6 +5806,9 @@ void gf_dasher_clean_inputs(GF_DASHSegmenter *dasher)
 			//we don't want to save any modif due to duration adjustments
 			gf_isom_delete(dasher->inputs[i].isobmf_input);
 		}
+#ifndef GPAC_DISABLE_MPEG2TS
+		if (dasher->inputs[i].ts_index) gf_m2ts_index_del(dasher->inputs[i].ts_index);
+#endif
 	}
 	gf_free(dasher->inputs);
 	dasher->inputs = NULL;
@@ -5552,6 +6026,14 @@ GF_Err gf_dasher_enable_real_time(GF_DASHSegmenter *dasher, Bool real_time)
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_dasher_enable_ts_index_write(GF_DASHSegmenter *dasher, Bool write_index)
+{
+	if (!dasher) return GF_BAD_PARAM;
+	dasher->ts_index_write = write_index;
+	return GF_OK;
+}
+
 GF_EXPORT
 
 GF_Err gf_dasher_set_content_protection_location_mode(GF_DASHSegmenter *dasher, GF_DASH_ContentLocationMode mode)
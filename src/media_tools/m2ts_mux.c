@@ -31,6 +31,11 @@
 
 /*90khz internal delay between two updates for bitrate compute per stream */
 #define BITRATE_UPDATE_WINDOW	90000
+
+/*max number of AUs queued per stream by program input threads*/
+#define M2TS_MAX_PREFETCH_PCK	32
+/*number of packets in the stream fifo*/
+#define M2TS_STREAM_QUEUE_LENGTH(_stream)	((_stream)->nb_pck_dispatched - (_stream)->nb_pck_consumed)
 /* length of adaptation_field_length; */
 #define ADAPTATION_LENGTH_LENGTH 1
 /* discontinuty flag, random access flag ... */
@@ -981,6 +986,72 @@ static Bool gf_m2ts_adjust_next_stream_time_for_pcr(GF_M2TS_Mux *muxer, GF_M2TS_
 	return 1;
 }
 
+static u32 gf_m2ts_stream_get_dispatched(GF_M2TS_Mux_Stream *stream)
+{
+	u32 nb_dispatched;
+	gf_mx_p(stream->mx);
+	nb_dispatched = stream->nb_pck_dispatched;
+	gf_mx_v(stream->mx);
+	return nb_dispatched;
+}
+
+/*flushes the input of the stream. With program input threads, the input is flushed ahead of time by the program thread,
+we wait until it has produced as many AUs as the flushes requested by the muxer, so that the multiplex does not depend on the thread timing*/
+static void gf_m2ts_stream_fetch_input(GF_M2TS_Mux_Stream *stream)
+{
+	GF_M2TS_Mux_Program *program = stream->program;
+	if (!stream->ifce->input_ctrl) return;
+	if (!program->input_th) {
+		stream->ifce->input_ctrl(stream->ifce, GF_ESI_INPUT_DATA_FLUSH, NULL);
+		return;
+	}
+	gf_mx_p(program->input_mx);
+	stream->nb_pck_requested++;
+	/*the stalled state is only valid for the flushes done so far, wait for the thread to try again*/
+	stream->input_stalled = GF_FALSE;
+	gf_mx_v(program->input_mx);
+	gf_sema_notify(program->input_sema, 1);
+
+	/*live inputs may not have data yet, don't wait for them*/
+	if (program->mux->real_time) return;
+
+	while (1) {
+		Bool done = GF_FALSE;
+		gf_mx_p(program->input_mx);
+		if (gf_m2ts_stream_get_dispatched(stream) >= stream->nb_pck_requested) done = GF_TRUE;
+		else if (stream->ifce->caps & GF_ESI_STREAM_IS_OVER) done = GF_TRUE;
+		else if (stream->input_stalled) done = GF_TRUE;
+		else if (program->input_th_state != 1) done = GF_TRUE;
+		else program->input_wait = GF_TRUE;
+		gf_mx_v(program->input_mx);
+		if (done) break;
+		/*woken up by the input thread at the end of its next refill pass*/
+		gf_sema_wait(program->input_done_sema);
+	}
+}
+
+/*checks if nb_pck AUs are available in the stream fifo. With program input threads, only the AUs requested by the muxer are considered available*/
+static Bool gf_m2ts_stream_has_input(GF_M2TS_Mux_Stream *stream, u32 nb_pck)
+{
+	u32 queue_length;
+	if (stream->program->input_th && !stream->program->mux->real_time) {
+		if (stream->nb_pck_requested < stream->nb_pck_consumed + nb_pck) return GF_FALSE;
+	}
+	gf_mx_p(stream->mx);
+	queue_length = M2TS_STREAM_QUEUE_LENGTH(stream);
+	gf_mx_v(stream->mx);
+	return (queue_length >= nb_pck) ? GF_TRUE : GF_FALSE;
+}
+
+/*checks if the input is over - with program input threads, the input is only considered over once the muxer requested all its AUs*/
+static Bool gf_m2ts_stream_input_over(GF_M2TS_Mux_Stream *stream)
+{
+	if (!(stream->ifce->caps & GF_ESI_STREAM_IS_OVER)) return GF_FALSE;
+	if (stream->program->input_th && !stream->program->mux->real_time && (gf_m2ts_stream_get_dispatched(stream) > stream->nb_pck_requested))
+		return GF_FALSE;
+	return GF_TRUE;
+}
+
 static u32 gf_m2ts_stream_process_pes(GF_M2TS_Mux *muxer, GF_M2TS_Mux_Stream *stream)
 {
 	u64 time_inc;
@@ -1026,11 +1097,11 @@ static u32 gf_m2ts_stream_process_pes(GF_M2TS_Mux *muxer, GF_M2TS_Mux_Stream *st
 	} else {
 		GF_M2TS_Packet *curr_pck;
 
-		if (!stream->pck_first && (stream->ifce->caps & GF_ESI_STREAM_IS_OVER))
+		if (!gf_m2ts_stream_has_input(stream, 1) && gf_m2ts_stream_input_over(stream))
 			return ret;
 
 		/*flush input pipe*/
-		if (stream->ifce->input_ctrl) stream->ifce->input_ctrl(stream->ifce, GF_ESI_INPUT_DATA_FLUSH, NULL);
+		gf_m2ts_stream_fetch_input(stream);
 
 		gf_mx_p(stream->mx);
 
@@ -1054,7 +1125,11 @@ static u32 gf_m2ts_stream_process_pes(GF_M2TS_Mux *muxer, GF_M2TS_Mux_Stream *st
 
 		/*discard first packet*/
 		stream->pck_first = curr_pck->next;
+		stream->nb_pck_consumed++;
 		gf_free(curr_pck);
+		/*wake up the input thread once half of the fifo is consumed*/
+		if (stream->program->input_sema && (M2TS_STREAM_QUEUE_LENGTH(stream) == M2TS_MAX_PREFETCH_PCK/2))
+			gf_sema_notify(stream->program->input_sema, 1);
 		stream->discard_data = GF_TRUE;
 
 		gf_mx_v(stream->mx);
@@ -1340,15 +1415,15 @@ void gf_m2ts_stream_update_data_following(GF_M2TS_Mux_Stream *stream)
 		}
 	} else {
 		/*flush input*/
-		if (!stream->pck_first && stream->ifce->input_ctrl) stream->ifce->input_ctrl(stream->ifce, GF_ESI_INPUT_DATA_FLUSH, NULL);
-		if (stream->pck_first) {
+		if (!gf_m2ts_stream_has_input(stream, 1)) gf_m2ts_stream_fetch_input(stream);
+		if (gf_m2ts_stream_has_input(stream, 1)) {
 			stream->next_payload_size = stream->pck_first->data_len;
 			stream->next_pck_cts = stream->pck_first->cts;
 			stream->next_pck_dts = stream->pck_first->dts;
 			stream->next_pck_flags = stream->pck_first->flags;
 
-			if (!stream->pck_first->next && stream->ifce->input_ctrl) stream->ifce->input_ctrl(stream->ifce, GF_ESI_INPUT_DATA_FLUSH, NULL);
-			if (stream->pck_first->next) {
+			if (!gf_m2ts_stream_has_input(stream, 2)) gf_m2ts_stream_fetch_input(stream);
+			if (gf_m2ts_stream_has_input(stream, 2)) {
 				stream->next_next_payload_size = stream->pck_first->next->data_len;
 			}
 
@@ -1463,7 +1538,7 @@ Bool gf_m2ts_stream_compute_pes_length(GF_M2TS_Mux_Stream *stream, u32 payload_l
 			return GF_FALSE;
 		}
 
-		if (stream->ifce->caps & GF_ESI_STREAM_IS_OVER) {
+		if (gf_m2ts_stream_input_over(stream)) {
 #if 0
 			while (stream->copy_from_next_packets > stream->next_payload_size) {
 				if (stream->copy_from_next_packets < 184) {
@@ -1933,6 +2008,7 @@ GF_Err gf_m2ts_output_ctrl(GF_ESInterface *_self, u32 ctrl_type, void *param)
 					stream->pck_last->next = stream->pck_reassembler;
 					stream->pck_last = stream->pck_reassembler;
 				}
+				stream->nb_pck_dispatched++;
 				gf_mx_v(stream->mx);
 				stream->pck_reassembler = NULL;
 			}
@@ -1964,6 +2040,7 @@ GF_Err gf_m2ts_output_ctrl(GF_ESInterface *_self, u32 ctrl_type, void *param)
 				stream->pck_last->next = stream->pck_reassembler;
 				stream->pck_last = stream->pck_reassembler;
 			}
+			stream->nb_pck_dispatched++;
 			gf_mx_v(stream->mx);
 			stream->pck_reassembler = NULL;
 		}
@@ -2395,8 +2472,28 @@ void gf_m2ts_mux_stream_del(GF_M2TS_Mux_Stream *st)
 	gf_free(st);
 }
 
+static void gf_m2ts_program_stop_input_thread(GF_M2TS_Mux_Program *prog)
+{
+	if (!prog->input_th) return;
+	gf_mx_p(prog->input_mx);
+	if (prog->input_th_state == 1) prog->input_th_state = 0;
+	gf_mx_v(prog->input_mx);
+	gf_sema_notify(prog->input_sema, 1);
+	/*waits for the thread to exit*/
+	gf_th_stop(prog->input_th);
+	gf_th_del(prog->input_th);
+	prog->input_th = NULL;
+	gf_sema_del(prog->input_sema);
+	prog->input_sema = NULL;
+	gf_sema_del(prog->input_done_sema);
+	prog->input_done_sema = NULL;
+	gf_mx_del(prog->input_mx);
+	prog->input_mx = NULL;
+}
+
 void gf_m2ts_mux_program_del(GF_M2TS_Mux_Program *prog)
 {
+	gf_m2ts_program_stop_input_thread(prog);
 	while (prog->streams) {
 		GF_M2TS_Mux_Stream *st = prog->streams->next;
 		gf_m2ts_mux_stream_del(prog->streams);
@@ -2420,6 +2517,12 @@ void gf_m2ts_mux_program_del(GF_M2TS_Mux_Program *prog)
 GF_EXPORT
 void gf_m2ts_mux_del(GF_M2TS_Mux *mux)
 {
+	GF_M2TS_Mux_Program *prog = mux->programs;
+	/*stop all input threads before destroying any stream*/
+	while (prog) {
+		gf_m2ts_program_stop_input_thread(prog);
+		prog = prog->next;
+	}
 	while (mux->programs) {
 		GF_M2TS_Mux_Program *p = mux->programs->next;
 		gf_m2ts_mux_program_del(mux->programs);
@@ -2519,8 +2622,81 @@ GF_Err gf_m2ts_mux_enable_pcr_only_packets(GF_M2TS_Mux *muxer, Bool enable_force
 }
 
 
+/*fetches one AU ahead on the stream if its fifo is not full - returns GF_TRUE if an AU was fetched*/
+static Bool gf_m2ts_stream_prefetch(GF_M2TS_Mux_Stream *stream)
+{
+	u32 queue_length, nb_dispatched;
+	Bool stalled;
+	if (!stream->ifce || !stream->ifce->input_ctrl) return GF_FALSE;
+	if (stream->ifce->caps & (GF_ESI_AU_PULL_CAP | GF_ESI_STREAM_IS_OVER)) return GF_FALSE;
+	gf_mx_p(stream->mx);
+	queue_length = M2TS_STREAM_QUEUE_LENGTH(stream);
+	nb_dispatched = stream->nb_pck_dispatched;
+	gf_mx_v(stream->mx);
+	if (queue_length >= M2TS_MAX_PREFETCH_PCK) return GF_FALSE;
+
+	stream->ifce->input_ctrl(stream->ifce, GF_ESI_INPUT_DATA_FLUSH, NULL);
+	stalled = (nb_dispatched == gf_m2ts_stream_get_dispatched(stream)) ? GF_TRUE : GF_FALSE;
+	gf_mx_p(stream->program->input_mx);
+	stream->input_stalled = stalled;
+	gf_mx_v(stream->program->input_mx);
+	return stalled ? GF_FALSE : GF_TRUE;
+}
+
+static u32 gf_m2ts_program_input_run(void *par)
+{
+	GF_M2TS_Mux_Program *program = (GF_M2TS_Mux_Program *)par;
+	while (1) {
+		Bool fetched = GF_FALSE;
+		GF_M2TS_Mux_Stream *stream;
+		gf_mx_p(program->input_mx);
+		if (program->input_th_state != 1) {
+			gf_mx_v(program->input_mx);
+			break;
+		}
+		gf_mx_v(program->input_mx);
+
+		stream = program->streams;
+		while (stream) {
+			if (gf_m2ts_stream_prefetch(stream)) fetched = GF_TRUE;
+			stream = stream->next;
+		}
+		/*wake up the muxer if it waits for data*/
+		gf_mx_p(program->input_mx);
+		if (program->input_wait) {
+			program->input_wait = GF_FALSE;
+			gf_sema_notify(program->input_done_sema, 1);
+		}
+		gf_mx_v(program->input_mx);
+		/*all fifos are full or inputs are stalled, wait for the muxer to consume data*/
+		if (!fetched) gf_sema_wait(program->input_sema);
+	}
+	gf_mx_p(program->input_mx);
+	program->input_th_state = 2;
+	if (program->input_wait) {
+		program->input_wait = GF_FALSE;
+		gf_sema_notify(program->input_done_sema, 1);
+	}
+	gf_mx_v(program->input_mx);
+	return 0;
+}
+
 GF_EXPORT
-const char *gf_m2ts_mux_process(GF_M2TS_Mux *muxer, u32 *status, u32 *usec_till_next)
+GF_Err gf_m2ts_mux_enable_program_threads(GF_M2TS_Mux *muxer, Bool enable)
+{
+	if (!muxer) return GF_BAD_PARAM;
+	muxer->program_threads = enable;
+	if (!enable) {
+		GF_M2TS_Mux_Program *program = muxer->programs;
+		while (program) {
+			gf_m2ts_program_stop_input_thread(program);
+			program = program->next;
+		}
+	}
+	return GF_OK;
+}
+
+static const char *gf_m2ts_mux_process_internal(GF_M2TS_Mux *muxer, u32 *status, u32 *usec_till_next, char *dst_pck)
 {
 	GF_M2TS_Mux_Program *program;
 	GF_M2TS_Mux_Stream *stream, *stream_to_process;
@@ -2535,6 +2711,33 @@ const char *gf_m2ts_mux_process(GF_M2TS_Mux *muxer, u32 *status, u32 *usec_till_
 	nb_streams = nb_streams_done = 0;
 	*status = GF_M2TS_STATE_IDLE;
 
+	if (muxer->program_threads) {
+		program = muxer->programs;
+		while (program) {
+			if (!program->input_th) {
+				program->input_th = gf_th_new("M2TS program input");
+				program->input_sema = gf_sema_new(M2TS_MAX_PREFETCH_PCK, 0);
+				program->input_done_sema = gf_sema_new(M2TS_MAX_PREFETCH_PCK, 0);
+				program->input_mx = gf_mx_new("M2TS program input");
+				program->input_th_state = 1;
+				if (gf_th_run(program->input_th, gf_m2ts_program_input_run, program) != GF_OK) {
+					GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS Muxer] Cannot start input thread for program %d\n", program->number));
+					gf_th_del(program->input_th);
+					program->input_th = NULL;
+					gf_sema_del(program->input_sema);
+					program->input_sema = NULL;
+					gf_sema_del(program->input_done_sema);
+					program->input_done_sema = NULL;
+					gf_mx_del(program->input_mx);
+					program->input_mx = NULL;
+					muxer->program_threads = GF_FALSE;
+					break;
+				}
+			}
+			program = program->next;
+		}
+	}
+
 	now_us = gf_sys_clock_high_res();
 	if (muxer->real_time) {
 		if (!muxer->init_sys_time) {
@@ -2683,7 +2886,7 @@ const char *gf_m2ts_mux_process(GF_M2TS_Mux *muxer, u32 *status, u32 *usec_till_
 				res = stream->process(muxer, stream);
 				/*next is rap on this stream, check flushing of other pes (we could use a goto)*/
 				if (!flush_all_pes && muxer->force_pat)
-					return gf_m2ts_mux_process(muxer, status, usec_till_next);
+					return gf_m2ts_mux_process_internal(muxer, status, usec_till_next, dst_pck);
 
 				if (res) {
 					/*always schedule the earliest data*/
@@ -2711,7 +2914,7 @@ const char *gf_m2ts_mux_process(GF_M2TS_Mux *muxer, u32 *status, u32 *usec_till_
 				}
 			}
 			nb_streams++;
-			if ((stream->ifce->caps & GF_ESI_STREAM_IS_OVER) && (!res || stream->refresh_rate_ms) )
+			if (stream->ifce && gf_m2ts_stream_input_over(stream) && (!res || stream->refresh_rate_ms) )
 				nb_streams_done ++;
 
 			stream = stream->next;
@@ -2737,12 +2940,12 @@ send_pck:
 	} else {
 
 		if (stream_to_process->tables) {
-			gf_m2ts_mux_table_get_next_packet(stream_to_process, muxer->dst_pck);
+			gf_m2ts_mux_table_get_next_packet(stream_to_process, dst_pck);
 		} else {
-			gf_m2ts_mux_pes_get_next_packet(stream_to_process, muxer->dst_pck);
+			gf_m2ts_mux_pes_get_next_packet(stream_to_process, dst_pck);
 		}
 
-		ret = muxer->dst_pck;
+		ret = dst_pck;
 		*status = GF_M2TS_STATE_DATA;
 
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG2-TS Muxer] Sending %s from PID %d at %d:%09d - mux time %d:%09d\n", stream_to_process->tables ? "table" : "PES", stream_to_process->pid, time.sec, time.nanosec, muxer->time.sec, muxer->time.nanosec));
@@ -2782,5 +2985,27 @@ send_pck:
 	return ret;
 }
 
+GF_EXPORT
+const char *gf_m2ts_mux_process(GF_M2TS_Mux *muxer, u32 *status, u32 *usec_till_next)
+{
+	return gf_m2ts_mux_process_internal(muxer, status, usec_till_next, muxer->dst_pck);
+}
+
+GF_EXPORT
+u32 gf_m2ts_mux_process_packets(GF_M2TS_Mux *muxer, char *packets, u32 nb_packets, u32 *status, u32 *usec_till_next)
+{
+	u32 nb_pck = 0;
+	*status = GF_M2TS_STATE_IDLE;
+	while (nb_pck < nb_packets) {
+		char *dst = packets + 188*nb_pck;
+		const char *pck = gf_m2ts_mux_process_internal(muxer, status, usec_till_next, dst);
+		if (!pck) break;
+		/*padding packet*/
+		if (pck != dst) memcpy(dst, pck, 188);
+		nb_pck++;
+	}
+	return nb_pck;
+}
+
 #endif /*GPAC_DISABLE_MPEG2TS_MUX*/
 
@@ -732,6 +732,7 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 	GF_M4ADecSpecInfo a_cfg;
 	const char *stxtcfg;
 	GF_BitStream *bs;
+	GF_ISOSample *samp;
 	u32 track, i, di, count, m_type, m_stype, dsi_size, qcp_type;
 	Bool is_ogg, has_qcp_pad, is_vobsub;
 	u32 aac_type, aac_mode;
@@ -1246,7 +1247,6 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 	qcp_rates = NULL;
 	rt_cnt = 0;
 	if (qcp_type) {
-		GF_ISOSample *samp;
 		Bool needs_rate_octet;
 		u32 tot_size, data_size, sample_size, avg_rate, agg_samp;
 		u32 block_size = 160;
@@ -1338,12 +1338,10 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 	}
 
 	/* Start exporting samples */
+	samp = gf_isom_sample_new();
 	for (i=0; i<count; i++) {
-		GF_ISOSample *samp = gf_isom_get_sample(dumper->file, track, i+1, &di);
-		if (!samp) {
-			e = gf_isom_last_error(dumper->file);
-			break;
-		}
+		e = gf_isom_get_sample_static(dumper->file, track, i+1, &di, samp);
+		if (e) break;
 		/*AVC sample to NALU*/
 		if (avccfg || svccfg || hevccfg || shvccfg) {
 			u32 j, nal_size, remain, nal_unit_size;
@@ -1404,10 +1402,10 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 		if (!avccfg && !svccfg && !hevccfg && !shvccfg &!is_webvtt) {
 			gf_bs_write_data(bs, samp->data, samp->dataLength);
 		}
-		gf_isom_sample_del(&samp);
 		gf_set_progress("Media Export", i+1, count);
 		if (dumper->flags & GF_EXPORT_DO_ABORT) break;
 	}
+	gf_isom_sample_del(&samp);
 	if (has_qcp_pad) gf_bs_write_u8(bs, 0);
 exit:
 	if (avccfg) gf_odf_avc_cfg_del(avccfg);
@@ -1606,6 +1604,7 @@ GF_Err gf_media_export_nhnt(GF_MediaExporter *dumper)
 	char szName[1000];
 	FILE *out_med, *out_inf, *out_nhnt;
 	GF_BitStream *bs;
+	GF_ISOSample *samp;
 	Bool has_b_frames;
 	u32 track, i, di, count, pos;
 
@@ -1672,9 +1671,9 @@ GF_Err gf_media_export_nhnt(GF_MediaExporter *dumper)
 
 	pos = 0;
 	count = gf_isom_get_sample_count(dumper->file, track);
+	samp = gf_isom_sample_new();
 	for (i=0; i<count; i++) {
-		GF_ISOSample *samp = gf_isom_get_sample(dumper->file, track, i+1, &di);
-		if (!samp) break;
+		if (gf_isom_get_sample_static(dumper->file, track, i+1, &di, samp)) break;
 		gf_fwrite(samp->data, samp->dataLength, 1, out_med);
 
 		/*dump nhnt info*/
@@ -1700,10 +1699,10 @@ GF_Err gf_media_export_nhnt(GF_MediaExporter *dumper)
 		gf_bs_write_u32(bs, (u32) samp->DTS);
 
 		pos += samp->dataLength;
-		gf_isom_sample_del(&samp);
 		gf_set_progress("NHNT Export", i+1, count);
 		if (dumper->flags & GF_EXPORT_DO_ABORT) break;
 	}
+	gf_isom_sample_del(&samp);
 	gf_fclose(out_med);
 	gf_bs_del(bs);
 	gf_fclose(out_nhnt);
@@ -1776,8 +1775,9 @@ static GF_Err MP4T_CopyTrack(GF_MediaExporter *dumper, GF_ISOFile *infile, u32 i
 	rate = 0;
 	ts = gf_isom_get_media_timescale(infile, inTrackNum);
 	count = gf_isom_get_sample_count(infile, inTrackNum);
+	samp = gf_isom_sample_new();
 	for (i=0; i<count; i++) {
-		samp = gf_isom_get_sample(infile, inTrackNum, i+1, &di);
+		if (gf_isom_get_sample_static(infile, inTrackNum, i+1, &di, samp)) break;
 		gf_isom_add_sample(outfile, newTk, descIndex, samp);
 		if (esd) {
 			rate += samp->dataLength;
@@ -1789,9 +1789,9 @@ static GF_Err MP4T_CopyTrack(GF_MediaExporter *dumper, GF_ISOFile *infile, u32 i
 				pos = 0;
 			}
 		}
-		gf_isom_sample_del(&samp);
 		gf_set_progress("ISO File Export", i, count);
 	}
+	gf_isom_sample_del(&samp);
 	gf_set_progress("ISO File Export", count, count);
 
 	if (msubtype == GF_ISOM_SUBTYPE_MPEG4_CRYP) {
@@ -43,6 +43,8 @@
 
 #ifndef GPAC_DISABLE_MEDIA_IMPORT
 
+/*read-ahead cache for elementary stream files parsed through a bitstream object*/
+#define IMPORT_READ_BUFFER_SIZE	65536
 
 GF_Err gf_import_message(GF_MediaImporter *import, GF_Err e, char *format, ...)
 {
@@ -4662,6 +4664,7 @@ restart_import:
 	sei_recovery_frame_count = -1;
 
 	bs = gf_bs_from_file(mdia, GF_BITSTREAM_READ);
+	gf_bs_set_input_buffering(bs, IMPORT_READ_BUFFER_SIZE);
 	if (!gf_media_nalu_is_start_code(bs)) {
 		e = gf_import_message(import, GF_NON_COMPLIANT_BITSTREAM, "Cannot find H264 start code");
 		goto exit;
@@ -5674,6 +5677,7 @@ restart_import:
 	nb_nalus = 0;
 
 	bs = gf_bs_from_file(mdia, GF_BITSTREAM_READ);
+	gf_bs_set_input_buffering(bs, IMPORT_READ_BUFFER_SIZE);
 	if (!gf_media_nalu_is_start_code(bs)) {
 		e = gf_import_message(import, GF_NON_COMPLIANT_BITSTREAM, "Cannot find HEVC start code");
 		goto exit;
@@ -7325,6 +7329,8 @@ GF_Err gf_import_saf(GF_MediaImporter *import)
 #endif
 }
 
+#ifndef GPAC_DISABLE_MPEG2TS
+
 typedef struct
 {
 	GF_MediaImporter *import;
@@ -7346,10 +7352,15 @@ typedef struct
 	u32 nb_video, nb_video_configured;
 	u32 nb_audio, nb_audio_configured;
 
+	/*import of all PIDs in one pass (trackID 0): one GF_TSImport per PID, stored in the PES user field*/
+	GF_List *pids;
+	GF_M2TS_PES *pes;
+	/*sample being assembled for the PID*/
+	GF_ISOSample *au;
+	u32 au_alloc, au_nb_i, au_nb_p, au_nb_b;
+	u32 vid_w, vid_h;
 } GF_TSImport;
 
-#ifndef GPAC_DISABLE_MPEG2TS
-
 /* Determine the ESD corresponding to the current track info based on the PID and sets the additional info
    in the track info as described in this esd */
 static void m2ts_set_track_mpeg4_probe_info(GF_M2TS_ES *es, GF_ESD *esd,
@@ -7465,6 +7476,70 @@ static void m2ts_set_track_mpeg4_creation_info(GF_MediaImporter *import, u32 *mt
 
 }
 
+/*media, stream and object types of a PES stream - allocates the AVC/HEVC config of the importer if needed*/
+static void m2ts_import_get_stream_type(GF_TSImport *tsimp, GF_M2TS_ES *es, u32 *mtype, u32 *stype, u32 *oti)
+{
+	switch (es->stream_type) {
+	case GF_M2TS_VIDEO_MPEG1:
+		*mtype = GF_ISOM_MEDIA_VISUAL;
+		*stype = GF_STREAM_VISUAL;
+		*oti = GPAC_OTI_VIDEO_MPEG1;
+		break;
+	case GF_M2TS_VIDEO_MPEG2:
+		*mtype = GF_ISOM_MEDIA_VISUAL;
+		*stype = GF_STREAM_VISUAL;
+		*oti = GPAC_OTI_VIDEO_MPEG2_422;
+		break;
+	case GF_M2TS_VIDEO_MPEG4:
+		*mtype = GF_ISOM_MEDIA_VISUAL;
+		*stype = GF_STREAM_VISUAL;
+		*oti = GPAC_OTI_VIDEO_MPEG4_PART2;
+		break;
+	case GF_M2TS_VIDEO_H264:
+		*mtype = GF_ISOM_MEDIA_VISUAL;
+		*stype = GF_STREAM_VISUAL;
+		*oti = GPAC_OTI_VIDEO_AVC;
+		tsimp->avccfg = gf_odf_avc_cfg_new();
+		break;
+	case GF_M2TS_VIDEO_HEVC:
+	case GF_M2TS_VIDEO_SHVC:
+		*mtype = GF_ISOM_MEDIA_VISUAL;
+		*stype = GF_STREAM_VISUAL;
+		*oti = GPAC_OTI_VIDEO_HEVC;
+#ifndef GPAC_DISABLE_HEVC
+		tsimp->hevccfg = gf_odf_hevc_cfg_new();
+#endif //GPAC_DISABLE_HEVC
+		break;
+	case GF_M2TS_VIDEO_SVC:
+		*mtype = GF_ISOM_MEDIA_VISUAL;
+		*stype = GF_STREAM_VISUAL;
+		*oti = GPAC_OTI_VIDEO_SVC;
+		tsimp->avccfg = gf_odf_avc_cfg_new();
+		break;
+	case GF_M2TS_AUDIO_MPEG1:
+		*mtype = GF_ISOM_MEDIA_AUDIO;
+		*stype = GF_STREAM_AUDIO;
+		*oti = GPAC_OTI_AUDIO_MPEG1;
+		break;
+	case GF_M2TS_AUDIO_MPEG2:
+		*mtype = GF_ISOM_MEDIA_AUDIO;
+		*stype = GF_STREAM_AUDIO;
+		*oti = GPAC_OTI_AUDIO_MPEG2_PART3;
+		break;
+	case GF_M2TS_AUDIO_LATM_AAC:
+	case GF_M2TS_AUDIO_AAC:
+		*mtype = GF_ISOM_MEDIA_AUDIO;
+		*stype = GF_STREAM_AUDIO;
+		*oti = GPAC_OTI_AUDIO_AAC_MPEG4;
+		break;
+	case GF_M2TS_AUDIO_AC3:
+		*mtype = GF_ISOM_MEDIA_AUDIO;
+		*stype = GF_STREAM_AUDIO;
+		*oti = GPAC_OTI_AUDIO_AC3;
+		break;
+	}
+}
+
 static void m2ts_create_track(GF_TSImport *tsimp, u32 mtype, u32 stype, u32 oti, u32 mpeg4_es_id, Bool is_in_iod)
 {
 	GF_MediaImporter *import= (GF_MediaImporter *)tsimp->import;
@@ -7509,33 +7584,43 @@ static void m2ts_create_track(GF_TSImport *tsimp, u32 mtype, u32 stype, u32 oti,
 	}
 }
 
+/*rewrites the 4-byte start codes of an AVC/HEVC sample in Annex-B format to 4-byte NALU sizes, in place*/
+static void m2ts_rewrite_nalu_data(char *data, u32 size)
+{
+	u32 sc_pos, start;
+	if (size<4) return;
+	sc_pos = 1;
+	start = 0;
+	while (sc_pos+4 <= size) {
+		if (!data[sc_pos] && !data[sc_pos+1] && !data[sc_pos+2] && (data[sc_pos+3]==1)) {
+			u32 nal_size = sc_pos-start-4;
+			data[start] = (nal_size>>24) & 0xFF;
+			data[start+1] = (nal_size>>16) & 0xFF;
+			data[start+2] = (nal_size>>8) & 0xFF;
+			data[start+3] = nal_size & 0xFF;
+			start = sc_pos;
+			sc_pos += 4;
+		} else {
+			sc_pos++;
+		}
+	}
+	size -= start+4;
+	data[start] = (size>>24) & 0xFF;
+	data[start+1] = (size>>16) & 0xFF;
+	data[start+2] = (size>>8) & 0xFF;
+	data[start+3] = size & 0xFF;
+}
+
 /*rewrite last AVC sample currently stored in Annex-B format to ISO format (rewrite start code)*/
 void m2ts_rewrite_nalu_sample(GF_MediaImporter *import, GF_TSImport *tsimp)
 {
 	GF_Err e;
-	u32 sc_pos, start;
-	GF_BitStream *bs;
 	GF_ISOSample *samp;
 	u32 count = gf_isom_get_sample_count(import->dest, tsimp->track);
 	if (!count) return;
 
 	samp = gf_isom_get_sample(import->dest, tsimp->track, count, NULL);
-	sc_pos = 1;
-	start = 0;
-	bs = gf_bs_new(samp->data, samp->dataLength, GF_BITSTREAM_WRITE);
-	while (1) {
-		if (!samp->data[sc_pos] && !samp->data[sc_pos+1] && !samp->data[sc_pos+2] && (samp->data[sc_pos+3]==1)) {
-			gf_bs_seek(bs, start);
-			gf_bs_write_u32(bs, (u32) sc_pos-start-4);
-			start = sc_pos;
-		}
-		sc_pos++;
-		if (start+sc_pos>=samp->dataLength) break;
-	}
-	gf_bs_seek(bs, start);
-	gf_bs_write_u32(bs, samp->dataLength-start-4);
-
-	gf_bs_del(bs);
+	m2ts_rewrite_nalu_data(samp->data, samp->dataLength);
 
 	e = gf_isom_update_sample(import->dest, tsimp->track, count, samp, GF_TRUE);
 	if (e) {
@@ -7582,6 +7667,394 @@ static void hevc_cfg_add_nalu(GF_MediaImporter *import, GF_HEVCConfig *hevccfg,
 }
 #endif //GPAC_DISABLE_HEVC
 
+/*updates the AVC/HEVC config of the PID with the parameter sets carried in the NALU (data starts with a start code) and
+detects access unit starts signaled by NALU types - returns GF_FALSE if the NALU is not part of the samples*/
+static Bool m2ts_import_check_nalu(GF_TSImport *tsimp, char *data, u32 data_len, u32 *vid_w, u32 *vid_h, Bool *is_au_start)
+{
+	GF_MediaImporter *import = tsimp->import;
+
+	/*avc data for the current sample is stored in annex-B, as we don't know the size of each nal
+	when called back (depending on PES packetization, the end of the nal could be in following pes)*/
+	if (tsimp->avccfg && !data[0] && !data[1]) {
+		GF_AVCConfigSlot *slc;
+		s32 idx;
+		Bool add_sps, is_subseq = GF_FALSE;
+		u32 nal_type = data[4] & 0x1F;
+
+		switch (nal_type) {
+		case GF_AVC_NALU_SVC_SUBSEQ_PARAM:
+			is_subseq = GF_TRUE;
+		case GF_AVC_NALU_SEQ_PARAM:
+			idx = gf_media_avc_read_sps(data+4, data_len-4, &tsimp->avc, is_subseq, NULL);
+
+			add_sps = GF_FALSE;
+			if (idx>=0) {
+				if (is_subseq) {
+					if ((tsimp->avc.sps[idx].state & AVC_SUBSPS_PARSED) && !(tsimp->avc.sps[idx].state & AVC_SUBSPS_DECLARED)) {
+						tsimp->avc.sps[idx].state |= AVC_SUBSPS_DECLARED;
+						add_sps = GF_TRUE;
+					}
+				} else {
+					if ((tsimp->avc.sps[idx].state & AVC_SPS_PARSED) && !(tsimp->avc.sps[idx].state & AVC_SPS_DECLARED)) {
+						tsimp->avc.sps[idx].state |= AVC_SPS_DECLARED;
+						add_sps = GF_TRUE;
+					}
+				}
+				if (add_sps) {
+					/*always store nalu size on 4 bytes*/
+					tsimp->avccfg->nal_unit_size = 4;
+					tsimp->avccfg->configurationVersion = 1;
+					tsimp->avccfg->profile_compatibility = tsimp->avc.sps[idx].prof_compat;
+					tsimp->avccfg->AVCProfileIndication = tsimp->avc.sps[idx].profile_idc;
+					tsimp->avccfg->AVCLevelIndication = tsimp->avc.sps[idx].level_idc;
+
+					if (*vid_w < tsimp->avc.sps[idx].width)
+						*vid_w = tsimp->avc.sps[idx].width;
+					if (*vid_h < tsimp->avc.sps[idx].height)
+						*vid_h = tsimp->avc.sps[idx].height;
+
+					if (!(import->flags & GF_IMPORT_FORCE_XPS_INBAND)) {
+						slc = (GF_AVCConfigSlot*)gf_malloc(sizeof(GF_AVCConfigSlot));
+						slc->size = data_len-4;
+						slc->data = (char*)gf_malloc(sizeof(char)*slc->size);
+						memcpy(slc->data, data+4, sizeof(char)*slc->size);
+						gf_list_add(tsimp->avccfg->sequenceParameterSets, slc);
+					}
+				}
+			}
+			if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
+				break;
+			}
+			return GF_FALSE;
+		case GF_AVC_NALU_PIC_PARAM:
+			idx = gf_media_avc_read_pps(data+4, data_len-4, &tsimp->avc);
+			if ((idx>=0) && (tsimp->avc.pps[idx].status==1)) {
+				tsimp->avc.pps[idx].status = 2;
+				if (!(import->flags & GF_IMPORT_FORCE_XPS_INBAND)) {
+					slc = (GF_AVCConfigSlot*)gf_malloc(sizeof(GF_AVCConfigSlot));
+					slc->size = data_len-4;
+					slc->data = (char*)gf_malloc(sizeof(char)*slc->size);
+					memcpy(slc->data, data+4, sizeof(char)*slc->size);
+					gf_list_add(tsimp->avccfg->pictureParameterSets, slc);
+				}
+			}
+			if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
+				break;
+			}
+			/*else discard because of invalid PPS*/
+			return GF_FALSE;
+		/*remove*/
+		case GF_AVC_NALU_ACCESS_UNIT:
+			tsimp->force_next_au_start = GF_TRUE;
+			return GF_FALSE;
+		case GF_AVC_NALU_FILLER_DATA:
+		case GF_AVC_NALU_END_OF_SEQ:
+		case GF_AVC_NALU_END_OF_STREAM:
+			return GF_FALSE;
+		case GF_AVC_NALU_SEI:
+			break;
+
+		}
+
+		if (tsimp->force_next_au_start) {
+			*is_au_start = GF_TRUE;
+			tsimp->force_next_au_start = GF_FALSE;
+		}
+	}
+
+	/*avc data for the current sample is stored in annex-B, as we don't know the size of each nal
+	when called back (depending on PES packetization, the end of the nal could be in following pes)*/
+#ifndef GPAC_DISABLE_HEVC
+	else if (tsimp->hevccfg && !data[0] && !data[1]) {
+		s32 idx;
+		Bool add_sps, is_subseq = GF_FALSE;
+		u32 nal_type = (data[4] & 0x7E) >> 1;
+
+		switch (nal_type) {
+		case GF_HEVC_NALU_SEQ_PARAM:
+			idx = gf_media_hevc_read_sps(data+4, data_len-4, &tsimp->hevc);
+			add_sps = GF_FALSE;
+			if (idx>=0) {
+				if (is_subseq) {
+					if ((tsimp->hevc.sps[idx].state & AVC_SUBSPS_PARSED) && !(tsimp->hevc.sps[idx].state & AVC_SUBSPS_DECLARED)) {
+						tsimp->hevc.sps[idx].state |= AVC_SUBSPS_DECLARED;
+						add_sps = GF_TRUE;
+					}
+				} else {
+					if ((tsimp->hevc.sps[idx].state & AVC_SPS_PARSED) && !(tsimp->hevc.sps[idx].state & AVC_SPS_DECLARED)) {
+						tsimp->hevc.sps[idx].state |= AVC_SPS_DECLARED;
+						add_sps = GF_TRUE;
+					}
+				}
+				if (add_sps) {
+					/*always store nalu size on 4 bytes*/
+					tsimp->hevccfg->nal_unit_size = 4;
+					tsimp->hevccfg->configurationVersion = 1;
+
+					tsimp->hevccfg->configurationVersion = 1;
+					tsimp->hevccfg->profile_space = tsimp->hevc.sps[idx].ptl.profile_space;
+					tsimp->hevccfg->profile_idc = tsimp->hevc.sps[idx].ptl.profile_idc;
+					tsimp->hevccfg->constraint_indicator_flags = 0;
+					tsimp->hevccfg->level_idc = tsimp->hevc.sps[idx].ptl.level_idc;
+					tsimp->hevccfg->general_profile_compatibility_flags = tsimp->hevc.sps[idx].ptl.profile_compatibility_flag;
+					tsimp->hevccfg->chromaFormat = tsimp->hevc.sps[idx].chroma_format_idc;
+					tsimp->hevccfg->luma_bit_depth = tsimp->hevc.sps[idx].bit_depth_luma;
+					tsimp->hevccfg->chroma_bit_depth = tsimp->hevc.sps[idx].bit_depth_chroma;
+
+					hevc_cfg_add_nalu(import, tsimp->hevccfg, nal_type, data+4, data_len-4);
+
+					if (*vid_w < tsimp->hevc.sps[idx].width)
+						*vid_w = tsimp->hevc.sps[idx].width;
+					if (*vid_h < tsimp->hevc.sps[idx].height)
+						*vid_h = tsimp->hevc.sps[idx].height;
+				}
+			}
+			if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
+				*is_au_start = GF_TRUE;
+				break;
+			}
+			return GF_FALSE;
+		case GF_HEVC_NALU_PIC_PARAM:
+			idx = gf_media_hevc_read_pps(data+4, data_len-4, &tsimp->hevc);
+			if ((idx>=0) && (tsimp->hevc.pps[idx].state==1)) {
+				tsimp->hevc.pps[idx].state = 2;
+				hevc_cfg_add_nalu(import, tsimp->hevccfg, nal_type, data+4, data_len-4);
+			}
+			if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
+				*is_au_start = GF_TRUE;
+				break;
+			}
+			return GF_FALSE;
+		case GF_HEVC_NALU_VID_PARAM:
+			idx = gf_media_hevc_read_vps(data+4, data_len-4, &tsimp->hevc);
+			if ((idx>=0) && (tsimp->hevc.vps[idx].state==1)) {
+				tsimp->hevc.vps[idx].state = 2;
+				tsimp->hevccfg->avgFrameRate = tsimp->hevc.vps[idx].rates[0].avg_pic_rate;
+				tsimp->hevccfg->constantFrameRate = tsimp->hevc.vps[idx].rates[0].constand_pic_rate_idc;
+				tsimp->hevccfg->numTemporalLayers = tsimp->hevc.vps[idx].max_sub_layers;
+				hevc_cfg_add_nalu(import, tsimp->hevccfg, nal_type, data+4, data_len-4);
+			}
+			if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
+				*is_au_start = GF_TRUE;
+				break;
+			}
+			return GF_FALSE;
+		/*remove*/
+		case GF_HEVC_NALU_ACCESS_UNIT:
+			tsimp->force_next_au_start = GF_TRUE;
+			return GF_FALSE;
+		case GF_HEVC_NALU_FILLER_DATA:
+		case GF_HEVC_NALU_END_OF_SEQ:
+		case GF_HEVC_NALU_END_OF_STREAM:
+			return GF_FALSE;
+		case GF_HEVC_NALU_SEI_PREFIX:
+			*is_au_start = GF_TRUE;
+			break;
+		}
+
+		if (tsimp->force_next_au_start) {
+			*is_au_start = GF_TRUE;
+			tsimp->force_next_au_start = GF_FALSE;
+		}
+	}
+#endif //GPAC_DISABLE_HEVC
+	return GF_TRUE;
+}
+
+/*import message and track setup on the first samples of a PID, and rebasing of the DTS of a new sample on the first DTS
+of the PID - returns GF_FALSE if the sample has a negative time and must be skipped*/
+static Bool m2ts_import_rebase_sample(GF_TSImport *tsimp, GF_M2TS_PES *stream, GF_ISOSample *samp)
+{
+	GF_MediaImporter *import = tsimp->import;
+	u64 DTS = samp->DTS;
+
+
+	if (stream->first_dts==DTS) {
+		switch (stream->stream_type) {
+		case GF_M2TS_VIDEO_MPEG1:
+			gf_import_message(import, GF_OK, "MPEG-1 Video import (TS PID %d)", stream->pid);
+			break;
+		case GF_M2TS_VIDEO_MPEG2:
+			gf_import_message(import, GF_OK, "MPEG-2 Video import (TS PID %d)", stream->pid);
+			break;
+		case GF_M2TS_VIDEO_MPEG4:
+			gf_import_message(import, GF_OK, "MPEG-4 Video import (TS PID %d)", stream->pid);
+			break;
+		case GF_M2TS_VIDEO_H264:
+			gf_import_message(import, GF_OK, "MPEG-4 AVC/H264 Video import (TS PID %d)", stream->pid);
+			break;
+		case GF_M2TS_VIDEO_HEVC:
+			gf_import_message(import, GF_OK, "MPEG-H HEVC Video import (TS PID %d)", stream->pid);
+			break;
+		case GF_M2TS_VIDEO_SVC:
+			gf_import_message(import, GF_OK, "H264-SVC Video import (TS PID %d)", stream->pid);
+			break;
+		case GF_M2TS_AUDIO_MPEG1:
+			gf_import_message(import, GF_OK, "MPEG-1 Audio import - SampleRate %d Channels %d Language %s (TS PID %d)", stream->aud_sr, stream->aud_nb_ch, gf_4cc_to_str(stream->lang), stream->pid);
+			break;
+		case GF_M2TS_AUDIO_MPEG2:
+			gf_import_message(import, GF_OK, "MPEG-2 Audio import - SampleRate %d Channels %d Language %s (TS PID %d)", stream->aud_sr, stream->aud_nb_ch, gf_4cc_to_str(stream->lang), stream->pid);
+			break;
+		case GF_M2TS_AUDIO_AAC:
+			gf_import_message(import, GF_OK, "MPEG-4 AAC Audio import - SampleRate %d Channels %d Language %s (TS PID %d)", stream->aud_sr, stream->aud_nb_ch, gf_4cc_to_str(stream->lang), stream->pid);
+			break;
+		case GF_M2TS_AUDIO_AC3:
+			gf_import_message(import, GF_OK, "Dolby AC3 Audio import - SampleRate %d Channels %d Language %s (TS PID %d)", stream->aud_sr, stream->aud_nb_ch, gf_4cc_to_str(stream->lang), stream->pid);
+			break;
+		case GF_M2TS_AUDIO_EC3:
+			gf_import_message(import, GF_OK, "Dolby E-AC3 Audio import - SampleRate %d Channels %d Language %s (TS PID %d)", stream->aud_sr, stream->aud_nb_ch, gf_4cc_to_str(stream->lang), stream->pid);
+			break;
+		}
+		if (stream->lang)
+			gf_isom_set_media_language(import->dest, tsimp->track, (char *) gf_4cc_to_str(stream->lang)+1);
+	}
+	if (!tsimp->stream_setup) {
+		if (stream->aud_sr) {
+			gf_isom_set_audio_info(import->dest, tsimp->track, 1, stream->aud_sr, stream->aud_nb_ch, 16);
+			tsimp->stream_setup = GF_TRUE;
+		}
+		else if (stream->vid_w) {
+			u32 w = stream->vid_w;
+			if (stream->vid_par) w = w * (stream->vid_par>>16) / (stream->vid_par&0xffff);
+			gf_isom_set_visual_info(import->dest, tsimp->track, 1, stream->vid_w, stream->vid_h);
+			gf_isom_set_track_layout_info(import->dest, tsimp->track, w<<16, stream->vid_h<<16, 0, 0, 0);
+			if (w != stream->vid_w)
+				gf_isom_set_pixel_aspect_ratio(import->dest, tsimp->track, 1, stream->vid_par>>16, stream->vid_par&0xff);
+
+			tsimp->stream_setup = GF_TRUE;
+		}
+	}
+
+	if (DTS < stream->first_dts) {
+		u32 sample_num = gf_isom_get_sample_count(import->dest, tsimp->track);
+		u32 dur = gf_isom_get_sample_duration(import->dest, tsimp->track, sample_num);
+
+		stream->first_dts = DTS - (tsimp->last_dts + 1 + dur);
+		stream->program->first_dts = stream->first_dts;
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS Import] negative time sample - PCR loop/discontinuity, adjusting\n"));
+	}
+	if (DTS < stream->first_dts) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS Import] negative time sample - skipping\n"));
+		return GF_FALSE;
+	}
+	samp->DTS = DTS - stream->first_dts;
+	return GF_TRUE;
+}
+
+/*ends the sample assembled for the PID and adds it to the file*/
+static void m2ts_import_pid_flush_au(GF_TSImport *tsimp)
+{
+	GF_Err e;
+	GF_MediaImporter *import = tsimp->import;
+	if (!tsimp->au) return;
+
+	if (tsimp->avccfg || tsimp->hevccfg) m2ts_rewrite_nalu_data(tsimp->au->data, tsimp->au->dataLength);
+
+	if (m2ts_import_rebase_sample(tsimp, tsimp->pes, tsimp->au)) {
+		e = gf_isom_add_sample(import->dest, tsimp->track, 1, tsimp->au);
+		if (e) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS Import] PID %d: Error adding sample: %s\n", tsimp->pes->pid, gf_error_to_string(e)));
+			import->last_error = e;
+		}
+		tsimp->nb_i += tsimp->au_nb_i;
+		tsimp->nb_p += tsimp->au_nb_p;
+		tsimp->nb_b += tsimp->au_nb_b;
+		tsimp->last_dts = tsimp->au->DTS + 1;
+	}
+	gf_isom_sample_del(&tsimp->au);
+	tsimp->au_alloc = tsimp->au_nb_i = tsimp->au_nb_p = tsimp->au_nb_b = 0;
+}
+
+/*same processing as the single PID import, except that samples are assembled in memory - called by the demuxer for each PES packet of an imported PID*/
+static void m2ts_import_pid_process(GF_TSImport *tsimp, GF_M2TS_PES_PCK *pck)
+{
+	Bool is_au_start = (pck->flags & GF_M2TS_PES_PCK_AU_START) ? GF_TRUE : GF_FALSE;
+
+	if (!m2ts_import_check_nalu(tsimp, pck->data, pck->data_len, &tsimp->vid_w, &tsimp->vid_h, &is_au_start))
+		return;
+
+	/*a new AU with the same DTS as the current one is appended to it*/
+	if (is_au_start && (!tsimp->au || (tsimp->au->DTS != pck->DTS))) {
+		m2ts_import_pid_flush_au(tsimp);
+		tsimp->au = gf_isom_sample_new();
+		tsimp->au->DTS = pck->DTS;
+		tsimp->au->CTS_Offset = (u32) (pck->PTS - pck->DTS);
+		tsimp->au->IsRAP = (pck->flags & GF_M2TS_PES_PCK_RAP) ? RAP : RAP_NO;
+	} else if (!tsimp->au) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS Import] missed beginning of sample data\n"));
+		return;
+	} else if (!is_au_start && (pck->flags & GF_M2TS_PES_PCK_RAP)) {
+		tsimp->au->IsRAP = RAP;
+	}
+
+	if (tsimp->au->dataLength + pck->data_len > tsimp->au_alloc) {
+		tsimp->au_alloc = MAX(tsimp->au->dataLength + pck->data_len, 3*tsimp->au_alloc/2);
+		tsimp->au->data = (char*)gf_realloc(tsimp->au->data, sizeof(char)*tsimp->au_alloc);
+	}
+	memcpy(tsimp->au->data + tsimp->au->dataLength, pck->data, sizeof(char)*pck->data_len);
+	tsimp->au->dataLength += pck->data_len;
+
+	if (pck->flags & GF_M2TS_PES_PCK_I_FRAME) tsimp->au_nb_i++;
+	if (pck->flags & GF_M2TS_PES_PCK_P_FRAME) tsimp->au_nb_p++;
+	if (pck->flags & GF_M2TS_PES_PCK_B_FRAME) tsimp->au_nb_b++;
+}
+
+/*creates the tracks of the PES streams of the program that can be imported*/
+static void m2ts_import_setup_pids(GF_TSImport *tsimp, GF_M2TS_Program *prog)
+{
+	u32 i, count;
+	count = gf_list_count(prog->streams);
+	for (i=0; i<count; i++) {
+		u32 mtype, stype, oti;
+		GF_TSImport *pid_imp;
+		GF_M2TS_ES *es = (GF_M2TS_ES *)gf_list_get(prog->streams, i);
+		if (es->flags & GF_M2TS_ES_IS_SECTION) continue;
+		if (es->user) continue;
+		/*RAW framing for the streams not imported, so that we get notified of the DTS/PTS*/
+		gf_m2ts_set_pes_framing((GF_M2TS_PES *)es, GF_M2TS_PES_FRAMING_RAW);
+
+		GF_SAFEALLOC(pid_imp, GF_TSImport);
+		pid_imp->import = tsimp->import;
+		pid_imp->avc.sps_active_idx = -1;
+		mtype = stype = oti = 0;
+		m2ts_import_get_stream_type(pid_imp, es, &mtype, &stype, &oti);
+		if (mtype) m2ts_create_track(pid_imp, mtype, stype, oti, es->mpeg4_es_id ? es->mpeg4_es_id : es->pid, GF_FALSE);
+		if (!pid_imp->track) {
+			if (pid_imp->avccfg) gf_odf_avc_cfg_del(pid_imp->avccfg);
+			if (pid_imp->hevccfg) gf_odf_hevc_cfg_del(pid_imp->hevccfg);
+			gf_free(pid_imp);
+			continue;
+		}
+		pid_imp->pes = (GF_M2TS_PES *)es;
+		es->user = pid_imp;
+		gf_list_add(tsimp->pids, pid_imp);
+		gf_m2ts_set_pes_framing(pid_imp->pes, GF_M2TS_PES_FRAMING_DEFAULT_NAL);
+	}
+}
+
+/*adds the last sample of each PID*/
+static void m2ts_import_stop_pids(GF_TSImport *tsimp)
+{
+	u32 i, count = gf_list_count(tsimp->pids);
+	for (i=0; i<count; i++) {
+		m2ts_import_pid_flush_au((GF_TSImport *)gf_list_get(tsimp->pids, i));
+	}
+}
+
+static void m2ts_import_del_pids(GF_TSImport *tsimp)
+{
+	while (gf_list_count(tsimp->pids)) {
+		GF_TSImport *pid_imp = (GF_TSImport *)gf_list_pop_back(tsimp->pids);
+		if (pid_imp->au) gf_isom_sample_del(&pid_imp->au);
+		if (pid_imp->avccfg) gf_odf_avc_cfg_del(pid_imp->avccfg);
+		if (pid_imp->hevccfg) gf_odf_hevc_cfg_del(pid_imp->hevccfg);
+		pid_imp->pes->user = NULL;
+		gf_free(pid_imp);
+	}
+	gf_list_del(tsimp->pids);
+	tsimp->pids = NULL;
+}
+
 void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 {
 	GF_Err e;
@@ -7760,6 +8233,8 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 					gf_import_message(import, GF_OK, "[MPEG-2 TS] Ignoring stream of type %d", es->stream_type);
 				}
 			}
+		} else if (tsimp->pids) {
+			m2ts_import_setup_pids(tsimp, prog);
 		} else {
 			/* We are not in PROBE mode, we are importing only one stream and don't care about the other streams */
 			u32 mtype, stype, oti;
@@ -7808,77 +8283,22 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 			mtype = stype = oti = 0;
 			is_in_iod = GF_FALSE;
 
-			switch (es->stream_type) {
-			case GF_M2TS_VIDEO_MPEG1:
-				mtype = GF_ISOM_MEDIA_VISUAL;
-				stype = GF_STREAM_VISUAL;
-				oti = GPAC_OTI_VIDEO_MPEG1;
-				break;
-			case GF_M2TS_VIDEO_MPEG2:
-				mtype = GF_ISOM_MEDIA_VISUAL;
-				stype = GF_STREAM_VISUAL;
-				oti = GPAC_OTI_VIDEO_MPEG2_422;
-				break;
-			case GF_M2TS_VIDEO_MPEG4:
-				mtype = GF_ISOM_MEDIA_VISUAL;
-				stype = GF_STREAM_VISUAL;
-				oti = GPAC_OTI_VIDEO_MPEG4_PART2;
-				break;
-			case GF_M2TS_VIDEO_H264:
-				mtype = GF_ISOM_MEDIA_VISUAL;
-				stype = GF_STREAM_VISUAL;
-				oti = GPAC_OTI_VIDEO_AVC;
-				tsimp->avccfg = gf_odf_avc_cfg_new();
-				break;
-			case GF_M2TS_VIDEO_HEVC:
-			case GF_M2TS_VIDEO_SHVC:
-				mtype = GF_ISOM_MEDIA_VISUAL;
-				stype = GF_STREAM_VISUAL;
-				oti = GPAC_OTI_VIDEO_HEVC;
-#ifndef GPAC_DISABLE_HEVC
-				tsimp->hevccfg = gf_odf_hevc_cfg_new();
-#endif //GPAC_DISABLE_HEVC
-				break;
-			case GF_M2TS_VIDEO_SVC:
-				mtype = GF_ISOM_MEDIA_VISUAL;
-				stype = GF_STREAM_VISUAL;
-				oti = GPAC_OTI_VIDEO_SVC;
-				tsimp->avccfg = gf_odf_avc_cfg_new();
-				break;
-			case GF_M2TS_AUDIO_MPEG1:
-				mtype = GF_ISOM_MEDIA_AUDIO;
-				stype = GF_STREAM_AUDIO;
-				oti = GPAC_OTI_AUDIO_MPEG1;
-				break;
-			case GF_M2TS_AUDIO_MPEG2:
-				mtype = GF_ISOM_MEDIA_AUDIO;
-				stype = GF_STREAM_AUDIO;
-				oti = GPAC_OTI_AUDIO_MPEG2_PART3;
-				break;
-			case GF_M2TS_AUDIO_LATM_AAC:
-			case GF_M2TS_AUDIO_AAC:
-				mtype = GF_ISOM_MEDIA_AUDIO;
-				stype = GF_STREAM_AUDIO;
-				oti = GPAC_OTI_AUDIO_AAC_MPEG4;
-				break;
-			case GF_M2TS_AUDIO_AC3:
-				mtype = GF_ISOM_MEDIA_AUDIO;
-				stype = GF_STREAM_AUDIO;
-				oti = GPAC_OTI_AUDIO_AC3;
-				break;
-			case GF_M2TS_SYSTEMS_MPEG4_PES:
-			case GF_M2TS_SYSTEMS_MPEG4_SECTIONS:
+			m2ts_import_get_stream_type(tsimp, es, &mtype, &stype, &oti);
+			if ((es->stream_type==GF_M2TS_SYSTEMS_MPEG4_PES) || (es->stream_type==GF_M2TS_SYSTEMS_MPEG4_SECTIONS)) {
 				if (prog->pmt_iod && !import->esd) {
 					import->esd = gf_m2ts_get_esd(es);
 					m2ts_set_track_mpeg4_creation_info(import, &mtype, &stype, &oti);
 					is_in_iod = GF_TRUE;
 				}
-				break;
 			}
 			m2ts_create_track(tsimp, mtype, stype, oti, es->mpeg4_es_id, is_in_iod);
 		}
 		break;
 	case GF_M2TS_EVT_AAC_CFG:
+		if (tsimp->pids) {
+			tsimp = (GF_TSImport *) ((GF_M2TS_PES_PCK*)par)->stream->user;
+			if (!tsimp) break;
+		}
 		if (!(import->flags & GF_IMPORT_PROBE_ONLY) && !tsimp->stream_setup) {
 			GF_ESD *esd = gf_isom_get_esd(import->dest, tsimp->track, 1);
 			if (esd) {
@@ -7964,198 +8384,19 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 			if (!pck->stream->program->first_dts || pck->stream->program->first_dts > pck->stream->first_dts) {
 				pck->stream->program->first_dts = 1 + pck->stream->first_dts;
 
-				if (pck->stream->pid != import->trackID) {
+				if (tsimp->pids ? !pck->stream->user : (pck->stream->pid != import->trackID)) {
 					gf_m2ts_set_pes_framing((GF_M2TS_PES *)pck->stream, GF_M2TS_PES_FRAMING_SKIP);
 				}
 			}
 		}
-		if (pck->stream->pid != import->trackID) return;
-
-		/*avc data for the current sample is stored in annex-B, as we don't know the size of each nal
-		when called back (depending on PES packetization, the end of the nal could be in following pes)*/
-		if (tsimp->avccfg && !pck->data[0] && !pck->data[1]) {
-			GF_AVCConfigSlot *slc;
-			s32 idx;
-			Bool add_sps, is_subseq = GF_FALSE;
-			u32 nal_type = pck->data[4] & 0x1F;
-
-			switch (nal_type) {
-			case GF_AVC_NALU_SVC_SUBSEQ_PARAM:
-				is_subseq = GF_TRUE;
-			case GF_AVC_NALU_SEQ_PARAM:
-				idx = gf_media_avc_read_sps(pck->data+4, pck->data_len-4, &tsimp->avc, is_subseq, NULL);
-
-				add_sps = GF_FALSE;
-				if (idx>=0) {
-					if (is_subseq) {
-						if ((tsimp->avc.sps[idx].state & AVC_SUBSPS_PARSED) && !(tsimp->avc.sps[idx].state & AVC_SUBSPS_DECLARED)) {
-							tsimp->avc.sps[idx].state |= AVC_SUBSPS_DECLARED;
-							add_sps = GF_TRUE;
-						}
-					} else {
-						if ((tsimp->avc.sps[idx].state & AVC_SPS_PARSED) && !(tsimp->avc.sps[idx].state & AVC_SPS_DECLARED)) {
-							tsimp->avc.sps[idx].state |= AVC_SPS_DECLARED;
-							add_sps = GF_TRUE;
-						}
-					}
-					if (add_sps) {
-						/*always store nalu size on 4 bytes*/
-						tsimp->avccfg->nal_unit_size = 4;
-						tsimp->avccfg->configurationVersion = 1;
-						tsimp->avccfg->profile_compatibility = tsimp->avc.sps[idx].prof_compat;
-						tsimp->avccfg->AVCProfileIndication = tsimp->avc.sps[idx].profile_idc;
-						tsimp->avccfg->AVCLevelIndication = tsimp->avc.sps[idx].level_idc;
-
-						if (pck->stream->vid_w < tsimp->avc.sps[idx].width)
-							pck->stream->vid_w = tsimp->avc.sps[idx].width;
-						if (pck->stream->vid_h < tsimp->avc.sps[idx].height)
-							pck->stream->vid_h = tsimp->avc.sps[idx].height;
-
-						if (!(import->flags & GF_IMPORT_FORCE_XPS_INBAND)) {
-							slc = (GF_AVCConfigSlot*)gf_malloc(sizeof(GF_AVCConfigSlot));
-							slc->size = pck->data_len-4;
-							slc->data = (char*)gf_malloc(sizeof(char)*slc->size);
-							memcpy(slc->data, pck->data+4, sizeof(char)*slc->size);
-							gf_list_add(tsimp->avccfg->sequenceParameterSets, slc);
-						}
-					}
-				}
-				if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
-					break;
-				}
-				return;
-			case GF_AVC_NALU_PIC_PARAM:
-				idx = gf_media_avc_read_pps(pck->data+4, pck->data_len-4, &tsimp->avc);
-				if ((idx>=0) && (tsimp->avc.pps[idx].status==1)) {
-					tsimp->avc.pps[idx].status = 2;
-					if (!(import->flags & GF_IMPORT_FORCE_XPS_INBAND)) {
-						slc = (GF_AVCConfigSlot*)gf_malloc(sizeof(GF_AVCConfigSlot));
-						slc->size = pck->data_len-4;
-						slc->data = (char*)gf_malloc(sizeof(char)*slc->size);
-						memcpy(slc->data, pck->data+4, sizeof(char)*slc->size);
-						gf_list_add(tsimp->avccfg->pictureParameterSets, slc);
-					}
-				}
-				if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
-					break;
-				}
-				/*else discard because of invalid PPS*/
-				return;
-			/*remove*/
-			case GF_AVC_NALU_ACCESS_UNIT:
-				tsimp->force_next_au_start = GF_TRUE;
-				return;
-			case GF_AVC_NALU_FILLER_DATA:
-			case GF_AVC_NALU_END_OF_SEQ:
-			case GF_AVC_NALU_END_OF_STREAM:
-				return;
-			case GF_AVC_NALU_SEI:
-				break;
-
-			}
-
-			if (tsimp->force_next_au_start) {
-				is_au_start = GF_TRUE;
-				tsimp->force_next_au_start = GF_FALSE;
-			}
+		if (tsimp->pids) {
+			if (pck->stream->user) m2ts_import_pid_process((GF_TSImport *) pck->stream->user, pck);
+			return;
 		}
+		if (pck->stream->pid != import->trackID) return;
 
-		/*avc data for the current sample is stored in annex-B, as we don't know the size of each nal
-		when called back (depending on PES packetization, the end of the nal could be in following pes)*/
-#ifndef GPAC_DISABLE_HEVC
-		else if (tsimp->hevccfg && !pck->data[0] && !pck->data[1]) {
-			s32 idx;
-			Bool add_sps, is_subseq = GF_FALSE;
-			u32 nal_type = (pck->data[4] & 0x7E) >> 1;
-
-			switch (nal_type) {
-			case GF_HEVC_NALU_SEQ_PARAM:
-				idx = gf_media_hevc_read_sps(pck->data+4, pck->data_len-4, &tsimp->hevc);
-				add_sps = GF_FALSE;
-				if (idx>=0) {
-					if (is_subseq) {
-						if ((tsimp->hevc.sps[idx].state & AVC_SUBSPS_PARSED) && !(tsimp->hevc.sps[idx].state & AVC_SUBSPS_DECLARED)) {
-							tsimp->hevc.sps[idx].state |= AVC_SUBSPS_DECLARED;
-							add_sps = GF_TRUE;
-						}
-					} else {
-						if ((tsimp->hevc.sps[idx].state & AVC_SPS_PARSED) && !(tsimp->hevc.sps[idx].state & AVC_SPS_DECLARED)) {
-							tsimp->hevc.sps[idx].state |= AVC_SPS_DECLARED;
-							add_sps = GF_TRUE;
-						}
-					}
-					if (add_sps) {
-						/*always store nalu size on 4 bytes*/
-						tsimp->hevccfg->nal_unit_size = 4;
-						tsimp->hevccfg->configurationVersion = 1;
-
-						tsimp->hevccfg->configurationVersion = 1;
-						tsimp->hevccfg->profile_space = tsimp->hevc.sps[idx].ptl.profile_space;
-						tsimp->hevccfg->profile_idc = tsimp->hevc.sps[idx].ptl.profile_idc;
-						tsimp->hevccfg->constraint_indicator_flags = 0;
-						tsimp->hevccfg->level_idc = tsimp->hevc.sps[idx].ptl.level_idc;
-						tsimp->hevccfg->general_profile_compatibility_flags = tsimp->hevc.sps[idx].ptl.profile_compatibility_flag;
-						tsimp->hevccfg->chromaFormat = tsimp->hevc.sps[idx].chroma_format_idc;
-						tsimp->hevccfg->luma_bit_depth = tsimp->hevc.sps[idx].bit_depth_luma;
-						tsimp->hevccfg->chroma_bit_depth = tsimp->hevc.sps[idx].bit_depth_chroma;
-
-						hevc_cfg_add_nalu(import, tsimp->hevccfg, nal_type, pck->data+4, pck->data_len-4);
-
-						if (pck->stream->vid_w < tsimp->avc.sps[idx].width)
-							pck->stream->vid_w = tsimp->avc.sps[idx].width;
-						if (pck->stream->vid_h < tsimp->avc.sps[idx].height)
-							pck->stream->vid_h = tsimp->avc.sps[idx].height;
-					}
-				}
-				if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
-					is_au_start = GF_TRUE;
-					break;
-				}
-				return;
-			case GF_HEVC_NALU_PIC_PARAM:
-				idx = gf_media_hevc_read_pps(pck->data+4, pck->data_len-4, &tsimp->hevc);
-				if ((idx>=0) && (tsimp->hevc.pps[idx].state==1)) {
-					tsimp->hevc.pps[idx].state = 2;
-					hevc_cfg_add_nalu(import, tsimp->hevccfg, nal_type, pck->data+4, pck->data_len-4);
-				}
-				if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
-					is_au_start = GF_TRUE;
-					break;
-				}
-				return;
-			case GF_HEVC_NALU_VID_PARAM:
-				idx = gf_media_hevc_read_vps(pck->data+4, pck->data_len-4, &tsimp->hevc);
-				if ((idx>=0) && (tsimp->hevc.vps[idx].state==1)) {
-					tsimp->hevc.vps[idx].state = 2;
-					tsimp->hevccfg->avgFrameRate = tsimp->hevc.vps[idx].rates[0].avg_pic_rate;
-					tsimp->hevccfg->constantFrameRate = tsimp->hevc.vps[idx].rates[0].constand_pic_rate_idc;
-					tsimp->hevccfg->numTemporalLayers = tsimp->hevc.vps[idx].max_sub_layers;
-					hevc_cfg_add_nalu(import, tsimp->hevccfg, nal_type, pck->data+4, pck->data_len-4);
-				}
-				if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
-					is_au_start = GF_TRUE;
-					break;
-				}
-				return;
-			/*remove*/
-			case GF_HEVC_NALU_ACCESS_UNIT:
-				tsimp->force_next_au_start = GF_TRUE;
-				return;
-			case GF_HEVC_NALU_FILLER_DATA:
-			case GF_HEVC_NALU_END_OF_SEQ:
-			case GF_HEVC_NALU_END_OF_STREAM:
-				return;
-			case GF_HEVC_NALU_SEI_PREFIX:
-				is_au_start = GF_TRUE;
-				break;
-			}
-
-			if (tsimp->force_next_au_start) {
-				is_au_start = GF_TRUE;
-				tsimp->force_next_au_start = GF_FALSE;
-			}
-		}
-#endif //GPAC_DISABLE_HEVC
+		if (!m2ts_import_check_nalu(tsimp, pck->data, pck->data_len, &pck->stream->vid_w, &pck->stream->vid_h, &is_au_start))
+			return;
 
 		if (!is_au_start) {
 			e = gf_isom_append_sample_data(import->dest, tsimp->track, (char*)pck->data, pck->data_len);
@@ -8180,73 +8421,7 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 		samp = gf_isom_sample_new();
 		samp->DTS = pck->DTS;
 		samp->CTS_Offset = (u32) (pck->PTS - samp->DTS);
-
-		if (pck->stream->first_dts==samp->DTS) {
-			switch (pck->stream->stream_type) {
-			case GF_M2TS_VIDEO_MPEG1:
-				gf_import_message(import, GF_OK, "MPEG-1 Video import (TS PID %d)", pck->stream->pid);
-				break;
-			case GF_M2TS_VIDEO_MPEG2:
-				gf_import_message(import, GF_OK, "MPEG-2 Video import (TS PID %d)", pck->stream->pid);
-				break;
-			case GF_M2TS_VIDEO_MPEG4:
-				gf_import_message(import, GF_OK, "MPEG-4 Video import (TS PID %d)", pck->stream->pid);
-				break;
-			case GF_M2TS_VIDEO_H264:
-				gf_import_message(import, GF_OK, "MPEG-4 AVC/H264 Video import (TS PID %d)", pck->stream->pid);
-				break;
-			case GF_M2TS_VIDEO_HEVC:
-				gf_import_message(import, GF_OK, "MPEG-H HEVC Video import (TS PID %d)", pck->stream->pid);
-				break;
-			case GF_M2TS_VIDEO_SVC:
-				gf_import_message(import, GF_OK, "H264-SVC Video import (TS PID %d)", pck->stream->pid);
-				break;
-			case GF_M2TS_AUDIO_MPEG1:
-				gf_import_message(import, GF_OK, "MPEG-1 Audio import - SampleRate %d Channels %d Language %s (TS PID %d)", pck->stream->aud_sr, pck->stream->aud_nb_ch, gf_4cc_to_str(pck->stream->lang), pck->stream->pid);
-				break;
-			case GF_M2TS_AUDIO_MPEG2:
-				gf_import_message(import, GF_OK, "MPEG-2 Audio import - SampleRate %d Channels %d Language %s (TS PID %d)", pck->stream->aud_sr, pck->stream->aud_nb_ch, gf_4cc_to_str(pck->stream->lang), pck->stream->pid);
-				break;
-			case GF_M2TS_AUDIO_AAC:
-				gf_import_message(import, GF_OK, "MPEG-4 AAC Audio import - SampleRate %d Channels %d Language %s (TS PID %d)", pck->stream->aud_sr, pck->stream->aud_nb_ch, gf_4cc_to_str(pck->stream->lang), pck->stream->pid);
-				break;
-			case GF_M2TS_AUDIO_AC3:
-				gf_import_message(import, GF_OK, "Dolby AC3 Audio import - SampleRate %d Channels %d Language %s (TS PID %d)", pck->stream->aud_sr, pck->stream->aud_nb_ch, gf_4cc_to_str(pck->stream->lang), pck->stream->pid);
-				break;
-			case GF_M2TS_AUDIO_EC3:
-				gf_import_message(import, GF_OK, "Dolby E-AC3 Audio import - SampleRate %d Channels %d Language %s (TS PID %d)", pck->stream->aud_sr, pck->stream->aud_nb_ch, gf_4cc_to_str(pck->stream->lang), pck->stream->pid);
-				break;
-			}
-			if (pck->stream->lang)
-				gf_isom_set_media_language(import->dest, tsimp->track, (char *) gf_4cc_to_str(pck->stream->lang)+1);
-		}
-		if (!tsimp->stream_setup) {
-			if (pck->stream->aud_sr) {
-				gf_isom_set_audio_info(import->dest, tsimp->track, 1, pck->stream->aud_sr, pck->stream->aud_nb_ch, 16);
-				tsimp->stream_setup = GF_TRUE;
-			}
-			else if (pck->stream->vid_w) {
-				u32 w = pck->stream->vid_w;
-				if (pck->stream->vid_par) w = w * (pck->stream->vid_par>>16) / (pck->stream->vid_par&0xffff);
-				gf_isom_set_visual_info(import->dest, tsimp->track, 1, pck->stream->vid_w, pck->stream->vid_h);
-				gf_isom_set_track_layout_info(import->dest, tsimp->track, w<<16, pck->stream->vid_h<<16, 0, 0, 0);
-				if (w != pck->stream->vid_w)
-					e = gf_isom_set_pixel_aspect_ratio(import->dest, tsimp->track, 1, pck->stream->vid_par>>16, pck->stream->vid_par&0xff);
-
-				tsimp->stream_setup = GF_TRUE;
-			}
-		}
-
-		if (samp->DTS < pck->stream->first_dts) {
-			u32 sample_num = gf_isom_get_sample_count(import->dest, tsimp->track);
-			u32 dur = gf_isom_get_sample_duration(import->dest, tsimp->track, sample_num);
-
-			pck->stream->first_dts = samp->DTS - (tsimp->last_dts + 1 + dur);
-			pck->stream->program->first_dts = pck->stream->first_dts;
-			GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS Import] negative time sample - PCR loop/discontinuity, adjusting\n"));
-		}
-		if (samp->DTS >= pck->stream->first_dts) {
-			samp->DTS -= pck->stream->first_dts;
+		if (m2ts_import_rebase_sample(tsimp, pck->stream, samp)) {
 			samp->IsRAP = (pck->flags & GF_M2TS_PES_PCK_RAP) ? RAP : RAP_NO;
 			samp->data = pck->data;
 			samp->dataLength = pck->data_len;
@@ -8272,8 +8447,6 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 			if (pck->flags & GF_M2TS_PES_PCK_P_FRAME) tsimp->nb_p++;
 			if (pck->flags & GF_M2TS_PES_PCK_B_FRAME) tsimp->nb_b++;
 			tsimp->last_dts = samp->DTS + 1;
-		} else {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS Import] negative time sample - skipping\n"));
 		}
 		samp->data = NULL;
 		gf_isom_sample_del(&samp);
@@ -8427,6 +8600,82 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 	}
 }
 
+/*sets the decoder config, bitrate and edit list of the imported track once the whole file is processed*/
+static void m2ts_import_finalize_track(GF_TSImport *tsimp, GF_M2TS_ES *es)
+{
+	GF_MediaImporter *import = tsimp->import;
+
+	if (tsimp->avccfg) {
+		u32 w = ((GF_M2TS_PES*)es)->vid_w;
+		u32 h = ((GF_M2TS_PES*)es)->vid_h;
+		gf_isom_avc_config_update(import->dest, tsimp->track, 1, tsimp->avccfg);
+
+		if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
+			gf_isom_avc_set_inband_config(import->dest, tsimp->track, 1);
+		}
+
+		gf_isom_set_visual_info(import->dest, tsimp->track, 1, w, h);
+		gf_isom_set_track_layout_info(import->dest, tsimp->track, w<<16, h<<16, 0, 0, 0);
+
+
+		/*in one pass import, samples are rewritten by the PID worker*/
+		if (!tsimp->pes) m2ts_rewrite_nalu_sample(import, tsimp);
+
+		gf_odf_avc_cfg_del(tsimp->avccfg);
+		tsimp->avccfg = NULL;
+	}
+
+	if (tsimp->hevccfg) {
+		u32 w = ((GF_M2TS_PES*)es)->vid_w;
+		u32 h = ((GF_M2TS_PES*)es)->vid_h;
+		hevc_set_parall_type(tsimp->hevccfg);
+		gf_isom_hevc_config_update(import->dest, tsimp->track, 1, tsimp->hevccfg);
+
+		if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
+			gf_isom_hevc_set_inband_config(import->dest, tsimp->track, 1);
+		}
+
+		gf_isom_set_visual_info(import->dest, tsimp->track, 1, w, h);
+		gf_isom_set_track_layout_info(import->dest, tsimp->track, w<<16, h<<16, 0, 0, 0);
+
+		if (!tsimp->pes) m2ts_rewrite_nalu_sample(import, tsimp);
+
+		gf_odf_hevc_cfg_del(tsimp->hevccfg);
+		tsimp->hevccfg = NULL;
+	}
+
+
+	if (tsimp->track) {
+		gf_media_update_bitrate(import->dest, tsimp->track);
+		/* creation of the edit lists */
+		if ((es->first_dts != es->program->first_dts) && gf_isom_get_sample_count(import->dest, tsimp->track) ) {
+			u32 media_ts, moov_ts, offset;
+			u64 dur;
+			Double pdur, poffset;
+			media_ts = gf_isom_get_media_timescale(import->dest, tsimp->track);
+			moov_ts = gf_isom_get_timescale(import->dest);
+			assert(es->program->first_dts - 1 <= es->first_dts);
+			poffset = (es->first_dts - (es->program->first_dts - 1) ) * 1.0 * moov_ts / media_ts;
+			offset = (u32)poffset;
+			pdur = gf_isom_get_media_duration(import->dest, tsimp->track) * 1.0 * moov_ts / media_ts;
+			dur = (u64)pdur;
+			if (poffset != offset || pdur != dur) {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_AUTHOR, ("Movie timescale (%u) not precise enough to store edit (media timescale: %u)\n", moov_ts, media_ts));
+			}
+			gf_isom_set_edit_segment(import->dest, tsimp->track, 0, offset, 0, GF_ISOM_EDIT_EMPTY);
+			gf_isom_set_edit_segment(import->dest, tsimp->track, offset, dur, 0, GF_ISOM_EDIT_NORMAL);
+			gf_import_message(import, GF_OK, "Timeline offset: %u ms", (offset * 1000) / moov_ts);
+		}
+
+		if (tsimp->nb_p) {
+			gf_import_message(import, GF_OK, "Import results: %d VOPs (%d Is - %d Ps - %d Bs)", gf_isom_get_sample_count(import->dest, tsimp->track), tsimp->nb_i, tsimp->nb_p, tsimp->nb_b);
+		}
+
+		if (es->program->pmt_iod)
+			gf_isom_set_brand_info(import->dest, GF_ISOM_BRAND_MP42, 1);
+	}
+}
+
 extern void gf_m2ts_flush_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes);
 
 /* Warning: we start importing only after finding the PMT */
@@ -8464,8 +8713,11 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 	ts->dvb_h_demux = (import->flags & GF_IMPORT_MPE_DEMUX) ? GF_TRUE : GF_FALSE;
 
 	if (import->flags & GF_IMPORT_PROBE_ONLY) do_import = GF_FALSE;
+	/*all PIDs imported in one pass*/
+	else if (!import->trackID) tsimp.pids = gf_list_new();
 
-	sprintf(progress, "Importing MPEG-2 TS (PID %d)", import->trackID);
+	if (tsimp.pids) sprintf(progress, "Importing MPEG-2 TS (all PIDs)");
+	else sprintf(progress, "Importing MPEG-2 TS (PID %d)", import->trackID);
 	if (do_import) gf_import_message(import, GF_OK, progress);
 
 	while (!feof(mts)) {
@@ -8484,6 +8736,10 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 	if (import->last_error) {
 		GF_Err e = import->last_error;
 		import->last_error = GF_OK;
+		if (tsimp.pids) {
+			m2ts_import_stop_pids(&tsimp);
+			m2ts_import_del_pids(&tsimp);
+		}
 		if (tsimp.avccfg) gf_odf_avc_cfg_del(tsimp.avccfg);
 		if (tsimp.hevccfg) gf_odf_hevc_cfg_del(tsimp.hevccfg);
 		gf_m2ts_demux_del(ts);
@@ -8499,6 +8755,7 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 			}
 		}
 	}
+	if (tsimp.pids) m2ts_import_stop_pids(&tsimp);
 
 	import->esd = NULL;
 	if (do_import) gf_set_progress(progress, (u32) (fsize/1024), (u32) (fsize/1024));
@@ -8507,6 +8764,22 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 		gf_m2ts_print_info(ts);
 	}
 
+	if (tsimp.pids) {
+		GF_Err e = import->last_error;
+		import->last_error = GF_OK;
+		if (!gf_list_count(tsimp.pids)) e = gf_import_message(import, GF_NOT_SUPPORTED, "No PID to import found");
+		for (i=0; i<gf_list_count(tsimp.pids); i++) {
+			GF_TSImport *pid_imp = (GF_TSImport *)gf_list_get(tsimp.pids, i);
+			if (pid_imp->pes->vid_w < pid_imp->vid_w) pid_imp->pes->vid_w = pid_imp->vid_w;
+			if (pid_imp->pes->vid_h < pid_imp->vid_h) pid_imp->pes->vid_h = pid_imp->vid_h;
+			m2ts_import_finalize_track(pid_imp, (GF_M2TS_ES *) pid_imp->pes);
+		}
+		m2ts_import_del_pids(&tsimp);
+		gf_m2ts_demux_del(ts);
+		gf_fclose(mts);
+		return e;
+	}
+
 	if (!(import->flags & GF_IMPORT_PROBE_ONLY)) {
 		es = (GF_M2TS_ES *)ts->ess[import->trackID];
 		if (!es) {
@@ -8515,72 +8788,7 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 			return gf_import_message(import, GF_BAD_PARAM, "Unknown PID %d", import->trackID);
 		}
 
-		if (tsimp.avccfg) {
-			u32 w = ((GF_M2TS_PES*)es)->vid_w;
-			u32 h = ((GF_M2TS_PES*)es)->vid_h;
-			gf_isom_avc_config_update(import->dest, tsimp.track, 1, tsimp.avccfg);
-
-			if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
-				gf_isom_avc_set_inband_config(import->dest, tsimp.track, 1);
-			}
-
-			gf_isom_set_visual_info(import->dest, tsimp.track, 1, w, h);
-			gf_isom_set_track_layout_info(import->dest, tsimp.track, w<<16, h<<16, 0, 0, 0);
-
-
-			m2ts_rewrite_nalu_sample(import, &tsimp);
-
-			gf_odf_avc_cfg_del(tsimp.avccfg);
-		}
-
-		if (tsimp.hevccfg) {
-			u32 w = ((GF_M2TS_PES*)es)->vid_w;
-			u32 h = ((GF_M2TS_PES*)es)->vid_h;
-			hevc_set_parall_type(tsimp.hevccfg);
-			gf_isom_hevc_config_update(import->dest, tsimp.track, 1, tsimp.hevccfg);
-
-			if (import->flags & GF_IMPORT_FORCE_XPS_INBAND) {
-				gf_isom_hevc_set_inband_config(import->dest, tsimp.track, 1);
-			}
-
-			gf_isom_set_visual_info(import->dest, tsimp.track, 1, w, h);
-			gf_isom_set_track_layout_info(import->dest, tsimp.track, w<<16, h<<16, 0, 0, 0);
-
-			m2ts_rewrite_nalu_sample(import, &tsimp);
-
-			gf_odf_hevc_cfg_del(tsimp.hevccfg);
-		}
-
-
-		if (tsimp.track) {
-			gf_media_update_bitrate(import->dest, tsimp.track);
-			/* creation of the edit lists */
-			if ((es->first_dts != es->program->first_dts) && gf_isom_get_sample_count(import->dest, tsimp.track) ) {
-				u32 media_ts, moov_ts, offset;
-				u64 dur;
-				Double pdur, poffset;
-				media_ts = gf_isom_get_media_timescale(import->dest, tsimp.track);
-				moov_ts = gf_isom_get_timescale(import->dest);
-				assert(es->program->first_dts - 1 <= es->first_dts);
-				poffset = (es->first_dts - (es->program->first_dts - 1) ) * 1.0 * moov_ts / media_ts;
-				offset = (u32)poffset;
-				pdur = gf_isom_get_media_duration(import->dest, tsimp.track) * 1.0 * moov_ts / media_ts;
-				dur = (u64)pdur;
-				if (poffset != offset || pdur != dur) {
-					GF_LOG(GF_LOG_WARNING, GF_LOG_AUTHOR, ("Movie timescale (%u) not precise enough to store edit (media timescale: %u)\n", moov_ts, media_ts));
-				}
-				gf_isom_set_edit_segment(import->dest, tsimp.track, 0, offset, 0, GF_ISOM_EDIT_EMPTY);
-				gf_isom_set_edit_segment(import->dest, tsimp.track, offset, dur, 0, GF_ISOM_EDIT_NORMAL);
-				gf_import_message(import, GF_OK, "Timeline offset: %u ms", (offset * 1000) / moov_ts);
-			}
-
-			if (tsimp.nb_p) {
-				gf_import_message(import, GF_OK, "Import results: %d VOPs (%d Is - %d Ps - %d Bs)", gf_isom_get_sample_count(import->dest, tsimp.track), tsimp.nb_i, tsimp.nb_p, tsimp.nb_b);
-			}
-
-			if (es->program->pmt_iod)
-				gf_isom_set_brand_info(import->dest, GF_ISOM_BRAND_MP42, 1);
-		}
+		m2ts_import_finalize_track(&tsimp, es);
 	}
 
 	gf_m2ts_demux_del(ts);
@@ -1108,6 +1108,407 @@ GF_Err gf_mpd_init_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *default_b
 	return gf_mpd_complete_from_dom(root, mpd, default_base_url);
 }
 
+/*incremental update of an MPD from a new version of its document*/
+
+typedef struct
+{
+	u32 start, end;
+} GF_MPDTextRange;
+
+struct __gf_mpd_text_state
+{
+	/*NULL-terminated text of the document last applied*/
+	char *text;
+	u32 size;
+	/*MPD start tag and SegmentTimeline elements in document order*/
+	GF_MPDTextRange root;
+	GF_MPDTextRange *blocks;
+	u32 nb_blocks, nb_alloc;
+	/*timelines of the MPD parsed from the SegmentTimeline elements*/
+	GF_MPD_SegmentTimeline **timelines;
+};
+
+/*locates the next markup of a NULL-terminated XML text from pos, skipping comments, CDATA sections, processing instructions
+and doctype. Returns the position following the markup, or 0 if none, and sets the local name of the element (prefix removed)*/
+static u32 gf_mpd_text_next_tag(const char *text, u32 size, u32 pos, u32 *tag_start, const char **name, u32 *name_len, Bool *is_end, Bool *is_empty)
+{
+	while (pos < size) {
+		u32 i;
+		char quote = 0;
+		const char *p = strchr(text + pos, '<');
+		if (!p || ((u32) (p - text) >= size)) return 0;
+		*tag_start = (u32) (p - text);
+		if ((p[1]=='!') || (p[1]=='?')) {
+			const char *end;
+			if (!strncmp(p, "<!--", 4)) end = strstr(p+4, "-->");
+			else if (!strncmp(p, "<![CDATA[", 9)) end = strstr(p+9, "]]>");
+			else if (p[1]=='?') end = strstr(p+2, "?>");
+			else end = strchr(p+2, '>');
+			if (!end) return 0;
+			pos = (u32) (strchr(end, '>') + 1 - text);
+			continue;
+		}
+		*is_end = (p[1]=='/') ? GF_TRUE : GF_FALSE;
+		i = *tag_start + (*is_end ? 2 : 1);
+		*name = text + i;
+		while ((i<size) && !strchr(" \t\r\n/>", text[i])) {
+			if (text[i]==':') *name = text + i + 1;
+			i++;
+		}
+		*name_len = (u32) (text + i - *name);
+		/*attribute values may contain '>'*/
+		while (i<size) {
+			if (quote) {
+				if (text[i]==quote) quote = 0;
+			} else if ((text[i]=='"') || (text[i]=='\'')) {
+				quote = text[i];
+			} else if (text[i]=='>') {
+				break;
+			}
+			i++;
+		}
+		if (i>=size) return 0;
+		*is_empty = (text[i-1]=='/') ? GF_TRUE : GF_FALSE;
+		return i+1;
+	}
+	return 0;
+}
+
+#define MPD_TEXT_IS_TAG(_name, _len, _str)	((_len==strlen(_str)) && !strncmp(_name, _str, _len))
+
+/*locates the MPD start tag and the SegmentTimeline elements of the text - returns GF_FALSE if the text is not a well-formed MPD*/
+static Bool gf_mpd_text_split(const char *text, u32 size, GF_MPDTextRange *root, GF_MPDTextRange **blocks, u32 *nb_blocks, u32 *nb_alloc)
+{
+	u32 pos = 0, start, name_len, block_start = 0;
+	const char *name;
+	Bool is_end, is_empty, in_block = GF_FALSE;
+
+	*nb_blocks = 0;
+	root->start = root->end = 0;
+	while ((pos = gf_mpd_text_next_tag(text, size, pos, &start, &name, &name_len, &is_end, &is_empty))) {
+		if (!root->end) {
+			if (is_end || is_empty || !MPD_TEXT_IS_TAG(name, name_len, "MPD")) return GF_FALSE;
+			root->start = start;
+			root->end = pos;
+			continue;
+		}
+		if (!MPD_TEXT_IS_TAG(name, name_len, "SegmentTimeline")) continue;
+		if (!is_end) {
+			if (in_block) return GF_FALSE;
+			block_start = start;
+			in_block = GF_TRUE;
+			if (!is_empty) continue;
+		} else if (!in_block) {
+			return GF_FALSE;
+		}
+		in_block = GF_FALSE;
+		if (*nb_blocks == *nb_alloc) {
+			*nb_alloc = *nb_alloc ? 2 * *nb_alloc : 16;
+			*blocks = (GF_MPDTextRange *) gf_realloc(*blocks, sizeof(GF_MPDTextRange) * *nb_alloc);
+		}
+		(*blocks)[*nb_blocks].start = block_start;
+		(*blocks)[*nb_blocks].end = pos;
+		(*nb_blocks)++;
+	}
+	return (root->end && !in_block) ? GF_TRUE : GF_FALSE;
+}
+
+/*parses the S elements of a SegmentTimeline text range, or only counts them if entries is NULL. If last_before is set, it
+receives the number of S elements ending before this position and the start of the first S element ending after it*/
+static GF_Err gf_mpd_text_parse_entries(const char *text, GF_MPDTextRange *range, GF_List *entries, u32 *nb_entries, u32 *last_before)
+{
+	u32 pos = range->start, start, name_len, nb_before = 0;
+	const char *name;
+	Bool is_end, is_empty, split_found = GF_FALSE;
+
+	*nb_entries = 0;
+	while ((pos = gf_mpd_text_next_tag(text, range->end, pos, &start, &name, &name_len, &is_end, &is_empty))) {
+		const char *att;
+		GF_MPD_SegmentTimelineEntry *ent;
+		if (is_end || !MPD_TEXT_IS_TAG(name, name_len, "S")) continue;
+		/*S elements are empty*/
+		if (!is_empty) return GF_NOT_SUPPORTED;
+		(*nb_entries)++;
+		if (last_before && !split_found) {
+			if (pos <= *last_before) {
+				nb_before++;
+			} else {
+				*last_before = MIN(*last_before, start);
+				split_found = GF_TRUE;
+			}
+		}
+		if (!entries) continue;
+
+		GF_SAFEALLOC(ent, GF_MPD_SegmentTimelineEntry);
+		if (!ent) return GF_OUT_OF_MEM;
+		gf_list_add(entries, ent);
+		att = name + name_len;
+		while (1) {
+			char value[64];
+			const char *att_name, *val_start, *val_end;
+			u32 att_len, len;
+			while (strchr(" \t\r\n", *att) && *att) att++;
+			if ((*att=='/') || (*att=='>') || !*att) break;
+			att_name = att;
+			while (*att && !strchr(" \t\r\n=", *att)) att++;
+			att_len = (u32) (att - att_name);
+			while (*att && (*att != '"') && (*att != '\'')) att++;
+			if (!*att) return GF_NON_COMPLIANT_BITSTREAM;
+			val_start = att+1;
+			val_end = strchr(val_start, *att);
+			if (!val_end) return GF_NON_COMPLIANT_BITSTREAM;
+			att = val_end+1;
+			len = MIN((u32) (val_end - val_start), 63);
+			memcpy(value, val_start, len);
+			value[len] = 0;
+			if (MPD_TEXT_IS_TAG(att_name, att_len, "t"))
+				ent->start_time = gf_mpd_parse_long_int(value);
+			else if (MPD_TEXT_IS_TAG(att_name, att_len, "d"))
+				ent->duration = gf_mpd_parse_int(value);
+			else if (MPD_TEXT_IS_TAG(att_name, att_len, "r")) {
+				ent->repeat_count = gf_mpd_parse_int(value);
+				if (ent->repeat_count == (u32)-1)
+					ent->repeat_count--;
+			}
+		}
+	}
+	if (last_before) {
+		if (!split_found) *last_before = MIN(*last_before, range->end);
+		*nb_entries = nb_before;
+	}
+	return GF_OK;
+}
+
+static void gf_mpd_text_add_timelines(GF_List *timelines, GF_MPD_SegmentList *list, GF_MPD_SegmentTemplate *template)
+{
+	if (list && list->segment_timeline) gf_list_add(timelines, list->segment_timeline);
+	if (template && template->segment_timeline) gf_list_add(timelines, template->segment_timeline);
+}
+
+GF_EXPORT
+GF_MPDTextState *gf_mpd_text_state_new(GF_MPD *mpd, const char *text, u32 size)
+{
+	u32 i, j, k, nb_entries;
+	GF_List *timelines;
+	GF_MPDTextState *state;
+
+	if (!mpd || !text) return NULL;
+	GF_SAFEALLOC(state, GF_MPDTextState);
+	if (!state) return NULL;
+	state->text = (char *) gf_malloc(sizeof(char) * (size+1));
+	memcpy(state->text, text, sizeof(char) * size);
+	state->text[size] = 0;
+	state->size = size;
+	if (!gf_mpd_text_split(state->text, size, &state->root, &state->blocks, &state->nb_blocks, &state->nb_alloc)) {
+		gf_mpd_text_state_del(state);
+		return NULL;
+	}
+
+	/*the timelines are listed in schema order, which is the document order; remote elements are not supported*/
+	timelines = gf_list_new();
+	for (i=0; i<gf_list_count(mpd->periods); i++) {
+		GF_MPD_Period *period = gf_list_get(mpd->periods, i);
+		if (period->xlink_href) break;
+		gf_mpd_text_add_timelines(timelines, period->segment_list, period->segment_template);
+		for (j=0; j<gf_list_count(period->adaptation_sets); j++) {
+			GF_MPD_AdaptationSet *set = gf_list_get(period->adaptation_sets, j);
+			if (set->xlink_href) break;
+			gf_mpd_text_add_timelines(timelines, set->segment_list, set->segment_template);
+			for (k=0; k<gf_list_count(set->representations); k++) {
+				GF_MPD_Representation *rep = gf_list_get(set->representations, k);
+				if (rep->segment_list && rep->segment_list->xlink_href) break;
+				gf_mpd_text_add_timelines(timelines, rep->segment_list, rep->segment_template);
+			}
+			if (k<gf_list_count(set->representations)) break;
+		}
+		if (j<gf_list_count(period->adaptation_sets)) break;
+	}
+	if ((i<gf_list_count(mpd->periods)) || (gf_list_count(timelines) != state->nb_blocks)) {
+		gf_list_del(timelines);
+		gf_mpd_text_state_del(state);
+		return NULL;
+	}
+	state->timelines = (GF_MPD_SegmentTimeline **) gf_malloc(sizeof(GF_MPD_SegmentTimeline *) * (state->nb_blocks+1));
+	for (i=0; i<state->nb_blocks; i++) {
+		state->timelines[i] = gf_list_get(timelines, i);
+		/*check the matching*/
+		if (gf_mpd_text_parse_entries(state->text, &state->blocks[i], NULL, &nb_entries, NULL)
+		        || (nb_entries != gf_list_count(state->timelines[i]->entries))) {
+			gf_list_del(timelines);
+			gf_mpd_text_state_del(state);
+			return NULL;
+		}
+	}
+	gf_list_del(timelines);
+	return state;
+}
+
+GF_EXPORT
+void gf_mpd_text_state_del(GF_MPDTextState *state)
+{
+	if (!state) return;
+	if (state->text) gf_free(state->text);
+	if (state->blocks) gf_free(state->blocks);
+	if (state->timelines) gf_free(state->timelines);
+	gf_free(state);
+}
+
+static Bool gf_mpd_text_same(const char *text1, u32 start1, u32 end1, const char *text2, u32 start2, u32 end2)
+{
+	if (end1 - start1 != end2 - start2) return GF_FALSE;
+	return memcmp(text1 + start1, text2 + start2, end1 - start1) ? GF_FALSE : GF_TRUE;
+}
+
+static Bool gf_mpd_same_string(const char *s1, const char *s2)
+{
+	if (!s1 || !s2) return (s1==s2) ? GF_TRUE : GF_FALSE;
+	return strcmp(s1, s2) ? GF_FALSE : GF_TRUE;
+}
+
+/*parses the MPD start tag alone*/
+static GF_MPD *gf_mpd_text_parse_root(const char *tag, u32 len)
+{
+	GF_Err e;
+	GF_MPD *mpd;
+	GF_DOMParser *parser;
+	char *str = (char *) gf_malloc(sizeof(char) * (len+2));
+	memcpy(str, tag, sizeof(char) * (len-1));
+	strcpy(str + len - 1, "/>");
+
+	parser = gf_xml_dom_new();
+	e = gf_xml_dom_parse_string(parser, str);
+	gf_free(str);
+	mpd = NULL;
+	if (!e && gf_xml_dom_get_root(parser)) {
+		mpd = gf_mpd_new();
+		e = gf_mpd_init_from_dom(gf_xml_dom_get_root(parser), mpd, NULL);
+		mpd->xml_namespace = NULL;
+		if (e) {
+			gf_mpd_del(mpd);
+			mpd = NULL;
+		}
+	}
+	gf_xml_dom_del(parser);
+	return mpd;
+}
+
+GF_EXPORT
+GF_Err gf_mpd_text_state_update(GF_MPDTextState *state, GF_MPD *mpd, const char *text, u32 size, u32 *nb_updated_timelines)
+{
+	u32 i, nb_blocks = 0, nb_alloc = 0;
+	GF_MPDTextRange root, *blocks = NULL;
+	GF_MPD *root_mpd = NULL;
+	GF_List **new_entries = NULL;
+	u32 *nb_kept = NULL;
+	GF_Err e = GF_NOT_SUPPORTED;
+
+	if (nb_updated_timelines) *nb_updated_timelines = 0;
+	if (!state || !mpd || !text) return GF_BAD_PARAM;
+	if (!gf_mpd_text_split(text, size, &root, &blocks, &nb_blocks, &nb_alloc)) goto exit;
+	if (nb_blocks != state->nb_blocks) goto exit;
+
+	/*everything but the MPD start tag and the timelines must be unchanged*/
+	if (!gf_mpd_text_same(state->text, 0, state->root.start, text, 0, root.start)) goto exit;
+	for (i=0; i<=nb_blocks; i++) {
+		u32 old_start = i ? state->blocks[i-1].end : state->root.end;
+		u32 old_end = (i<nb_blocks) ? state->blocks[i].start : state->size;
+		u32 new_start = i ? blocks[i-1].end : root.end;
+		u32 new_end = (i<nb_blocks) ? blocks[i].start : size;
+		if (!gf_mpd_text_same(state->text, old_start, old_end, text, new_start, new_end)) goto exit;
+	}
+
+	/*only MPD attributes not changing the timing model of the session may change*/
+	if (!gf_mpd_text_same(state->text, state->root.start, state->root.end, text, root.start, root.end)) {
+		root_mpd = gf_mpd_text_parse_root(text + root.start, root.end - root.start);
+		if (!root_mpd) goto exit;
+		if ((root_mpd->type != mpd->type) || (root_mpd->availabilityStartTime != mpd->availabilityStartTime)
+		        || (root_mpd->time_shift_buffer_depth != mpd->time_shift_buffer_depth)
+		        || !gf_mpd_same_string(root_mpd->ID, mpd->ID) || !gf_mpd_same_string(root_mpd->profiles, mpd->profiles))
+			goto exit;
+	}
+
+	/*parse the changed timelines, appended S elements only when the previous ones are unchanged*/
+	new_entries = (GF_List **) gf_malloc(sizeof(GF_List *) * (nb_blocks+1));
+	nb_kept = (u32 *) gf_malloc(sizeof(u32) * (nb_blocks+1));
+	memset(new_entries, 0, sizeof(GF_List *) * (nb_blocks+1));
+	for (i=0; i<nb_blocks; i++) {
+		GF_MPDTextRange *old_range = &state->blocks[i];
+		GF_MPDTextRange range = blocks[i];
+		u32 prefix, max_prefix, nb_old, nb_unchanged, nb_parsed, count;
+
+		nb_kept[i] = 0;
+		if (gf_mpd_text_same(state->text, old_range->start, old_range->end, text, range.start, range.end)) continue;
+
+		max_prefix = MIN(old_range->end - old_range->start, range.end - range.start);
+		prefix = 0;
+		while ((prefix < max_prefix) && (state->text[old_range->start + prefix] == text[range.start + prefix])) prefix++;
+
+		/*S elements entirely in the common prefix are the first ones of the timeline in memory, unless purged*/
+		count = gf_list_count(state->timelines[i]->entries);
+		prefix += old_range->start;
+		if (gf_mpd_text_parse_entries(state->text, old_range, NULL, &nb_old, NULL)) goto exit;
+		if (gf_mpd_text_parse_entries(state->text, old_range, NULL, &nb_unchanged, &prefix)) goto exit;
+		if (nb_unchanged && (count > nb_old - nb_unchanged)) {
+			nb_kept[i] = count - (nb_old - nb_unchanged);
+			range.start += prefix - old_range->start;
+		}
+		new_entries[i] = gf_list_new();
+		e = gf_mpd_text_parse_entries(text, &range, new_entries[i], &nb_parsed, NULL);
+		if (e) goto exit;
+		e = GF_NOT_SUPPORTED;
+	}
+
+	/*apply*/
+	if (root_mpd) {
+		mpd->publishTime = root_mpd->publishTime;
+		mpd->availabilityEndTime = root_mpd->availabilityEndTime;
+		mpd->media_presentation_duration = root_mpd->media_presentation_duration;
+		mpd->minimum_update_period = root_mpd->minimum_update_period;
+		mpd->min_buffer_time = root_mpd->min_buffer_time;
+		mpd->suggested_presentation_delay = root_mpd->suggested_presentation_delay;
+		mpd->max_segment_duration = root_mpd->max_segment_duration;
+		mpd->max_subsegment_duration = root_mpd->max_subsegment_duration;
+	}
+	for (i=0; i<nb_blocks; i++) {
+		GF_List *entries;
+		if (!new_entries[i]) continue;
+		entries = state->timelines[i]->entries;
+		while (gf_list_count(entries) > nb_kept[i]) {
+			GF_MPD_SegmentTimelineEntry *ent = gf_list_last(entries);
+			gf_list_rem_last(entries);
+			gf_free(ent);
+		}
+		while (gf_list_count(new_entries[i])) {
+			gf_list_add(entries, gf_list_get(new_entries[i], 0));
+			gf_list_rem(new_entries[i], 0);
+		}
+		if (nb_updated_timelines) (*nb_updated_timelines)++;
+	}
+	gf_free(state->text);
+	state->text = (char *) gf_malloc(sizeof(char) * (size+1));
+	memcpy(state->text, text, sizeof(char) * size);
+	state->text[size] = 0;
+	state->size = size;
+	state->root = root;
+	gf_free(state->blocks);
+	state->blocks = blocks;
+	state->nb_alloc = nb_alloc;
+	blocks = NULL;
+	e = GF_OK;
+
+exit:
+	if (new_entries) {
+		for (i=0; i<nb_blocks; i++) {
+			if (new_entries[i]) gf_mpd_del_list(new_entries[i], gf_mpd_segment_entry_free, 0);
+		}
+		gf_free(new_entries);
+	}
+	if (nb_kept) gf_free(nb_kept);
+	if (blocks) gf_free(blocks);
+	if (root_mpd) gf_mpd_del(root_mpd);
+	return e;
+}
+
 GF_EXPORT
 void gf_mpd_getter_del_session(GF_FileDownload *getter) {
 	if (!getter || !getter->del_session)
@@ -2650,6 +3051,9 @@ GF_Err gf_mpd_resolve_url(GF_MPD *mpd, GF_MPD_Representation *rep, GF_MPD_Adapta
 			/*check total duration*/
 			if (period->duration
 				&& ((start_number + item_index) * *segment_duration_in_ms > period->duration)) {
+				/*restore the template, the MPD may be queried for other segments*/
+				if (format_tag) format_tag[0] = '%';
+				second_sep[0] = '$';
 				gf_free(url);
 				gf_free(solved_template);
 				return GF_EOS;
@@ -2683,6 +3087,8 @@ GF_Err gf_mpd_resolve_url(GF_MPD *mpd, GF_MPD_Representation *rep, GF_MPD_Adapta
 							start_time += ent->duration * (1 + ent->repeat_count);
 							continue;
 						} else {
+							if (format_tag) format_tag[0] = '%';
+							second_sep[0] = '$';
 							gf_free(url);
 							gf_free(solved_template);
 							return GF_EOS;
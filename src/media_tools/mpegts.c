@@ -31,6 +31,7 @@
 #include <gpac/constants.h>
 #include <gpac/internal/media_dev.h>
 #include <gpac/download.h>
+#include <gpac/cache.h>
 
 
 #ifndef GPAC_DISABLE_STREAMING
@@ -110,6 +111,8 @@ static void gf_m2ts_estimate_duration(GF_M2TS_Demuxer *ts, u64 PCR, u16 pcr_pid)
 {
 	u64 file_size = 0;
 //	if (ts->duration>0) return;
+	/*duration is known from the index*/
+	if (ts->index) return;
 
 	if (ts->file || ts->file_size) {
 		file_size = ts->file_size;
@@ -1314,19 +1317,111 @@ static u32 gf_m2ts_reframe_id3_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, Bool s
 	return 0;
 }
 
-static u32 gf_m2ts_sync(GF_M2TS_Demuxer *ts, Bool simple_check)
+#if defined(WIN32) && !defined(__GNUC__)
+# include <intrin.h>
+# define GPAC_HAS_SSE2
+#else
+# ifdef __SSE2__
+#  include <emmintrin.h>
+#  define GPAC_HAS_SSE2
+# endif
+#endif
+
+#ifdef GPAC_HAS_SSE2
+
+/*AVX2 version is selected at run time, only with compilers supporting per-function target and CPU detection*/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#include <immintrin.h>
+#define GPAC_M2TS_SYNC_AVX2
+#endif
+
+static GFINLINE u32 gf_m2ts_sync_first_bit(u32 mask)
+{
+#if defined(WIN32) && !defined(__GNUC__)
+	unsigned long idx;
+	_BitScanForward(&idx, mask);
+	return (u32) idx;
+#else
+	return (u32) __builtin_ctz(mask);
+#endif
+}
+
+/*checks 16 candidate positions at once: a packet may start at i if data[i] is a sync byte followed by another one 188 or 192 bytes later.
+Returns the first candidate position, or the first position not checked - only positions with 192 bytes of lookahead are checked*/
+static u32 gf_m2ts_sync_find_sse2(const u8 *data, u32 size, u32 i)
+{
+	const __m128i sync = _mm_set1_epi8(0x47);
+	while (i + 192 + 16 <= size) {
+		__m128i start = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (data + i)), sync);
+		__m128i next_188 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (data + i + 188)), sync);
+		__m128i next_192 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (data + i + 192)), sync);
+		u32 mask = (u32) _mm_movemask_epi8(_mm_and_si128(start, _mm_or_si128(next_188, next_192)));
+		if (mask) return i + gf_m2ts_sync_first_bit(mask);
+		i += 16;
+	}
+	return i;
+}
+
+#ifdef GPAC_M2TS_SYNC_AVX2
+/*same as above, 32 positions at once*/
+__attribute__((target("avx2")))
+static u32 gf_m2ts_sync_find_avx2(const u8 *data, u32 size, u32 i)
+{
+	const __m256i sync = _mm256_set1_epi8(0x47);
+	while (i + 192 + 32 <= size) {
+		__m256i start = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (data + i)), sync);
+		__m256i next_188 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (data + i + 188)), sync);
+		__m256i next_192 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (data + i + 192)), sync);
+		u32 mask = (u32) _mm256_movemask_epi8(_mm256_and_si256(start, _mm256_or_si256(next_188, next_192)));
+		if (mask) return i + gf_m2ts_sync_first_bit(mask);
+		i += 32;
+	}
+	return i;
+}
+#endif
+
+static u32 gf_m2ts_sync_find(const u8 *data, u32 size, u32 i)
+{
+#ifdef GPAC_M2TS_SYNC_AVX2
+	if (__builtin_cpu_supports("avx2")) {
+		i = gf_m2ts_sync_find_avx2(data, size, i);
+	}
+#endif
+	return gf_m2ts_sync_find_sse2(data, size, i);
+}
+
+#endif /*GPAC_HAS_SSE2*/
+
+/*returns the position of the first packet in @data - if no sync is found, returns the first position which could not be checked*/
+static u32 gf_m2ts_sync(GF_M2TS_Demuxer *ts, char *data, u32 size, Bool simple_check, Bool *synced)
 {
 	u32 i=0;
+	*synced = GF_FALSE;
 	/*if first byte is sync assume we're sync*/
-	if (simple_check && (ts->buffer[i]==0x47)) return 0;
+	if (simple_check && size && (data[i]==0x47)) {
+		*synced = GF_TRUE;
+		return 0;
+	}
 
-	while (i<ts->buffer_size) {
-		if (i+188>ts->buffer_size) return ts->buffer_size;
-		if ((ts->buffer[i]==0x47) && (ts->buffer[i+188]==0x47))
-			break;
-		if ((ts->buffer[i]==0x47) && (ts->buffer[i+192]==0x47)) {
-			ts->prefix_present = 1;
-			break;
+	while (i+188<size) {
+#ifdef GPAC_HAS_SSE2
+		/*skip non-candidate positions, the remaining positions (end of buffer) are checked one by one below*/
+		i = gf_m2ts_sync_find((const u8 *) data, size, i);
+		if (i+188>=size) break;
+#endif
+		if (data[i]==0x47) {
+			if (data[i+188]==0x47) {
+				*synced = GF_TRUE;
+				break;
+			}
+			/*wait for more data to check for 192-byte packets*/
+			if (i+192>=size)
+				break;
+			if (data[i+192]==0x47) {
+				ts->prefix_present = 1;
+				*synced = GF_TRUE;
+				break;
+			}
 		}
 		i++;
 	}
@@ -2916,6 +3011,16 @@ void gf_m2ts_flush_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes)
 	pes->rap = 0;
 }
 
+/*makes sure the PES reassembly buffer can hold size bytes. The buffer is kept across PES packets and grows by at least half its size,
+so that reassembling a PES larger than the previous ones does not reallocate (and possibly move) the buffer for each TS packet*/
+static void gf_m2ts_pes_reserve(GF_M2TS_PES *pes, u32 size)
+{
+	if (size <= pes->pck_alloc_len) return;
+	if (size < pes->pck_alloc_len + pes->pck_alloc_len/2) size = pes->pck_alloc_len + pes->pck_alloc_len/2;
+	pes->pck_alloc_len = size;
+	pes->pck_data = (u8*)gf_realloc(pes->pck_data, pes->pck_alloc_len);
+}
+
 static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_Header *hdr, unsigned char *data, u32 data_size, GF_M2TS_AdaptationField *paf)
 {
 	u8 expect_cc;
@@ -2971,10 +3076,7 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 	} else if (pes->pes_len && (pes->pck_data_len + data_size == pes->pes_len + 6)) {
 		/* 6 = startcode+stream_id+length*/
 		/*reassemble pes*/
-		if (pes->pck_data_len + data_size > pes->pck_alloc_len) {
-			pes->pck_alloc_len = pes->pck_data_len + data_size;
-			pes->pck_data = (u8*)gf_realloc(pes->pck_data, pes->pck_alloc_len);
-		}
+		gf_m2ts_pes_reserve(pes, pes->pck_data_len + data_size);
 		memcpy(pes->pck_data+pes->pck_data_len, data, data_size);
 		pes->pck_data_len += data_size;
 		/*force discard*/
@@ -2993,10 +3095,7 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 		return;
 	}
 	/*reassemble*/
-	if (pes->pck_data_len + data_size > pes->pck_alloc_len ) {
-		pes->pck_alloc_len = pes->pck_data_len + data_size;
-		pes->pck_data = (u8*)gf_realloc(pes->pck_data, pes->pck_alloc_len);
-	}
+	gf_m2ts_pes_reserve(pes, pes->pck_data_len + data_size);
 	memcpy(pes->pck_data + pes->pck_data_len, data, data_size);
 	pes->pck_data_len += data_size;
 
@@ -3008,6 +3107,10 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 		if (pes->pes_len + 6 == pes->pck_data_len) {
 			gf_m2ts_flush_pes(ts, pes);
 		}
+		/*PES size known, allocate it at once*/
+		else if (pes->pes_len + 6 > pes->pck_data_len) {
+			gf_m2ts_pes_reserve(pes, pes->pes_len + 6);
+		}
 	}
 }
 
@@ -3393,65 +3496,488 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 	return GF_OK;
 }
 
-GF_EXPORT
-GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, char *data, u32 data_size)
+/*TS analyzer*/
+
+/*number of slots of the sliding window: the window covers the last completed slots*/
+#define M2TS_STATS_NB_SLOTS	10
+/*TR 101 290 limits, in 27 MHz*/
+#define M2TS_STATS_PCR_REPETITION	(40*27000)
+#define M2TS_STATS_PCR_DISCONTINUITY	(100*27000)
+#define M2TS_STATS_PSI_REPETITION	(500*27000)
+#define M2TS_STATS_PTS_REPETITION	(700*27000)
+/*PCR accuracy limit in ns*/
+#define M2TS_STATS_PCR_ACCURACY	500
+
+typedef struct
 {
-	GF_Err e;
-	u32 pos, pck_size;
-	Bool is_align = 1;
-	if (ts->buffer) {
-		if (ts->alloc_size < ts->buffer_size+data_size) {
-			ts->alloc_size = ts->buffer_size+data_size;
-			ts->buffer = (char*)gf_realloc(ts->buffer, sizeof(char)*ts->alloc_size);
-		}
-		memcpy(ts->buffer + ts->buffer_size, data, sizeof(char)*data_size);
-		ts->buffer_size += data_size;
-		is_align = 0;
-	} else {
-		ts->buffer = data;
-		ts->buffer_size = data_size;
+	GF_M2TS_PIDStats s;
+	/*last continuity counter, -1 if none, and set if the last packet was a duplicate*/
+	s32 last_cc;
+	Bool dup_cc;
+	/*stream clock and packet count when the stream clock was first known for this PID*/
+	Bool has_time;
+	u64 first_time, first_nb_packets;
+	/*last PCR and packet number of the last PCR*/
+	Bool has_pcr;
+	u64 last_pcr, last_pcr_pck;
+	/*stream clock of the last PES/section start and of the last PTS, sum and number of start intervals*/
+	Bool has_unit, has_pts;
+	u64 last_unit_time, last_pts_time, unit_interval_sum;
+	u32 nb_unit_intervals;
+	/*per slot packet count and PCR inaccuracy range in ns*/
+	u32 slot_pck[M2TS_STATS_NB_SLOTS];
+	s32 slot_dev_min[M2TS_STATS_NB_SLOTS], slot_dev_max[M2TS_STATS_NB_SLOTS];
+} GF_M2TSPIDStatsCtx;
+
+struct __gf_m2ts_stats
+{
+	/*slot duration in 27 MHz*/
+	u64 slot_dur;
+	/*PID statistics, allocated on the first packet of the PID and kept until the analyzer is disabled, and PIDs in order of appearance*/
+	GF_M2TSPIDStatsCtx *pids[GF_M2TS_MAX_STREAMS];
+	u16 active[GF_M2TS_MAX_STREAMS];
+	u32 nb_active;
+	u64 nb_pck;
+	u32 sync_errors, cc_errors;
+
+	/*stream clock: PCRs of the reference PID, interpolated with the average packet duration measured over the last window*/
+	u16 ref_pid;
+	u64 ref_first_pck, ref_last_pck, ref_span;
+	u64 clock_at_pcr;
+	Double pck_dur;
+	/*number of continuity errors when the rate measurement started*/
+	u32 ref_cc_errors;
+	Bool has_time;
+	u64 now, first_time;
+
+	/*current slot and its start time*/
+	u32 slot, nb_slots_done;
+	u64 slot_start;
+};
+
+static void gf_m2ts_stats_reset_slot(GF_M2TSPIDStatsCtx *ps, u32 slot)
+{
+	ps->slot_pck[slot] = 0;
+	ps->slot_dev_min[slot] = 0x7FFFFFFF;
+	ps->slot_dev_max[slot] = -0x7FFFFFFF;
+}
+
+/*number of packets of the PID over the completed slots of the window*/
+static u32 gf_m2ts_stats_window_packets(struct __gf_m2ts_stats *st, GF_M2TSPIDStatsCtx *ps)
+{
+	u32 i, nb_pck = 0;
+	for (i=0; i<M2TS_STATS_NB_SLOTS; i++) {
+		if (i != st->slot) nb_pck += ps->slot_pck[i];
 	}
+	return nb_pck;
+}
 
-	/*sync input data*/
-	pos = gf_m2ts_sync(ts, is_align);
-	if (pos==ts->buffer_size) {
-		if (is_align) {
-			ts->buffer = (char*)gf_malloc(sizeof(char)*data_size);
-			memcpy(ts->buffer, data, sizeof(char)*data_size);
-			ts->alloc_size = ts->buffer_size = data_size;
+static u32 gf_m2ts_stats_window_bitrate(struct __gf_m2ts_stats *st, u32 nb_pck)
+{
+	u32 nb_slots = MIN(st->nb_slots_done, M2TS_STATS_NB_SLOTS-1);
+	if (!nb_slots) return 0;
+	return (u32) ((Double) nb_pck * 188 * 8 * 27000000 / (nb_slots * st->slot_dur));
+}
+
+static void gf_m2ts_stats_update_clock(struct __gf_m2ts_stats *st)
+{
+	u32 i, j;
+	u64 now, nb_skip;
+	if (!st->pck_dur) return;
+
+	now = st->clock_at_pcr + (u64) ((st->nb_pck - st->ref_last_pck) * st->pck_dur);
+	/*the interpolation may slightly overshoot the next PCR*/
+	if (now < st->now) now = st->now;
+	st->now = now;
+	if (!st->has_time) {
+		st->has_time = GF_TRUE;
+		st->first_time = st->slot_start = now;
+		/*packets received before the stream clock started are not part of the window*/
+		for (i=0; i<st->nb_active; i++) {
+			for (j=0; j<M2TS_STATS_NB_SLOTS; j++) gf_m2ts_stats_reset_slot(st->pids[st->active[i]], j);
 		}
-		return GF_OK;
+		return;
 	}
-	pck_size = ts->prefix_present ? 192 : 188;
-	e=GF_OK;
-	for (;;) {
-		/*wait for a complete packet*/
-		if (ts->buffer_size < pos  + pck_size) {
-			ts->buffer_size -= pos;
-			if (!ts->buffer_size) {
-				if (!is_align) gf_free(ts->buffer);
-				ts->buffer = NULL;
-				return e;
+	if (now < st->slot_start + st->slot_dur) return;
+
+	/*skip the slots entirely elapsed since a stream clock jump*/
+	nb_skip = (now - st->slot_start) / st->slot_dur;
+	if (nb_skip > M2TS_STATS_NB_SLOTS) st->slot_start += (nb_skip - M2TS_STATS_NB_SLOTS) * st->slot_dur;
+
+	while (now >= st->slot_start + st->slot_dur) {
+		st->slot = (st->slot + 1) % M2TS_STATS_NB_SLOTS;
+		st->slot_start += st->slot_dur;
+		if (st->nb_slots_done < M2TS_STATS_NB_SLOTS) st->nb_slots_done++;
+		for (i=0; i<st->nb_active; i++) {
+			GF_M2TSPIDStatsCtx *ps = st->pids[st->active[i]];
+			gf_m2ts_stats_reset_slot(ps, st->slot);
+			if (st->nb_slots_done >= M2TS_STATS_NB_SLOTS-1) {
+				j = gf_m2ts_stats_window_bitrate(st, gf_m2ts_stats_window_packets(st, ps));
+				if (j > ps->s.max_bitrate) ps->s.max_bitrate = j;
+			}
+		}
+	}
+}
+
+static void gf_m2ts_stats_pcr(struct __gf_m2ts_stats *st, GF_M2TSPIDStatsCtx *ps, u64 pcr, Bool discontinuity)
+{
+	s64 diff = 0;
+	Bool valid = GF_FALSE;
+	ps->s.flags |= GF_M2TS_STATS_PCR;
+	ps->s.nb_pcr++;
+	if (ps->has_pcr) {
+		diff = (s64) pcr - (s64) ps->last_pcr;
+		/*PCR wrap*/
+		if (diff < - (s64) GF_M2TS_MAX_PCR / 2) diff += GF_M2TS_MAX_PCR;
+		if (!discontinuity) {
+			if ((diff < 0) || (diff > M2TS_STATS_PCR_DISCONTINUITY)) {
+				ps->s.pcr_discontinuity_errors++;
+			} else {
+				valid = GF_TRUE;
+				if (diff > M2TS_STATS_PCR_REPETITION) ps->s.pcr_repetition_errors++;
+			}
+		}
+	}
+	if (valid && st->pck_dur) {
+		Double expected = (st->nb_pck - ps->last_pcr_pck) * st->pck_dur;
+		/*deviation in ns, clamped before conversion (the packet count since the last PCR may be large)*/
+		Double dev_ns = (diff - expected) * 1000 / 27;
+		s32 dev;
+		if (dev_ns > GF_INT_MAX) dev = GF_INT_MAX;
+		else if (dev_ns < -GF_INT_MAX) dev = -GF_INT_MAX;
+		else dev = (s32) dev_ns;
+		u32 abs_dev = (dev<0) ? -dev : dev;
+		if (abs_dev > M2TS_STATS_PCR_ACCURACY) ps->s.pcr_accuracy_errors++;
+		if (abs_dev > ps->s.pcr_accuracy_max) ps->s.pcr_accuracy_max = abs_dev;
+		if (dev < ps->slot_dev_min[st->slot]) ps->slot_dev_min[st->slot] = dev;
+		if (dev > ps->slot_dev_max[st->slot]) ps->slot_dev_max[st->slot] = dev;
+	}
+
+	/*the first PCR PID found drives the stream clock*/
+	if (!st->ref_pid) st->ref_pid = ps->s.pid;
+	if (st->ref_pid == ps->s.pid) {
+		if (valid) {
+			st->clock_at_pcr += diff;
+			st->ref_span += diff;
+			/*the multiplex rate is measured over windows, windows with lost packets being discarded*/
+			if (!st->has_time || (st->ref_span >= st->slot_dur * (M2TS_STATS_NB_SLOTS-1))) {
+				if (!st->has_time || (st->ref_cc_errors == st->cc_errors))
+					st->pck_dur = (Double) (s64) st->ref_span / (st->nb_pck - st->ref_first_pck);
+				if (st->has_time) {
+					st->ref_span = 0;
+					st->ref_first_pck = st->nb_pck;
+					st->ref_cc_errors = st->cc_errors;
+				}
+			}
+		} else {
+			/*restart the rate measurement, the clock goes on from its interpolated value*/
+			st->clock_at_pcr = st->now;
+			st->ref_span = 0;
+			st->ref_first_pck = st->nb_pck;
+			st->ref_cc_errors = st->cc_errors;
+		}
+		st->ref_last_pck = st->nb_pck;
+	}
+	ps->has_pcr = GF_TRUE;
+	ps->last_pcr = pcr;
+	ps->last_pcr_pck = st->nb_pck;
+}
+
+static void gf_m2ts_stats_unit_start(GF_M2TS_Demuxer *ts, struct __gf_m2ts_stats *st, GF_M2TSPIDStatsCtx *ps, unsigned char *data, u32 pos)
+{
+	u64 interval = 0;
+	u32 pid = ps->s.pid;
+	Bool is_psi = GF_FALSE;
+
+	ps->s.nb_units++;
+	if (pid == GF_M2TS_PID_PAT) {
+		ps->s.flags |= GF_M2TS_STATS_PAT;
+		is_psi = GF_TRUE;
+	} else if (ts->ess[pid] && ts->ess[pid]->program && (ts->ess[pid]->program->pmt_pid == pid)) {
+		ps->s.flags |= GF_M2TS_STATS_PMT;
+		is_psi = GF_TRUE;
+	} else if ((pos + 14 <= 188) && !data[pos] && !data[pos+1] && (data[pos+2]==1)) {
+		ps->s.flags |= GF_M2TS_STATS_PES;
+	} else {
+		ps->s.flags |= GF_M2TS_STATS_SECTION;
+	}
+	if (!st->has_time) return;
+
+	if (ps->has_unit) {
+		interval = st->now - ps->last_unit_time;
+		ps->unit_interval_sum += interval;
+		ps->nb_unit_intervals++;
+		if (interval > (u64) ps->s.unit_interval_max * 27000) ps->s.unit_interval_max = (u32) (interval / 27000);
+		if (is_psi && (interval > M2TS_STATS_PSI_REPETITION)) ps->s.repetition_errors++;
+	}
+	ps->has_unit = GF_TRUE;
+	ps->last_unit_time = st->now;
+
+	/*PES with PTS*/
+	if ((ps->s.flags & GF_M2TS_STATS_PES) && (pos + 14 <= 188) && (data[pos+7] & 0x80)) {
+		if (ps->has_pts && (st->now - ps->last_pts_time > M2TS_STATS_PTS_REPETITION)) ps->s.repetition_errors++;
+		ps->has_pts = GF_TRUE;
+		ps->last_pts_time = st->now;
+	}
+}
+
+static GFINLINE void gf_m2ts_stats_cc_error(struct __gf_m2ts_stats *st, GF_M2TSPIDStatsCtx *ps)
+{
+	ps->s.cc_errors++;
+	st->cc_errors++;
+}
+
+/*analyzes a TS packet without demultiplexing it*/
+static void gf_m2ts_stats_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
+{
+	struct __gf_m2ts_stats *st = ts->stats;
+	GF_M2TSPIDStatsCtx *ps;
+	u32 pid, cc, pos;
+	Bool has_payload, discontinuity = GF_FALSE;
+
+	st->nb_pck++;
+	if (data[0] != 0x47) {
+		st->sync_errors++;
+		return;
+	}
+	gf_m2ts_stats_update_clock(st);
+
+	pid = ((data[1] & 0x1f) << 8) | data[2];
+	ps = st->pids[pid];
+	if (!ps) {
+		u32 i;
+		GF_SAFEALLOC(ps, GF_M2TSPIDStatsCtx);
+		if (!ps) return;
+		ps->s.pid = pid;
+		ps->last_cc = -1;
+		for (i=0; i<M2TS_STATS_NB_SLOTS; i++) gf_m2ts_stats_reset_slot(ps, i);
+		st->pids[pid] = ps;
+		st->active[st->nb_active] = pid;
+		st->nb_active++;
+	}
+	ps->s.nb_packets++;
+	ps->slot_pck[st->slot]++;
+	if (!ps->has_time && st->has_time) {
+		ps->has_time = GF_TRUE;
+		ps->first_time = st->now;
+		ps->first_nb_packets = ps->s.nb_packets - 1;
+	}
+	if (data[1] & 0x80) {
+		ps->s.transport_errors++;
+		return;
+	}
+	if (data[3] & 0xC0) ps->s.nb_scrambled++;
+	has_payload = (data[3] & 0x10) ? GF_TRUE : GF_FALSE;
+	pos = 4;
+	if (data[3] & 0x20) {
+		u32 af_size = data[4];
+		pos += 1 + af_size;
+		if (af_size) {
+			discontinuity = (data[5] & 0x80) ? GF_TRUE : GF_FALSE;
+			if ((af_size >= 7) && (data[5] & 0x10)) {
+				u64 pcr_base = ((u64) data[6] << 25) | ((u64) data[7] << 17) | ((u64) data[8] << 9) | ((u64) data[9] << 1) | (data[10] >> 7);
+				gf_m2ts_stats_pcr(st, ps, pcr_base * 300 + (((data[10] & 0x1) << 8) | data[11]), discontinuity);
 			}
-			if (is_align) {
-				data = ts->buffer+pos;
-				ts->buffer = (char*)gf_malloc(sizeof(char)*ts->buffer_size);
-				memcpy(ts->buffer, data, sizeof(char)*ts->buffer_size);
-				ts->alloc_size = ts->buffer_size;
+		}
+	}
+
+	/*continuity check (not done for null packets), a packet may be sent twice and packets without payload do not increment the counter*/
+	if (pid != 0x1FFF) {
+		cc = data[3] & 0xf;
+		if ((ps->last_cc >= 0) && !discontinuity) {
+			if (!has_payload) {
+				if (cc != (u32) ps->last_cc) gf_m2ts_stats_cc_error(st, ps);
+			} else if (cc == (u32) ps->last_cc) {
+				if (ps->dup_cc) gf_m2ts_stats_cc_error(st, ps);
+				ps->dup_cc = GF_TRUE;
 			} else {
-				memmove(ts->buffer, ts->buffer + pos, sizeof(char)*ts->buffer_size);
+				if (cc != ((ps->last_cc + 1) & 0xf)) gf_m2ts_stats_cc_error(st, ps);
+				ps->dup_cc = GF_FALSE;
 			}
+		}
+		ps->last_cc = cc;
+	}
+
+	if (has_payload && (data[1] & 0x40) && (pos < 188))
+		gf_m2ts_stats_unit_start(ts, st, ps, data, pos);
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_demux_enable_stats(GF_M2TS_Demuxer *ts, Bool enable, u32 window_ms)
+{
+	u32 i;
+	if (!ts) return GF_BAD_PARAM;
+	if (ts->stats) {
+		for (i=0; i<ts->stats->nb_active; i++) gf_free(ts->stats->pids[ts->stats->active[i]]);
+		gf_free(ts->stats);
+		ts->stats = NULL;
+	}
+	if (!enable) return GF_OK;
+	GF_SAFEALLOC(ts->stats, struct __gf_m2ts_stats);
+	if (!ts->stats) return GF_OUT_OF_MEM;
+	if (!window_ms) window_ms = 1000;
+	ts->stats->slot_dur = (u64) window_ms * 27000 / (M2TS_STATS_NB_SLOTS-1);
+	if (!ts->stats->slot_dur) ts->stats->slot_dur = 1;
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_demux_get_stats(GF_M2TS_Demuxer *ts, GF_M2TS_Stats *stats)
+{
+	u32 i, nb_pck;
+	u64 nb_timed_pck;
+	struct __gf_m2ts_stats *st = ts ? ts->stats : NULL;
+	if (!st || !stats) return GF_BAD_PARAM;
+	memset(stats, 0, sizeof(GF_M2TS_Stats));
+	stats->time = st->has_time ? (u32) ((st->now - st->first_time) / 27000) : 0;
+	stats->pcr_pid = st->ref_pid;
+	stats->nb_packets = st->nb_pck;
+	stats->sync_errors = st->sync_errors;
+	stats->nb_pids = st->nb_active;
+	nb_pck = 0;
+	nb_timed_pck = 0;
+	for (i=0; i<stats->nb_pids; i++) {
+		GF_M2TSPIDStatsCtx *ps = st->pids[st->active[i]];
+		nb_pck += gf_m2ts_stats_window_packets(st, ps);
+		if (ps->has_time) nb_timed_pck += ps->s.nb_packets - ps->first_nb_packets;
+	}
+	stats->bitrate = gf_m2ts_stats_window_bitrate(st, nb_pck);
+	if (st->has_time && (st->now > st->first_time))
+		stats->avg_bitrate = (u32) ((Double) (s64) nb_timed_pck * 188 * 8 * 27000000 / (s64) (st->now - st->first_time));
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_demux_get_pid_stats(GF_M2TS_Demuxer *ts, u32 idx, GF_M2TS_PIDStats *stats)
+{
+	u32 i;
+	s32 dev_min, dev_max;
+	GF_M2TSPIDStatsCtx *ps;
+	struct __gf_m2ts_stats *st = ts ? ts->stats : NULL;
+	if (!st || !stats || (idx >= st->nb_active)) return GF_BAD_PARAM;
+	ps = st->pids[st->active[idx]];
+
+	memcpy(stats, &ps->s, sizeof(GF_M2TS_PIDStats));
+	stats->bitrate = gf_m2ts_stats_window_bitrate(st, gf_m2ts_stats_window_packets(st, ps));
+	if (ps->has_time && (st->now > ps->first_time))
+		stats->avg_bitrate = (u32) ((Double) (s64) (ps->s.nb_packets - ps->first_nb_packets) * 188 * 8 * 27000000 / (s64) (st->now - ps->first_time));
+	if (ps->nb_unit_intervals)
+		stats->unit_interval_avg = (u32) (ps->unit_interval_sum / ps->nb_unit_intervals / 27000);
+
+	dev_min = 0x7FFFFFFF;
+	dev_max = -0x7FFFFFFF;
+	for (i=0; i<M2TS_STATS_NB_SLOTS; i++) {
+		if (ps->slot_dev_min[i] < dev_min) dev_min = ps->slot_dev_min[i];
+		if (ps->slot_dev_max[i] > dev_max) dev_max = ps->slot_dev_max[i];
+	}
+	stats->pcr_jitter = (dev_max >= dev_min) ? (u32) (dev_max - dev_min) : 0;
+	return GF_OK;
+}
+
+/*checks if a packet without adaptation field on this PID can be dropped without parsing*/
+static GFINLINE Bool gf_m2ts_pid_ignored(GF_M2TS_Demuxer *ts, u32 pid)
+{
+	GF_M2TS_ES *es = ts->ess[pid];
+	/*PSI and DVB tables*/
+	if (pid <= GF_M2TS_PID_SIT) return GF_FALSE;
+	if (!es) return GF_TRUE;
+	if (es->flags & GF_M2TS_ES_IS_SECTION) return GF_FALSE;
+	return ((GF_M2TS_PES *)es)->reframe ? GF_FALSE : GF_TRUE;
+}
+
+/*processes nb_pck contiguous packets, stops when parsing is aborted. Error-free, clear, payload-only packets on PIDs
+nobody listens to are dropped from their header. The PID state is checked for each packet since processing the previous
+one may (un)declare streams or change their framing*/
+static GF_Err gf_m2ts_process_packets(GF_M2TS_Demuxer *ts, unsigned char *data, u32 nb_pck, u32 pck_size)
+{
+	GF_Err e = GF_OK;
+
+	if (ts->on_packets) ts->on_packets(ts, (const char *) data, nb_pck, pck_size);
+
+	while (nb_pck) {
+		if (ts->stats) gf_m2ts_stats_packet(ts, data);
+
+		if ((data[0]==0x47) && !(data[1] & 0x80) && ((data[3] & 0xF0) == 0x10) && gf_m2ts_pid_ignored(ts, ((data[1] & 0x1f) << 8) | data[2])) {
+			ts->pck_number++;
+		} else {
+			e |= gf_m2ts_process_packet(ts, data);
+			if (ts->abort_parsing) return e;
+		}
+		data += pck_size;
+		nb_pck--;
+	}
+	return e;
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, char *data, u32 data_size)
+{
+	GF_Err e = GF_OK;
+	u32 pos, pck_size, nb_pck, remain;
+	Bool synced, simple_check = GF_TRUE;
+	/*set when the previous call ended on a checked packet boundary*/
+	Bool validated = ts->buffer_synced;
+
+	/*complete the bytes left by the previous call with the head of the new data*/
+	if (ts->buffer_size) {
+		u32 carry = ts->buffer_size;
+		u32 copy = MIN(data_size, GF_M2TS_RESYNC_BUFFER_SIZE - carry);
+		u32 total = carry + copy;
+		memcpy(ts->buffer + carry, data, sizeof(char)*copy);
+
+		/*the carried bytes are only assumed synchronized if confirmed by the previous call*/
+		pos = gf_m2ts_sync(ts, ts->buffer, total, ts->buffer_synced, &synced);
+		pck_size = ts->prefix_present ? 192 : 188;
+		if (synced && (pos < carry)) {
+			/*packets starting in the carried bytes*/
+			nb_pck = MIN((carry - pos + pck_size - 1) / pck_size, (total - pos) / pck_size);
+			e = gf_m2ts_process_packets(ts, (unsigned char *)ts->buffer + pos, nb_pck, pck_size);
+			if (ts->abort_parsing) {
+				ts->buffer_size = 0;
+				return e;
+			}
+			pos += nb_pck * pck_size;
+		}
+		/*not enough data to complete the packet or to sync, wait for the next call*/
+		if (pos < carry) {
+			ts->buffer_size = total - pos;
+			if (pos) memmove(ts->buffer, ts->buffer + pos, sizeof(char)*ts->buffer_size);
+			ts->buffer_synced = synced;
 			return e;
 		}
-		/*process*/
-		e |= gf_m2ts_process_packet(ts, (unsigned char *)ts->buffer+pos);
-		pos += pck_size;
+		ts->buffer_size = 0;
+		data += pos - carry;
+		data_size -= pos - carry;
+		simple_check = validated = synced;
+	}
 
+	/*sync input data*/
+	pos = gf_m2ts_sync(ts, data, data_size, simple_check, &synced);
+	if (synced && (pos || !simple_check)) validated = GF_TRUE;
+	pck_size = ts->prefix_present ? 192 : 188;
+	if (synced) {
+		nb_pck = (data_size - pos) / pck_size;
+		e |= gf_m2ts_process_packets(ts, (unsigned char *)data + pos, nb_pck, pck_size);
 		if (ts->abort_parsing) {
-			if (!is_align) gf_free(ts->buffer);
-			ts->buffer = NULL;
+			ts->buffer_size = 0;
 			return e;
 		}
+		pos += nb_pck * pck_size;
+	}
+	/*keep the incomplete packet, or the bytes not checked for sync, for the next call*/
+	remain = data_size - pos;
+	ts->buffer_size = remain;
+	/*trust the packet boundary only if it was checked or follows a packet with a sync marker, otherwise a full resync is done on the next call*/
+	if (!data_size) {
+		ts->buffer_synced = validated;
+	} else if (synced && (validated || ((pos >= pck_size) && (data[pos - pck_size]==0x47)))) {
+		ts->buffer_synced = (!remain || (data[pos]==0x47)) ? GF_TRUE : GF_FALSE;
+	} else {
+		ts->buffer_synced = GF_FALSE;
+	}
+	if (remain) {
+		assert(remain <= GF_M2TS_RESYNC_BUFFER_SIZE);
+		memcpy(ts->buffer, data + pos, sizeof(char)*remain);
 	}
 	return e;
 }
@@ -3760,7 +4286,6 @@ void gf_m2ts_demux_del(GF_M2TS_Demuxer *ts)
 		//bacause of pure PCR streams, en ES might be reassigned on 2 PIDs, one for the ES and one for the PCR
 		if (ts->ess[i] && (ts->ess[i]->pid==i)) gf_m2ts_es_del(ts->ess[i], ts);
 	}
-	if (ts->buffer) gf_free(ts->buffer);
 	while (gf_list_count(ts->programs)) {
 		GF_M2TS_Program *p = (GF_M2TS_Program *)gf_list_last(ts->programs);
 		gf_list_rem_last(ts->programs);
@@ -3819,6 +4344,8 @@ void gf_m2ts_demux_del(GF_M2TS_Demuxer *ts)
 		gf_th_del(ts->th);
 
 	if (ts->socket_url) gf_free(ts->socket_url);
+	if (ts->index) gf_m2ts_index_del(ts->index);
+	gf_m2ts_demux_enable_stats(ts, GF_FALSE, 0);
 	gf_free(ts);
 }
 
@@ -3853,10 +4380,17 @@ GF_Err gf_m2ts_demux_file(GF_M2TS_Demuxer *ts, const char *fileName, u64 start_b
 	else if (fileName && !strnicmp(fileName, "gmem://", 7)) {
 		void *mem_address;
 		u32 remain;
+#ifndef GPAC_DISABLE_CORE_TOOLS
+		GF_CacheBlob *blob;
+#endif
 		if (sscanf(fileName, "gmem://%d@%p", &size, &mem_address) != 2) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[M2TSDemux] Cannot open next file %s\n", fileName));
 			return GF_URL_ERROR;
 		}
+#ifndef GPAC_DISABLE_CORE_TOOLS
+		/*the downloader may delete or rewrite the segment while we parse it*/
+		blob = gf_cache_blob_get(fileName);
+#endif
 		if (refresh_type==0)
 			ts->pos_in_stream = 0;
 
@@ -3870,6 +4404,9 @@ GF_Err gf_m2ts_demux_file(GF_M2TS_Demuxer *ts, const char *fileName, u64 start_b
 		/*process chunk*/
 		ts->abort_parsing = GF_FALSE;
 		e = gf_m2ts_process_data(ts, mem_address, size);
+#ifndef GPAC_DISABLE_CORE_TOOLS
+		gf_cache_blob_release(blob);
+#endif
 
 		if (refresh_type==2)
 			ts->pos_in_stream = 0;
@@ -3952,6 +4489,424 @@ GF_Err gf_m2ts_demux_file(GF_M2TS_Demuxer *ts, const char *fileName, u64 start_b
 	return GF_OK;
 }
 
+#define M2TS_INDEX_MAGIC	GF_4CC('G','T','S','I')
+#define M2TS_INDEX_VERSION	2
+#define M2TS_INDEX_IO_BYTES	18800
+
+static void gf_m2ts_index_get_name(const char *fileName, char *szName)
+{
+	strcpy(szName, fileName);
+	strcat(szName, ".tsidx");
+}
+
+static void gf_m2ts_index_add_entry(GF_M2TS_Index *index, GF_M2TS_IndexEntry *entry)
+{
+	if (index->nb_entries == index->nb_alloc) {
+		index->nb_alloc = index->nb_alloc ? 2*index->nb_alloc : 1024;
+		index->entries = (GF_M2TS_IndexEntry *) gf_realloc(index->entries, sizeof(GF_M2TS_IndexEntry)*index->nb_alloc);
+	}
+	index->entries[index->nb_entries] = *entry;
+	index->nb_entries++;
+}
+
+GF_EXPORT
+Bool gf_m2ts_index_get_event_entry(GF_M2TS_Demuxer *ts, u32 evt_type, void *par, GF_M2TS_IndexEntry *entry)
+{
+	GF_M2TS_PES_PCK *pck;
+	GF_M2TS_PES *pes;
+
+	memset(entry, 0, sizeof(GF_M2TS_IndexEntry));
+	entry->evt_type = evt_type;
+	entry->offset = (u64) (ts->pck_number-1)*188;
+
+	switch (evt_type) {
+	case GF_M2TS_EVT_PAT_FOUND:
+	case GF_M2TS_EVT_PAT_UPDATE:
+	case GF_M2TS_EVT_PAT_REPEAT:
+	case GF_M2TS_EVT_CAT_FOUND:
+	case GF_M2TS_EVT_CAT_UPDATE:
+	case GF_M2TS_EVT_CAT_REPEAT:
+		return GF_TRUE;
+	case GF_M2TS_EVT_PMT_FOUND:
+	case GF_M2TS_EVT_PMT_UPDATE:
+	case GF_M2TS_EVT_PMT_REPEAT:
+		entry->pid = ((GF_M2TS_Program *)par)->pcr_pid;
+		return GF_TRUE;
+	case GF_M2TS_EVT_PES_PCK:
+		pck = (GF_M2TS_PES_PCK *)par;
+		pes = pck->stream;
+		entry->pid = pes->pid;
+		entry->PTS = pck->PTS;
+		entry->DTS = pck->DTS;
+		entry->pes_offset = (u64) (pes->pes_start_packet_number-1)*188;
+		if (pck->flags & GF_M2TS_PES_PCK_RAP) entry->flags |= GF_M2TS_INDEX_RAP;
+		if (pes->program && (pes->pid == pes->program->pcr_pid)) entry->flags |= GF_M2TS_INDEX_PCR_PID;
+		switch (pes->stream_type) {
+		case GF_M2TS_VIDEO_MPEG1:
+		case GF_M2TS_VIDEO_MPEG2:
+		case GF_M2TS_VIDEO_DCII:
+		case GF_M2TS_VIDEO_MPEG4:
+		case GF_M2TS_VIDEO_H264:
+		case GF_M2TS_VIDEO_SVC:
+		case GF_M2TS_VIDEO_HEVC:
+		case GF_M2TS_VIDEO_SHVC:
+		case GF_M2TS_VIDEO_VC1:
+			entry->flags |= GF_M2TS_INDEX_VIDEO;
+			break;
+		}
+
+		/* Interpolated PCR value for the TS packet containing the PES header start */
+		if (pes->last_pcr_value && pes->before_last_pcr_value_pck_number && pes->last_pcr_value > pes->before_last_pcr_value) {
+			u32 delta_pcr_pck_num = pes->last_pcr_value_pck_number - pes->before_last_pcr_value_pck_number;
+			u32 delta_pts_pcr_pck_num = pes->pes_start_packet_number - pes->last_pcr_value_pck_number;
+			u64 delta_pcr_value = pes->last_pcr_value - pes->before_last_pcr_value;
+			if ((pes->pes_start_packet_number > pes->last_pcr_value_pck_number)
+			        && (pes->last_pcr_value > pes->before_last_pcr_value)) {
+
+				pes->last_pcr_value = pes->before_last_pcr_value;
+			}
+			/* we can compute the interpolated pcr value for the packet containing the PES header */
+			entry->interpolated_pcr = pes->last_pcr_value + (u64)((delta_pcr_value*delta_pts_pcr_pck_num*1.0)/delta_pcr_pck_num);
+			entry->flags |= GF_M2TS_INDEX_PCR_INTERPOLATED;
+		}
+		entry->last_pcr = pes->last_pcr_value;
+		return GF_TRUE;
+	case GF_M2TS_EVT_PES_PCR:
+		pck = (GF_M2TS_PES_PCK *)par;
+		entry->pid = pck->stream->pid;
+		entry->PTS = pck->PTS;
+		return GF_TRUE;
+	}
+	return GF_FALSE;
+}
+
+static void gf_m2ts_index_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
+{
+	GF_M2TS_IndexEntry entry;
+	GF_M2TS_Index *index = (GF_M2TS_Index *)ts->user;
+
+	if (evt_type == GF_M2TS_EVT_PMT_FOUND) {
+		u32 i, count;
+		GF_M2TS_Program *prog = (GF_M2TS_Program *)par;
+		if (!index->pcr_pid) index->pcr_pid = prog->pcr_pid;
+		count = gf_list_count(prog->streams);
+		for (i=0; i<count; i++) {
+			GF_M2TS_ES *es = (GF_M2TS_ES *)gf_list_get(prog->streams, i);
+			gf_m2ts_set_pes_framing((GF_M2TS_PES *)es, GF_M2TS_PES_FRAMING_DEFAULT);
+		}
+	}
+	if (gf_m2ts_index_get_event_entry(ts, evt_type, par, &entry))
+		gf_m2ts_index_add_entry(index, &entry);
+}
+
+GF_EXPORT
+GF_M2TS_Index *gf_m2ts_index_build(const char *fileName)
+{
+	GF_M2TS_Demuxer *ts;
+	GF_M2TS_Index *index;
+	char data[M2TS_INDEX_IO_BYTES];
+	FILE *f = gf_fopen(fileName, "rb");
+	if (!f) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[M2TSDemux] Cannot open %s for indexing\n", fileName));
+		return NULL;
+	}
+	GF_SAFEALLOC(index, GF_M2TS_Index);
+	if (!index) {
+		gf_fclose(f);
+		return NULL;
+	}
+	gf_fseek(f, 0, SEEK_END);
+	index->file_size = gf_ftell(f);
+	gf_fseek(f, 0, SEEK_SET);
+	index->file_mtime = gf_file_modification_time(fileName);
+
+	ts = gf_m2ts_demux_new();
+	ts->on_event = gf_m2ts_index_on_event;
+	ts->notify_pes_timing = GF_TRUE;
+	ts->user = index;
+
+	/*PES are not flushed at the end of the file, as done by the DASH segmenter*/
+	while (!feof(f)) {
+		u32 size = (u32) fread(data, 1, M2TS_INDEX_IO_BYTES, f);
+		gf_m2ts_process_data(ts, data, size);
+		if (size<M2TS_INDEX_IO_BYTES) break;
+	}
+	gf_m2ts_demux_del(ts);
+	gf_fclose(f);
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[M2TSDemux] Indexed %s: %d entries\n", fileName, index->nb_entries));
+	return index;
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_index_save(GF_M2TS_Index *index, const char *fileName)
+{
+	u32 i;
+	FILE *f;
+	GF_BitStream *bs;
+	char szName[GF_MAX_PATH];
+
+	gf_m2ts_index_get_name(fileName, szName);
+	f = gf_fopen(szName, "wb");
+	if (!f) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[M2TSDemux] Cannot create index file %s\n", szName));
+		return GF_IO_ERR;
+	}
+	bs = gf_bs_from_file(f, GF_BITSTREAM_WRITE);
+	gf_bs_write_u32(bs, M2TS_INDEX_MAGIC);
+	gf_bs_write_u32(bs, M2TS_INDEX_VERSION);
+	gf_bs_write_u64(bs, index->file_size);
+	gf_bs_write_u64(bs, index->file_mtime);
+	gf_bs_write_u16(bs, index->pcr_pid);
+	gf_bs_write_u32(bs, index->nb_entries);
+	for (i=0; i<index->nb_entries; i++) {
+		GF_M2TS_IndexEntry *ent = &index->entries[i];
+		gf_bs_write_u64(bs, ent->offset);
+		gf_bs_write_u64(bs, ent->pes_offset);
+		gf_bs_write_u64(bs, ent->PTS);
+		gf_bs_write_u64(bs, ent->DTS);
+		gf_bs_write_u64(bs, ent->interpolated_pcr);
+		gf_bs_write_u64(bs, ent->last_pcr);
+		gf_bs_write_u8(bs, ent->evt_type);
+		gf_bs_write_u8(bs, ent->flags);
+		gf_bs_write_u16(bs, ent->pid);
+	}
+	gf_bs_del(bs);
+	if (gf_fclose(f)) return GF_IO_ERR;
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_M2TS_Index *gf_m2ts_index_load(const char *fileName)
+{
+	u32 i, nb_entries, size;
+	u64 file_size;
+	char *data;
+	FILE *f;
+	GF_BitStream *bs;
+	GF_M2TS_Index *index;
+	char szName[GF_MAX_PATH];
+
+	f = gf_fopen(fileName, "rb");
+	if (!f) return NULL;
+	gf_fseek(f, 0, SEEK_END);
+	file_size = gf_ftell(f);
+	gf_fclose(f);
+
+	/*load the whole index at once, parsing it from the file is much slower*/
+	gf_m2ts_index_get_name(fileName, szName);
+	f = gf_fopen(szName, "rb");
+	if (!f) return NULL;
+	gf_fseek(f, 0, SEEK_END);
+	size = (u32) gf_ftell(f);
+	gf_fseek(f, 0, SEEK_SET);
+	data = (char *) gf_malloc(sizeof(char) * (size ? size : 1));
+	size = (u32) fread(data, 1, size, f);
+	gf_fclose(f);
+	bs = gf_bs_new(data, size, GF_BITSTREAM_READ);
+
+	index = NULL;
+	if ((gf_bs_read_u32(bs) != M2TS_INDEX_MAGIC) || (gf_bs_read_u32(bs) != M2TS_INDEX_VERSION)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[M2TSDemux] Unsupported index file %s, ignoring\n", szName));
+		goto exit;
+	}
+	/*TS file modified since indexing*/
+	if ((gf_bs_read_u64(bs) != file_size) || (gf_bs_read_u64(bs) != gf_file_modification_time(fileName))) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[M2TSDemux] Index file %s is outdated, ignoring\n", szName));
+		goto exit;
+	}
+	GF_SAFEALLOC(index, GF_M2TS_Index);
+	if (!index) goto exit;
+	index->file_size = file_size;
+	index->file_mtime = gf_file_modification_time(fileName);
+	index->pcr_pid = gf_bs_read_u16(bs);
+	nb_entries = gf_bs_read_u32(bs);
+	if (gf_bs_available(bs) < (u64) nb_entries * 52) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[M2TSDemux] Truncated index file %s, ignoring\n", szName));
+		gf_free(index);
+		index = NULL;
+		goto exit;
+	}
+	index->entries = (GF_M2TS_IndexEntry *) gf_malloc(sizeof(GF_M2TS_IndexEntry) * (nb_entries ? nb_entries : 1));
+	index->nb_entries = index->nb_alloc = nb_entries;
+	for (i=0; i<nb_entries; i++) {
+		GF_M2TS_IndexEntry *ent = &index->entries[i];
+		ent->offset = gf_bs_read_u64(bs);
+		ent->pes_offset = gf_bs_read_u64(bs);
+		ent->PTS = gf_bs_read_u64(bs);
+		ent->DTS = gf_bs_read_u64(bs);
+		ent->interpolated_pcr = gf_bs_read_u64(bs);
+		ent->last_pcr = gf_bs_read_u64(bs);
+		ent->evt_type = gf_bs_read_u8(bs);
+		ent->flags = gf_bs_read_u8(bs);
+		ent->pid = gf_bs_read_u16(bs);
+	}
+
+exit:
+	gf_bs_del(bs);
+	gf_free(data);
+	return index;
+}
+
+GF_EXPORT
+GF_M2TS_Index *gf_m2ts_index_open(const char *fileName, Bool build)
+{
+	GF_M2TS_Index *index = gf_m2ts_index_load(fileName);
+	if (index || !build) return index;
+
+	index = gf_m2ts_index_build(fileName);
+	/*the index is still usable if it cannot be saved*/
+	if (index) gf_m2ts_index_save(index, fileName);
+	return index;
+}
+
+GF_EXPORT
+void gf_m2ts_index_del(GF_M2TS_Index *index)
+{
+	if (!index) return;
+	if (index->entries) gf_free(index->entries);
+	if (index->raps) gf_free(index->raps);
+	gf_free(index);
+}
+
+GF_EXPORT
+Double gf_m2ts_index_get_duration(GF_M2TS_Index *index)
+{
+	u32 i, nb_pes;
+	u64 first_PTS, last_PTS, last_DTS;
+	u32 last_frame_duration;
+
+	/*same computation as the full file scan, on the PES of the PCR PIDs*/
+	nb_pes = 0;
+	first_PTS = last_PTS = last_DTS = 0;
+	last_frame_duration = 0;
+	for (i=0; i<index->nb_entries; i++) {
+		GF_M2TS_IndexEntry *ent = &index->entries[i];
+		if (ent->evt_type != GF_M2TS_EVT_PES_PCK) continue;
+		if (!(ent->flags & GF_M2TS_INDEX_PCR_PID)) continue;
+
+		if (!nb_pes || (first_PTS > ent->PTS)) {
+			first_PTS = ent->PTS;
+			nb_pes++;
+		}
+		if (ent->PTS > last_PTS) {
+			last_PTS = ent->PTS;
+		}
+		if (last_DTS != ent->DTS) {
+			last_frame_duration = (u32) (ent->DTS - last_DTS);
+			last_DTS = ent->DTS;
+		}
+	}
+	return (last_PTS + last_frame_duration - first_PTS)/90000.0;
+}
+
+/*PID used for seeking when none is given: the first video PID with RAPs, otherwise the PCR PID if it has RAPs
+(a dedicated PCR PID has no PES), otherwise the first PID with RAPs*/
+static u16 gf_m2ts_index_get_seek_pid(GF_M2TS_Index *index)
+{
+	u32 i;
+	u16 pid = 0;
+	u8 *pid_flags = (u8 *) gf_malloc(sizeof(u8) * GF_M2TS_MAX_STREAMS);
+	if (!pid_flags) return 0;
+	memset(pid_flags, 0, sizeof(u8) * GF_M2TS_MAX_STREAMS);
+
+	for (i=0; i<index->nb_entries; i++) {
+		GF_M2TS_IndexEntry *ent = &index->entries[i];
+		if (ent->evt_type != GF_M2TS_EVT_PES_PCK) continue;
+		if (ent->flags & GF_M2TS_INDEX_RAP) pid_flags[ent->pid] |= 1;
+		if (ent->flags & GF_M2TS_INDEX_VIDEO) pid_flags[ent->pid] |= 2;
+	}
+	for (i=0; i<index->nb_entries; i++) {
+		GF_M2TS_IndexEntry *ent = &index->entries[i];
+		if ((ent->evt_type == GF_M2TS_EVT_PES_PCK) && (pid_flags[ent->pid] == 3)) {
+			pid = ent->pid;
+			break;
+		}
+	}
+	if (!pid && (pid_flags[index->pcr_pid] & 1)) pid = index->pcr_pid;
+	if (!pid) {
+		for (i=0; i<index->nb_entries; i++) {
+			GF_M2TS_IndexEntry *ent = &index->entries[i];
+			if ((ent->evt_type == GF_M2TS_EVT_PES_PCK) && (pid_flags[ent->pid] & 1)) {
+				pid = ent->pid;
+				break;
+			}
+		}
+	}
+	gf_free(pid_flags);
+	return pid;
+}
+
+static int gf_m2ts_index_rap_cmp(const void *a, const void *b)
+{
+	const GF_M2TS_IndexEntry *e1 = *(const GF_M2TS_IndexEntry **)a;
+	const GF_M2TS_IndexEntry *e2 = *(const GF_M2TS_IndexEntry **)b;
+	if (e1->PTS < e2->PTS) return -1;
+	if (e1->PTS > e2->PTS) return 1;
+	/*keep file order*/
+	if (e1 < e2) return -1;
+	if (e1 > e2) return 1;
+	return 0;
+}
+
+/*lists the RAP entries of the PID, sorted by PTS - entries before the first PTS of the PID (timestamp wrap) are ignored*/
+static void gf_m2ts_index_sort_raps(GF_M2TS_Index *index, u16 pid)
+{
+	u32 i;
+	Bool first_found = GF_FALSE;
+
+	index->rap_pid = pid;
+	index->nb_raps = 0;
+	index->rap_first_PTS = 0;
+	if (index->raps) gf_free(index->raps);
+	index->raps = NULL;
+	for (i=0; i<index->nb_entries; i++) {
+		GF_M2TS_IndexEntry *ent = &index->entries[i];
+		if (ent->evt_type != GF_M2TS_EVT_PES_PCK) continue;
+		if (ent->pid != pid) continue;
+		if (!first_found) {
+			first_found = GF_TRUE;
+			index->rap_first_PTS = ent->PTS;
+		}
+		if (!(ent->flags & GF_M2TS_INDEX_RAP)) continue;
+		if (ent->PTS < index->rap_first_PTS) continue;
+		if (!index->raps) index->raps = (GF_M2TS_IndexEntry **) gf_malloc(sizeof(GF_M2TS_IndexEntry *) * index->nb_entries);
+		index->raps[index->nb_raps] = ent;
+		index->nb_raps++;
+	}
+	if (index->nb_raps > 1)
+		qsort(index->raps, index->nb_raps, sizeof(GF_M2TS_IndexEntry *), gf_m2ts_index_rap_cmp);
+}
+
+GF_EXPORT
+Bool gf_m2ts_index_find_rap(GF_M2TS_Index *index, u16 pid, u32 time_ms, u64 *offset, u64 *PTS)
+{
+	u32 low, high;
+	u64 target;
+
+	if (!pid) {
+		if (!index->seek_pid) index->seek_pid = gf_m2ts_index_get_seek_pid(index);
+		pid = index->seek_pid;
+		if (!pid) return GF_FALSE;
+	}
+	if (pid != index->rap_pid) gf_m2ts_index_sort_raps(index, pid);
+
+	/*last RAP with PTS at or before the target*/
+	target = index->rap_first_PTS + (u64) time_ms * 90;
+	low = 0;
+	high = index->nb_raps;
+	while (low < high) {
+		u32 mid = (low + high) / 2;
+		if (index->raps[mid]->PTS <= target) low = mid + 1;
+		else high = mid;
+	}
+	if (!low) return GF_FALSE;
+
+	if (offset) *offset = index->raps[low-1]->pes_offset;
+	if (PTS) *PTS = index->raps[low-1]->PTS;
+	return GF_TRUE;
+}
+
 
 static u32 gf_m2ts_demuxer_run(void *_p)
 {
@@ -3990,11 +4945,19 @@ static u32 gf_m2ts_demuxer_run(void *_p)
 			GF_RTPReorder *ch = NULL;
 #endif
 			u32 nb_empty=0;
+			u32 j, nb_dgrams;
 			Bool first_run, is_rtp;
+			GF_SockDatagram dgrams[GF_M2TS_UDP_BUFFER_SIZE/GF_M2TS_UDP_DATAGRAM_SIZE];
 			FILE *record_to = NULL;
 			if (ts->record_to)
 				record_to = gf_fopen(ts->record_to, "wb");
 
+			/*the UDP buffer is split in datagram slots so that all pending datagrams are fetched at once*/
+			for (i=0; i<GF_M2TS_UDP_BUFFER_SIZE/GF_M2TS_UDP_DATAGRAM_SIZE; i++) {
+				dgrams[i].data = data + i*GF_M2TS_UDP_DATAGRAM_SIZE;
+				dgrams[i].size = GF_M2TS_UDP_DATAGRAM_SIZE;
+			}
+
 			first_run = 1;
 			is_rtp = 0;
 			while (ts->run_state) {
@@ -4002,10 +4965,10 @@ static u32 gf_m2ts_demuxer_run(void *_p)
 					gf_sleep(1);
 					continue;
 				}
-				size = 0;
+				nb_dgrams = 0;
 				/*m2ts chunks by chunks*/
-				e = gf_sk_receive(ts->sock, data, GF_M2TS_UDP_BUFFER_SIZE, 0, &size);
-				if (!size || e) {
+				e = gf_sk_receive_batch(ts->sock, dgrams, GF_M2TS_UDP_BUFFER_SIZE/GF_M2TS_UDP_DATAGRAM_SIZE, &nb_dgrams);
+				if (!nb_dgrams || e) {
 					nb_empty++;
 					if (nb_empty==1000) {
 						gf_sleep(1);
@@ -4013,40 +4976,46 @@ static u32 gf_m2ts_demuxer_run(void *_p)
 					}
 					continue;
 				}
-				if (first_run) {
-					first_run = 0;
-					/*FIXME: we assume only simple RTP packaging (no CSRC nor extensions)*/
-					if ((data[0] != 0x47) && ((data[1] & 0x7F) == 33) ) {
-						is_rtp = 1;
+				for (j=0; j<nb_dgrams; j++) {
+					char *dg_data = dgrams[j].data;
+					size = dgrams[j].read;
+					if (!size) continue;
+
+					if (first_run) {
+						first_run = 0;
+						/*FIXME: we assume only simple RTP packaging (no CSRC nor extensions)*/
+						if ((dg_data[0] != 0x47) && ((dg_data[1] & 0x7F) == 33) ) {
+							is_rtp = 1;
 #ifndef GPAC_DISABLE_STREAMING
-						ch = gf_rtp_reorderer_new(100, 500);
+							ch = gf_rtp_reorderer_new(100, 500);
 #endif
+						}
 					}
-				}
-				/*process chunk*/
-				if (is_rtp) {
+					/*process chunk*/
+					if (is_rtp) {
 #ifndef GPAC_DISABLE_STREAMING
-					char *pck;
-					seq_num = ((data[2] << 8) & 0xFF00) | (data[3] & 0xFF);
-					gf_rtp_reorderer_add(ch, (void *) data, size, seq_num);
-
-					pck = (char *) gf_rtp_reorderer_get(ch, &size);
-					if (pck) {
-						gf_m2ts_process_data(ts, pck+12, size-12);
-						if (record_to)
-							fwrite(data+12, size-12, 1, record_to);
-						gf_free(pck);
-					}
+						char *pck;
+						seq_num = ((dg_data[2] << 8) & 0xFF00) | (dg_data[3] & 0xFF);
+						gf_rtp_reorderer_add(ch, (void *) dg_data, size, seq_num);
+
+						pck = (char *) gf_rtp_reorderer_get(ch, &size);
+						if (pck) {
+							gf_m2ts_process_data(ts, pck+12, size-12);
+							if (record_to)
+								fwrite(dg_data+12, size-12, 1, record_to);
+							gf_free(pck);
+						}
 #else
-					gf_m2ts_process_data(ts, data+12, size-12);
-					if (record_to)
-						fwrite(data+12, size-12, 1, record_to);
+						gf_m2ts_process_data(ts, dg_data+12, size-12);
+						if (record_to)
+							fwrite(dg_data+12, size-12, 1, record_to);
 #endif
 
-				} else {
-					gf_m2ts_process_data(ts, data, size);
-					if (record_to)
-						fwrite(data, size, 1, record_to);
+					} else {
+						gf_m2ts_process_data(ts, dg_data, size);
+						if (record_to)
+							fwrite(dg_data, size, 1, record_to);
+					}
 				}
 			}
 			if (record_to)
@@ -4065,7 +5034,7 @@ static u32 gf_m2ts_demuxer_run(void *_p)
 				gf_sleep(1);
 			}
 		} else {
-			u32 pos = 0;
+			u64 pos = 0;
 			GF_BitStream *ts_bs = NULL;
 
 			if (ts->file)
@@ -4082,9 +5051,16 @@ static u32 gf_m2ts_demuxer_run(void *_p)
 					continue;
 				}
 
-				if (ts->start_range && ts->duration) {
+				/*seek to the PES start of the last RAP before the target time, or estimate the position from the duration if no RAP is indexed*/
+				if (ts->start_range && ts->file && ts->index && gf_m2ts_index_find_rap(ts->index, 0, ts->start_range, &pos, NULL)) {
+					if (pos>=ts->file_size) {
+						pos = 0;
+					}
+					ts->start_range = 0;
+					gf_bs_seek(ts_bs, pos);
+				} else if (ts->start_range && ts->duration) {
 					Double perc = ts->start_range / (1000 * ts->duration);
-					pos = (u32) (s64) (perc * ts->file_size);
+					pos = (u64) (perc * ts->file_size);
 					/*align to TS packet size*/
 					pos/=188;
 					pos*=188;
@@ -4121,7 +5097,7 @@ static u32 gf_m2ts_demuxer_run(void *_p)
 			ts->force_file_refresh = 0;
 
 			if (ts_bs) {
-				pos = (u32) gf_bs_get_position(ts_bs);
+				pos = gf_bs_get_position(ts_bs);
 				gf_bs_del(ts_bs);
 				ts_bs = NULL;
 			}
@@ -4453,6 +5429,8 @@ static GF_Err gf_m2ts_demuxer_setup_file(GF_M2TS_Demuxer *ts, char *url)
 			gf_fseek(ts->file, 0, SEEK_END);
 			ts->file_size = gf_ftell(ts->file);
 			gf_fseek(ts->file, 0, SEEK_SET);
+
+			if (ts->index) ts->duration = gf_m2ts_index_get_duration(ts->index);
 		}
 	}
 
@@ -61,6 +61,13 @@ struct __tag_bitstream
 
 	char *buffer_io;
 	u32 buffer_io_size, buffer_written;
+
+	/*read-ahead cache for file read mode - the file position is always position + cache_read_size - cache_read_pos*/
+	char *cache_read;
+	u32 cache_read_alloc, cache_read_size, cache_read_pos;
+
+	/*opaque value set by the user*/
+	u64 cookie;
 };
 
 
@@ -175,6 +182,45 @@ u32 gf_bs_get_output_buffering(GF_BitStream *bs)
 	return bs ? bs->buffer_io_size : 0;
 }
 
+GF_EXPORT
+GF_Err gf_bs_set_input_buffering(GF_BitStream *bs, u32 size)
+{
+	if (!bs->stream) return GF_OK;
+	if (bs->bsmode != GF_BITSTREAM_FILE_READ) {
+		return GF_OK;
+	}
+	/*drop the read-ahead data and move the file back to our position*/
+	if (bs->cache_read_pos != bs->cache_read_size)
+		gf_fseek(bs->stream, bs->position, SEEK_SET);
+	bs->cache_read_size = bs->cache_read_pos = 0;
+	if (!size) {
+		if (bs->cache_read) gf_free(bs->cache_read);
+		bs->cache_read = NULL;
+		bs->cache_read_alloc = 0;
+		return GF_OK;
+	}
+	bs->cache_read = (char*)gf_realloc(bs->cache_read, size);
+	if (!bs->cache_read) {
+		bs->cache_read_alloc = 0;
+		return GF_OUT_OF_MEM;
+	}
+	bs->cache_read_alloc = size;
+	return GF_OK;
+}
+
+GF_EXPORT
+u32 gf_bs_get_input_buffering(GF_BitStream *bs)
+{
+	return bs ? bs->cache_read_alloc : 0;
+}
+
+static Bool bs_refill_read_cache(GF_BitStream *bs)
+{
+	bs->cache_read_pos = 0;
+	bs->cache_read_size = (u32) fread(bs->cache_read, 1, bs->cache_read_alloc, bs->stream);
+	return bs->cache_read_size ? GF_TRUE : GF_FALSE;
+}
+
 GF_EXPORT
 void gf_bs_del(GF_BitStream *bs)
 {
@@ -183,6 +229,7 @@ void gf_bs_del(GF_BitStream *bs)
 	if ((bs->bsmode == GF_BITSTREAM_WRITE_DYN) && bs->original) gf_free(bs->original);
 	if (bs->buffer_io)
 		bs_flush_cache(bs);
+	if (bs->cache_read) gf_free(bs->cache_read);
 	gf_free(bs);
 }
 
@@ -213,6 +260,15 @@ static u8 BS_ReadByte(GF_BitStream *bs)
 	if (bs->buffer_io)
 		bs_flush_cache(bs);
 
+	if (bs->cache_read) {
+		if ((bs->cache_read_pos < bs->cache_read_size) || bs_refill_read_cache(bs)) {
+			bs->position++;
+			return (u8) bs->cache_read[bs->cache_read_pos++];
+		}
+		if (bs->EndOfStream) bs->EndOfStream(bs->par);
+		return 0;
+	}
+
 	/*we are in FILE mode, test for end of file*/
 	if (!feof(bs->stream)) {
 		bs->position++;
@@ -255,6 +311,30 @@ u32 gf_bs_read_int(GF_BitStream *bs, u32 nBits)
 {
 	u32 ret;
 
+	/*read modes: gather the remaining bits of the current byte and the needed bytes in a 64 bit word
+	rather than going bit by bit. The current byte is kept as current << nbBits as done by gf_bs_read_bit*/
+	if ((nBits <= 32) && ((bs->bsmode == GF_BITSTREAM_READ) || (bs->bsmode == GF_BITSTREAM_FILE_READ))) {
+		u64 cache;
+		u32 byte, nb_cache;
+		if (!nBits) return 0;
+
+		nb_cache = 8 - bs->nbBits;
+		byte = bs->current >> bs->nbBits;
+		cache = byte & ((1 << nb_cache) - 1);
+		if (nBits <= nb_cache) {
+			bs->nbBits += nBits;
+		} else {
+			while (nb_cache < nBits) {
+				byte = BS_ReadByte(bs);
+				cache = (cache << 8) | byte;
+				nb_cache += 8;
+			}
+			bs->nbBits = 8 - (nb_cache - nBits);
+		}
+		bs->current = byte << bs->nbBits;
+		return (u32) ((cache >> (nb_cache - nBits)) & (0xFFFFFFFF >> (32 - nBits)));
+	}
+
 #ifndef NO_OPTS
 	if (nBits + bs->nbBits <= 8) {
 		bs->nbBits += nBits;
@@ -357,15 +437,72 @@ u64 gf_bs_read_long_int(GF_BitStream *bs, u32 nBits)
 	if (nBits>64) {
 		gf_bs_read_long_int(bs, nBits-64);
 		ret = gf_bs_read_long_int(bs, 64);
+	} else if (nBits>32) {
+		ret = gf_bs_read_int(bs, nBits-32);
+		ret <<= 32;
+		ret |= gf_bs_read_int(bs, 32);
 	} else {
-		while (nBits-- > 0) {
-			ret <<= 1;
-			ret |= gf_bs_read_bit(bs);
-		}
+		ret = gf_bs_read_int(bs, nBits);
 	}
 	return ret;
 }
 
+/*number of leading zero bits in a non-null byte*/
+static GFINLINE u32 bs_clz8(u32 val)
+{
+#if defined(__GNUC__)
+	return __builtin_clz(val) - 24;
+#else
+	u32 res = 0;
+	while (!(val & 0x80)) {
+		val <<= 1;
+		res++;
+	}
+	return res;
+#endif
+}
+
+GF_EXPORT
+u32 gf_bs_read_ue(GF_BitStream *bs)
+{
+	u32 nb_zeros = 0;
+	if ((bs->bsmode != GF_BITSTREAM_READ) && (bs->bsmode != GF_BITSTREAM_FILE_READ)) return 0;
+
+	/*count the leading zeros a byte at a time, then skip them and the marker bit*/
+	while (1) {
+		u32 left = 8 - bs->nbBits;
+		u32 byte = bs->current >> bs->nbBits;
+		u32 val = byte & ((1 << left) - 1);
+		if (val) {
+			u32 zeros = bs_clz8(val) - bs->nbBits;
+			nb_zeros += zeros;
+			bs->nbBits += zeros + 1;
+			bs->current = byte << bs->nbBits;
+			break;
+		}
+		nb_zeros += left;
+		if ((nb_zeros > 31) || (bs->position >= bs->size)) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[BS] Invalid exp-Golomb code or not enough bits in bitstream\n"));
+			return 0;
+		}
+		bs->current = BS_ReadByte(bs);
+		bs->nbBits = 0;
+	}
+	if (nb_zeros > 31) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[BS] Invalid exp-Golomb code: %d leading zeros\n", nb_zeros));
+		return 0;
+	}
+	return ((u32)1 << nb_zeros) - 1 + gf_bs_read_int(bs, nb_zeros);
+}
+
+GF_EXPORT
+s32 gf_bs_read_se(GF_BitStream *bs)
+{
+	u32 v = gf_bs_read_ue(bs);
+	if ((v & 0x1) == 0) return (s32) (0 - (v>>1));
+	return (v + 1) >> 1;
+}
+
 
 GF_EXPORT
 Float gf_bs_read_float(GF_BitStream *bs)
@@ -413,6 +550,27 @@ u32 gf_bs_read_data(GF_BitStream *bs, char *data, u32 nbBytes)
 		case GF_BITSTREAM_FILE_WRITE:
 			if (bs->buffer_io)
 				bs_flush_cache(bs);
+			if (bs->cache_read) {
+				u32 done = 0;
+				while (done < nbBytes) {
+					u32 avail = bs->cache_read_size - bs->cache_read_pos;
+					if (!avail) {
+						/*large reads go directly to the file*/
+						if (nbBytes - done >= bs->cache_read_alloc) {
+							done += (u32) fread(data + done, 1, nbBytes - done, bs->stream);
+							break;
+						}
+						if (!bs_refill_read_cache(bs)) break;
+						continue;
+					}
+					if (avail > nbBytes - done) avail = nbBytes - done;
+					memcpy(data + done, bs->cache_read + bs->cache_read_pos, avail);
+					bs->cache_read_pos += avail;
+					done += avail;
+				}
+				bs->position += done;
+				return done;
+			}
 			nbBytes = (u32) fread(data, 1, nbBytes, bs->stream);
 			bs->position += nbBytes;
 			return nbBytes;
@@ -794,6 +952,8 @@ void gf_bs_get_content(GF_BitStream *bs, char **output, u32 *outSize)
 	If READ (MEM or FILE) mode, just read n times 8 bit
 	If WRITE (MEM or FILE) mode, write n times 0 on 8 bit
 */
+static GF_Err BS_SeekIntern(GF_BitStream *bs, u64 offset);
+
 GF_EXPORT
 void gf_bs_skip_bytes(GF_BitStream *bs, u64 nbBytes)
 {
@@ -805,8 +965,14 @@ void gf_bs_skip_bytes(GF_BitStream *bs, u64 nbBytes)
 	if ((bs->bsmode == GF_BITSTREAM_FILE_WRITE) || (bs->bsmode == GF_BITSTREAM_FILE_READ)) {
 		if (bs->buffer_io)
 			bs_flush_cache(bs);
+		if (bs->cache_read) {
+			BS_SeekIntern(bs, bs->position + nbBytes);
+			return;
+		}
 		gf_fseek(bs->stream, nbBytes, SEEK_CUR);
 		bs->position += nbBytes;
+		/*data may have been written to the underlying file by other means*/
+		if ((bs->bsmode == GF_BITSTREAM_FILE_WRITE) && (bs->position > bs->size)) bs->size = bs->position;
 		return;
 	}
 
@@ -868,6 +1034,19 @@ static GF_Err BS_SeekIntern(GF_BitStream *bs, u64 offset)
 	if (bs->buffer_io)
 		bs_flush_cache(bs);
 
+	if (bs->cache_read) {
+		u64 cache_start = bs->position - bs->cache_read_pos;
+		/*seek in the read-ahead data*/
+		if ((offset >= cache_start) && (offset < cache_start + bs->cache_read_size)) {
+			bs->cache_read_pos = (u32) (offset - cache_start);
+			bs->position = offset;
+			bs->current = 0;
+			bs->nbBits = 8;
+			return GF_OK;
+		}
+		bs->cache_read_size = bs->cache_read_pos = 0;
+	}
+
 	gf_fseek(bs->stream, offset, SEEK_SET);
 
 	bs->position = offset;
@@ -1089,3 +1268,20 @@ void gf_bs_reassign(GF_BitStream *bs, FILE *stream)
 		break;
 	}
 }
+
+GF_EXPORT
+u64 gf_bs_set_cookie(GF_BitStream *bs, u64 cookie)
+{
+	u64 res = 0;
+	if (!bs) return 0;
+	res = bs->cookie;
+	bs->cookie = cookie;
+	return res;
+}
+
+GF_EXPORT
+u64 gf_bs_get_cookie(GF_BitStream *bs)
+{
+	if (!bs) return 0;
+	return bs->cookie;
+}
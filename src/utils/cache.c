@@ -162,10 +162,178 @@ struct __DownloadedCacheEntryStruct
 	* Set to 1 if file is not stored on disk
 	*/
 	Bool memory_stored;
-	u32 mem_allocated;
-	u8 *mem_storage;
+	/**
+	* Memory blob of the entry and its gmem:// URL
+	*/
+	GF_CacheBlob *blob;
+	char mem_url[64];
+	/**
+	* Set to 1 if a memory stored file is also written in the disk cache for later replay
+	*/
+	Bool disk_copy;
+};
+
+/**
+* Refcounted memory storage of gmem:// entries, shared between the cache entry and the readers
+*/
+struct __CacheBlobStruct
+{
+	u8 *data;
+	u32 size, alloc;
+	u32 ref_count;
 };
 
+/*all blobs are registered so that gmem:// URLs can be resolved back to their blob*/
+static GF_List *cache_blobs = NULL;
+static GF_Mutex *cache_blobs_mx = NULL;
+static u32 cache_blobs_users = 0;
+
+void gf_cache_blobs_init()
+{
+	if (!cache_blobs_users && !cache_blobs_mx) {
+		cache_blobs_mx = gf_mx_new("CacheBlobs");
+		cache_blobs = gf_list_new();
+	}
+	cache_blobs_users++;
+}
+
+/*destroys the registry once the last user is gone and the last blob released - called with cache_blobs_mx held, which it releases*/
+static void gf_cache_blobs_check_del()
+{
+	GF_Mutex *mx = cache_blobs_mx;
+	if (cache_blobs_users || gf_list_count(cache_blobs)) {
+		gf_mx_v(mx);
+		return;
+	}
+	gf_list_del(cache_blobs);
+	cache_blobs = NULL;
+	cache_blobs_mx = NULL;
+	gf_mx_v(mx);
+	gf_mx_del(mx);
+}
+
+void gf_cache_blobs_close()
+{
+	if (!cache_blobs_mx) return;
+	gf_mx_p(cache_blobs_mx);
+	if (cache_blobs_users) cache_blobs_users--;
+	/*blobs may still be held by readers, the registry is destroyed with the last one*/
+	gf_cache_blobs_check_del();
+}
+
+static GF_CacheBlob *gf_cache_blob_new(u32 alloc)
+{
+	GF_CacheBlob *blob;
+	GF_SAFEALLOC(blob, GF_CacheBlob);
+	if (!blob) return NULL;
+	blob->data = (u8*)gf_malloc(sizeof(char) * (alloc + 2));
+	if (!blob->data) {
+		gf_free(blob);
+		return NULL;
+	}
+	blob->alloc = alloc;
+	blob->ref_count = 1;
+	gf_mx_p(cache_blobs_mx);
+	gf_list_add(cache_blobs, blob);
+	gf_mx_v(cache_blobs_mx);
+	return blob;
+}
+
+GF_EXPORT
+GF_CacheBlob *gf_cache_blob_get(const char *gmem_url)
+{
+	u32 i, size;
+	void *mem_address;
+	GF_CacheBlob *blob;
+	if (!gmem_url || strncmp(gmem_url, "gmem://", 7) || !cache_blobs_mx) return NULL;
+	if (sscanf(gmem_url, "gmem://%d@%p", &size, &mem_address) != 2) return NULL;
+
+	gf_mx_p(cache_blobs_mx);
+	i=0;
+	while ((blob = (GF_CacheBlob*)gf_list_enum(cache_blobs, &i))) {
+		if ((blob->data != mem_address) || (size > blob->size)) continue;
+		blob->ref_count++;
+		break;
+	}
+	gf_mx_v(cache_blobs_mx);
+	return blob;
+}
+
+GF_EXPORT
+void gf_cache_blob_release(GF_CacheBlob *blob)
+{
+	if (!blob || !cache_blobs_mx) return;
+	gf_mx_p(cache_blobs_mx);
+	assert(blob->ref_count);
+	blob->ref_count--;
+	if (!blob->ref_count) {
+		gf_list_del_item(cache_blobs, blob);
+		gf_free(blob->data);
+		gf_free(blob);
+	}
+	gf_cache_blobs_check_del();
+}
+
+void gf_cache_entry_hold_blob(const DownloadedCacheEntry entry, GF_CacheBlob **held)
+{
+	GF_CacheBlob *prev;
+	if (!entry || !held || !cache_blobs_mx) return;
+	prev = *held;
+	if (prev == (entry->memory_stored ? entry->blob : NULL)) return;
+	gf_mx_p(cache_blobs_mx);
+	*held = entry->memory_stored ? entry->blob : NULL;
+	if (*held) (*held)->ref_count++;
+	gf_mx_v(cache_blobs_mx);
+	if (prev) gf_cache_blob_release(prev);
+}
+
+/*makes sure the entry blob can hold size bytes. Memory still used by a reader is never moved nor overwritten,
+the entry switches to a new blob instead*/
+static GF_Err gf_cache_entry_blob_alloc(DownloadedCacheEntry entry, u32 size, Bool keep_data)
+{
+	GF_CacheBlob *blob = entry->blob;
+	GF_CacheBlob *new_blob;
+	u32 alloc;
+
+	if (blob) {
+		gf_mx_p(cache_blobs_mx);
+		if (blob->ref_count==1) {
+			if (!keep_data) blob->size = 0;
+			if (blob->alloc < size) {
+				u8 *data = (u8*)gf_realloc(blob->data, sizeof(char) * (size + 2));
+				if (!data) {
+					gf_mx_v(cache_blobs_mx);
+					return GF_OUT_OF_MEM;
+				}
+				blob->data = data;
+				blob->alloc = size;
+			}
+			gf_mx_v(cache_blobs_mx);
+			return GF_OK;
+		}
+		gf_mx_v(cache_blobs_mx);
+	}
+	alloc = size;
+	if (blob && (blob->alloc > alloc)) alloc = blob->alloc;
+	new_blob = gf_cache_blob_new(alloc);
+	if (!new_blob) return GF_OUT_OF_MEM;
+	if (blob) {
+		if (keep_data) {
+			memcpy(new_blob->data, blob->data, blob->size);
+			new_blob->size = blob->size;
+		}
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_NETWORK, ("[CACHE] Memory of %s still in use, switching to new storage\n", entry->url));
+		gf_cache_blob_release(blob);
+	}
+	entry->blob = new_blob;
+	return GF_OK;
+}
+
+static void gf_cache_entry_update_mem_url(DownloadedCacheEntry entry)
+{
+	sprintf(entry->mem_url, "gmem://%d@%p", entry->blob ? entry->blob->size : 0, entry->blob ? entry->blob->data : NULL);
+}
+
 Bool delete_cache_files(void *cbck, char *item_name, char *item_path, GF_FileEnumInfo *file_info) {
 	const char * startPattern;
 	int sz;
@@ -352,10 +520,43 @@ u32 gf_cache_get_cache_filesize ( const DownloadedCacheEntry entry )
 }
 
 const char * gf_cache_get_cache_filename( const DownloadedCacheEntry entry )
+{
+	if (!entry) return NULL;
+	return entry->memory_stored ? entry->mem_url : entry->cache_filename;
+}
+
+const char * gf_cache_get_disk_filename( const DownloadedCacheEntry entry )
 {
 	return entry ? entry->cache_filename : NULL;
 }
 
+GF_Err gf_cache_load_disk_copy( const DownloadedCacheEntry entry )
+{
+	FILE *f;
+	u32 size;
+	GF_Err e;
+	CHECK_ENTRY;
+	if (!entry->memory_stored) return GF_OK;
+	if (!entry->disk_copy || !entry->cache_filename) return GF_NOT_SUPPORTED;
+
+	f = gf_fopen(entry->cache_filename, "rb");
+	if (!f) return GF_IO_ERR;
+	gf_fseek(f, 0, SEEK_END);
+	size = (u32) gf_ftell(f);
+	gf_fseek(f, 0, SEEK_SET);
+	e = gf_cache_entry_blob_alloc(entry, size, GF_FALSE);
+	if (!e && (fread(entry->blob->data, 1, size, f) != size))
+		e = GF_IO_ERR;
+	gf_fclose(f);
+	if (e) return e;
+
+	memset(entry->blob->data + size, 0, 2);
+	entry->blob->size = entry->written_in_cache = entry->cacheSize = size;
+	gf_cache_entry_update_mem_url(entry);
+	GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[CACHE] Restored %s in memory from %s\n", entry->url, entry->cache_filename));
+	return GF_OK;
+}
+
 GF_EXPORT
 GF_Err gf_cache_append_http_headers(const DownloadedCacheEntry entry, char * httpRequest) {
 	if (!entry || !httpRequest)
@@ -383,7 +584,7 @@ GF_Err gf_cache_append_http_headers(const DownloadedCacheEntry entry, char * htt
 static const char * default_cache_file_suffix = ".dat";
 static const char * cache_file_info_suffix = ".txt";
 
-DownloadedCacheEntry gf_cache_create_entry ( GF_DownloadManager * dm, const char * cache_directory, const char * url , u64 start_range, u64 end_range, Bool mem_storage)
+DownloadedCacheEntry gf_cache_create_entry ( GF_DownloadManager * dm, const char * cache_directory, const char * url , u64 start_range, u64 end_range, Bool mem_storage, Bool disk_copy)
 {
 	char tmp[_CACHE_TMP_SIZE];
 	u8 hash[_CACHE_HASH_SIZE];
@@ -435,6 +636,7 @@ DownloadedCacheEntry gf_cache_create_entry ( GF_DownloadManager * dm, const char
 	entry->hash = gf_strdup ( tmp );
 
 	entry->memory_stored = mem_storage;
+	entry->disk_copy = mem_storage ? disk_copy : GF_FALSE;
 
 	entry->cacheSize = 0;
 	entry->contentLength = 0;
@@ -461,14 +663,11 @@ DownloadedCacheEntry gf_cache_create_entry ( GF_DownloadManager * dm, const char
 	entry->write_session = NULL;
 	entry->sessions = gf_list_new();
 
-	if (entry->memory_stored) {
-		entry->cache_filename = (char*)gf_malloc ( strlen ("gmem://") + 8 + strlen("@") + 16 + 1);
-	} else {
-		/* Sizeof cache directory + hash + possible extension */
+	/* Sizeof cache directory + hash + possible extension */
+	if (!entry->memory_stored || entry->disk_copy)
 		entry->cache_filename = (char*)gf_malloc ( strlen ( cache_directory ) + strlen(cache_file_prefix) + strlen(tmp) + _CACHE_MAX_EXTENSION_SIZE + 1);
-	}
 
-	if ( !entry->hash || !entry->url || !entry->cache_filename || !entry->sessions)
+	if ( !entry->hash || !entry->url || (!entry->cache_filename && (!entry->memory_stored || entry->disk_copy)) || !entry->sessions)
 	{
 		GF_Err err;
 		/* Probably out of memory */
@@ -481,8 +680,8 @@ DownloadedCacheEntry gf_cache_create_entry ( GF_DownloadManager * dm, const char
 	}
 
 	if (entry->memory_stored) {
-		sprintf(entry->cache_filename, "gmem://%d@%p", entry->contentLength, entry->mem_storage);
-		return entry;
+		gf_cache_entry_update_mem_url(entry);
+		if (!entry->disk_copy) return entry;
 	}
 
 
@@ -565,6 +764,16 @@ u32 gf_cache_get_content_length( const DownloadedCacheEntry entry)
 	return entry ? entry->contentLength : 0;
 }
 
+GF_Err gf_cache_extend_range( const DownloadedCacheEntry entry, u64 range_end, u32 size )
+{
+	CHECK_ENTRY;
+	if (entry->writeFilePtr || entry->blob) return GF_BAD_PARAM;
+	entry->range_end = range_end;
+	entry->contentLength += size;
+	entry->cacheSize += size;
+	return gf_cache_flush_disk_cache(entry);
+}
+
 GF_Err gf_cache_close_write_cache( const DownloadedCacheEntry entry, const GF_DownloadSession * sess, Bool success )
 {
 	GF_Err e = GF_OK;
@@ -638,22 +847,24 @@ GF_Err gf_cache_open_write_cache( const DownloadedCacheEntry entry, const GF_Dow
 	entry->flags &= ~CORRUPTED;
 
 	if (entry->memory_stored) {
-		GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[CACHE] Opening cache file %s for write (%s)...\n", entry->cache_filename, entry->url));
-		if (!entry->mem_allocated || (entry->mem_allocated < entry->contentLength)) {
-			if (entry->contentLength) entry->mem_allocated = entry->contentLength;
-			else if (!entry->mem_allocated) entry->mem_allocated = 81920;
-			entry->mem_storage = (u8*)gf_realloc(entry->mem_storage, sizeof(char)* (entry->mem_allocated + 2) );
-		}
-		if (!entry->mem_allocated) {
+		GF_Err e;
+		GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[CACHE] Opening memory storage for write (%s)...\n", entry->url));
+		e = gf_cache_entry_blob_alloc(entry, entry->contentLength ? entry->contentLength : 81920, entry->continue_file);
+		if (e) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_NETWORK, ("[CACHE] Failed to create memory storage for file %s\n", entry->url));
-			return GF_OUT_OF_MEM;
+			return e;
 		}
-		sprintf(entry->cache_filename, "gmem://%d@%p", entry->contentLength, entry->mem_storage);
-		return GF_OK;
+		gf_cache_entry_update_mem_url(entry);
+		if (!entry->disk_copy)
+			return GF_OK;
 	}
 
 	GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[CACHE] Opening cache file %s for write (%s)...\n", entry->cache_filename, entry->url));
 	entry->writeFilePtr = gf_fopen(entry->cache_filename, entry->continue_file ? "a+b" : "wb");
+	if (!entry->writeFilePtr && entry->memory_stored) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[CACHE] Cannot open cache file %s, %s is only stored in memory\n", entry->cache_filename, entry->url));
+		return GF_OK;
+	}
 	if (!entry->writeFilePtr) {
 		GF_LOG(GF_LOG_ERROR, GF_LOG_NETWORK,
 		       ("[CACHE] Error while opening cache file %s for writting.\n", entry->cache_filename));
@@ -673,25 +884,36 @@ GF_Err gf_cache_write_to_cache( const DownloadedCacheEntry entry, const GF_Downl
 	u32 read;
 	CHECK_ENTRY;
 
-	if (!data || (!entry->writeFilePtr && !entry->mem_storage) || sess != entry->write_session) {
-		GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("Incorrect parameter : data=%p, writeFilePtr=%p mem_storage=%p at "__FILE__"\n", data, entry->writeFilePtr, entry->mem_storage));
+	if (!data || (!entry->writeFilePtr && !entry->blob) || sess != entry->write_session) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("Incorrect parameter : data=%p, writeFilePtr=%p blob=%p at "__FILE__"\n", data, entry->writeFilePtr, entry->blob));
 		return GF_BAD_PARAM;
 	}
 
 	if (entry->memory_stored) {
-		if (entry->written_in_cache + size > entry->mem_allocated) {
-			u32 new_size = MAX(entry->mem_allocated*2, entry->written_in_cache + size);
-			entry->mem_storage = (u8*)gf_realloc(entry->mem_storage, (new_size+2));
-			entry->mem_allocated = new_size;
-			sprintf(entry->cache_filename, "gmem://%d@%p", entry->contentLength, entry->mem_storage);
+		if (entry->written_in_cache + size > entry->blob->alloc) {
+			u32 new_size = MAX(entry->blob->alloc*2, entry->written_in_cache + size);
+			GF_Err e = gf_cache_entry_blob_alloc(entry, new_size, GF_TRUE);
+			if (e) return e;
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_NETWORK, ("[CACHE] Reallocating memory cache to %d bytes\n", new_size));
 		}
-		memcpy(entry->mem_storage + entry->written_in_cache, data, size);
+		memcpy(entry->blob->data + entry->written_in_cache, data, size);
 		entry->written_in_cache += size;
-		memset(entry->mem_storage + entry->written_in_cache, 0, 2);
-		sprintf(entry->cache_filename, "gmem://%d@%p", entry->written_in_cache, entry->mem_storage);
+		memset(entry->blob->data + entry->written_in_cache, 0, 2);
+		entry->blob->size = entry->written_in_cache;
+		gf_cache_entry_update_mem_url(entry);
 
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_NETWORK, ("[CACHE] Storing %d bytes to memory\n", size));
+		if (!entry->writeFilePtr)
+			return GF_OK;
+
+		/*disk copy is only used for replay, it is flushed on close and a write error simply drops it*/
+		if (gf_fwrite(data, sizeof(char), size, entry->writeFilePtr) != size) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[CACHE] Error while writing cache file %s, %s is only stored in memory\n", entry->cache_filename, entry->url));
+			gf_fclose(entry->writeFilePtr);
+			entry->writeFilePtr = NULL;
+			gf_delete_file(entry->cache_filename);
+			entry->file_exists = GF_FALSE;
+		}
 		return GF_OK;
 	}
 
@@ -724,7 +946,7 @@ GF_CacheReader gf_cache_reader_new(const DownloadedCacheEntry entry) {
 	reader = (GF_CacheReader)gf_malloc(sizeof(struct __CacheReaderStruct));
 	if (reader == NULL)
 		return NULL;
-	reader->readPtr = gf_fopen( entry->cache_filename, "rb" );
+	reader->readPtr = entry->cache_filename ? gf_fopen( entry->cache_filename, "rb" ) : NULL;
 	reader->readPosition = 0;
 	if (!reader->readPtr) {
 		gf_cache_reader_del(reader);
@@ -823,8 +1045,10 @@ GF_Err gf_cache_delete_entry ( const DownloadedCacheEntry entry )
 		gf_free ( entry->mimeType );
 		entry->mimeType = NULL;
 	}
-	if (entry->mem_storage) {
-		gf_free(entry->mem_storage);
+	/*readers may still use the memory*/
+	if (entry->blob) {
+		gf_cache_blob_release(entry->blob);
+		entry->blob = NULL;
 	}
 
 	if ( entry->cache_filename ) {
@@ -858,7 +1082,7 @@ GF_Err gf_cache_delete_entry ( const DownloadedCacheEntry entry )
 
 Bool gf_cache_check_if_cache_file_is_corrupted(const DownloadedCacheEntry entry)
 {
-	FILE *the_cache = gf_fopen ( entry->cache_filename, "rb" );
+	FILE *the_cache = entry->cache_filename ? gf_fopen ( entry->cache_filename, "rb" ) : NULL;
 	if ( the_cache ) {
 		char * endPtr;
 		const char * keyValue = gf_cfg_get_key ( entry->properties, CACHE_SECTION_NAME, CACHE_SECTION_NAME_CONTENT_SIZE );
@@ -955,7 +1179,7 @@ Bool gf_cache_is_in_progress(const DownloadedCacheEntry entry)
 {
 	if (!entry) return GF_FALSE;
 	if (entry->writeFilePtr) return GF_TRUE;
-	if (entry->mem_storage && entry->written_in_cache && entry->contentLength && (entry->written_in_cache<entry->contentLength))
+	if (entry->blob && entry->written_in_cache && entry->contentLength && (entry->written_in_cache<entry->contentLength))
 		return GF_TRUE;
 	return GF_FALSE;
 }
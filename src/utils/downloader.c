@@ -104,6 +104,28 @@ typedef struct __partialDownloadStruct {
 	char * filename;
 } GF_PartialDownload ;
 
+/*HTTP connection to a server, kept alive in the download manager once the download is done*/
+typedef struct
+{
+	char *server_name;
+	u16 port;
+	Bool use_ssl, use_proxy;
+	GF_Socket *sock;
+#ifdef GPAC_HAS_SSL
+	SSL *ssl;
+#endif
+	/*sessions having sent a request on this connection, in request order - only the first one reads the socket*/
+	GF_List *pipeline;
+	/*bytes received past the end of a response, belonging to the next response in the pipeline*/
+	char *pending;
+	u32 pending_size;
+	/*no more requests can be sent on the connection, and pipelined sessions must resend their request - except the one set in sync_sess*/
+	Bool broken;
+	void *sync_sess;
+	/*system clock at which the connection became idle*/
+	u32 idle_since;
+} GF_DMConnection;
+
 struct __gf_download_session
 {
 	/*this is always 0 and helps differenciating downloads from other interfaces (interfaceType != 0)*/
@@ -132,6 +154,19 @@ struct __gf_download_session
 	GF_List *headers;
 
 	GF_Socket *sock;
+	/*connection owning the socket, NULL if not registered in the connection pool*/
+	GF_DMConnection *conn;
+	/*the connection was taken from the pool, the server may have closed it meanwhile*/
+	Bool reused_conn;
+	/*the last response was entirely read, the connection may carry another request*/
+	Bool conn_reusable;
+	/*pipelined sessions wait on this semaphore until they are at the head of the pipeline or the connection is lost*/
+	GF_Semaphore *pipeline_sema;
+	Bool pipeline_wait;
+	/*thread having sent the request of the session on its connection*/
+	u32 pipeline_th_id;
+	/*memory blob of the last gmem:// URL handed out by the session, held until the next one*/
+	GF_CacheBlob *handout_blob;
 	u32 num_retry;
 	GF_NetIOStatus status;
 
@@ -199,6 +234,8 @@ struct __gf_download_manager
 	GF_Config *cfg;
 	GF_List *sessions;
 	Bool disable_cache, simulate_no_connection, allow_offline_cache;
+	/*memory cache entries are also written to disk for later replay*/
+	Bool mem_cache_disk_copy;
 	u32 limit_data_rate, read_buf_size;
 
 	GF_List *skip_proxy_servers;
@@ -206,6 +243,13 @@ struct __gf_download_manager
 	GF_List *cache_entries;
 	/* FIXME : should be placed in DownloadedCacheEntry maybe... */
 	GF_List *partial_downloads;
+
+	/*HTTP connections, in use or idle*/
+	GF_List *connections;
+	GF_Mutex *conn_mx;
+	u32 keep_alive_timeout, max_idle_connections, pipeline_depth;
+	Bool pipelining;
+	GF_DMConnectionStats conn_stats;
 #ifdef GPAC_HAS_SSL
 	SSL_CTX *ssl_ctx;
 #endif
@@ -285,6 +329,19 @@ void gf_cache_set_end_range(DownloadedCacheEntry entry, u64 range_end);
 /*returns 1 if cache is currently open for write*/
 Bool gf_cache_is_in_progress(const DownloadedCacheEntry entry);
 
+/*returns the file name on disk of the entry, NULL if the entry is only stored in memory*/
+const char * gf_cache_get_disk_filename( const DownloadedCacheEntry entry );
+
+/*reloads the memory of an entry from its disk copy, does nothing for entries not stored in memory*/
+GF_Err gf_cache_load_disk_copy( const DownloadedCacheEntry entry );
+
+/*create/destroy the registry of memory blobs, one call per download manager*/
+void gf_cache_blobs_init();
+void gf_cache_blobs_close();
+
+/*takes a reference on the memory blob of the entry in held, releasing the blob previously held*/
+void gf_cache_entry_hold_blob(const DownloadedCacheEntry entry, GF_CacheBlob **held);
+
 /**
  * Find a User's credentials for a given site
  */
@@ -518,9 +575,10 @@ DownloadedCacheEntry gf_dm_find_cached_entry_by_url(GF_DownloadSession * sess)
  * \param start_range the start of the byte range request
  * \param end_range the end of the byte range request
  * \param mem_storage Boolean indicating if the cache data should be stored in memory
+ * \param disk_copy Boolean indicating if data stored in memory should also be written to the disk cache
  * \return The DownloadedCacheEntry
  */
-DownloadedCacheEntry gf_cache_create_entry( GF_DownloadManager * dm, const char * cache_directory, const char * url, u64 start_range, u64 end_range, Bool mem_storage);
+DownloadedCacheEntry gf_cache_create_entry( GF_DownloadManager * dm, const char * cache_directory, const char * url, u64 start_range, u64 end_range, Bool mem_storage, Bool disk_copy);
 
 /*!
  * Removes a session for a DownloadedCacheEntry
@@ -582,7 +640,7 @@ static void gf_dm_configure_cache(GF_DownloadSession *sess)
 		u32 i, count;
 		entry = gf_dm_find_cached_entry_by_url(sess);
 		if (!entry) {
-			entry = gf_cache_create_entry(sess->dm, sess->dm->cache_directory, sess->orig_url, sess->range_start, sess->range_end, (sess->flags&GF_NETIO_SESSION_MEMORY_CACHE) ? GF_TRUE : GF_FALSE);
+			entry = gf_cache_create_entry(sess->dm, sess->dm->cache_directory, sess->orig_url, sess->range_start, sess->range_end, (sess->flags&GF_NETIO_SESSION_MEMORY_CACHE) ? GF_TRUE : GF_FALSE, sess->dm->mem_cache_disk_copy);
 			gf_mx_p( sess->dm->cache_mx );
 			gf_list_add(sess->dm->cache_entries, entry);
 			gf_mx_v( sess->dm->cache_mx );
@@ -622,7 +680,7 @@ void gf_dm_delete_cached_file_entry(const GF_DownloadManager * dm,  const char *
 	gf_dm_url_info_init(&info);
 	e = gf_dm_get_url_info(url, &info, NULL);
 	if (e != GF_OK) {
-		gf_mx_p( dm->cache_mx );
+		gf_mx_v( dm->cache_mx );
 		gf_dm_url_info_del(&info);
 		return;
 	}
@@ -681,6 +739,242 @@ static void gf_dm_clear_headers(GF_DownloadSession *sess)
 }
 
 
+static void gf_dm_conn_del(GF_DMConnection *conn)
+{
+#ifdef GPAC_HAS_SSL
+	if (conn->ssl) {
+		SSL_shutdown(conn->ssl);
+		SSL_free(conn->ssl);
+	}
+#endif
+	if (conn->sock) gf_sk_del(conn->sock);
+	if (conn->pending) gf_free(conn->pending);
+	gf_list_del(conn->pipeline);
+	gf_free(conn->server_name);
+	gf_free(conn);
+}
+
+static Bool gf_dm_conn_match(GF_DMConnection *conn, GF_DownloadSession *sess)
+{
+	if (conn->broken || (conn->port != sess->port)) return GF_FALSE;
+	if (conn->use_proxy != ((sess->proxy_enabled==1) ? GF_TRUE : GF_FALSE)) return GF_FALSE;
+	if (conn->use_ssl != ((sess->flags & GF_DOWNLOAD_SESSION_USE_SSL) ? GF_TRUE : GF_FALSE)) return GF_FALSE;
+	return strcmp(conn->server_name, sess->server_name) ? GF_FALSE : GF_TRUE;
+}
+
+/*an idle connection has nothing to read: data or end of stream means the server closed it*/
+static Bool gf_dm_conn_is_closed(GF_DMConnection *conn)
+{
+	char c;
+	u32 read;
+	return (gf_sk_receive(conn->sock, &c, 1, 0, &read) == GF_IP_NETWORK_EMPTY) ? GF_FALSE : GF_TRUE;
+}
+
+/*only sessions issuing small GET requests, always read entirely, are pipelined. Persistent sessions keep the connection for their next
+requests: they may be pipelined behind other requests, but no request may be pipelined behind them*/
+static Bool gf_dm_sess_can_pipeline(GF_DownloadSession *sess, Bool is_last)
+{
+	if (!(sess->flags & GF_NETIO_SESSION_ALLOW_PIPELINE)) return GF_FALSE;
+	if (sess->flags & GF_DOWNLOAD_SESSION_USE_SSL) return GF_FALSE;
+	if (!is_last && (sess->flags & GF_NETIO_SESSION_PERSISTENT)) return GF_FALSE;
+	return GF_TRUE;
+}
+
+static void gf_dm_sess_attach_connection(GF_DownloadSession *sess, GF_DMConnection *conn)
+{
+	sess->pipeline_th_id = gf_th_id();
+	gf_list_add(conn->pipeline, sess);
+	sess->conn = conn;
+	sess->sock = conn->sock;
+#ifdef GPAC_HAS_SSL
+	sess->ssl = conn->ssl;
+#endif
+}
+
+/*attaches the session to an idle connection to its server, or pipelines it on a connection in use.
+Returns GF_FALSE if a new connection is needed*/
+static Bool gf_dm_sess_get_connection(GF_DownloadSession *sess)
+{
+	u32 i, j, now, th_id;
+	GF_DMConnection *pipe_conn = NULL;
+	GF_DownloadManager *dm = sess->dm;
+	if (!dm) return GF_FALSE;
+
+	th_id = gf_th_id();
+	gf_mx_p(dm->conn_mx);
+	now = gf_sys_clock();
+	for (i=0; i<gf_list_count(dm->connections); i++) {
+		GF_DMConnection *conn = (GF_DMConnection *)gf_list_get(dm->connections, i);
+		u32 nb_pending = gf_list_count(conn->pipeline);
+		if (nb_pending) {
+			if (pipe_conn || !dm->pipelining || (nb_pending >= dm->pipeline_depth) || !gf_dm_conn_match(conn, sess)) continue;
+			for (j=0; j<nb_pending; j++) {
+				GF_DownloadSession *a_sess = (GF_DownloadSession *)gf_list_get(conn->pipeline, j);
+				if (!gf_dm_sess_can_pipeline(a_sess, GF_FALSE)) break;
+				/*a thread cannot wait for a response it has to read itself*/
+				if (a_sess->pipeline_th_id == th_id) break;
+			}
+			if (j==nb_pending) pipe_conn = conn;
+			continue;
+		}
+		if (now - conn->idle_since <= dm->keep_alive_timeout) {
+			if (!gf_dm_conn_match(conn, sess)) continue;
+			if (!gf_dm_conn_is_closed(conn)) {
+				gf_dm_sess_attach_connection(sess, conn);
+				dm->conn_stats.nb_reused++;
+				gf_mx_v(dm->conn_mx);
+				return GF_TRUE;
+			}
+		}
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_NETWORK, ("[HTTP] Closing idle connection to %s:%d\n", conn->server_name, conn->port));
+		gf_list_rem(dm->connections, i);
+		i--;
+		gf_dm_conn_del(conn);
+		dm->conn_stats.nb_expired++;
+	}
+	if (pipe_conn && gf_dm_sess_can_pipeline(sess, GF_TRUE)) {
+		if (!sess->pipeline_sema) sess->pipeline_sema = gf_sema_new(1, 0);
+		gf_dm_sess_attach_connection(sess, pipe_conn);
+		dm->conn_stats.nb_pipelined++;
+		gf_mx_v(dm->conn_mx);
+		return GF_TRUE;
+	}
+	gf_mx_v(dm->conn_mx);
+	return GF_FALSE;
+}
+
+/*registers the newly connected socket of the session in the connection pool*/
+static void gf_dm_sess_add_connection(GF_DownloadSession *sess)
+{
+	GF_DMConnection *conn;
+	if (!sess->dm) return;
+	GF_SAFEALLOC(conn, GF_DMConnection);
+	if (!conn) return;
+	conn->server_name = gf_strdup(sess->server_name);
+	conn->port = sess->port;
+	conn->use_ssl = (sess->flags & GF_DOWNLOAD_SESSION_USE_SSL) ? GF_TRUE : GF_FALSE;
+	conn->use_proxy = (sess->proxy_enabled==1) ? GF_TRUE : GF_FALSE;
+	conn->sock = sess->sock;
+#ifdef GPAC_HAS_SSL
+	conn->ssl = sess->ssl;
+#endif
+	conn->pipeline = gf_list_new();
+	gf_list_add(conn->pipeline, sess);
+	sess->conn = conn;
+	sess->pipeline_th_id = gf_th_id();
+	sess->reused_conn = GF_FALSE;
+
+	gf_mx_p(sess->dm->conn_mx);
+	gf_list_add(sess->dm->connections, conn);
+	sess->dm->conn_stats.nb_connections++;
+	gf_mx_v(sess->dm->conn_mx);
+}
+
+/*detaches the session from its socket. If keep_alive is set and no other request is pending, the connection is kept in the pool*/
+static void gf_dm_sess_release_connection(GF_DownloadSession *sess, Bool keep_alive)
+{
+	GF_DMConnection *conn = sess->conn;
+
+	if (!conn) {
+#ifdef GPAC_HAS_SSL
+		if (sess->ssl) {
+			SSL_shutdown(sess->ssl);
+			SSL_free(sess->ssl);
+		}
+#endif
+		if (sess->sock) gf_sk_del(sess->sock);
+	} else {
+		GF_DownloadManager *dm = sess->dm;
+		gf_mx_p(dm->conn_mx);
+		if (!keep_alive && !conn->broken) {
+			conn->broken = GF_TRUE;
+			/*the response being read is not affected by a pipelined session leaving*/
+			conn->sync_sess = (gf_list_get(conn->pipeline, 0) != sess) ? gf_list_get(conn->pipeline, 0) : NULL;
+		}
+		gf_list_del_item(conn->pipeline, sess);
+		/*wake up the new head of the pipeline, or all pipelined sessions if they must resend their request - and the session itself
+		if it is released by another thread while waiting*/
+		if (gf_list_count(conn->pipeline)) {
+			u32 i;
+			for (i=0; i<gf_list_count(conn->pipeline); i++) {
+				GF_DownloadSession *a_sess = (GF_DownloadSession *)gf_list_get(conn->pipeline, i);
+				if (a_sess->pipeline_sema && (!i || conn->broken)) gf_sema_notify(a_sess->pipeline_sema, 1);
+			}
+		}
+		if (sess->pipeline_sema) gf_sema_notify(sess->pipeline_sema, 1);
+		if (!gf_list_count(conn->pipeline)) {
+			u32 i, nb_idle = 0;
+			for (i=0; i<gf_list_count(dm->connections); i++) {
+				GF_DMConnection *a_conn = (GF_DMConnection *)gf_list_get(dm->connections, i);
+				if (!gf_list_count(a_conn->pipeline) && (a_conn != conn) && !strcmp(a_conn->server_name, conn->server_name))
+					nb_idle++;
+			}
+			if (!conn->broken && !conn->pending_size && dm->keep_alive_timeout && (nb_idle < dm->max_idle_connections)) {
+				conn->idle_since = gf_sys_clock();
+			} else {
+				gf_list_del_item(dm->connections, conn);
+				gf_dm_conn_del(conn);
+			}
+		}
+		gf_mx_v(dm->conn_mx);
+	}
+	sess->conn = NULL;
+	sess->sock = NULL;
+#ifdef GPAC_HAS_SSL
+	sess->ssl = NULL;
+#endif
+	sess->reused_conn = GF_FALSE;
+	sess->conn_reusable = GF_FALSE;
+}
+
+/*checks if a pipelined session may read its response - returns GF_TRUE if the session shall wait. Non-threaded sessions wait here
+on the pipeline semaphore, threaded ones wait in the session thread once the session mutex is released*/
+static Bool gf_dm_sess_wait_pipeline(GF_DownloadSession *sess)
+{
+	Bool is_first, broken;
+	GF_DMConnection *conn = sess->conn;
+
+	gf_mx_p(sess->dm->conn_mx);
+	is_first = (gf_list_get(conn->pipeline, 0) == sess) ? GF_TRUE : GF_FALSE;
+	broken = (conn->broken && (conn->sync_sess != sess)) ? GF_TRUE : GF_FALSE;
+	gf_mx_v(sess->dm->conn_mx);
+
+	if (broken) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[HTTP] Connection to %s lost before the response to pipelined request %s - retrying\n", sess->server_name, sess->remote_path));
+		gf_dm_sess_release_connection(sess, GF_FALSE);
+		sess->status = GF_NETIO_SETUP;
+		return GF_TRUE;
+	}
+	if (is_first) return GF_FALSE;
+	if (sess->flags & GF_NETIO_SESSION_NOT_THREADED) gf_sema_wait(sess->pipeline_sema);
+	else sess->pipeline_wait = GF_TRUE;
+	return GF_TRUE;
+}
+
+/*stores bytes read past the end of the response for the next pipelined session*/
+static void gf_dm_sess_store_pending(GF_DownloadSession *sess, const char *data, u32 size)
+{
+	GF_DMConnection *conn = sess->conn;
+	gf_mx_p(sess->dm->conn_mx);
+	conn->pending = (char *)gf_realloc(conn->pending, sizeof(char) * (conn->pending_size + size));
+	memcpy(conn->pending + conn->pending_size, data, size);
+	conn->pending_size += size;
+	gf_mx_v(sess->dm->conn_mx);
+}
+
+static u32 gf_dm_sess_read_pending(GF_DownloadSession *sess, char *data, u32 data_size)
+{
+	u32 size;
+	GF_DMConnection *conn = sess->conn;
+	gf_mx_p(sess->dm->conn_mx);
+	size = MIN(conn->pending_size, data_size);
+	memcpy(data, conn->pending, size);
+	conn->pending_size -= size;
+	memmove(conn->pending, conn->pending + size, conn->pending_size);
+	gf_mx_v(sess->dm->conn_mx);
+	return size;
+}
+
 static void gf_dm_disconnect(GF_DownloadSession *sess, Bool force_close)
 {
 	assert( sess );
@@ -703,18 +997,7 @@ static void gf_dm_disconnect(GF_DownloadSession *sess, Bool force_close)
 		gf_mx_p(sess->mx);
 
 	if (force_close || !(sess->flags & GF_NETIO_SESSION_PERSISTENT)) {
-#ifdef GPAC_HAS_SSL
-		if (sess->ssl) {
-			SSL_shutdown(sess->ssl);
-			SSL_free(sess->ssl);
-			sess->ssl = NULL;
-		}
-#endif
-		if (sess->sock) {
-			GF_Socket * sx = sess->sock;
-			sess->sock = NULL;
-			gf_sk_del(sx);
-		}
+		gf_dm_sess_release_connection(sess, force_close ? GF_FALSE : sess->conn_reusable);
 	}
 	if (force_close && sess->use_cache_file) {
 		gf_cache_close_write_cache(sess->cache_entry, sess, GF_FALSE);
@@ -765,8 +1048,9 @@ void gf_dm_sess_del(GF_DownloadSession *sess)
 	if (sess->init_data) gf_free(sess->init_data);
 	sess->orig_url = sess->server_name = sess->remote_path;
 	sess->creds = NULL;
-	if (sess->sock)
-		gf_sk_del(sess->sock);
+	gf_dm_sess_release_connection(sess, sess->conn_reusable);
+	if (sess->pipeline_sema) gf_sema_del(sess->pipeline_sema);
+	if (sess->handout_blob) gf_cache_blob_release(sess->handout_blob);
 	gf_list_del(sess->headers);
 	gf_free(sess);
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_NETWORK, ("[Downloader] gf_dm_sess_del(%p) : DONE\n", sess ));
@@ -1082,8 +1366,7 @@ GF_Err gf_dm_sess_setup_from_url(GF_DownloadSession *sess, const char *url)
 		sess->num_retry = SESSION_RETRY_COUNT;
 		sess->needs_cache_reconfig = 1;
 	} else {
-		if (sess->sock) gf_sk_del(sess->sock);
-		sess->sock = NULL;
+		gf_dm_sess_release_connection(sess, sess->conn_reusable);
 		sess->status = GF_NETIO_SETUP;
 	}
 	return sess->last_error;
@@ -1109,10 +1392,20 @@ static u32 gf_dm_session_thread(void *par)
 			sess->do_requests(sess);
 		}
 		gf_mx_v(sess->mx);
-		gf_sleep(0);
+		/*blocked behind other pipelined requests on the connection*/
+		if (sess->pipeline_wait) {
+			sess->pipeline_wait = GF_FALSE;
+			gf_sema_wait(sess->pipeline_sema);
+		} else {
+			gf_sleep(0);
+		}
 	}
 	/*destroy all sessions*/
 	gf_dm_disconnect(sess, GF_FALSE);
+	/*the session will not read anything else, don't block requests pipelined behind it*/
+	gf_mx_p(sess->mx);
+	gf_dm_sess_release_connection(sess, sess->conn_reusable);
+	gf_mx_v(sess->mx);
 	sess->status = GF_NETIO_STATE_ERROR;
 	sess->last_error = GF_OK;
 	sess->flags |= GF_DOWNLOAD_SESSION_THREAD_DEAD;
@@ -1193,6 +1486,12 @@ static GF_Err gf_dm_read_data(GF_DownloadSession *sess, char *data, u32 data_siz
 	if (!sess)
 		return GF_BAD_PARAM;
 
+	/*data of a pipelined response already read by the previous session*/
+	if (sess->conn && sess->conn->pending_size) {
+		*out_read = gf_dm_sess_read_pending(sess, data, data_size);
+		return GF_OK;
+	}
+
 #ifdef GPAC_HAS_SSL
 	if (sess->ssl) {
 		s32 size = SSL_read(sess->ssl, data, data_size);
@@ -1269,11 +1568,6 @@ static void gf_dm_connect(GF_DownloadSession *sess)
 	u16 proxy_port = 0;
 	const char *proxy, *ip;
 
-	if (!sess->sock) {
-		sess->num_retry = 40;
-		sess->sock = gf_sk_new(GF_SOCK_TYPE_TCP);
-	}
-
 	/*connect*/
 	sess->status = GF_NETIO_SETUP;
 	gf_dm_sess_notify_state(sess, sess->status, GF_OK);
@@ -1323,6 +1617,20 @@ static void gf_dm_connect(GF_DownloadSession *sess)
 		proxy = sess->server_name;
 		proxy_port = sess->port;
 	}
+
+	if (!sess->sock) {
+		if (gf_dm_sess_get_connection(sess)) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[HTTP] Reusing connection to %s:%d\n", proxy, proxy_port));
+			sess->reused_conn = GF_TRUE;
+			sess->connect_time = sess->ssl_setup_time = 0;
+			sess->status = GF_NETIO_CONNECTED;
+			gf_dm_sess_notify_state(sess, GF_NETIO_CONNECTED, GF_OK);
+			gf_dm_configure_cache(sess);
+			return;
+		}
+		sess->num_retry = 40;
+		sess->sock = gf_sk_new(GF_SOCK_TYPE_TCP);
+	}
 	GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[HTTP] Connecting to %s:%d\n", proxy, proxy_port));
 
 	if (sess->status == GF_NETIO_SETUP) {
@@ -1466,6 +1774,9 @@ static void gf_dm_connect(GF_DownloadSession *sess)
 	}
 #endif
 
+	if (!sess->conn && sess->sock && (sess->status == GF_NETIO_CONNECTED))
+		gf_dm_sess_add_connection(sess);
+
 	/*this should be done when building HTTP GET request in case we have range directives*/
 	gf_dm_configure_cache(sess);
 
@@ -1700,8 +2011,11 @@ GF_DownloadManager *gf_dm_new(GF_Config *cfg)
 	dm->credentials = gf_list_new();
 	dm->skip_proxy_servers = gf_list_new();
 	dm->partial_downloads = gf_list_new();
+	dm->connections = gf_list_new();
+	dm->conn_mx = gf_mx_new("download_manager_connections_mx");
 	dm->cfg = cfg;
 	dm->cache_mx = gf_mx_new("download_manager_cache_mx");
+	gf_cache_blobs_init();
 	default_cache_dir = NULL;
 	gf_mx_p( dm->cache_mx );
 	if (cfg)
@@ -1772,6 +2086,13 @@ retry_cache:
 			dm->allow_offline_cache = GF_TRUE;
 	}
 
+	dm->mem_cache_disk_copy = GF_FALSE;
+	if (cfg) {
+		opt = gf_cfg_get_key(cfg, "Downloader", "MemoryCacheDiskCopy");
+		if (opt && !strcmp(opt, "yes") )
+			dm->mem_cache_disk_copy = GF_TRUE;
+	}
+
 	dm->head_timeout = 5000;
 	if (cfg) {
 		opt = gf_cfg_get_key(cfg, "Downloader", "HTTPHeadTimeout");
@@ -1787,6 +2108,20 @@ retry_cache:
 		}
 	}
 
+	dm->keep_alive_timeout = 10000;
+	dm->max_idle_connections = 4;
+	dm->pipeline_depth = 4;
+	if (cfg) {
+		opt = gf_cfg_get_key(cfg, "Downloader", "KeepAliveTimeout");
+		if (opt) dm->keep_alive_timeout = atoi(opt);
+		opt = gf_cfg_get_key(cfg, "Downloader", "MaxIdleConnections");
+		if (opt) dm->max_idle_connections = atoi(opt);
+		opt = gf_cfg_get_key(cfg, "Downloader", "HTTPPipelining");
+		if (opt && !strcmp(opt, "yes")) dm->pipelining = GF_TRUE;
+		opt = gf_cfg_get_key(cfg, "Downloader", "PipelineDepth");
+		if (opt) dm->pipeline_depth = atoi(opt);
+	}
+
 	gf_mx_v( dm->cache_mx );
 	if (default_cache_dir)
 		gf_free(default_cache_dir);
@@ -1836,6 +2171,34 @@ void gf_dm_del(GF_DownloadManager *dm)
 	}
 	gf_list_del(dm->sessions);
 	dm->sessions = NULL;
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[HTTP] %d connections opened - %d requests on kept-alive connections - %d pipelined requests\n",
+	                                     dm->conn_stats.nb_connections, dm->conn_stats.nb_reused, dm->conn_stats.nb_pipelined));
+	while (gf_list_count(dm->connections)) {
+		GF_DMConnection *conn = (GF_DMConnection *)gf_list_get(dm->connections, 0);
+		gf_list_rem(dm->connections, 0);
+		/*connection used by a session not managed by the downloader, the first session keeps the socket*/
+		while (gf_list_count(conn->pipeline)) {
+			GF_DownloadSession *sess = (GF_DownloadSession *)gf_list_get(conn->pipeline, 0);
+			gf_list_rem(conn->pipeline, 0);
+			sess->conn = NULL;
+			if (conn->sock) {
+				conn->sock = NULL;
+#ifdef GPAC_HAS_SSL
+				conn->ssl = NULL;
+#endif
+			} else {
+				sess->sock = NULL;
+				sess->status = GF_NETIO_STATE_ERROR;
+			}
+		}
+		gf_dm_conn_del(conn);
+	}
+	gf_list_del(dm->connections);
+	dm->connections = NULL;
+	gf_mx_del(dm->conn_mx);
+	dm->conn_mx = NULL;
+
 	assert( dm->skip_proxy_servers );
 	while (gf_list_count(dm->skip_proxy_servers)) {
 		char *serv = (char*)gf_list_get(dm->skip_proxy_servers, 0);
@@ -1884,6 +2247,7 @@ void gf_dm_del(GF_DownloadManager *dm)
 	gf_mx_v( dm->cache_mx );
 	gf_mx_del( dm->cache_mx);
 	dm->cache_mx = NULL;
+	gf_cache_blobs_close();
 	gf_free(dm);
 }
 
@@ -2077,6 +2441,12 @@ static GFINLINE void gf_dm_data_received(GF_DownloadSession *sess, u8 *payload,
 	} else {
 		data = payload;
 		remaining = payload_size = 0;
+		/*bytes past the end of the response belong to the next pipelined response*/
+		if (sess->conn && sess->total_size && (sess->total_size != SIZE_IN_STREAM) && (sess->bytes_done + nbBytes > sess->total_size)) {
+			u32 extra = sess->bytes_done + nbBytes - sess->total_size;
+			nbBytes -= extra;
+			gf_dm_sess_store_pending(sess, (char *) data + nbBytes, extra);
+		}
 	}
 
 	if (data && nbBytes && store_in_init) {
@@ -2113,6 +2483,8 @@ static GFINLINE void gf_dm_data_received(GF_DownloadSession *sess, u8 *payload,
 	}
 
 	if (sess->total_size && (sess->bytes_done == sess->total_size)) {
+		/*the chunk trailer may still be pending, only reuse connections after identity-encoded responses*/
+		if (!sess->chunked) sess->conn_reusable = GF_TRUE;
 		gf_dm_disconnect(sess, GF_FALSE);
 		par.msg_type = GF_NETIO_DATA_TRANSFERED;
 		par.error = GF_OK;
@@ -2225,9 +2597,18 @@ const char *gf_dm_sess_get_cache_name(GF_DownloadSession * sess)
 {
 	if (!sess) return NULL;
 	if (! sess->cache_entry || sess->needs_cache_reconfig) return NULL;
+	/*the memory behind the URL stays valid until a reader gets it, even if the entry is deleted or downloaded again*/
+	gf_cache_entry_hold_blob(sess->cache_entry, &sess->handout_blob);
 	return gf_cache_get_cache_filename(sess->cache_entry);
 }
 
+GF_EXPORT
+GF_Err gf_dm_sess_extend_cache_range(GF_DownloadSession *sess, u64 end_range, u32 size)
+{
+	if (!sess || !sess->cache_entry || sess->needs_cache_reconfig) return GF_BAD_PARAM;
+	return gf_cache_extend_range(sess->cache_entry, end_range, size);
+}
+
 GF_EXPORT
 Bool gf_dm_sess_can_be_cached_on_disk(const GF_DownloadSession *sess)
 {
@@ -2286,6 +2667,7 @@ static GF_Err http_send_headers(GF_DownloadSession *sess, char * sHTTP) {
 	assert (sess->status == GF_NETIO_CONNECTED);
 
 	gf_dm_clear_headers(sess);
+	sess->conn_reusable = GF_FALSE;
 
 	if (sess->needs_cache_reconfig) {
 		gf_dm_configure_cache(sess);
@@ -2527,6 +2909,14 @@ static GF_Err http_send_headers(GF_DownloadSession *sess, char * sHTTP) {
 	}
 
 	if (e) {
+		/*kept-alive connection closed by the server, retry on a new one*/
+		if (sess->reused_conn && sess->num_retry) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[HTTP] Kept-alive connection to %s closed by server - retrying\n", sess->server_name));
+			gf_dm_sess_release_connection(sess, GF_FALSE);
+			sess->num_retry--;
+			sess->status = GF_NETIO_SETUP;
+			return GF_OK;
+		}
 		sess->status = GF_NETIO_STATE_ERROR;
 		sess->last_error = e;
 		gf_dm_sess_notify_state(sess, GF_NETIO_STATE_ERROR, e);
@@ -2713,6 +3103,10 @@ static GF_Err wait_for_header_and_parse(GF_DownloadSession *sess, char * sHTTP)
 		return GF_OK;
 	}
 
+	/*pipelined request, wait for the previous responses to be read*/
+	if (sess->conn && gf_dm_sess_wait_pipeline(sess))
+		return GF_OK;
+
 	buf_size = sess->dm ? sess->dm->read_buf_size : GF_DOWNLOAD_BUFFER_SIZE;
 
 	//always set start time to the time at last attempt reply parsing
@@ -2794,6 +3188,10 @@ static GF_Err wait_for_header_and_parse(GF_DownloadSession *sess, char * sHTTP)
 		e = GF_REMOTE_SERVICE_ERROR;
 		goto exit;
 	}
+	/*HTTP/1.0 servers close the connection after the response unless asked to keep it alive*/
+	else if (!strncmp("HTTP/1.0", comp, 8)) {
+		connection_closed = GF_TRUE;
+	}
 	Pos = gf_token_get(buf, Pos, " ", comp, 400);
 	if (Pos <= 0) {
 		e = GF_REMOTE_SERVICE_ERROR;
@@ -2917,6 +3315,8 @@ static GF_Err wait_for_header_and_parse(GF_DownloadSession *sess, char * sHTTP)
 		else if (!stricmp(hdrp->name, "Connection") ) {
 			if (strstr(hdrp->value, "close"))
 				connection_closed = GF_TRUE;
+			else if (strstr(hdrp->value, "keep-alive") || strstr(hdrp->value, "Keep-Alive"))
+				connection_closed = GF_FALSE;
 		}
 
 		if (sess->status==GF_NETIO_DISCONNECTED) return GF_OK;
@@ -3009,6 +3409,19 @@ static GF_Err wait_for_header_and_parse(GF_DownloadSession *sess, char * sHTTP)
 	{
 		sess->status = GF_NETIO_PARSE_REPLY;
 		assert(sess->cache_entry);
+		/*memory stored entries are served from their disk copy*/
+		if (gf_cache_load_disk_copy(sess->cache_entry)) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[HTTP] Cannot reload %s from cache, downloading it again\n", sess->orig_url));
+			gf_dm_disconnect(sess, GF_FALSE);
+			sess->status = GF_NETIO_SETUP;
+			e = gf_dm_sess_setup_from_url(sess, sess->orig_url);
+			if (e) {
+				sess->status = GF_NETIO_STATE_ERROR;
+				sess->last_error = e;
+				gf_dm_sess_notify_state(sess, sess->status, e);
+			}
+			return e;
+		}
 		sess->total_size = gf_cache_get_cache_filesize(sess->cache_entry);
 
 		gf_dm_sess_notify_state(sess, GF_NETIO_PARSE_REPLY, GF_OK);
@@ -3018,10 +3431,9 @@ static GF_Err wait_for_header_and_parse(GF_DownloadSession *sess, char * sHTTP)
 			/* For modules that do not use cache and have problems with GF_NETIO_DATA_TRANSFERED ... */
 			const char * filename;
 			FILE * f;
-			filename = gf_cache_get_cache_filename(sess->cache_entry);
+			filename = gf_cache_get_disk_filename(sess->cache_entry);
 			GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[HTTP] Sending data to modules from %s...\n", filename));
-			f = gf_fopen(filename, "rb");
-			assert(filename);
+			f = filename ? gf_fopen(filename, "rb") : NULL;
 			if (!f) {
 				GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[HTTP] FAILED to open cache file %s for reading contents !\n", filename));
 				/* Ooops, no cache, redowload everything ! */
@@ -3163,6 +3575,7 @@ static GF_Err wait_for_header_and_parse(GF_DownloadSession *sess, char * sHTTP)
 		sess->use_cache_file = GF_FALSE;
 
 	if (sess->http_read_type==HEAD) {
+		if (BodyStart == bytesRead) sess->conn_reusable = GF_TRUE;
 		gf_dm_disconnect(sess, GF_FALSE);
 		gf_dm_sess_notify_state(sess, GF_NETIO_DATA_TRANSFERED, GF_OK);
 		sess->http_read_type = GET;
@@ -3680,6 +4093,24 @@ u32 gf_dm_get_global_rate(GF_DownloadManager *dm)
 	return 8*ret;
 }
 
+GF_EXPORT
+GF_Err gf_dm_get_connection_stats(GF_DownloadManager *dm, GF_DMConnectionStats *stats)
+{
+	u32 i, count;
+	if (!dm || !stats) return GF_BAD_PARAM;
+	gf_mx_p(dm->conn_mx);
+	*stats = dm->conn_stats;
+	stats->nb_idle = stats->nb_active = 0;
+	count = gf_list_count(dm->connections);
+	for (i=0; i<count; i++) {
+		GF_DMConnection *conn = (GF_DMConnection *)gf_list_get(dm->connections, i);
+		if (gf_list_count(conn->pipeline)) stats->nb_active++;
+		else stats->nb_idle++;
+	}
+	gf_mx_v(dm->conn_mx);
+	return GF_OK;
+}
+
 GF_EXPORT
 const char *gf_dm_sess_get_header(GF_DownloadSession *sess, const char *name)
 {
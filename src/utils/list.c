@@ -38,14 +38,18 @@
 
 	multi-step memory array withou gf_realloc on remove, using the GF_LIST_REALLOC macro
 	GF_LIST_ARRAY_GROW
+
+	The mode may be forced at build time by defining one of the above, otherwise GF_LIST_ARRAY_GROW is used
 */
 
+#if !defined(GF_LIST_LINKED) && !defined(GF_LIST_DOUBLE_LINKED) && !defined(GF_LIST_ARRAY) && !defined(GF_LIST_ARRAY_GROW)
 /*after some tuning, this seems to be the fastest mode on WINCE*/
 #ifdef _WIN32_WCE
 #define GF_LIST_LINKED
 #else
 #define GF_LIST_ARRAY_GROW
 #endif
+#endif
 
 #define GF_LIST_REALLOC(a) (a = a ? (3*a/2) : 10)
 //#define GF_LIST_REALLOC(a) (a++)
@@ -95,6 +99,13 @@ void gf_list_reset(GF_List *ptr)
 	while (ptr && ptr->entryCount) gf_list_rem(ptr, 0);
 }
 
+/*nothing to pre-allocate for linked lists*/
+GF_EXPORT
+GF_Err gf_list_reserve(GF_List *ptr, u32 nb_items)
+{
+	return ptr ? GF_OK : GF_BAD_PARAM;
+}
+
 GF_EXPORT
 GF_Err gf_list_add(GF_List *ptr, void* item)
 {
@@ -293,6 +304,13 @@ void gf_list_reset(GF_List *ptr)
 	while (ptr && ptr->entryCount) gf_list_rem(ptr, 0);
 }
 
+/*nothing to pre-allocate for linked lists*/
+GF_EXPORT
+GF_Err gf_list_reserve(GF_List *ptr, u32 nb_items)
+{
+	return ptr ? GF_OK : GF_BAD_PARAM;
+}
+
 GF_EXPORT
 GF_Err gf_list_add(GF_List *ptr, void* item)
 {
@@ -319,7 +337,7 @@ GF_Err gf_list_add(GF_List *ptr, void* item)
 
 
 GF_EXPORT
-u32 gf_list_count(GF_List *ptr)
+u32 gf_list_count(const GF_List *ptr)
 {
 	if (! ptr) return 0;
 	return ptr->entryCount;
@@ -514,7 +532,7 @@ GF_Err gf_list_add(GF_List *ptr, void* item)
 }
 
 GF_EXPORT
-u32 gf_list_count(GF_List *ptr)
+u32 gf_list_count(const GF_List *ptr)
 {
 	return ptr ? ptr->entryCount : 0;
 }
@@ -584,6 +602,13 @@ void gf_list_reset(GF_List *ptr)
 	}
 }
 
+/*the array is reallocated to its exact size at each add/remove, nothing to pre-allocate*/
+GF_EXPORT
+GF_Err gf_list_reserve(GF_List *ptr, u32 nb_items)
+{
+	return ptr ? GF_OK : GF_BAD_PARAM;
+}
+
 #else	/*GF_LIST_ARRAY_GROW*/
 
 
@@ -701,6 +726,19 @@ void gf_list_reset(GF_List *ptr)
 	if (ptr) ptr->entryCount = 0;
 }
 
+GF_EXPORT
+GF_Err gf_list_reserve(GF_List *ptr, u32 nb_items)
+{
+	void **slots;
+	if (!ptr) return GF_BAD_PARAM;
+	if (nb_items <= ptr->allocSize) return GF_OK;
+	slots = (void**)gf_realloc(ptr->slots, nb_items*sizeof(void*));
+	if (!slots) return GF_OUT_OF_MEM;
+	ptr->slots = slots;
+	ptr->allocSize = nb_items;
+	return GF_OK;
+}
+
 #endif
 
 GF_EXPORT
@@ -744,26 +782,41 @@ void *gf_list_rev_enum(GF_List *ptr, u32 *pos) {
 GF_EXPORT
 GF_Err gf_list_swap(GF_List *l1, GF_List *l2)
 {
-	GF_Err e;
-	u32 count = gf_list_count(l1);
+	GF_List tmp;
 	if (!l1 || !l2) return GF_BAD_PARAM;
 	if (l1 == l2) return GF_OK;
 
-	while (gf_list_count(l2)) {
-		void *ptr = gf_list_get(l2, 0);
-		e = gf_list_rem(l2, 0);
-		if (e) return e;
-		e = gf_list_add(l1, ptr);
-		if (e) return e;
-	}
-	while (count) {
-		void *ptr = gf_list_get(l1, 0);
-		e = gf_list_rem(l1, 0);
-		if (e) return e;
-		count--;
-		e = gf_list_add(l2, ptr);
-		if (e) return e;
+	/*all modes keep their state in the list object, swap them*/
+	tmp = *l1;
+	*l1 = *l2;
+	*l2 = tmp;
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_list_append(GF_List *dst, GF_List *src)
+{
+	u32 count;
+	GF_Err e;
+	if (!dst || !src) return GF_BAD_PARAM;
+	count = gf_list_count(src);
+	if (!count) return GF_OK;
+
+#if defined(GF_LIST_ARRAY_GROW)
+	e = gf_list_reserve(dst, dst->entryCount + count);
+	if (e) return e;
+	/*src slots may have been reallocated if src==dst*/
+	memcpy(dst->slots + dst->entryCount, src->slots, sizeof(void*)*count);
+	dst->entryCount += count;
+#else
+	{
+		u32 i;
+		for (i=0; i<count; i++) {
+			e = gf_list_add(dst, gf_list_get(src, i));
+			if (e) return e;
+		}
 	}
+#endif
 	return GF_OK;
 }
 
@@ -774,31 +827,36 @@ GF_Err gf_list_transfer(GF_List *l1, GF_List *l2)
 	if (!l1 || !l2) return GF_BAD_PARAM;
 	if (l1 == l2) return GF_OK;
 
-	while (gf_list_count(l2)) {
-		void *ptr = gf_list_get(l2, 0);
-		e = gf_list_rem(l2, 0);
-		if (e) return e;
-		e = gf_list_add(l1, ptr);
-		if (e) return e;
-	}
+	e = gf_list_append(l1, l2);
+	if (e) return e;
+	gf_list_reset(l2);
 	return GF_OK;
 }
 
 GF_EXPORT
 GF_List* gf_list_clone(GF_List *ptr) {
 	GF_List* new_list;
-	u32 i = 0;
-	void* item;
 	if (!ptr) return NULL;
 	new_list = gf_list_new();
-	while ((item = gf_list_enum(ptr, &i)))
-		gf_list_add(new_list, item);
-
+	if (!new_list) return NULL;
+	if (gf_list_append(new_list, ptr) != GF_OK) {
+		gf_list_del(new_list);
+		return NULL;
+	}
 	return new_list;
 }
 
 GF_EXPORT
 void gf_list_reverse(GF_List *ptr) {
+#if defined(GF_LIST_ARRAY) || defined(GF_LIST_ARRAY_GROW)
+	u32 i, j;
+	if (!ptr || !ptr->entryCount) return;
+	for (i=0, j=ptr->entryCount-1; i<j; i++, j--) {
+		void *item = ptr->slots[i];
+		ptr->slots[i] = ptr->slots[j];
+		ptr->slots[j] = item;
+	}
+#else
 	GF_List* saved_order;
 	void* item;
 	u32 i = 0;
@@ -811,6 +869,7 @@ void gf_list_reverse(GF_List *ptr) {
 	}
 
 	gf_list_del(saved_order);
+#endif
 }
 
 GF_EXPORT
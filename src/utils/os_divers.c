@@ -139,6 +139,32 @@ void gf_sleep(u32 ms)
 #endif
 }
 
+GF_EXPORT
+void gf_sleep_until_high_res(u64 clock_us, u32 spin_us)
+{
+	u64 now = gf_sys_clock_high_res();
+	if (now >= clock_us) return;
+
+	if (clock_us - now > spin_us) {
+		u64 sleep_us = clock_us - now - spin_us;
+#ifdef WIN32
+		/*millisecond granularity, the remaining time is busy-waited*/
+		if (sleep_us >= 1000) Sleep((u32) (sleep_us / 1000));
+#else
+		struct timespec ts;
+		ts.tv_sec = (time_t) (sleep_us / 1000000);
+		ts.tv_nsec = (long) ((sleep_us % 1000000) * 1000);
+#if defined(CLOCK_MONOTONIC) && !defined(__DARWIN__) && !defined(__APPLE__)
+		while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR) {}
+#else
+		while (nanosleep(&ts, &ts) && (errno == EINTR)) {}
+#endif
+#endif
+	}
+	if (!spin_us) return;
+	while (gf_sys_clock_high_res() < clock_us) {}
+}
+
 #ifndef gettimeofday
 #ifdef _WIN32_WCE
 
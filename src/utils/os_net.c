@@ -23,6 +23,11 @@
  *
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/*for recvmmsg/sendmmsg*/
+#define _GNU_SOURCE
+#endif
+
 #ifndef GPAC_DISABLE_CORE_TOOLS
 
 #if defined(WIN32) || defined(_WIN32_WCE)
@@ -112,6 +117,16 @@ static int wsa_init = 0;
 
 #include <gpac/network.h>
 
+/*batched datagram I/O*/
+#if defined(GPAC_CONFIG_LINUX) && defined(MSG_WAITFORONE)
+#define GPAC_HAS_MMSG
+#include <time.h>
+#if defined(SO_TXTIME)
+#include <linux/net_tstamp.h>
+#define GPAC_HAS_TXTIME
+#endif
+#endif
+
 /*not defined on solaris*/
 #if !defined(INADDR_NONE)
 # if (defined(sun) && defined(__SVR4))
@@ -151,6 +166,13 @@ typedef s32 SOCKET;
 
 #define SOCK_MICROSEC_WAIT	500
 
+/*writing on a connection closed by the peer (eg, a kept-alive HTTP connection) fails instead of raising SIGPIPE*/
+#ifdef MSG_NOSIGNAL
+#define SOCK_SEND_FLAGS	MSG_NOSIGNAL
+#else
+#define SOCK_SEND_FLAGS	0
+#endif
+
 #ifdef GPAC_HAS_IPV6
 static u32 ipv6_check_state = 0;
 #endif
@@ -172,7 +194,11 @@ enum
 	GF_SOCK_IS_LISTENING = 1<<13,
 	/*socket is bound to a specific dest (server) or source (client) */
 	GF_SOCK_HAS_PEER = 1<<14,
-	GF_SOCK_IS_MIP = 1<<15
+	GF_SOCK_IS_MIP = 1<<15,
+	/*kernel reception timestamps are enabled*/
+	GF_SOCK_HAS_RX_TIMESTAMPS = 1<<16,
+	/*SO_TXTIME is enabled, batched sends carry their send time*/
+	GF_SOCK_HAS_TXTIME = 1<<17
 };
 
 struct __tag_socket
@@ -875,7 +901,7 @@ GF_Err gf_sk_send(GF_Socket *sock, const char *buffer, u32 length)
 		if (sock->flags & GF_SOCK_HAS_PEER) {
 			res = (s32) sendto(sock->socket, (char *) buffer+count,  length - count, 0, (struct sockaddr *) &sock->dest_addr, sock->dest_addr_len);
 		} else {
-			res = (s32) send(sock->socket, (char *) buffer+count, length - count, 0);
+			res = (s32) send(sock->socket, (char *) buffer+count, length - count, SOCK_SEND_FLAGS);
 		}
 		if (res == SOCKET_ERROR) {
 			if (not_ready)
@@ -887,6 +913,9 @@ GF_Err gf_sk_send(GF_Socket *sock, const char *buffer, u32 length)
 #ifndef __SYMBIAN32__
 			case ENOTCONN:
 			case ECONNRESET:
+#ifdef EPIPE
+			case EPIPE:
+#endif
 				return GF_IP_CONNECTION_CLOSED;
 #endif
 			default:
@@ -1221,6 +1250,270 @@ GF_Err gf_sk_receive(GF_Socket *sock, char *buffer, u32 length, u32 startFrom, u
 }
 
 
+#ifdef GPAC_HAS_MMSG
+
+/*max number of datagrams per recvmmsg/sendmmsg call*/
+#define GF_SOCK_MAX_BATCH	64
+
+/*offset in microseconds from the system UTC clock to gf_sys_clock_high_res*/
+static s64 gf_sk_utc_offset()
+{
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return ((s64) now.tv_sec) * 1000000 + now.tv_usec - (s64) gf_sys_clock_high_res();
+}
+
+#ifdef GPAC_HAS_TXTIME
+/*offset in nanoseconds from gf_sys_clock_high_res to CLOCK_MONOTONIC, used by SO_TXTIME*/
+static s64 gf_sk_monotonic_offset()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((s64) now.tv_sec) * 1000000000 + now.tv_nsec - ((s64) gf_sys_clock_high_res()) * 1000;
+}
+#endif
+
+#endif /*GPAC_HAS_MMSG*/
+
+GF_EXPORT
+GF_Err gf_sk_set_rx_timestamps(GF_Socket *sock, Bool enable)
+{
+#if defined(GPAC_HAS_MMSG) && defined(SO_TIMESTAMPNS)
+	int val = enable ? 1 : 0;
+	if (!sock || !sock->socket) return GF_BAD_PARAM;
+	if (sock->flags & GF_SOCK_IS_TCP) return GF_NOT_SUPPORTED;
+
+	if (setsockopt(sock->socket, SOL_SOCKET, SO_TIMESTAMPNS, (const char *) &val, sizeof(val)) == SOCKET_ERROR) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] cannot %s reception timestamps (error %d)\n", enable ? "enable" : "disable", LASTSOCKERROR));
+		return GF_IP_NETWORK_FAILURE;
+	}
+	if (enable) sock->flags |= GF_SOCK_HAS_RX_TIMESTAMPS;
+	else sock->flags &= ~GF_SOCK_HAS_RX_TIMESTAMPS;
+	return GF_OK;
+#else
+	return GF_NOT_SUPPORTED;
+#endif
+}
+
+GF_EXPORT
+GF_Err gf_sk_set_paced_send(GF_Socket *sock, Bool enable)
+{
+#if defined(GPAC_HAS_TXTIME)
+	struct sock_txtime txtime;
+	if (!sock || !sock->socket) return GF_BAD_PARAM;
+	if (sock->flags & GF_SOCK_IS_TCP) return GF_NOT_SUPPORTED;
+
+	/*the option cannot be removed from the socket, we simply stop attaching send times*/
+	if (!enable) {
+		sock->flags &= ~GF_SOCK_HAS_TXTIME;
+		return GF_OK;
+	}
+	memset(&txtime, 0, sizeof(struct sock_txtime));
+	txtime.clockid = CLOCK_MONOTONIC;
+	if (setsockopt(sock->socket, SOL_SOCKET, SO_TXTIME, (const char *) &txtime, sizeof(txtime)) == SOCKET_ERROR) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] cannot enable paced send (error %d)\n", LASTSOCKERROR));
+		return GF_NOT_SUPPORTED;
+	}
+	sock->flags |= GF_SOCK_HAS_TXTIME;
+	return GF_OK;
+#else
+	return GF_NOT_SUPPORTED;
+#endif
+}
+
+GF_EXPORT
+GF_Err gf_sk_receive_batch(GF_Socket *sock, GF_SockDatagram *datagrams, u32 nb_datagrams, u32 *nb_read)
+{
+	u32 i;
+	GF_Err e = GF_OK;
+#ifdef GPAC_HAS_MMSG
+	s32 res, ready;
+	s64 utc_offset = 0;
+	struct timeval timeout;
+	fd_set Group;
+	struct mmsghdr msgs[GF_SOCK_MAX_BATCH];
+	struct iovec iovs[GF_SOCK_MAX_BATCH];
+	char ctrl[GF_SOCK_MAX_BATCH][CMSG_SPACE(sizeof(struct timespec))];
+#endif
+
+	if (!nb_read) return GF_BAD_PARAM;
+	*nb_read = 0;
+	if (!sock || !sock->socket || !datagrams) return GF_BAD_PARAM;
+
+#ifdef GPAC_HAS_MMSG
+	if (!(sock->flags & GF_SOCK_IS_TCP)) {
+		//can we read?
+		FD_ZERO(&Group);
+		FD_SET(sock->socket, &Group);
+		timeout.tv_sec = 0;
+		timeout.tv_usec = SOCK_MICROSEC_WAIT;
+		ready = select((int) sock->socket+1, &Group, NULL, NULL, &timeout);
+		if (ready == SOCKET_ERROR) {
+			switch (LASTSOCKERROR) {
+			case EBADF:
+				return GF_IP_CONNECTION_CLOSED;
+			case EAGAIN:
+				return GF_IP_SOCK_WOULD_BLOCK;
+			case EINTR:
+				return GF_IP_NETWORK_EMPTY;
+			default:
+				GF_LOG(GF_LOG_ERROR, GF_LOG_NETWORK, ("[socket] cannot select (error %d)\n", LASTSOCKERROR));
+				return GF_IP_NETWORK_FAILURE;
+			}
+		}
+		if (!ready || !FD_ISSET(sock->socket, &Group)) return GF_IP_NETWORK_EMPTY;
+
+		if (sock->flags & GF_SOCK_HAS_RX_TIMESTAMPS) utc_offset = gf_sk_utc_offset();
+
+		//read everything pending, GF_SOCK_MAX_BATCH datagrams at a time
+		while (*nb_read < nb_datagrams) {
+			GF_SockDatagram *dg = datagrams + *nb_read;
+			u32 nb = MIN(nb_datagrams - *nb_read, GF_SOCK_MAX_BATCH);
+
+			memset(msgs, 0, sizeof(struct mmsghdr)*nb);
+			for (i=0; i<nb; i++) {
+				iovs[i].iov_base = dg[i].data;
+				iovs[i].iov_len = dg[i].size;
+				msgs[i].msg_hdr.msg_iov = &iovs[i];
+				msgs[i].msg_hdr.msg_iovlen = 1;
+				if (sock->flags & GF_SOCK_HAS_PEER) {
+					msgs[i].msg_hdr.msg_name = &sock->dest_addr;
+					msgs[i].msg_hdr.msg_namelen = sizeof(sock->dest_addr);
+				}
+				if (sock->flags & GF_SOCK_HAS_RX_TIMESTAMPS) {
+					msgs[i].msg_hdr.msg_control = ctrl[i];
+					msgs[i].msg_hdr.msg_controllen = sizeof(ctrl[i]);
+				}
+			}
+			res = recvmmsg(sock->socket, msgs, nb, MSG_DONTWAIT, NULL);
+			if (res == SOCKET_ERROR) {
+				res = LASTSOCKERROR;
+				if ((res == EAGAIN) || (res == EWOULDBLOCK)) break;
+				GF_LOG(GF_LOG_ERROR, GF_LOG_NETWORK, ("[socket] error reading - socket error %d\n",  res));
+				e = (res==ECONNREFUSED) ? GF_IP_CONNECTION_CLOSED : GF_IP_NETWORK_FAILURE;
+				break;
+			}
+			for (i=0; i<(u32) res; i++) {
+				struct cmsghdr *cmsg;
+				dg[i].read = msgs[i].msg_len;
+				dg[i].timestamp = 0;
+				if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+					GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] datagram truncated to %d bytes\n", dg[i].size));
+				}
+				if (sock->flags & GF_SOCK_HAS_PEER) sock->dest_addr_len = msgs[i].msg_hdr.msg_namelen;
+				if (!(sock->flags & GF_SOCK_HAS_RX_TIMESTAMPS)) continue;
+
+				for (cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+					if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS)) {
+						struct timespec ts;
+						memcpy(&ts, CMSG_DATA(cmsg), sizeof(struct timespec));
+						dg[i].timestamp = (u64) (((s64) ts.tv_sec) * 1000000 + ts.tv_nsec / 1000 - utc_offset);
+						break;
+					}
+				}
+			}
+			*nb_read += res;
+			if ((u32) res < nb) break;
+		}
+		if (*nb_read) return GF_OK;
+		return e ? e : GF_IP_NETWORK_EMPTY;
+	}
+#endif
+
+	//one datagram per call
+	for (i=0; i<nb_datagrams; i++) {
+		datagrams[i].timestamp = 0;
+		e = gf_sk_receive(sock, datagrams[i].data, datagrams[i].size, 0, &datagrams[i].read);
+		if (e || !datagrams[i].read) break;
+		(*nb_read)++;
+	}
+	if (*nb_read) return GF_OK;
+	return e ? e : GF_IP_NETWORK_EMPTY;
+}
+
+GF_EXPORT
+GF_Err gf_sk_send_batch(GF_Socket *sock, GF_SockDatagram *datagrams, u32 nb_datagrams, u32 *nb_sent)
+{
+	u32 i;
+	GF_Err e;
+#ifdef GPAC_HAS_MMSG
+	s32 res;
+	struct mmsghdr msgs[GF_SOCK_MAX_BATCH];
+	struct iovec iovs[GF_SOCK_MAX_BATCH];
+#ifdef GPAC_HAS_TXTIME
+	s64 mono_offset = 0;
+	char ctrl[GF_SOCK_MAX_BATCH][CMSG_SPACE(sizeof(u64))];
+#endif
+#endif
+
+	if (!nb_sent) return GF_BAD_PARAM;
+	*nb_sent = 0;
+	if (!sock || !sock->socket || !datagrams) return GF_BAD_PARAM;
+
+#ifdef GPAC_HAS_MMSG
+	if (!(sock->flags & GF_SOCK_IS_TCP)) {
+#ifdef GPAC_HAS_TXTIME
+		if (sock->flags & GF_SOCK_HAS_TXTIME) mono_offset = gf_sk_monotonic_offset();
+#endif
+		while (*nb_sent < nb_datagrams) {
+			GF_SockDatagram *dg = datagrams + *nb_sent;
+			u32 nb = MIN(nb_datagrams - *nb_sent, GF_SOCK_MAX_BATCH);
+
+			memset(msgs, 0, sizeof(struct mmsghdr)*nb);
+			for (i=0; i<nb; i++) {
+				iovs[i].iov_base = dg[i].data;
+				iovs[i].iov_len = dg[i].size;
+				msgs[i].msg_hdr.msg_iov = &iovs[i];
+				msgs[i].msg_hdr.msg_iovlen = 1;
+				if (sock->flags & GF_SOCK_HAS_PEER) {
+					msgs[i].msg_hdr.msg_name = &sock->dest_addr;
+					msgs[i].msg_hdr.msg_namelen = sock->dest_addr_len;
+				}
+#ifdef GPAC_HAS_TXTIME
+				if ((sock->flags & GF_SOCK_HAS_TXTIME) && dg[i].timestamp) {
+					struct cmsghdr *cmsg;
+					u64 txtime = (u64) (((s64) dg[i].timestamp) * 1000 + mono_offset);
+					msgs[i].msg_hdr.msg_control = ctrl[i];
+					msgs[i].msg_hdr.msg_controllen = sizeof(ctrl[i]);
+					cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr);
+					cmsg->cmsg_level = SOL_SOCKET;
+					cmsg->cmsg_type = SCM_TXTIME;
+					cmsg->cmsg_len = CMSG_LEN(sizeof(u64));
+					memcpy(CMSG_DATA(cmsg), &txtime, sizeof(u64));
+				}
+#endif
+			}
+			res = sendmmsg(sock->socket, msgs, nb, 0);
+			if (res == SOCKET_ERROR) {
+				switch (res = LASTSOCKERROR) {
+				case EAGAIN:
+					return GF_IP_SOCK_WOULD_BLOCK;
+				case ENOTCONN:
+				case ECONNRESET:
+				case ECONNREFUSED:
+					return GF_IP_CONNECTION_CLOSED;
+				default:
+					GF_LOG(GF_LOG_ERROR, GF_LOG_NETWORK, ("[socket] error sending - socket error %d\n",  res));
+					return GF_IP_NETWORK_FAILURE;
+				}
+			}
+			*nb_sent += res;
+		}
+		return GF_OK;
+	}
+#endif
+
+	//one datagram per call
+	for (i=0; i<nb_datagrams; i++) {
+		e = gf_sk_send(sock, datagrams[i].data, datagrams[i].size);
+		if (e) return e;
+		(*nb_sent)++;
+	}
+	return GF_OK;
+}
+
+
+GF_EXPORT
 GF_Err gf_sk_listen(GF_Socket *sock, u32 MaxConnection)
 {
 	s32 i;
@@ -1232,6 +1525,7 @@ GF_Err gf_sk_listen(GF_Socket *sock, u32 MaxConnection)
 	return GF_OK;
 }
 
+GF_EXPORT
 GF_Err gf_sk_accept(GF_Socket *sock, GF_Socket **newConnection)
 {
 	u32 client_address_size;
@@ -1555,7 +1849,7 @@ GF_Err gf_sk_send_wait(GF_Socket *sock, const char *buffer, u32 length, u32 Seco
 	//direct writing
 	count = 0;
 	while (count < length) {
-		res = (s32) send(sock->socket, (char *) buffer+count, length - count, 0);
+		res = (s32) send(sock->socket, (char *) buffer+count, length - count, SOCK_SEND_FLAGS);
 		if (res == SOCKET_ERROR) {
 			switch (LASTSOCKERROR) {
 			case EAGAIN:
@@ -0,0 +1,26 @@
+#test HTTP connection reuse and pipelining of the downloader against the loopback server of httpconn
+
+http_conn_test ()
+{
+
+test_begin "http-connections-$1" "download"
+if [ $test_skip  = 1 ] ; then
+return
+fi
+
+do_test "httpconn $2" "download"
+
+test_end
+}
+
+`httpconn -h 2> /dev/null`
+if [ $? = 0 ] ; then
+#HTTP/1.1: all requests pipelined on a single connection
+http_conn_test "pipeline" "-port 8642 -nb-req 4"
+
+#HTTP/1.0: requests pipelined behind a closing response are sent again on new connections
+http_conn_test "http10" "-port 8643 -nb-req 4 -http10"
+
+#non-threaded sessions reuse the kept-alive connection
+http_conn_test "sync" "-port 8644 -nb-req 4 -sync"
+fi
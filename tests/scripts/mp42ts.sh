@@ -42,4 +42,28 @@ ts_test "temi" "-src $mp4file -dst-file=$tsfile -temi -insert-ntp"
 
 ts_test "pcr" "-src $mp4file -dst-file=$tsfile -pcr-ms 40 -force-pcr-only -pcr-init 0 -pcr-offset 30000 -rap"
 
+#UDP output over loopback, smoke test only: tspcrcheck fails if it does not receive PCRs
+#loopback timing is too noisy to check the pacing itself, the measured jitter is only logged
+ts_udp_test ()
+{
+
+test_begin "mp42ts-$1" "receive" "send"
+if [ $test_skip  = 1 ] ; then
+return
+fi
+
+do_test "tspcrcheck -ip $IFCE -port 1234 -duration 5000" "receive" &
+sleep 1
+
+do_test "$MP42TS -src $mp4file -dst-udp=$IFCE:1234 -real-time -time 3000 -pcr-init 0 $2" "send"
+
+wait
+test_end
+}
+
+`tspcrcheck -h 2> /dev/null`
+if [ $? = 0 ] ; then
+ts_udp_test "pace" "-rate 2000 -nb-pack 7 -pace"
+fi
+
 rm $mp4file
\ No newline at end of file
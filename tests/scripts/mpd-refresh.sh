@@ -0,0 +1,94 @@
+#test incremental refresh of a dynamic MPD against a full parse of each version, using mpdrefresh
+
+#writes a dynamic MPD to $1 with publishTime $2, the S elements $3 and $4 of the video and audio timelines and the extra video representations $5
+mpd_gen ()
+{
+cat > $1 << EOF
+<?xml version="1.0"?>
+<MPD xmlns="urn:mpeg:dash:schema:mpd:2011" type="dynamic" profiles="urn:mpeg:dash:profile:isoff-live:2011" availabilityStartTime="2016-01-01T00:00:00Z" publishTime="$2" minimumUpdatePeriod="PT2S" minBufferTime="PT2S" timeShiftBufferDepth="PT30S">
+ <!-- <SegmentTimeline> in comments and attributes is not a timeline -->
+ <Period id="p0" start="PT0S">
+  <AdaptationSet mimeType="video/mp4" segmentAlignment="true" title="a > b">
+   <SegmentTemplate timescale="1000" media="video_\$Time\$.m4s" initialization="video_init.mp4">
+    <SegmentTimeline>
+$3
+    </SegmentTimeline>
+   </SegmentTemplate>
+   <Representation id="v1" bandwidth="500000" width="640" height="360" codecs="avc1.42c01e"/>
+$5
+  </AdaptationSet>
+  <AdaptationSet mimeType="audio/mp4" segmentAlignment="true">
+   <Representation id="a1" bandwidth="64000" codecs="mp4a.40.2">
+    <SegmentTemplate timescale="48000" media="audio_\$Time\$.m4s" initialization="audio_init.mp4">
+     <SegmentTimeline>
+$4
+     </SegmentTimeline>
+    </SegmentTemplate>
+   </Representation>
+  </AdaptationSet>
+ </Period>
+</MPD>
+EOF
+}
+
+mpd_refresh_test ()
+{
+
+test_begin "mpd-refresh-$1" "refresh"
+if [ $test_skip  = 1 ] ; then
+return
+fi
+
+do_test "mpdrefresh $2" "refresh"
+
+test_end
+}
+
+`mpdrefresh -h 2> /dev/null`
+if [ $? = 0 ] ; then
+
+mpd0="$TEMP_DIR/refresh0.mpd"
+mpd1="$TEMP_DIR/refresh1.mpd"
+mpd2="$TEMP_DIR/refresh2.mpd"
+mpd3="$TEMP_DIR/refresh3.mpd"
+mpd4="$TEMP_DIR/refresh4.mpd"
+
+video='     <S t="0" d="2000" r="4"/>
+     <S d="1000"/>'
+audio='      <S t="0" d="96000" r="4"/>
+      <S d="48000"/>'
+mpd_gen $mpd0 "2016-01-01T00:00:10Z" "$video" "$audio" ""
+
+#S elements appended to both timelines
+video="$video"'
+     <S d="2000"/>
+     <S d="1000"/>'
+audio="$audio"'
+      <S d="96000"/>'
+mpd_gen $mpd1 "2016-01-01T00:00:12Z" "$video" "$audio" ""
+
+#repeat count of the last S of the video timeline changed, audio unchanged
+video='     <S t="0" d="2000" r="4"/>
+     <S d="1000"/>
+     <S d="2000"/>
+     <S d="1000" r="2"/>'
+mpd_gen $mpd2 "2016-01-01T00:00:14Z" "$video" "$audio" ""
+
+#representation added, requires a full parse
+mpd_gen $mpd3 "2016-01-01T00:00:16Z" "$video" "$audio" '   <Representation id="v2" bandwidth="1000000" width="1280" height="720" codecs="avc1.42c01f"/>'
+
+#S elements appended after the full parse
+video="$video"'
+     <S d="2000" r="1"/>'
+mpd_gen $mpd4 "2016-01-01T00:00:18Z" "$video" "$audio" '   <Representation id="v2" bandwidth="1000000" width="1280" height="720" codecs="avc1.42c01f"/>'
+
+mpd_refresh_test "append" "$mpd0 -incremental $mpd1"
+
+mpd_refresh_test "repeat" "$mpd1 -incremental $mpd2"
+
+mpd_refresh_test "structure" "$mpd2 -full $mpd3"
+
+mpd_refresh_test "sequence" "$mpd0 -incremental $mpd1 -incremental $mpd2 -full $mpd3 -incremental $mpd4"
+
+rm -f $mpd0 $mpd1 $mpd2 $mpd3 $mpd4
+fi